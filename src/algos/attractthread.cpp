@@ -6,6 +6,7 @@
  */
 
 #include "attractthread.h"
+#include "trace.h"
 
 #include "../gui/gl/glfunctions.h"
 
@@ -27,6 +28,8 @@ AttractThread::~AttractThread()
 
 void AttractThread::run()
 {
+    TRACE_SCOPE( "AttractThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
 
     for ( int ie = m_id; ie < m_edges.length(); ie += numThreads )
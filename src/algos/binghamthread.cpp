@@ -8,6 +8,7 @@
 
 #include "fmath.h"
 #include "sorts.h"
+#include "trace.h"
 
 #include "../data/datasets/datasetsh.h"
 #include "../data/mesh/tesselation.h"
@@ -33,6 +34,8 @@ std::vector<std::vector<float> > BinghamThread::getResultVector()
 
 void BinghamThread::run()
 {
+    TRACE_SCOPE( "BinghamThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
     std::vector<ColumnVector>* data = m_ds->getData();
 
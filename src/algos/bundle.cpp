@@ -8,27 +8,28 @@
 #include "bundle.h"
 #include "bundlethread.h"
 
-#include "kdtree.h"
-
 #include "../data/datasets/datasetfibers.h"
 
 #include "../gui/gl/glfunctions.h"
 
 #include <QThread>
 
+
 Bundle::Bundle( DatasetFibers* ds ) :
     m_sourceDataset( ds ),
     m_threadsRunning( 0 ),
     m_currentLoop( 0 ),
     m_iterations( 10 ),
     m_radius( 10.0 ),
-    m_smoothRange( 10.0 )
+    m_smoothRange( 10.0 ),
+    m_cellSize( 10.0 )
 {
     m_fibs = *( m_sourceDataset->getFibs() );
 }
 
 Bundle::~Bundle()
 {
+    clearThreads();
     m_fibs.clear();
 }
 
@@ -39,104 +40,198 @@ std::vector<Fib>Bundle::getFibs()
 
 void Bundle::start()
 {
+    m_currentLoop = 0;
+    initPoints();
+
+    clearThreads();
+    int numThreads = GLFunctions::idealThreadCount;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        BundleThread* t = new BundleThread( i, this );
+        m_threads.push_back( t );
+        connect( t, SIGNAL( progress() ), this, SLOT( slotProgress() ), Qt::QueuedConnection );
+        connect( t, SIGNAL( finished() ), this, SLOT( slotThreadFinished() ), Qt::QueuedConnection );
+    }
+
     startLoop();
 }
 
-void Bundle::startLoop()
+void Bundle::initPoints()
 {
-    int numThreads = GLFunctions::idealThreadCount;
-    ++m_currentLoop;
-    qDebug() << "start loop:" << m_currentLoop;
-
-    // build kdTree
-    int numPoints = 0;
-    m_kdVerts.clear();
-    m_reverseIndexes.clear();
+    unsigned int numPoints = 0;
+    m_fibStarts.resize( m_fibs.size() + 1 );
     for ( unsigned int i = 0; i < m_fibs.size(); ++i )
     {
+        m_fibStarts[i] = numPoints;
         numPoints += m_fibs[i].length();
-        for( unsigned int k = 0; k < m_fibs[i].length(); ++k )
+    }
+    m_fibStarts[m_fibs.size()] = numPoints;
+
+    m_points.resize( numPoints * 3 );
+    m_endpoints.resize( m_fibs.size() * 6 );
+    m_forces.assign( numPoints * 3, 0 );
+    m_pointCells.resize( numPoints );
+    m_cellPoints.resize( numPoints * 3 );
+    m_cellFibs.resize( numPoints );
+
+    for ( unsigned int i = 0; i < m_fibs.size(); ++i )
+    {
+        const std::vector<QVector3D>* verts = m_fibs[i].getVerts();
+        float* p = &m_points[m_fibStarts[i] * 3];
+        for ( unsigned int k = 0; k < verts->size(); ++k )
+        {
+            *p++ = verts->at( k ).x();
+            *p++ = verts->at( k ).y();
+            *p++ = verts->at( k ).z();
+        }
+        // start and end points never move, so their positions are fixed for the whole run
+        if ( verts->size() > 0 )
         {
-            m_kdVerts.push_back( m_fibs[i].getVert( k ).x() );
-            m_kdVerts.push_back( m_fibs[i].getVert( k ).y() );
-            m_kdVerts.push_back( m_fibs[i].getVert( k ).z() );
-            m_reverseIndexes.push_back( i );
+            float* e = &m_endpoints[i * 6];
+            e[0] = verts->front().x();
+            e[1] = verts->front().y();
+            e[2] = verts->front().z();
+            e[3] = verts->back().x();
+            e[4] = verts->back().y();
+            e[5] = verts->back().z();
         }
     }
-    KdTree* kdTree = new KdTree( numPoints, m_kdVerts.data() );
+}
 
+void Bundle::startLoop()
+{
+    m_loopTimer.start();
+    ++m_currentLoop;
+    qDebug() << "start loop:" << m_currentLoop;
 
-    // create threads;
-    for ( int i = 0; i < numThreads; ++i )
+    buildGrid();
+
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
     {
-        BundleThread* t = new BundleThread( i, &m_fibs, kdTree, &m_kdVerts, &m_reverseIndexes, numPoints );
-        t->setRadius( m_radius );
-        t->setIterations( m_iterations );
-        m_threads.push_back( t );
-        connect( t, SIGNAL( progress() ), this, SLOT( slotProgress() ), Qt::QueuedConnection );
-        connect( t, SIGNAL( finished() ), this, SLOT( slotThreadFinished() ), Qt::QueuedConnection );
+        m_threads[i]->setRadius( m_radius );
+        m_threads[i]->setPass( BundleThread::FORCES );
     }
-
-    // run threads
-    for ( int i = 0; i < numThreads; ++i )
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
     {
         ++m_threadsRunning;
         m_threads[i]->start();
     }
-
-
 }
 
-void Bundle::applyLoopResult()
+void Bundle::buildGrid()
 {
-    qDebug() << "apply";
-    // apply movement to fibs
-    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    unsigned int numPoints = m_pointCells.size();
+    if ( numPoints == 0 )
+    {
+        m_cellStarts.assign( 2, 0 );
+        m_gridDim[0] = m_gridDim[1] = m_gridDim[2] = 1;
+        return;
+    }
+
+    float min[3] = { m_points[0], m_points[1], m_points[2] };
+    float max[3] = { m_points[0], m_points[1], m_points[2] };
+    if ( m_currentLoop > 1 )
+    {
+        // the apply pass of the previous loop already collected the bounds per thread
+        for ( unsigned int i = 0; i < m_threads.size(); ++i )
+        {
+            m_threads[i]->bounds( min, max );
+        }
+    }
+    else
     {
-        int pc = 0;
-        std::vector< QVector3D > forces = m_threads[i]->getForces();
-        for( unsigned int k = i; k < m_fibs.size(); k += m_threads.size() )
+        for ( unsigned int i = 0; i < numPoints; ++i )
         {
-            Fib fib = m_fibs[k];
-            float size = fib.length() - 1;
-            float v = 1.0;
-            for ( unsigned int l = 1; l < fib.length() - 1; ++l )
+            for ( int a = 0; a < 3; ++a )
             {
-                QVector3D force = forces[pc++] / ( m_iterations * 0.50 );
-
-                if ( l < ( ( size / 100 ) * m_smoothRange ) )
-                {
-                    v = static_cast<float>( l ) / ( ( size / 100 ) * m_smoothRange );
-                }
-                else if ( l > ( ( size / 100 ) * ( 100. - m_smoothRange ) ) )
-                {
-                    v = static_cast<float>( size - l ) / ( ( size / 100 ) * m_smoothRange );
-                }
-                else
-                {
-                    v = 1.0;
-                }
-                QVector3D vert = fib[l];
-                vert.setX( fib[l].x() + force.x() * v );
-                vert.setY( fib[l].y() + force.y() * v );
-                vert.setZ( fib[l].z() + force.z() * v );
-                fib.setVert( l, vert );
-
+                min[a] = qMin( min[a], m_points[i * 3 + a] );
+                max[a] = qMax( max[a], m_points[i * 3 + a] );
             }
+        }
+    }
+
+    // cells at least as large as the query radius, so a query touches at most 3x3x3 cells,
+    // grown if needed to keep the cell table small
+    m_cellSize = qMax( m_radius, 0.001f );
+    double numCells = 0;
+    do
+    {
+        numCells = 1;
+        for ( int a = 0; a < 3; ++a )
+        {
+            m_gridMin[a] = min[a];
+            m_gridDim[a] = static_cast<int>( ( max[a] - min[a] ) / m_cellSize ) + 1;
+            numCells *= m_gridDim[a];
+        }
+        if ( numCells > 16777216. )
+        {
+            m_cellSize *= 1.25f;
+        }
+    }
+    while ( numCells > 16777216. );
 
-            m_fibs[k] = fib;
+    runThreads( BundleThread::CELLS );
+
+    // counting sort of the point positions and fiber ids into cell order
+    m_cellStarts.assign( static_cast<unsigned int>( numCells ) + 1, 0 );
+    for ( unsigned int i = 0; i < numPoints; ++i )
+    {
+        ++m_cellStarts[m_pointCells[i] + 1];
+    }
+    for ( unsigned int i = 1; i < m_cellStarts.size(); ++i )
+    {
+        m_cellStarts[i] += m_cellStarts[i - 1];
+    }
+    for ( unsigned int i = 0; i < m_fibs.size(); ++i )
+    {
+        for ( unsigned int k = m_fibStarts[i]; k < m_fibStarts[i + 1]; ++k )
+        {
+            unsigned int pos = m_cellStarts[m_pointCells[k]]++;
+            m_cellPoints[pos * 3] = m_points[k * 3];
+            m_cellPoints[pos * 3 + 1] = m_points[k * 3 + 1];
+            m_cellPoints[pos * 3 + 2] = m_points[k * 3 + 2];
+            m_cellFibs[pos] = i;
         }
     }
+    // the scatter advanced every start to the next cell's start, shift back
+    for ( unsigned int i = m_cellStarts.size() - 1; i > 0; --i )
+    {
+        m_cellStarts[i] = m_cellStarts[i - 1];
+    }
+    m_cellStarts[0] = 0;
+}
 
+void Bundle::runThreads( int pass )
+{
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->setPass( pass );
+        m_threads[i]->setRadius( m_radius );
+        m_threads[i]->start();
+    }
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->wait();
+    }
+}
 
-    // delete threads
+void Bundle::clearThreads()
+{
     for ( unsigned int i = 0; i < m_threads.size(); ++i )
     {
+        m_threads[i]->wait();
         delete m_threads[i];
     }
     m_threads.clear();
 }
 
+void Bundle::applyLoopResult()
+{
+    // moves the points in place and collects the new bounds for the next grid
+    runThreads( BundleThread::APPLY );
+    qDebug() << "loop" << m_currentLoop << "took" << m_loopTimer.elapsed() << "ms for" << m_fibs.size() << "fibers";
+}
+
 void Bundle::slotProgress()
 {
     emit( progress() );
@@ -146,21 +241,32 @@ void Bundle::slotThreadFinished()
 {
     emit( progress() );
     --m_threadsRunning;
-    if ( !m_threadsRunning && m_currentLoop > m_iterations - 1 )
+    if ( m_threadsRunning )
+    {
+        return;
+    }
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        // the thread emits its finished signal from inside run()
+        m_threads[i]->wait();
+    }
+
+    applyLoopResult();
+
+    if ( m_currentLoop < m_iterations )
+    {
+        startLoop();
+    }
+    else
     {
-        applyLoopResult();
+        runThreads( BundleThread::STORE );
+        clearThreads();
         qDebug() << "all threads finished";
 
         qDebug() << "bundled " << m_fibs.size() << " fibers";
         qDebug() << "finished bundling";
         emit( finished() );
     }
-
-    if ( !m_threadsRunning && m_currentLoop < m_iterations )
-    {
-        applyLoopResult();
-        startLoop();
-    }
 }
 
 void Bundle::setIterations( int value, int )
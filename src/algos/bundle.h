@@ -11,16 +11,24 @@
 #include "fib.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QVector>
 
 class DatasetFibers;
 class BundleThread;
 
 
+/*
+ * Iterative attraction bundling. All fiber points live in one flat buffer that is moved in place,
+ * neighbours are found through a uniform grid with cell size >= radius that is refilled with a
+ * counting sort after every iteration. Threads and their scratch buffers live for the whole run.
+ */
 class Bundle : public QObject
 {
     Q_OBJECT
 
+    friend class BundleThread;
+
 public:
     Bundle( DatasetFibers* ds );
     virtual ~Bundle();
@@ -33,6 +41,11 @@ public:
     void applyLoopResult();
 
 private:
+    void initPoints();
+    void buildGrid();
+    void runThreads( int pass );
+    void clearThreads();
+
     DatasetFibers* m_sourceDataset;
     std::vector<BundleThread*> m_threads;
     int m_threadsRunning;
@@ -42,8 +55,23 @@ private:
     float m_smoothRange;
 
     std::vector<Fib> m_fibs;
-    std::vector<float> m_kdVerts;
-    std::vector<unsigned int>m_reverseIndexes;
+
+    // flat copy of all fiber points, fiber i owns points m_fibStarts[i] to m_fibStarts[i+1]
+    std::vector<float> m_points;
+    std::vector<unsigned int> m_fibStarts;
+    std::vector<float> m_endpoints;
+    std::vector<float> m_forces;
+
+    // uniform grid, points of cell c are m_cellStarts[c] to m_cellStarts[c+1] in m_cellPoints
+    float m_cellSize;
+    float m_gridMin[3];
+    int m_gridDim[3];
+    std::vector<unsigned int> m_pointCells;
+    std::vector<unsigned int> m_cellStarts;
+    std::vector<float> m_cellPoints;
+    std::vector<unsigned int> m_cellFibs;
+
+    QElapsedTimer m_loopTimer;
 
 private slots:
     void slotProgress();
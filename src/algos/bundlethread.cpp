@@ -5,131 +5,267 @@
  * @author Ralph Schurade
  */
 #include "bundlethread.h"
-#include "fmath.h"
-#include "kdtree.h"
+#include "bundle.h"
+#include "trace.h"
 
-#include "../gui/gl/glfunctions.h"
+#include <cmath>
+#include <limits>
 
-#include "time.h"
-#include "math.h"
-
-BundleThread::BundleThread( int id,
-                               std::vector<Fib>* fibs,
-                               KdTree* kdTree,
-                               std::vector<float>* kdVerts,
-                               std::vector<unsigned int>* revInd,
-                               int numPoints ) :
+BundleThread::BundleThread( int id, Bundle* bundle ) :
     m_id( id ),
-    m_fibs( fibs ),
-    m_kdTree( kdTree ),
-    m_kdVerts( kdVerts ),
-    m_revInd( revInd ),
+    m_bundle( bundle ),
+    m_pass( FORCES ),
     m_radius( 5.0f ),
-    m_numPoints( numPoints ),
-    m_iterations( 10 )
+    m_stamp( 0 )
 {
-    m_boxMin.resize( 3 );
-    m_boxMax.resize( 3 );
+    for ( int a = 0; a < 3; ++a )
+    {
+        m_min[a] = std::numeric_limits<float>::max();
+        m_max[a] = -std::numeric_limits<float>::max();
+    }
 }
 
 BundleThread::~BundleThread()
 {
-    m_forces.clear();
 }
 
-std::vector< QVector3D > BundleThread::getForces()
+void BundleThread::run()
 {
-    return m_forces;
+    TRACE_SCOPE( "BundleThread::run" );
+    switch ( m_pass )
+    {
+        case FORCES:
+            calculateForces();
+            emit( finished() );
+            break;
+        case APPLY:
+            applyForces();
+            break;
+        case CELLS:
+            cellIndexes();
+            break;
+        case STORE:
+            storeFibs();
+            break;
+    }
 }
 
-void BundleThread::run()
+void BundleThread::bounds( float* min, float* max )
 {
-    // for each point run algo
-    calculateForces();
+    for ( int a = 0; a < 3; ++a )
+    {
+        min[a] = qMin( min[a], m_min[a] );
+        max[a] = qMax( max[a], m_max[a] );
+    }
+}
+
+void BundleThread::chunk( unsigned int& begin, unsigned int& end )
+{
+    unsigned int numFibs = m_bundle->m_fibs.size();
+    unsigned int numThreads = m_bundle->m_threads.size();
+    unsigned int chunkSize = numFibs / numThreads;
+    begin = m_id * chunkSize;
+    end = ( m_id == static_cast<int>( numThreads ) - 1 ) ? numFibs : begin + chunkSize;
+}
 
-    emit( finished() );
+bool BundleThread::compatible( unsigned int fib, unsigned int other )
+{
+    if ( m_tested[other] == m_stamp )
+    {
+        return m_compatible[other];
+    }
+    const float* e0 = &m_bundle->m_endpoints[fib * 6];
+    const float* e1 = &m_bundle->m_endpoints[other * 6];
+    bool result = false;
+    for ( int i = 0; i < 2 && !result; ++i )
+    {
+        for ( int k = 0; k < 2 && !result; ++k )
+        {
+            float dx = e0[i * 3] - e1[k * 3];
+            float dy = e0[i * 3 + 1] - e1[k * 3 + 1];
+            float dz = e0[i * 3 + 2] - e1[k * 3 + 2];
+            result = ( dx * dx + dy * dy + dz * dz ) < 400.f;
+        }
+    }
+    m_tested[other] = m_stamp;
+    m_compatible[other] = result;
+    return result;
 }
 
 void BundleThread::calculateForces()
 {
-    int numThreads = GLFunctions::idealThreadCount;
-    for ( unsigned int i = m_id; i < m_fibs->size(); i += numThreads )
+    Bundle* b = m_bundle;
+    unsigned int numFibs = b->m_fibs.size();
+    unsigned int numThreads = b->m_threads.size();
+    if ( m_tested.size() != numFibs )
     {
-        Fib fib = m_fibs->at( i );
-        for( unsigned int k = 1; k < fib.length() - 1; ++k )
+        m_tested.assign( numFibs, 0 );
+        m_compatible.assign( numFibs, 0 );
+        m_stamp = 0;
+    }
+
+    const float* points = b->m_points.data();
+    const float* cellPoints = b->m_cellPoints.data();
+    const unsigned int* cellFibs = b->m_cellFibs.data();
+    const unsigned int* cellStarts = b->m_cellStarts.data();
+    float* forces = b->m_forces.data();
+    int dimX = b->m_gridDim[0];
+    int dimY = b->m_gridDim[1];
+    int dimZ = b->m_gridDim[2];
+
+    for ( unsigned int i = m_id; i < numFibs; i += numThreads )
+    {
+        if ( ++m_stamp == 0 )
+        {
+            m_tested.assign( numFibs, 0 );
+            m_stamp = 1;
+        }
+
+        for ( unsigned int k = b->m_fibStarts[i] + 1; k + 1 < b->m_fibStarts[i + 1]; ++k )
         {
-            QVector3D start = fib.firstVert();
-            QVector3D end = fib.lastVert();
-
-            QVector3D point = fib[k];
-            m_boxMin[0] = point.x() - m_radius;
-            m_boxMax[0] = point.x() + m_radius;
-            m_boxMin[1] = point.y() - m_radius;
-            m_boxMax[1] = point.y() + m_radius;
-            m_boxMin[2] = point.z() - m_radius;
-            m_boxMax[2] = point.z() + m_radius;
-            std::vector<QVector3D>result;
-            std::vector<unsigned int>revInds;
-
-            boxTest( result, revInds, 0, m_numPoints - 1, 0 );
-            QVector3D center( 0, 0, 0 );
+            const float* p = &points[k * 3];
+            float boxMin[3];
+            float boxMax[3];
+            int cellMin[3];
+            int cellMax[3];
+            int dims[3] = { dimX, dimY, dimZ };
+            for ( int a = 0; a < 3; ++a )
+            {
+                boxMin[a] = p[a] - m_radius;
+                boxMax[a] = p[a] + m_radius;
+                cellMin[a] = qMax( 0, static_cast<int>( floor( ( boxMin[a] - b->m_gridMin[a] ) / b->m_cellSize ) ) );
+                cellMax[a] = qMin( dims[a] - 1, static_cast<int>( floor( ( boxMax[a] - b->m_gridMin[a] ) / b->m_cellSize ) ) );
+            }
 
+            float cx = 0;
+            float cy = 0;
+            float cz = 0;
             int countIn = 0;
-            for( unsigned int l = 0; l < result.size(); ++l )
+            for ( int z = cellMin[2]; z <= cellMax[2]; ++z )
             {
-                int curFib = revInds[l];
-                Fib fib1 = m_fibs->at( curFib );
-                QVector3D start1 = fib1.firstVert();
-                QVector3D end1 = fib1.lastVert();
-
-                if ( ( start - start1 ).length() < 20 ||
-                     ( start - end1 ).length()   < 20 ||
-                     ( end - start1 ).length()   < 20 ||
-                     ( end - end1 ).length()     < 20 )
+                for ( int y = cellMin[1]; y <= cellMax[1]; ++y )
                 {
-                    center += result[l];
-                    ++countIn;
+                    // cells along x are contiguous in the sorted buffer
+                    unsigned int row = ( z * dimY + y ) * dimX;
+                    unsigned int first = cellStarts[row + cellMin[0]];
+                    unsigned int last = cellStarts[row + cellMax[0] + 1];
+                    for ( unsigned int l = first; l < last; ++l )
+                    {
+                        const float* q = &cellPoints[l * 3];
+                        if ( q[0] < boxMin[0] || q[0] > boxMax[0] ||
+                             q[1] < boxMin[1] || q[1] > boxMax[1] ||
+                             q[2] < boxMin[2] || q[2] > boxMax[2] )
+                        {
+                            continue;
+                        }
+                        if ( compatible( i, cellFibs[l] ) )
+                        {
+                            cx += q[0];
+                            cy += q[1];
+                            cz += q[2];
+                            ++countIn;
+                        }
+                    }
                 }
             }
-            center /= countIn;
-            QVector3D force = ( center - point );
-            m_forces.push_back( force );
+            // the point itself is always in its own box
+            countIn = qMax( countIn, 1 );
+            forces[k * 3] = cx / countIn - p[0];
+            forces[k * 3 + 1] = cy / countIn - p[1];
+            forces[k * 3 + 2] = cz / countIn - p[2];
         }
     }
 }
 
-void BundleThread::boxTest( std::vector<QVector3D>& result, std::vector<unsigned int>& revInds, unsigned int left, unsigned int right, int axis )
+void BundleThread::applyForces()
 {
-    // abort condition
-    if ( left > right || right == std::numeric_limits<unsigned int>::max() )
+    Bundle* b = m_bundle;
+    unsigned int begin;
+    unsigned int end;
+    chunk( begin, end );
+
+    float* points = b->m_points.data();
+    const float* forces = b->m_forces.data();
+    float scale = 1.0f / ( b->m_iterations * 0.50 );
+    float smoothRange = b->m_smoothRange;
+
+    for ( int a = 0; a < 3; ++a )
     {
-        return;
+        m_min[a] = std::numeric_limits<float>::max();
+        m_max[a] = -std::numeric_limits<float>::max();
     }
 
-    int root = left + ( ( right - left ) / 2 );
-    int axis1 = ( axis + 1 ) % 3;
-    int pointIndex = m_kdTree->m_tree[root] * 3;
-
-    if ( m_kdVerts->at( pointIndex + axis ) < m_boxMin[axis] )
+    for ( unsigned int i = begin; i < end; ++i )
     {
-        boxTest( result, revInds, root + 1, right, axis1 );
+        unsigned int first = b->m_fibStarts[i];
+        unsigned int length = b->m_fibStarts[i + 1] - first;
+        float size = static_cast<float>( length ) - 1;
+        float ramp = ( size / 100 ) * smoothRange;
+        for ( unsigned int l = 1; l + 1 < length; ++l )
+        {
+            float v = 1.0;
+            if ( l < ramp )
+            {
+                v = static_cast<float>( l ) / ramp;
+            }
+            else if ( l > ( ( size / 100 ) * ( 100. - smoothRange ) ) )
+            {
+                v = static_cast<float>( size - l ) / ramp;
+            }
+            float* p = &points[( first + l ) * 3];
+            const float* f = &forces[( first + l ) * 3];
+            p[0] += f[0] * scale * v;
+            p[1] += f[1] * scale * v;
+            p[2] += f[2] * scale * v;
+        }
+        for ( unsigned int l = first; l < first + length; ++l )
+        {
+            for ( int a = 0; a < 3; ++a )
+            {
+                m_min[a] = qMin( m_min[a], points[l * 3 + a] );
+                m_max[a] = qMax( m_max[a], points[l * 3 + a] );
+            }
+        }
     }
-    else if ( m_kdVerts->at( pointIndex + axis ) > m_boxMax[axis] )
+}
+
+void BundleThread::cellIndexes()
+{
+    Bundle* b = m_bundle;
+    unsigned int begin;
+    unsigned int end;
+    chunk( begin, end );
+
+    const float* points = b->m_points.data();
+    unsigned int* cells = b->m_pointCells.data();
+    for ( unsigned int l = b->m_fibStarts[begin]; l < b->m_fibStarts[end]; ++l )
     {
-        boxTest( result, revInds, left, root - 1, axis1 );
+        int c[3];
+        for ( int a = 0; a < 3; ++a )
+        {
+            c[a] = static_cast<int>( ( points[l * 3 + a] - b->m_gridMin[a] ) / b->m_cellSize );
+            c[a] = qMax( 0, qMin( b->m_gridDim[a] - 1, c[a] ) );
+        }
+        cells[l] = ( c[2] * b->m_gridDim[1] + c[1] ) * b->m_gridDim[0] + c[0];
     }
-    else
+}
+
+void BundleThread::storeFibs()
+{
+    Bundle* b = m_bundle;
+    unsigned int begin;
+    unsigned int end;
+    chunk( begin, end );
+
+    const float* points = b->m_points.data();
+    for ( unsigned int i = begin; i < end; ++i )
     {
-        int axis2 = ( axis + 2 ) % 3;
-        if ( m_kdVerts->at( pointIndex + axis1 ) <= m_boxMax[axis1] &&
-             m_kdVerts->at( pointIndex + axis1 ) >= m_boxMin[axis1] &&
-             m_kdVerts->at( pointIndex + axis2 ) <= m_boxMax[axis2] &&
-             m_kdVerts->at( pointIndex + axis2 ) >= m_boxMin[axis2] )
+        Fib& fib = b->m_fibs[i];
+        const float* p = &points[b->m_fibStarts[i] * 3];
+        for ( unsigned int l = 0; l < fib.length(); ++l )
         {
-            result.push_back( QVector3D( m_kdVerts->at( pointIndex ), m_kdVerts->at( pointIndex+1 ), m_kdVerts->at( pointIndex+2 ) ) );
-            revInds.push_back( m_revInd->at( m_kdTree->m_tree[root] ) );
+            QVector3D vert( p[l * 3], p[l * 3 + 1], p[l * 3 + 2] );
+            fib.setVert( l, vert );
         }
-        boxTest( result, revInds, left, root - 1, axis1 );
-        boxTest( result, revInds, root + 1, right, axis1 );
     }
 }
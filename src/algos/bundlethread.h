@@ -8,48 +8,60 @@
 #ifndef BUNDLETHREAD_H_
 #define BUNDLETHREAD_H_
 
-#include "fib.h"
-
 #include <QDebug>
 #include <QThread>
-#include <QVector>
-#include <QVector3D>
 
-class KdTree;
+#include <vector>
+
+class Bundle;
 
 class BundleThread : public QThread
 {
     Q_OBJECT
 
 public:
-    BundleThread( int id, std::vector<Fib>* fibs, KdTree* kdTree, std::vector<float>* kdVerts, std::vector< unsigned int>* revInd, int numPoints );
+    enum Pass
+    {
+        FORCES,
+        APPLY,
+        CELLS,
+        STORE
+    };
+
+    BundleThread( int id, Bundle* bundle );
 
     virtual ~BundleThread();
 
-    std::vector< QVector3D >getForces();
+    void setPass( int pass ) { m_pass = pass; };
     void setRadius( float value ) { m_radius = value; };
-    void setIterations( float value ) { m_iterations = value; };
+
+    // merges the point bounds collected in the last apply pass into min and max
+    void bounds( float* min, float* max );
 
 private:
     void run();
 
+    void chunk( unsigned int& begin, unsigned int& end );
+
     void calculateForces();
+    void applyForces();
+    void cellIndexes();
+    void storeFibs();
 
-    void boxTest( std::vector<QVector3D>& workfield, std::vector<unsigned int>& revInds, unsigned int left, unsigned int right, int axis );
+    bool compatible( unsigned int fib, unsigned int other );
 
     int m_id;
+    Bundle* m_bundle;
+    int m_pass;
+    float m_radius;
 
-    std::vector<Fib>* m_fibs;
-    std::vector< QVector3D > m_forces;
-    KdTree* m_kdTree;
-    std::vector<float>* m_kdVerts;
-    std::vector< unsigned int>* m_revInd;
+    // endpoint test result per fiber, valid while the entry equals m_stamp, kept over all loops
+    std::vector<unsigned int> m_tested;
+    std::vector<unsigned char> m_compatible;
+    unsigned int m_stamp;
 
-    std::vector<float> m_boxMin;
-    std::vector<float> m_boxMax;
-    float m_radius;
-    int m_numPoints;
-    float m_iterations;
+    float m_min[3];
+    float m_max[3];
 
 signals:
     void progress();
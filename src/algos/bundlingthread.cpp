@@ -6,6 +6,7 @@
  */
 
 #include "bundlingthread.h"
+#include "trace.h"
 
 BundlingThread::BundlingThread(Connections* cons)
 {
@@ -19,5 +20,7 @@ BundlingThread::~BundlingThread()
 
 void BundlingThread::run()
 {
+    TRACE_SCOPE( "BundlingThread::run" );
+
     m_cons->fullAttract();
 }
@@ -6,6 +6,7 @@
  */
 
 #include "colormapbase.h"
+#include "colormapthread.h"
 
 #include "../gui/gl/glfunctions.h"
 
@@ -24,6 +25,7 @@ ColormapBase::ColormapBase() :
 
     m_values.push_back( p0 );
     m_values.push_back( p1 );
+    updateLut();
 }
 
 
@@ -40,6 +42,7 @@ ColormapBase::ColormapBase( QString name, QColor c0, QColor c1 ) :
 
     m_values.push_back( p0 );
     m_values.push_back( p1 );
+    updateLut();
 }
 
 ColormapBase::ColormapBase( QList<QVariant> cm )
@@ -55,13 +58,14 @@ ColormapBase::ColormapBase( QList<QVariant> cm )
         p.color = c;
         m_values.push_back( p );
     }
+    updateLut();
 }
 
 ColormapBase::ColormapBase( QString name, std::vector< ColormapPair > values ) :
     m_name( name ),
     m_values( values )
 {
-
+    updateLut();
 }
 
 ColormapBase::~ColormapBase()
@@ -88,6 +92,7 @@ void ColormapBase::insertValue( ColormapPair pair )
             break;
         }
     }
+    updateLut();
 }
 
 void ColormapBase::insertValue( float value, QColor color )
@@ -103,32 +108,108 @@ void ColormapBase::removeValue( int index )
     if ( index > 0 && index < (int)( m_values.size() - 1 ) )
     {
         m_values.erase( m_values.begin() + index );
+        updateLut();
     }
 }
 
-QColor ColormapBase::getColor( float value )
+void ColormapBase::updateLut()
 {
-    QColor color1;
-    QColor color2;
-    float value1 = 0.0;
-    float value2 = 1.0;
+    m_lut = QVector<float>( 4 * LUT_SIZE, 1.0f );
+    if ( m_values.empty() )
+    {
+        return;
+    }
 
-    for ( unsigned int i = 1; i < m_values.size(); ++i )
+    if ( m_values.size() == 1 )
     {
-        if ( value >=m_values[i-1].value &&  value <= m_values[i].value )
+        for ( int i = 0; i < LUT_SIZE; ++i )
         {
-            color1 = m_values[i-1].color;
-            value1 = m_values[i-1].value;
-            color2 = m_values[i].color;
-            value2 = m_values[i].value;
+            m_lut[4 * i]     = m_values[0].color.redF();
+            m_lut[4 * i + 1] = m_values[0].color.greenF();
+            m_lut[4 * i + 2] = m_values[0].color.blueF();
         }
+        return;
     }
-    value = ( value - value1 ) / (value2 - value1 );
 
-    QColor out( ( 1.0 - value ) * color1.red()   + value * color2.red(),
-                ( 1.0 - value ) * color1.green() + value * color2.green(),
-                ( 1.0 - value ) * color1.blue()  + value * color2.blue() );
-    return out;
+    // the stops are sorted, so the interval only ever moves forward
+    unsigned int k = 1;
+    for ( int i = 0; i < LUT_SIZE; ++i )
+    {
+        float value = static_cast<float>( i ) / ( LUT_SIZE - 1 );
+        while ( k < m_values.size() - 1 && value > m_values[k].value )
+        {
+            ++k;
+        }
+
+        QColor color1 = m_values[k - 1].color;
+        QColor color2 = m_values[k].color;
+        float value1 = m_values[k - 1].value;
+        float value2 = m_values[k].value;
+
+        float t = ( value2 > value1 ) ? ( value - value1 ) / ( value2 - value1 ) : 1.0f;
+        t = qMax( 0.0f, qMin( 1.0f, t ) );
+
+        m_lut[4 * i]     = ( 1.0f - t ) * color1.redF()   + t * color2.redF();
+        m_lut[4 * i + 1] = ( 1.0f - t ) * color1.greenF() + t * color2.greenF();
+        m_lut[4 * i + 2] = ( 1.0f - t ) * color1.blueF()  + t * color2.blueF();
+    }
+}
+
+QColor ColormapBase::getColor( float value )
+{
+    float x = value * ( LUT_SIZE - 1 ) + 0.5f;
+    x = x > 0.0f ? x : 0.0f;
+    x = x < LUT_SIZE - 1 ? x : LUT_SIZE - 1;
+    const float* c = m_lut.constData() + 4 * static_cast<int>( x );
+    return QColor::fromRgbF( c[0], c[1], c[2] );
+}
+
+void ColormapBase::map( const float* values, size_t n, float min, float max, float* rgbaOut ) const
+{
+    // below that the threads cost more than they save
+    int numThreads = ( n < 65536 ) ? 1 : GLFunctions::idealThreadCount;
+    if ( numThreads < 2 )
+    {
+        mapRange( values, 0, n, min, max, rgbaOut );
+        return;
+    }
+
+    std::vector<ColormapThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new ColormapThread( this, values, n, min, max, rgbaOut, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+void ColormapBase::mapRange( const float* values, size_t begin, size_t end, float min, float max, float* rgbaOut ) const
+{
+    const float* lut = m_lut.constData();
+    const float last = LUT_SIZE - 1;
+    float scale = ( max > min ) ? last / ( max - min ) : 0.0f;
+    float offset = 0.5f - min * scale;
+
+    for ( size_t i = begin; i < end; ++i )
+    {
+        // written so nan ends up at 0
+        float x = values[i] * scale + offset;
+        x = x > 0.0f ? x : 0.0f;
+        x = x < last ? x : last;
+        const float* c = lut + 4 * static_cast<int>( x );
+        float* out = rgbaOut + 4 * i;
+        out[0] = c[0];
+        out[1] = c[1];
+        out[2] = c[2];
+        out[3] = c[3];
+    }
 }
 
 QString ColormapBase::getCode()
@@ -181,11 +262,13 @@ ColormapPair ColormapBase::get( int id )
 void ColormapBase::setValue( int id, float value )
 {
     m_values[id].value = value;
+    updateLut();
 }
 
 void ColormapBase::setColor( int id, QColor color )
 {
     m_values[id].color = color;
+    updateLut();
 }
 
 QList<QVariant>ColormapBase::serialize()
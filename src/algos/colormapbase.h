@@ -18,9 +18,20 @@ struct ColormapPair
     QColor color;
 };
 
+class ColormapThread;
+
+/*
+ * A colormap is a list of color stops over [0,1]. It keeps a lookup table baked from the stops and rebuilt
+ * whenever they change, getColor and map only index into it. The table is implicitly shared, so copies
+ * are cheap and read only use from several threads is safe.
+ */
 class ColormapBase
 {
+    friend class ColormapThread;
+
 public:
+    static const int LUT_SIZE = 1024;
+
     ColormapBase();
     ColormapBase( QString name, QColor c0, QColor c1 );
     ColormapBase( QString name, std::vector< ColormapPair >values );
@@ -43,12 +54,20 @@ public:
     QColor getColor( float value );
     QString getCode();
 
+    // rgba for every value, mapped with min and max to [0,1] and clamped, rgbaOut needs space for 4 * n floats
+    void map( const float* values, size_t n, float min, float max, float* rgbaOut ) const;
+
     QList<QVariant>serialize();
 
 private:
+    void updateLut();
+    void mapRange( const float* values, size_t begin, size_t end, float min, float max, float* rgbaOut ) const;
+
     QString m_name;
     std::vector< ColormapPair >m_values;
 
+    QVector<float>m_lut; //!< LUT_SIZE rgba entries
+
 };
 
 #endif /* COLORMAPBASE_H_ */
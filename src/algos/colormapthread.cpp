@@ -0,0 +1,46 @@
+/*
+ * colormapthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "colormapthread.h"
+#include "colormapbase.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+ColormapThread::ColormapThread( const ColormapBase* colormap, const float* values, size_t size, float min, float max, float* rgbaOut, int id ) :
+    m_colormap( colormap ),
+    m_values( values ),
+    m_size( size ),
+    m_min( min ),
+    m_max( max ),
+    m_rgbaOut( rgbaOut ),
+    m_id( id )
+{
+}
+
+ColormapThread::~ColormapThread()
+{
+}
+
+void ColormapThread::run()
+{
+    TRACE_SCOPE( "ColormapThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    size_t chunkSize = m_size / numThreads;
+
+    size_t begin = m_id * chunkSize;
+    size_t end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    m_colormap->mapRange( m_values, begin, end, m_min, m_max, m_rgbaOut );
+}
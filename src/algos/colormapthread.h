@@ -0,0 +1,33 @@
+/*
+ * colormapthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef COLORMAPTHREAD_H_
+#define COLORMAPTHREAD_H_
+
+#include <QThread>
+
+class ColormapBase;
+
+class ColormapThread : public QThread
+{
+public:
+    ColormapThread( const ColormapBase* colormap, const float* values, size_t size, float min, float max, float* rgbaOut, int id );
+    virtual ~ColormapThread();
+
+private:
+    void run();
+
+    const ColormapBase* m_colormap;
+    const float* m_values;
+    size_t m_size;
+    float m_min;
+    float m_max;
+    float* m_rgbaOut;
+    int m_id;
+};
+
+#endif /* COLORMAPTHREAD_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "compatibilitiesthread.h"
+#include "trace.h"
 
 #include "../gui/gl/glfunctions.h"
 
@@ -24,6 +25,8 @@ CompatibilitiesThread::~CompatibilitiesThread()
 
 void CompatibilitiesThread::run()
 {
+    TRACE_SCOPE( "CompatibilitiesThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
 
     for ( int i = m_id; i < m_edges.length(); i += numThreads )
@@ -31,6 +34,7 @@ void CompatibilitiesThread::run()
         if ( ( i % 1000 ) == 0 )
         {
             qDebug() << "calculating compatibilites: " << i;
+            TRACE_COUNTER( "compatibility edges", i );
             emit( progress() );
         }
         for ( int j = 0; j < m_edges.length(); j++ )
@@ -0,0 +1,469 @@
+/*
+ * connectedcomponents.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "connectedcomponents.h"
+#include "connectedcomponentsthread.h"
+
+#include "../data/mesh/trianglemesh2.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    struct LargerComponent
+    {
+        const std::vector<ConnectedComponents::Component>* components;
+
+        bool operator()( int a, int b ) const
+        {
+            return ( *components )[a].size > ( *components )[b].size;
+        }
+    };
+
+    ConnectedComponents::Component emptyComponent()
+    {
+        ConnectedComponents::Component c;
+        c.size = 0;
+        for ( int i = 0; i < 3; ++i )
+        {
+            c.min[i] = std::numeric_limits<float>::max();
+            c.max[i] = -std::numeric_limits<float>::max();
+        }
+        return c;
+    }
+
+    void extend( ConnectedComponents::Component& c, float x, float y, float z )
+    {
+        c.min[0] = qMin( c.min[0], x );
+        c.min[1] = qMin( c.min[1], y );
+        c.min[2] = qMin( c.min[2], z );
+        c.max[0] = qMax( c.max[0], x );
+        c.max[1] = qMax( c.max[1], y );
+        c.max[2] = qMax( c.max[2], z );
+    }
+}
+
+ConnectedComponents::ConnectedComponents() :
+    m_mask( 0 ),
+    m_mesh( 0 ),
+    m_edgeConnected( false )
+{
+    m_dims[0] = 0;
+    m_dims[1] = 0;
+    m_dims[2] = 0;
+}
+
+ConnectedComponents::~ConnectedComponents()
+{
+}
+
+void ConnectedComponents::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<ConnectedComponentsThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new ConnectedComponentsThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+const std::vector<ConnectedComponents::Component>& ConnectedComponents::components()
+{
+    return m_components;
+}
+
+const std::vector<int>& ConnectedComponents::labels()
+{
+    return m_labels;
+}
+
+unsigned int ConnectedComponents::numComponents()
+{
+    return m_components.size();
+}
+
+int ConnectedComponents::find( int id )
+{
+    // path halving, a lost race only leaves a longer path behind
+    int parent = m_parent[id].loadAcquire();
+    while ( parent != id )
+    {
+        int grandParent = m_parent[parent].loadAcquire();
+        if ( grandParent != parent )
+        {
+            m_parent[id].testAndSetRelaxed( parent, grandParent );
+        }
+        id = parent;
+        parent = grandParent;
+    }
+    return id;
+}
+
+void ConnectedComponents::unite( int a, int b )
+{
+    while ( true )
+    {
+        a = find( a );
+        b = find( b );
+        if ( a == b )
+        {
+            return;
+        }
+        if ( a < b )
+        {
+            std::swap( a, b );
+        }
+        // only a root may be linked, if a got a parent in the meantime start over from there
+        if ( m_parent[a].testAndSetOrdered( a, b ) )
+        {
+            return;
+        }
+    }
+}
+
+bool ConnectedComponents::labelVolume( const std::vector<bool>& mask, int nx, int ny, int nz, int connectivity )
+{
+    if ( connectivity != 6 && connectivity != 18 && connectivity != 26 )
+    {
+        return false;
+    }
+
+    m_mask = &mask;
+    m_mesh = 0;
+    m_dims[0] = nx;
+    m_dims[1] = ny;
+    m_dims[2] = nz;
+    unsigned int size = nx * ny * nz;
+
+    // neighbours in the half of the neighbourhood that is visited before the voxel itself
+    m_offsets.clear();
+    for ( int dz = -1; dz <= 0; ++dz )
+    {
+        for ( int dy = -1; dy <= 1; ++dy )
+        {
+            for ( int dx = -1; dx <= 1; ++dx )
+            {
+                if ( dz == 0 && ( dy > 0 || ( dy == 0 && dx >= 0 ) ) )
+                {
+                    continue;
+                }
+                int nonZero = ( dx != 0 ) + ( dy != 0 ) + ( dz != 0 );
+                if ( ( connectivity == 6 && nonZero > 1 ) || ( connectivity == 18 && nonZero > 2 ) )
+                {
+                    continue;
+                }
+                m_offsets.push_back( dx );
+                m_offsets.push_back( dy );
+                m_offsets.push_back( dz );
+            }
+        }
+    }
+
+    m_parent.resize( size );
+    for ( unsigned int i = 0; i < size; ++i )
+    {
+        m_parent[i].store( i );
+    }
+    m_labels.resize( size );
+
+    if ( mask.size() >= size )
+    {
+        runPass( ConnectedComponentsThread::UNITE_VOXELS, nz );
+        runPass( ConnectedComponentsThread::FLATTEN, size );
+    }
+    else
+    {
+        std::fill( m_labels.begin(), m_labels.end(), 0 );
+    }
+    collect();
+    m_mask = 0;
+    return true;
+}
+
+void ConnectedComponents::labelMesh( TriangleMesh2* mesh, bool edgeConnected )
+{
+    m_mesh = mesh;
+    m_mask = 0;
+    m_edgeConnected = edgeConnected;
+
+    unsigned int numVerts = mesh->numVerts();
+    unsigned int numTris = mesh->numTris();
+    unsigned int* triangles = mesh->getIndexes();
+
+    if ( edgeConnected )
+    {
+        // triangles around each vertex, counted and then filled in place
+        m_starOffsets.assign( numVerts + 1, 0 );
+        for ( unsigned int i = 0; i < numTris * 3; ++i )
+        {
+            ++m_starOffsets[triangles[i] + 1];
+        }
+        for ( unsigned int i = 0; i < numVerts; ++i )
+        {
+            m_starOffsets[i + 1] += m_starOffsets[i];
+        }
+        m_star.resize( numTris * 3 );
+        std::vector<unsigned int> fill( m_starOffsets.begin(), m_starOffsets.end() - 1 );
+        for ( unsigned int i = 0; i < numTris * 3; ++i )
+        {
+            m_star[fill[triangles[i]]++] = i / 3;
+        }
+    }
+
+    unsigned int numNodes = edgeConnected ? numTris : numVerts;
+    m_parent.resize( numNodes );
+    for ( unsigned int i = 0; i < numNodes; ++i )
+    {
+        m_parent[i].store( i );
+    }
+    m_labels.resize( numTris );
+
+    runPass( ConnectedComponentsThread::UNITE_TRIANGLES, numTris );
+    runPass( ConnectedComponentsThread::FLATTEN, numTris );
+
+    std::vector<unsigned int>().swap( m_starOffsets );
+    std::vector<unsigned int>().swap( m_star );
+
+    collect();
+    m_mesh = 0;
+}
+
+void ConnectedComponents::uniteVoxels( unsigned int begin, unsigned int end )
+{
+    const std::vector<bool>& mask = *m_mask;
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int numOffsets = m_offsets.size() / 3;
+
+    for ( int z = begin; z < (int)end; ++z )
+    {
+        for ( int y = 0; y < ny; ++y )
+        {
+            for ( int x = 0; x < nx; ++x )
+            {
+                int id = x + nx * ( y + ny * z );
+                if ( !mask[id] )
+                {
+                    continue;
+                }
+                for ( int k = 0; k < numOffsets; ++k )
+                {
+                    int xx = x + m_offsets[k * 3];
+                    int yy = y + m_offsets[k * 3 + 1];
+                    int zz = z + m_offsets[k * 3 + 2];
+                    if ( xx < 0 || xx >= nx || yy < 0 || yy >= ny || zz < 0 )
+                    {
+                        continue;
+                    }
+                    int neighbour = xx + nx * ( yy + ny * zz );
+                    if ( mask[neighbour] )
+                    {
+                        unite( id, neighbour );
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ConnectedComponents::uniteTriangles( unsigned int begin, unsigned int end )
+{
+    unsigned int* triangles = m_mesh->getIndexes();
+
+    for ( unsigned int t = begin; t < end; ++t )
+    {
+        unsigned int* tri = &triangles[t * 3];
+        if ( !m_edgeConnected )
+        {
+            unite( tri[0], tri[1] );
+            unite( tri[0], tri[2] );
+            continue;
+        }
+        // every edge is found from both of its triangles, the one with the lower index does the work
+        for ( int e = 0; e < 3; ++e )
+        {
+            unsigned int a = tri[e];
+            unsigned int b = tri[( e + 1 ) % 3];
+            for ( unsigned int k = m_starOffsets[a]; k < m_starOffsets[a + 1]; ++k )
+            {
+                unsigned int s = m_star[k];
+                if ( s <= t )
+                {
+                    continue;
+                }
+                unsigned int* other = &triangles[s * 3];
+                if ( other[0] == b || other[1] == b || other[2] == b )
+                {
+                    unite( t, s );
+                }
+            }
+        }
+    }
+}
+
+void ConnectedComponents::flatten( unsigned int begin, unsigned int end )
+{
+    // label is root + 1 for now, collect() turns it into the component
+    if ( m_mask )
+    {
+        const std::vector<bool>& mask = *m_mask;
+        for ( unsigned int i = begin; i < end; ++i )
+        {
+            m_labels[i] = mask[i] ? find( i ) + 1 : 0;
+        }
+    }
+    else
+    {
+        unsigned int* triangles = m_mesh->getIndexes();
+        for ( unsigned int i = begin; i < end; ++i )
+        {
+            m_labels[i] = find( m_edgeConnected ? i : triangles[i * 3] ) + 1;
+        }
+    }
+}
+
+void ConnectedComponents::relabel( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        m_labels[i] = m_remap[m_labels[i]];
+    }
+}
+
+void ConnectedComponents::collect()
+{
+    // components in the order their first element turns up, the root's parent entry is reused as the
+    // component id, encoded as -1 - id to tell it from a parent index
+    m_components.clear();
+
+    if ( m_mask )
+    {
+        int nx = m_dims[0];
+        int ny = m_dims[1];
+        int nz = m_dims[2];
+        int i = 0;
+        for ( int z = 0; z < nz; ++z )
+        {
+            for ( int y = 0; y < ny; ++y )
+            {
+                for ( int x = 0; x < nx; ++x, ++i )
+                {
+                    if ( m_labels[i] == 0 )
+                    {
+                        continue;
+                    }
+                    int root = m_labels[i] - 1;
+                    int value = m_parent[root].load();
+                    int id = -1 - value;
+                    if ( value >= 0 )
+                    {
+                        id = m_components.size();
+                        m_parent[root].store( -1 - id );
+                        m_components.push_back( emptyComponent() );
+                    }
+                    m_labels[i] = id + 1;
+                    Component& c = m_components[id];
+                    ++c.size;
+                    extend( c, x, y, z );
+                }
+            }
+        }
+    }
+    else
+    {
+        unsigned int* triangles = m_mesh->getIndexes();
+        float* vertices = m_mesh->getVertices();
+        unsigned int stride = m_mesh->bufferSize();
+        for ( unsigned int i = 0; i < m_labels.size(); ++i )
+        {
+            int root = m_labels[i] - 1;
+            int value = m_parent[root].load();
+            int id = -1 - value;
+            if ( value >= 0 )
+            {
+                id = m_components.size();
+                m_parent[root].store( -1 - id );
+                m_components.push_back( emptyComponent() );
+            }
+            m_labels[i] = id + 1;
+            Component& c = m_components[id];
+            ++c.size;
+            for ( int k = 0; k < 3; ++k )
+            {
+                float* v = &vertices[triangles[i * 3 + k] * stride];
+                extend( c, v[0], v[1], v[2] );
+            }
+        }
+    }
+    std::vector<QAtomicInt>().swap( m_parent );
+
+    // largest first, ties keep the order of appearance
+    std::vector<int> order( m_components.size() );
+    for ( unsigned int i = 0; i < order.size(); ++i )
+    {
+        order[i] = i;
+    }
+    LargerComponent larger;
+    larger.components = &m_components;
+    std::stable_sort( order.begin(), order.end(), larger );
+
+    std::vector<Component> sorted( m_components.size() );
+    m_remap.assign( m_components.size() + 1, 0 );
+    for ( unsigned int i = 0; i < order.size(); ++i )
+    {
+        sorted[i] = m_components[order[i]];
+        m_remap[order[i] + 1] = i + 1;
+    }
+    m_components.swap( sorted );
+
+    runPass( ConnectedComponentsThread::RELABEL, m_labels.size() );
+}
+
+void ConnectedComponents::keep( unsigned int count )
+{
+    if ( count >= m_components.size() )
+    {
+        return;
+    }
+    m_remap.assign( m_components.size() + 1, 0 );
+    for ( unsigned int i = 1; i <= count; ++i )
+    {
+        m_remap[i] = i;
+    }
+    m_components.resize( count );
+
+    runPass( ConnectedComponentsThread::RELABEL, m_labels.size() );
+}
+
+void ConnectedComponents::keepLargest( unsigned int count )
+{
+    keep( count );
+}
+
+void ConnectedComponents::removeSmallerThan( unsigned int size )
+{
+    // sorted by size, so the ones to keep are at the front
+    unsigned int count = 0;
+    while ( count < m_components.size() && m_components[count].size >= size )
+    {
+        ++count;
+    }
+    keep( count );
+}
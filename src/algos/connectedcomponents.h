@@ -0,0 +1,88 @@
+/*
+ * connectedcomponents.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef CONNECTEDCOMPONENTS_H_
+#define CONNECTEDCOMPONENTS_H_
+
+#include <QAtomicInt>
+
+#include <vector>
+
+class ConnectedComponentsThread;
+class TriangleMesh2;
+
+/*
+ * Connected component labelling of volumes and triangle meshes with a shared union find. All threads
+ * link their elements at once, roots are swapped in with compare and set and always point to the smaller
+ * index, so no locks are needed and the result doesn't depend on the thread timing. Components are
+ * numbered from 1 by decreasing size, 0 is the background and what the filters removed.
+ */
+class ConnectedComponents
+{
+    friend class ConnectedComponentsThread;
+
+public:
+    struct Component
+    {
+        unsigned int size;
+        // voxel indices for volumes, vertex positions for meshes
+        float min[3];
+        float max[3];
+    };
+
+    ConnectedComponents();
+    virtual ~ConnectedComponents();
+
+    // foreground voxels are connected over faces (6), also edges (18) or also corners (26), false for any
+    // other connectivity
+    bool labelVolume( const std::vector<bool>& mask, int nx, int ny, int nz, int connectivity = 26 );
+
+    // one label per triangle, triangles are connected if they share a vertex or only if they share an edge
+    void labelMesh( TriangleMesh2* mesh, bool edgeConnected = false );
+
+    // the component with label l is at l - 1
+    const std::vector<Component>& components();
+    const std::vector<int>& labels();
+    unsigned int numComponents();
+
+    void keepLargest( unsigned int count );
+    void removeSmallerThan( unsigned int size );
+
+private:
+    void runPass( int pass, unsigned int size );
+
+    void unite( int a, int b );
+    int find( int id );
+
+    void uniteVoxels( unsigned int begin, unsigned int end );
+    void uniteTriangles( unsigned int begin, unsigned int end );
+    void flatten( unsigned int begin, unsigned int end );
+    void relabel( unsigned int begin, unsigned int end );
+
+    void collect();
+    void keep( unsigned int count );
+
+    // union find over voxels, mesh vertices or triangles, roots are replaced by their component in collect()
+    std::vector<QAtomicInt> m_parent;
+
+    std::vector<int> m_labels;
+    std::vector<Component> m_components;
+    std::vector<int> m_remap;
+
+    // volume input, offsets of the neighbours that come before a voxel
+    const std::vector<bool>* m_mask;
+    int m_dims[3];
+    std::vector<int> m_offsets;
+
+    // mesh input, triangles around each vertex as offsets into m_star
+    TriangleMesh2* m_mesh;
+    bool m_edgeConnected;
+    std::vector<unsigned int> m_starOffsets;
+    std::vector<unsigned int> m_star;
+};
+
+#endif /* CONNECTEDCOMPONENTS_H_ */
@@ -0,0 +1,57 @@
+/*
+ * connectedcomponentsthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "connectedcomponentsthread.h"
+#include "connectedcomponents.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+ConnectedComponentsThread::ConnectedComponentsThread( ConnectedComponents* components, int pass, unsigned int size, int id ) :
+    m_components( components ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+ConnectedComponentsThread::~ConnectedComponentsThread()
+{
+}
+
+void ConnectedComponentsThread::run()
+{
+    TRACE_SCOPE( "ConnectedComponentsThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case UNITE_VOXELS:
+            m_components->uniteVoxels( begin, end );
+            break;
+        case UNITE_TRIANGLES:
+            m_components->uniteTriangles( begin, end );
+            break;
+        case FLATTEN:
+            m_components->flatten( begin, end );
+            break;
+        case RELABEL:
+            m_components->relabel( begin, end );
+            break;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * connectedcomponentsthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef CONNECTEDCOMPONENTSTHREAD_H_
+#define CONNECTEDCOMPONENTSTHREAD_H_
+
+#include <QThread>
+
+class ConnectedComponents;
+
+class ConnectedComponentsThread : public QThread
+{
+public:
+    enum Pass
+    {
+        UNITE_VOXELS,
+        UNITE_TRIANGLES,
+        FLATTEN,
+        RELABEL
+    };
+
+    ConnectedComponentsThread( ConnectedComponents* components, int pass, unsigned int size, int id );
+    virtual ~ConnectedComponentsThread();
+
+private:
+    void run();
+
+    ConnectedComponents* m_components;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* CONNECTEDCOMPONENTSTHREAD_H_ */
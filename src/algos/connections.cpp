@@ -17,6 +17,8 @@
 
 #include "../gui/gl/glfunctions.h"
 
+#include "../io/textparser.h"
+
 Connections::Connections()
 {
     params();
@@ -97,32 +99,24 @@ Connections::Connections( QString fib )
 void Connections::loadConnexels( QString filename )
 {
 //load textfile with px py pz qx qy qz value:
-    QFile n( filename );
-    if ( !n.open( QIODevice::ReadOnly ) )
+    TextParser n( filename );
+    if ( !n.open() )
     {
         qDebug() << "connexel file unreadable: " << filename;
+        return;
     }
-    QTextStream ns( &n );
-    QString nl;
 
-    while ( !ns.atEnd() )
+    std::vector<double> vals;
+    std::vector<unsigned int> offsets;
+    n.rows( 0, n.numLines(), vals, offsets );
+
+    for ( unsigned int i = 0; i + 1 < offsets.size(); ++i )
     {
-        nl = ns.readLine();
-        QRegExp rx( "(\\ |\\t)" );
-        QStringList vals = nl.split( rx, QString::SkipEmptyParts );
-        if ( vals.size() == 7 )
+        if ( offsets[i + 1] - offsets[i] == 7 )
         {
-            QVector3D* anode1;
-            QVector3D* anode2;
+            const double* v = &vals[offsets[i]];
             //x,y,z
-            anode1 = new QVector3D( ( (QString) ( vals.at( 0 ) ) ).toFloat(), ( (QString) ( vals.at( 1 ) ) ).toFloat(),
-                    ( (QString) ( vals.at( 2 ) ) ).toFloat() );
-
-            anode2 = new QVector3D( ( (QString) ( vals.at( 3 ) ) ).toFloat(), ( (QString) ( vals.at( 4 ) ) ).toFloat(),
-                    ( (QString) ( vals.at( 5 ) ) ).toFloat() );
-            float value = ( (QString) ( vals.at( 6 ) ) ).toFloat();
-            Edge* aedge;
-            aedge = new Edge( *anode1, *anode2, value );
+            Edge* aedge = new Edge( QVector3D( v[0], v[1], v[2] ), QVector3D( v[3], v[4], v[5] ), v[6] );
             edges << aedge;
         }
     }
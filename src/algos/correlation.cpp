@@ -8,13 +8,12 @@
 #include "correlation.h"
 #include "correlationthread.h"
 
-#include "../data/datasets/datasetmeshtimeseries.h"
-#include "../data/mesh/trianglemesh2.h"
-
 #include "../gui/gl/glfunctions.h"
 
-Correlation::Correlation( DatasetMeshTimeSeries* ds ) :
-    m_dataset( ds ),
+Correlation::Correlation( const float* series, int numNodes, int numFrames ) :
+    m_series( series ),
+    m_numNodes( numNodes ),
+    m_numFrames( numFrames ),
     m_threadsRunning( 0 )
 {
 }
@@ -25,8 +24,8 @@ Correlation::~Correlation()
 
 void Correlation::start()
 {
-    int nroi = m_dataset->getMesh()->numVerts();
-    int ntp = m_dataset->getNumDataPoints();
+    int nroi = m_numNodes;
+    int ntp = m_numFrames;
 
     m_exField = new float[ nroi ];
     m_ex2Field = new float[ nroi ];
@@ -39,7 +38,7 @@ void Correlation::start()
         float xk;
         for ( int k = 0; k < ntp; ++k )
         { //for all timepoints
-            xk = m_dataset->getData( i, k ); //timepoint k at position i...
+            xk = m_series[i * ntp + k]; //timepoint k at position i...
             ex += xk;
             ex2 += xk*xk;
         }
@@ -54,7 +53,7 @@ void Correlation::start()
     // create threads
     for ( int i = 0; i < numThreads; ++i )
     {
-        CorrelationThread* t = new CorrelationThread( i, m_dataset, m_exField, m_ex2Field );
+        CorrelationThread* t = new CorrelationThread( i, m_series, m_numNodes, m_numFrames, m_exField, m_ex2Field );
         m_threads.push_back( t );
         connect( t, SIGNAL( progress() ), this, SLOT( slotProgress() ), Qt::QueuedConnection );
         connect( t, SIGNAL( finished() ), this, SLOT( slotThreadFinished() ), Qt::QueuedConnection );
@@ -85,7 +84,7 @@ void Correlation::slotThreadFinished()
     {
         qDebug() << "all threads finished";
 
-        int m_n = m_dataset->getMesh()->numVerts();
+        int m_n = m_numNodes;
         qDebug() << m_n;
         int numThreads = GLFunctions::idealThreadCount;
 
@@ -11,7 +11,6 @@
 #include <QDebug>
 #include <QVector>
 
-class DatasetMeshTimeSeries;
 class CorrelationThread;
 
 class Correlation : public QObject
@@ -19,7 +18,8 @@ class Correlation : public QObject
     Q_OBJECT
 
 public:
-    Correlation( DatasetMeshTimeSeries* ds );
+    // series holds numFrames values for each of the numNodes nodes, one node after the other
+    Correlation( const float* series, int numNodes, int numFrames );
     virtual ~Correlation();
 
     void start();
@@ -27,7 +27,9 @@ public:
     float** getResult();
 
 private:
-    DatasetMeshTimeSeries* m_dataset;
+    const float* m_series;
+    int m_numNodes;
+    int m_numFrames;
 
     std::vector<CorrelationThread*> m_threads;
     int m_threadsRunning;
@@ -6,18 +6,17 @@
  */
 
 #include "correlationthread.h"
-
-#include "../data/datasets/datasetmeshtimeseries.h"
-
-#include "../data/mesh/trianglemesh2.h"
+#include "trace.h"
 
 #include "../gui/gl/glfunctions.h"
 
 #include <cmath>
 
-CorrelationThread::CorrelationThread( int id, DatasetMeshTimeSeries* ds, float* exField, float* ex2Field ) :
+CorrelationThread::CorrelationThread( int id, const float* series, int numNodes, int numFrames, float* exField, float* ex2Field ) :
     m_id( id ),
-    m_dataset( ds ),
+    m_series( series ),
+    m_numNodes( numNodes ),
+    m_numFrames( numFrames ),
     m_exField( exField ),
     m_ex2Field( ex2Field )
 {
@@ -35,8 +34,10 @@ std::vector< std::vector<float> >* CorrelationThread::getResult()
 
 void CorrelationThread::run()
 {
-    int nroi = m_dataset->getMesh()->numVerts();
-    int ntp = m_dataset->getNumDataPoints();
+    TRACE_SCOPE( "CorrelationThread::run" );
+
+    int nroi = m_numNodes;
+    int ntp = m_numFrames;
 
     int numThreads = GLFunctions::idealThreadCount;
 
@@ -58,8 +59,8 @@ void CorrelationThread::run()
                 float xk, yk;
 
                 //this needs to get connected to whatever data representation of the timeseries data is used:
-                xk = m_dataset->getData( i, k ); //timepoint k at position i...
-                yk = m_dataset->getData( j, k );
+                xk = m_series[i * ntp + k]; //timepoint k at position i...
+                yk = m_series[j * ntp + k];
                 exy += xk*yk;
             }
 
@@ -11,14 +11,13 @@
 #include <QDebug>
 #include <QThread>
 
-class DatasetMeshTimeSeries;
-
 class CorrelationThread : public QThread
 {
     Q_OBJECT
 
 public:
-    CorrelationThread( int id, DatasetMeshTimeSeries* ds, float* exField, float* ex2Field );
+    // series holds numFrames values for each of the numNodes nodes, one node after the other
+    CorrelationThread( int id, const float* series, int numNodes, int numFrames, float* exField, float* ex2Field );
     virtual ~CorrelationThread();
 
     std::vector< std::vector<float> >* getResult();
@@ -27,7 +26,9 @@ private:
     void run();
 
     int m_id;
-    DatasetMeshTimeSeries* m_dataset;
+    const float* m_series;
+    int m_numNodes;
+    int m_numFrames;
     float* m_exField;
     float* m_ex2Field;
 
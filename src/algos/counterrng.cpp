@@ -0,0 +1,94 @@
+/*
+ * counterrng.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "counterrng.h"
+
+#include <cmath>
+
+CounterRng::CounterRng( quint64 key, quint64 stream ) :
+    m_used( 4 ),
+    m_spareNormal( 0.0f ),
+    m_hasSpare( false )
+{
+    m_key[0] = static_cast<quint32>( key );
+    m_key[1] = static_cast<quint32>( key >> 32 );
+    // the lower half counts the blocks, the upper half selects the stream
+    m_counter[0] = 0;
+    m_counter[1] = 0;
+    m_counter[2] = static_cast<quint32>( stream );
+    m_counter[3] = static_cast<quint32>( stream >> 32 );
+}
+
+CounterRng::~CounterRng()
+{
+}
+
+void CounterRng::generate()
+{
+    quint32 c[4] = { m_counter[0], m_counter[1], m_counter[2], m_counter[3] };
+    quint32 k0 = m_key[0];
+    quint32 k1 = m_key[1];
+
+    for ( int round = 0; round < 10; ++round )
+    {
+        quint64 p0 = static_cast<quint64>( 0xD2511F53u ) * c[0];
+        quint64 p1 = static_cast<quint64>( 0xCD9E8D57u ) * c[2];
+        quint32 hi0 = static_cast<quint32>( p0 >> 32 );
+        quint32 lo0 = static_cast<quint32>( p0 );
+        quint32 hi1 = static_cast<quint32>( p1 >> 32 );
+        quint32 lo1 = static_cast<quint32>( p1 );
+        c[0] = hi1 ^ c[1] ^ k0;
+        c[1] = lo1;
+        c[2] = hi0 ^ c[3] ^ k1;
+        c[3] = lo0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+
+    m_out[0] = c[0];
+    m_out[1] = c[1];
+    m_out[2] = c[2];
+    m_out[3] = c[3];
+    m_used = 0;
+
+    if ( ++m_counter[0] == 0 )
+    {
+        ++m_counter[1];
+    }
+}
+
+quint32 CounterRng::next()
+{
+    if ( m_used == 4 )
+    {
+        generate();
+    }
+    return m_out[m_used++];
+}
+
+float CounterRng::uniform()
+{
+    // 24 bits fit the float mantissa, so the result never rounds up to 1
+    return ( next() >> 8 ) * ( 1.0f / 16777216.0f );
+}
+
+float CounterRng::normal()
+{
+    if ( m_hasSpare )
+    {
+        m_hasSpare = false;
+        return m_spareNormal;
+    }
+    // box muller, u1 is in (0, 1] to keep the log finite
+    float u1 = 1.0f - uniform();
+    float u2 = uniform();
+    float r = sqrt( -2.0f * log( u1 ) );
+    float phi = 6.2831853f * u2;
+    m_spareNormal = r * sin( phi );
+    m_hasSpare = true;
+    return r * cos( phi );
+}
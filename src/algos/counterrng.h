@@ -0,0 +1,44 @@
+/*
+ * counterrng.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef COUNTERRNG_H_
+#define COUNTERRNG_H_
+
+#include <QtGlobal>
+
+/*
+ * Counter based random numbers (Philox4x32-10, Salmon et al. 2011). The output is a pure function of
+ * key, stream and position, so every work item gets its own stream and draws the same numbers no
+ * matter which thread runs it or in which order.
+ */
+class CounterRng
+{
+public:
+    CounterRng( quint64 key, quint64 stream );
+    virtual ~CounterRng();
+
+    quint32 next();
+
+    // [0, 1)
+    float uniform();
+
+    // standard normal distribution
+    float normal();
+
+private:
+    void generate();
+
+    quint32 m_key[2];
+    quint32 m_counter[4];
+    quint32 m_out[4];
+    int m_used;
+
+    float m_spareNormal;
+    bool m_hasSpare;
+};
+
+#endif /* COUNTERRNG_H_ */
@@ -0,0 +1,231 @@
+/*
+ * distancetransform.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "distancetransform.h"
+#include "distancetransformthread.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QtGlobal>
+
+#include <cmath>
+#include <limits>
+
+DistanceTransform::DistanceTransform( int nx, int ny, int nz, float dx, float dy, float dz ) :
+    m_withNearest( false )
+{
+    m_dims[0] = nx;
+    m_dims[1] = ny;
+    m_dims[2] = nz;
+    m_spacing[0] = dx > 0 ? dx : 1.0f;
+    m_spacing[1] = dy > 0 ? dy : 1.0f;
+    m_spacing[2] = dz > 0 ? dz : 1.0f;
+}
+
+DistanceTransform::~DistanceTransform()
+{
+}
+
+void DistanceTransform::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<DistanceTransformThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new DistanceTransformThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+void DistanceTransform::distance( const std::vector<bool>& features, std::vector<float>& out, std::vector<int>* nearest )
+{
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int nz = m_dims[2];
+    size_t size = static_cast<size_t>( nx ) * ny * nz;
+
+    out.clear();
+    if ( nearest )
+    {
+        nearest->clear();
+    }
+
+    bool any = false;
+    for ( size_t i = 0; i < size && i < features.size() && !any; ++i )
+    {
+        any = features[i];
+    }
+    if ( !any || features.size() < size )
+    {
+        return;
+    }
+
+    m_withNearest = ( nearest != 0 );
+    m_squared.resize( size );
+    for ( size_t i = 0; i < size; ++i )
+    {
+        m_squared[i] = features[i] ? 0.0f : std::numeric_limits<float>::max();
+    }
+    if ( m_withNearest )
+    {
+        m_nearest.resize( size );
+        for ( size_t i = 0; i < size; ++i )
+        {
+            m_nearest[i] = features[i] ? static_cast<int>( i ) : -1;
+        }
+    }
+
+    runPass( DistanceTransformThread::LINES_X, ny * nz );
+    runPass( DistanceTransformThread::LINES_Y, nx * nz );
+    runPass( DistanceTransformThread::LINES_Z, nx * ny );
+
+    out.resize( size );
+    for ( size_t i = 0; i < size; ++i )
+    {
+        out[i] = sqrt( m_squared[i] );
+    }
+    std::vector<float>().swap( m_squared );
+
+    if ( m_withNearest )
+    {
+        nearest->swap( m_nearest );
+        std::vector<int>().swap( m_nearest );
+    }
+}
+
+void DistanceTransform::signedDistance( const std::vector<bool>& mask, std::vector<float>& out )
+{
+    std::vector<bool> outside( mask.size() );
+    for ( size_t i = 0; i < mask.size(); ++i )
+    {
+        outside[i] = !mask[i];
+    }
+
+    // distance to the nearest inside voxel is only non zero outside and vice versa
+    std::vector<float> toInside;
+    std::vector<float> toOutside;
+    distance( mask, toInside );
+    distance( outside, toOutside );
+
+    out.clear();
+    if ( toInside.empty() || toOutside.empty() )
+    {
+        return;
+    }
+    out.resize( toInside.size() );
+    for ( size_t i = 0; i < out.size(); ++i )
+    {
+        out[i] = toInside[i] - toOutside[i];
+    }
+}
+
+void DistanceTransform::transformLines( unsigned int begin, unsigned int end, int axis )
+{
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int n = m_dims[axis];
+    size_t stride = ( axis == 0 ) ? 1 : ( axis == 1 ? nx : static_cast<size_t>( nx ) * ny );
+    double w = m_spacing[axis] * m_spacing[axis];
+    const float inf = std::numeric_limits<float>::max();
+
+    // per thread buffers, the line values, the parabola sites of the lower envelope and their borders
+    std::vector<float> f( n );
+    std::vector<int> fNearest( n );
+    std::vector<int> v( n );
+    std::vector<double> z( n + 1 );
+
+    for ( unsigned int u = begin; u < end; ++u )
+    {
+        size_t base;
+        if ( axis == 0 )
+        {
+            base = static_cast<size_t>( u ) * nx;
+        }
+        else if ( axis == 1 )
+        {
+            base = ( u / nx ) * static_cast<size_t>( nx ) * ny + u % nx;
+        }
+        else
+        {
+            base = u;
+        }
+
+        for ( int q = 0; q < n; ++q )
+        {
+            f[q] = m_squared[base + q * stride];
+        }
+        if ( m_withNearest )
+        {
+            for ( int q = 0; q < n; ++q )
+            {
+                fNearest[q] = m_nearest[base + q * stride];
+            }
+        }
+
+        int k = -1;
+        for ( int q = 0; q < n; ++q )
+        {
+            if ( f[q] == inf )
+            {
+                continue;
+            }
+            if ( k < 0 )
+            {
+                k = 0;
+                v[0] = q;
+                z[0] = -std::numeric_limits<double>::max();
+                z[1] = std::numeric_limits<double>::max();
+                continue;
+            }
+            double s;
+            while ( true )
+            {
+                int p = v[k];
+                s = ( ( f[q] + w * q * q ) - ( f[p] + w * p * p ) ) / ( 2.0 * w * ( q - p ) );
+                if ( s > z[k] || k == 0 )
+                {
+                    break;
+                }
+                --k;
+            }
+            ++k;
+            v[k] = q;
+            z[k] = s;
+            z[k + 1] = std::numeric_limits<double>::max();
+        }
+
+        // no site on this line, it keeps its infinite distance until a later pass
+        if ( k < 0 )
+        {
+            continue;
+        }
+
+        k = 0;
+        for ( int q = 0; q < n; ++q )
+        {
+            while ( z[k + 1] < q )
+            {
+                ++k;
+            }
+            int p = v[k];
+            m_squared[base + q * stride] = w * ( q - p ) * ( q - p ) + f[p];
+            if ( m_withNearest )
+            {
+                m_nearest[base + q * stride] = fNearest[p];
+            }
+        }
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * distancetransform.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef DISTANCETRANSFORM_H_
+#define DISTANCETRANSFORM_H_
+
+#include <vector>
+
+class DistanceTransformThread;
+
+/*
+ * Exact euclidean distance transform after Felzenszwalb and Huttenlocher. Each axis is one pass of
+ * 1D lower envelopes of parabolas, so the whole transform is linear in the number of voxels, the
+ * lines of a pass are split over the threads. Distances are in mm, voxel sizes may differ per axis.
+ */
+class DistanceTransform
+{
+    friend class DistanceTransformThread;
+
+public:
+    DistanceTransform( int nx, int ny, int nz, float dx = 1.0f, float dy = 1.0f, float dz = 1.0f );
+    virtual ~DistanceTransform();
+
+    // distance of every voxel to the nearest feature voxel, nearest gets the index of that voxel,
+    // both stay empty if there is no feature voxel at all
+    void distance( const std::vector<bool>& features, std::vector<float>& out, std::vector<int>* nearest = 0 );
+
+    // distance to the mask border, positive outside and negative inside the mask
+    void signedDistance( const std::vector<bool>& mask, std::vector<float>& out );
+
+private:
+    void runPass( int pass, unsigned int size );
+
+    void transformLines( unsigned int begin, unsigned int end, int axis );
+
+    int m_dims[3];
+    float m_spacing[3];
+
+    // squared distances and nearest feature index, updated in place by every pass
+    std::vector<float> m_squared;
+    std::vector<int> m_nearest;
+    bool m_withNearest;
+};
+
+#endif /* DISTANCETRANSFORM_H_ */
@@ -0,0 +1,54 @@
+/*
+ * distancetransformthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "distancetransformthread.h"
+#include "distancetransform.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+DistanceTransformThread::DistanceTransformThread( DistanceTransform* transform, int pass, unsigned int size, int id ) :
+    m_transform( transform ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+DistanceTransformThread::~DistanceTransformThread()
+{
+}
+
+void DistanceTransformThread::run()
+{
+    TRACE_SCOPE( "DistanceTransformThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case LINES_X:
+            m_transform->transformLines( begin, end, 0 );
+            break;
+        case LINES_Y:
+            m_transform->transformLines( begin, end, 1 );
+            break;
+        case LINES_Z:
+            m_transform->transformLines( begin, end, 2 );
+            break;
+    }
+}
@@ -0,0 +1,37 @@
+/*
+ * distancetransformthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef DISTANCETRANSFORMTHREAD_H_
+#define DISTANCETRANSFORMTHREAD_H_
+
+#include <QThread>
+
+class DistanceTransform;
+
+class DistanceTransformThread : public QThread
+{
+public:
+    enum Pass
+    {
+        LINES_X,
+        LINES_Y,
+        LINES_Z
+    };
+
+    DistanceTransformThread( DistanceTransform* transform, int pass, unsigned int size, int id );
+    virtual ~DistanceTransformThread();
+
+private:
+    void run();
+
+    DistanceTransform* m_transform;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* DISTANCETRANSFORMTHREAD_H_ */
@@ -7,6 +7,7 @@
 #include "dwialgos.h"
 
 #include "fmath.h"
+#include "probtrack.h"
 #include "track.h"
 #include "qball.h"
 #include "bingham.h"
@@ -302,6 +303,61 @@ QList<Dataset*> DWIAlgos::tensorTrack( Dataset* ds )
     return l;
 }
 
+QList<Dataset*> DWIAlgos::probTrack( Dataset* ds, int samplesPerSeed, quint64 seed )
+{
+    ProbTrack* tracker = probTracker( ds, samplesPerSeed, seed );
+    tracker->run();
+    qDebug() << "probabilistic tracking:" << tracker->numSamples() << "samples," << tracker->fibs()->size() << "fibers";
+
+    QList<Dataset*> l = probTrackResult( ds, *tracker->fibs(), *tracker->density() );
+    delete tracker;
+    return l;
+}
+
+ProbTrack* DWIAlgos::probTracker( Dataset* ds, int samplesPerSeed, quint64 seed )
+{
+    PropertyGroup& props = ds->properties( "maingl" );
+    int nx = props.get( Fn::Property::D_NX ).toInt();
+    int ny = props.get( Fn::Property::D_NY ).toInt();
+    int nz = props.get( Fn::Property::D_NZ ).toInt();
+    float dx = props.get( Fn::Property::D_DX ).toFloat();
+    float dy = props.get( Fn::Property::D_DY ).toFloat();
+    float dz = props.get( Fn::Property::D_DZ ).toFloat();
+
+    ProbTrack* tracker = new ProbTrack( nx, ny, nz, dx, dy, dz );
+    if ( props.get( Fn::Property::D_TYPE ).toInt() == (int)Fn::DatasetType::NIFTI_SH )
+    {
+        tracker->setSH( *dynamic_cast<DatasetSH*>( ds )->getData() );
+    }
+    else
+    {
+        tracker->setTensors( *dynamic_cast<DatasetTensor*>( ds )->getData() );
+    }
+    tracker->setSeed( seed );
+    tracker->setSamplesPerSeed( samplesPerSeed );
+    // one fiber per seed to look at, the visitation map gets all samples
+    tracker->setFiberSamples( 1 );
+    return tracker;
+}
+
+QList<Dataset*> DWIAlgos::probTrackResult( Dataset* ds, std::vector<Fib>& fibs, std::vector<float>& density )
+{
+    QList<Dataset*> l;
+    if ( fibs.size() > 0 )
+    {
+        QList<QString>dataNames;
+        dataNames.push_back( "anisotropy" );
+        l.push_back( new DatasetFibers( QDir( "probabilistic fibers" ), fibs, dataNames ) );
+    }
+
+    QString name = ds->properties( "maingl" ).get( Fn::Property::D_NAME ).toString() + " (visitation map)";
+    Writer writer( ds, QFileInfo() );
+    DatasetScalar* map = new DatasetScalar( QDir( name ), density, writer.createHeader( 1 ) );
+    map->properties().set( Fn::Property::D_NAME, name );
+    l.push_back( map );
+    return l;
+}
+
 QList<Dataset*> DWIAlgos::bingham2DWI( Dataset* ds )
 {
     QList<Dataset*> l= Bingham::bingham2Tensor( dynamic_cast<DatasetBingham*>( ds ) );
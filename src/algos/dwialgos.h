@@ -9,8 +9,13 @@
 #define DWIALGOS_H_
 
 #include <QList>
+#include <QtGlobal>
+
+#include <vector>
 
 class Dataset;
+class Fib;
+class ProbTrack;
 
 class DWIAlgos
 {
@@ -27,6 +32,10 @@ public:
     static QList<Dataset*> sh2mesh( Dataset* ds );
 
     static QList<Dataset*> tensorTrack( Dataset* ds );
+    static QList<Dataset*> probTrack( Dataset* ds, int samplesPerSeed = 10, quint64 seed = 0 );
+    // the two halves of probTrack for running the tracker elsewhere, e.g. in the background
+    static ProbTrack* probTracker( Dataset* ds, int samplesPerSeed, quint64 seed );
+    static QList<Dataset*> probTrackResult( Dataset* ds, std::vector<Fib>& fibs, std::vector<float>& density );
 
 private:
     DWIAlgos();
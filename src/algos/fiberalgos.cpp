@@ -34,10 +34,7 @@ QList<Dataset*> FiberAlgos::thinOut( Dataset* ds )
 QList<Dataset*> FiberAlgos::tractDensity( Dataset* ds )
 {
     Fibers* fa = new Fibers( dynamic_cast<DatasetFibers*>( ds ) );
-    DatasetScalar* out = fa->tractDensity();
-    QList<Dataset*> l;
-    l.push_back( out );
-    return l;
+    return fa->tractDensity();
 }
 
 QList<Dataset*> FiberAlgos::tractColor( Dataset* ds )
@@ -75,3 +72,14 @@ QList<Dataset*> FiberAlgos::downSample( Dataset* ds )
     l.push_back( out );
     return l;
 }
+
+QList<Dataset*> FiberAlgos::tractProfile( Dataset* ds, QList<Dataset*> volumes, int nodes )
+{
+    DatasetFibers* fibers = dynamic_cast<DatasetFibers*>( ds );
+    if ( !fibers )
+    {
+        return QList<Dataset*>();
+    }
+    Fibers fa( fibers );
+    return fa.tractProfile( volumes, nodes );
+}
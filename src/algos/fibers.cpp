@@ -5,6 +5,10 @@
  * @author Ralph Schurade
  */
 #include "fibers.h"
+#include "quickbundles.h"
+#include "tractdensity.h"
+#include "tractprofile.h"
+#include "volumesampler.h"
 
 #include "../data/datasets/datasetfibers.h"
 #include "../data/datasets/datasetscalar.h"
@@ -14,9 +18,9 @@
 #include "../algos/colormapbase.h"
 #include "../gui/gl/colormapfunctions.h"
 
-#include <QSet>
 #include <QVector3D>
 
+#include <algorithm>
 #include <limits>
 #include <math.h>
 
@@ -41,79 +45,33 @@ Fibers::~Fibers()
 
 DatasetFibers* Fibers::thinOut()
 {
-    float maxDistance = 1.0;
-    bool merged = true;
-    bool currentMerged = false;
-    int iteration = 1;
-    std::vector<Fib> fibs = *( m_dataset->getFibs() );
-    std::vector<Fib> mergedFibs;
-    std::vector<Fib> unmergedFibs;
+    float threshold = Models::getGlobal( Fn::Property::G_CLUSTER_THRESHOLD ).toFloat();
+    int numPoints = Models::getGlobal( Fn::Property::G_CLUSTER_POINTS ).toInt();
 
-    while ( merged )
-    {
-        qDebug() << "iteration:" << iteration;
-        ++iteration;
-        qDebug() << fibs.size() << "fibers before merging";
+    QuickBundles qb( m_dataset->getFibs(), threshold, numPoints );
+    qb.run();
 
-        merged = false;
-        std::vector<bool>processed( fibs.size(), false );
+    QList<QString> dataNames;
+    dataNames.push_back( "cluster size" );
+    DatasetFibers* out = new DatasetFibers( QDir( "fiber clusters" ), qb.centroidFibs(), dataNames );
 
-        for ( unsigned int i = 0; i < fibs.size(); ++i )
-        {
-            currentMerged = false;
-            Fib currentFib = fibs.at( i );
-            for( unsigned int k = i + 1; k < fibs.size(); ++k )
-            {
-                if ( currentFib.length() == fibs.at( k ).length() )
-                {
-                    float dist = currentFib.dist( fibs.at( k ) );
-                    if ( dist < maxDistance )
-                    {
-                        mergedFibs.push_back( mergeFibs( currentFib, fibs.at( k ) ) );
-                        merged = true;
-                        currentMerged = true;
-                        processed[k] = true;
-                        break;
-                    }
-                }
-            }
-            if ( !currentMerged && !processed[i] )
-            {
-                unmergedFibs.push_back( currentFib );
-            }
-        }
-        fibs = mergedFibs;
-        mergedFibs.clear();
-        qDebug() << fibs.size() + unmergedFibs.size() << "fibers after merging";
-    }
-    fibs.insert( fibs.end(), unmergedFibs.begin(), unmergedFibs.end() );
-    return new DatasetFibers( QDir( "new fibers" ), fibs, m_dataset->getDataNames() );
-}
-
-Fib Fibers::mergeFibs( Fib& lhs, Fib& rhs )
-{
-    Fib out;
-    for ( unsigned int i = 0; i < lhs.length(); ++i )
+    float maxSize = 1;
+    std::vector<unsigned int>* starts = qb.clusterStarts();
+    for ( int i = 0; i < qb.numClusters(); ++i )
     {
-        out.addVert( ( lhs[i] + rhs[i] ) / 2 );
-        out.setData( 0, i, ( lhs.getData( 0, i ) + rhs.getData( 0, i ) ) / 2 );
-    }
-
-    for ( unsigned int i = 1; i < lhs.getCountDataFields(); ++i )
-    {
-        out.addDataField();
-        for ( unsigned int k = 0; k < lhs.length(); ++k )
-        {
-            out.setData( i, k, ( lhs.getData( 0, k ) + rhs.getData( 0, k ) ) / 2 );
-        }
+        maxSize = qMax( maxSize, (float)( starts->at( i + 1 ) - starts->at( i ) ) );
     }
+    out->setDataMaxes( std::vector<float>( 1, maxSize ) );
 
+    // the membership belongs to the clustered fibers, whole clusters are then selected on them
+    m_dataset->setClusters( *qb.assignment() );
     return out;
 }
 
-DatasetScalar* Fibers::tractDensity()
+void Fibers::initGrid()
 {
     float res = Models::getGlobal( Fn::Property::G_TRACT_TEX_RESOLUTION ).toFloat();
+    res /= Models::getGlobal( Fn::Property::G_TRACT_SUPERSAMPLING ).toInt();
 
     QVector3D lowerCorner = m_dataset->getBoundingBox().first;
     QVector3D upperCorner = m_dataset->getBoundingBox().second;
@@ -123,218 +81,60 @@ DatasetScalar* Fibers::tractDensity()
     m_ax = lowerCorner.x();
     m_ay = lowerCorner.y();
     m_az = lowerCorner.z();
-    m_nx = ( upperCorner.x() - m_ax ) / res;
-    m_ny = ( upperCorner.y() - m_ay ) / res;
-    m_nz = ( upperCorner.z() - m_az ) / res;
+    m_nx = qMax( 1, (int)ceil( ( upperCorner.x() - m_ax ) / res ) );
+    m_ny = qMax( 1, (int)ceil( ( upperCorner.y() - m_ay ) / res ) );
+    m_nz = qMax( 1, (int)ceil( ( upperCorner.z() - m_az ) / res ) );
 
     m_blockSize = m_nx * m_ny * m_nz;
-    std::vector<float> data( m_blockSize, 0 );
-    std::vector<Fib> fibs = m_dataset->getSelectedFibs();
-
-    float x, y, z;
-    QVector3D p3;
-    qDebug() << "calculating tract density for " << fibs.size() << " fibers...";
-    for ( unsigned int i = 0; i < fibs.size(); ++i )
-    {
-        if ( i % 1000 == 0 ) qDebug() << i << " done...";
-        std::vector<float> fibdata( m_blockSize, 0 );
-
-        for( unsigned int k = 0; k < fibs[i].length() - 1; ++k )
-        {
-            QVector3D p1( fibs[i][k] );
-            QVector3D p2( fibs[i][k+1] );
+}
 
-            for ( int l = 0; l < 10; ++l )
-            {
-                p3 = ( 1.0 - ( (float)l / 10. ) ) * p1 + ( (float)l / 10. ) * p2;
-                x = p3.x();
-                y = p3.y();
-                z = p3.z();
+QList<Dataset*> Fibers::tractDensity()
+{
+    initGrid();
 
-                int id = getID( x, y, z );
+    std::vector<Fib> fibs = m_dataset->getSelectedFibs();
+    qDebug() << "calculating tract density for " << fibs.size() << " fibers...";
 
-                if ( fibdata[id] == 0 )
-                {
-                    ++fibdata[id];
-                    ++data[id];
-                }
-            }
-        }
-    }
+    TractDensity density( &fibs, m_nx, m_ny, m_nz, m_dx, m_dy, m_dz, m_ax, m_ay, m_az );
+    density.run( TractDensity::COUNT | TractDensity::LENGTH );
 
-    nifti_image* header = createHeader( 1 );
-    DatasetScalar* out = new DatasetScalar( QDir( "tract density" ), data, header );
-    return out;
+    QList<Dataset*> l;
+    l.push_back( new DatasetScalar( QDir( "tract density" ), *density.count(), createHeader( 1 ) ) );
+    l.push_back( new DatasetScalar( QDir( "tract density (length)" ), *density.length(), createHeader( 1 ) ) );
+    return l;
 }
 
 Dataset3D* Fibers::tractColor()
 {
-    QVector3D lowerCorner = m_dataset->getBoundingBox().first;
-    QVector3D upperCorner = m_dataset->getBoundingBox().second;
-    m_dx = Models::getGlobal( Fn::Property::G_TRACT_TEX_RESOLUTION ).toFloat();
-    m_dy = m_dx;
-    m_dz = m_dx;
-    m_ax = lowerCorner.x();
-    m_ay = lowerCorner.y();
-    m_az = lowerCorner.z();
-    m_nx = ( upperCorner.x() - m_ax ) / m_dx;
-    m_ny = ( upperCorner.y() - m_ay ) / m_dx;
-    m_nz = ( upperCorner.z() - m_az ) / m_dx;
+    initGrid();
 
     int source = Models::getGlobal( Fn::Property::G_TRACT_TEXT_SOURCE ).toInt();
-    m_blockSize = m_nx * m_ny * m_nz;
-    std::vector<QVector3D> data( m_blockSize );
-    std::vector<int> count( m_blockSize, 0 );
     std::vector<Fib> fibs = m_dataset->getSelectedFibs();
 
-    QSet<int> visited;
-    int id = 0;
-
-    switch ( source )
+    TractDensity density( &fibs, m_nx, m_ny, m_nz, m_dx, m_dy, m_dz, m_ax, m_ay, m_az );
+    if ( source == TractDensity::DATA )
     {
-        case 0:
-        {
-            for ( unsigned int i = 0; i < fibs.size(); ++i )
-            {
-                Fib fib = fibs[i];
-                visited.clear();
-
-                for ( unsigned int k = 0; k < fib.length(); ++k )
-                {
-                    QVector3D localColor = fib.getTangent( k );
-                    localColor.setX( fabs( localColor.x() ) );
-                    localColor.setY( fabs( localColor.y() ) );
-                    localColor.setZ( fabs( localColor.z() ) );
-                    localColor.normalize();
-
-                    id = getID( fib[k].x(), fib[k].y(), fib[k].z() );
-                    if ( !visited.contains( id) )
-                    {
-                        ++count[ id ];
-                        data[ id ] += localColor;
-                        visited.insert( id );
-                    }
-                }
-            }
-
-            for ( int i = 0; i < m_blockSize; ++i )
-            {
-                data[i] /= count[i];
-                count[i] = qMin( count[i], 10 );
-            }
-            float div;
-            for ( int i = 0; i < m_blockSize; ++i )
-            {
-                div = ( (float)count[i] / 20. ) + 0.5;
-                data[i] *= div;
-            }
-            break;
-        }
-        case 1:
-        {
-            for ( unsigned int i = 0; i < fibs.size(); ++i )
-            {
-                Fib fib = fibs[i];
-                visited.clear();
-
-                QColor localColor = fib.globalColor();
-                QVector3D colVec( localColor.redF(), localColor.greenF(), localColor.blue() );
-
-                for ( unsigned int k = 0; k < fib.length(); ++k )
-                {
-                    id = getID( fib[k].x(), fib[k].y(), fib[k].z() );
-                    if ( !visited.contains( id) )
-                    {
-                        ++count[ id ];
-                        data[ id ] += colVec;
-                        visited.insert( id );
-                    }
-                }
-            }
-            for ( int i = 0; i < m_blockSize; ++i )
-            {
-                data[i] /= count[i];
-                count[i] = qMin( count[i], 10 );
-            }
-            float div;
-            for ( int i = 0; i < m_blockSize; ++i )
-            {
-                div = ( (float)count[i] / 20. ) + 0.5;
-                data[i] *= div;
-            }
-            break;
-        }
-        case 2:
-        {
-            for ( unsigned int i = 0; i < fibs.size(); ++i )
-            {
-                Fib fib = fibs[i];
-                visited.clear();
-
-                QColor localColor = fib.customColor();
-                QVector3D colVec( localColor.redF(), localColor.greenF(), localColor.blue() );
-
-                for ( unsigned int k = 0; k < fib.length(); ++k )
-                {
-                    id = getID( fib[k].x(), fib[k].y(), fib[k].z() );
-                    if ( !visited.contains( id) )
-                    {
-                        ++count[ id ];
-                        data[ id ] += colVec;
-                        visited.insert( id );
-                    }
-                }
-            }
-
-            for ( int i = 0; i < m_blockSize; ++i )
-            {
-                data[i] /= count[i];
-            }
+        int dm = m_dataset->properties( "maingl" ).get( Fn::Property::D_DATAMODE ).toInt();
+        int cm = m_dataset->properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt();
+        density.setColorSource( source, dm, m_dataset->getDataMins()[dm], m_dataset->getDataMaxes()[dm], ColormapFunctions::get( cm ) );
+    }
+    else
+    {
+        density.setColorSource( source );
+    }
+    density.run( TractDensity::COLOR );
 
-            break;
-        }
-        case 3:
+    std::vector<float>* count = density.count();
+    std::vector<float>* color = density.color();
+    std::vector<QVector3D> data( m_blockSize );
+    for ( int i = 0; i < m_blockSize; ++i )
+    {
+        data[i] = QVector3D( color->at( i * 3 ), color->at( i * 3 + 1 ), color->at( i * 3 + 2 ) );
+        // direction and global colors get brighter with more fibers
+        if ( source == TractDensity::LOCAL || source == TractDensity::GLOBAL )
         {
-            int dm = m_dataset->properties( "maingl" ).get( Fn::Property::D_DATAMODE ).toInt();
-            int cm = m_dataset->properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt();
-            ColormapBase cmb = ColormapFunctions::get( cm );
-
-            float dataMin = m_dataset->getDataMins()[dm];
-            float dataMax = m_dataset->getDataMaxes()[dm];
-            float div = dataMax - dataMin;
-
-            for ( unsigned int i = 0; i < fibs.size(); ++i )
-            {
-                Fib fib = fibs[i];
-                visited.clear();
-
-                for ( unsigned int k = 0; k < fib.length(); ++k )
-                {
-                    float value = ( fib.getData( dm, k ) - dataMin ) / div;
-
-                    QColor localColor = cmb.getColor( value );
-                    QVector3D colVec( localColor.redF(), localColor.greenF(), localColor.blue() );
-
-                    id = getID( fib[k].x(), fib[k].y(), fib[k].z() );
-                    if ( !visited.contains( id) )
-                    {
-                        ++count[ id ];
-                        data[ id ] += colVec;
-                        visited.insert( id );
-                    }
-                }
-            }
-
-            for ( int i = 0; i < m_blockSize; ++i )
-            {
-                data[i] /= count[i];
-            }
-
-            break;
+            data[i] *= ( qMin( count->at( i ), 10.0f ) / 20. ) + 0.5;
         }
-
-        default:
-            break;
     }
 
     nifti_image* header = createHeader( 3 );
@@ -387,6 +187,152 @@ DatasetFibers* Fibers::downSample()
     return out;
 }
 
+QList<Dataset*> Fibers::tractProfile( QList<Dataset*> volumes, int nodes )
+{
+    QList<Dataset*> l;
+    std::vector<Fib>* fibs = m_dataset->getFibs();
+
+    std::vector<VolumeSampler*> samplers;
+    QList<QString> names;
+    for ( int i = 0; i < volumes.size(); ++i )
+    {
+        VolumeSampler* sampler = new VolumeSampler( volumes[i] );
+        if ( sampler->isValid() )
+        {
+            samplers.push_back( sampler );
+            names.push_back( volumes[i]->properties().get( Fn::Property::D_NAME ).toString() );
+        }
+        else
+        {
+            delete sampler;
+        }
+    }
+    if ( samplers.empty() || fibs->empty() )
+    {
+        return l;
+    }
+
+    TractProfile tp( nodes );
+    std::vector<int>* clusters = m_dataset->getClusters();
+    bool bundles = clusters->size() == fibs->size();
+    if ( bundles )
+    {
+        tp.setBundles( *clusters );
+    }
+    else if ( !clusters->empty() )
+    {
+        qWarning() << "cluster assignment doesn't match the fibers," << clusters->size() << "for" << fibs->size() << "fibers, profiling them as one bundle";
+    }
+
+    std::vector< std::vector<float> > values;
+    std::vector< std::vector<float> > means;
+    std::vector< std::vector<float> > stdDevs;
+    std::vector<float> positions;
+    tp.profile( *fibs, samplers, values, means, stdDevs, &positions );
+    for ( unsigned int v = 0; v < samplers.size(); ++v )
+    {
+        delete samplers[v];
+    }
+    nodes = tp.numNodes();
+
+    // the resampled fibers carry one data field per volume
+    std::vector<float> mins;
+    std::vector<float> maxes;
+    for ( unsigned int v = 0; v < values.size(); ++v )
+    {
+        mins.push_back( *std::min_element( values[v].begin(), values[v].end() ) );
+        maxes.push_back( *std::max_element( values[v].begin(), values[v].end() ) );
+    }
+
+    std::vector<Fib> newFibs( fibs->size() );
+    std::vector<QVector3D> verts( nodes );
+    for ( unsigned int i = 0; i < fibs->size(); ++i )
+    {
+        size_t base = static_cast<size_t>( i ) * nodes;
+        for ( int k = 0; k < nodes; ++k )
+        {
+            verts[k] = QVector3D( positions[( base + k ) * 3], positions[( base + k ) * 3 + 1], positions[( base + k ) * 3 + 2] );
+        }
+        Fib fib( verts );
+        for ( unsigned int v = 0; v < values.size(); ++v )
+        {
+            std::vector<float> field( values[v].begin() + base, values[v].begin() + base + nodes );
+            if ( v == 0 )
+            {
+                fib.setDataField( 0, field );
+            }
+            else
+            {
+                fib.addDataField( field );
+            }
+        }
+        fib.setCustomColor( fibs->at( i ).customColor() );
+        newFibs[i] = fib;
+    }
+    std::vector<float>().swap( positions );
+
+    DatasetFibers* profiled = new DatasetFibers( QDir( "profiled fibers" ), newFibs, names );
+    profiled->setDataMins( mins );
+    profiled->setDataMaxes( maxes );
+    if ( bundles )
+    {
+        profiled->setClusters( *clusters );
+    }
+    l.push_back( profiled );
+
+    // one center line per bundle with the mean and standard deviation of every volume
+    QList<QString> profileNames;
+    std::vector<float> profileMins;
+    std::vector<float> profileMaxes;
+    for ( int v = 0; v < names.size(); ++v )
+    {
+        profileNames.push_back( names[v] + " mean" );
+        profileNames.push_back( names[v] + " std" );
+        profileMins.push_back( mins[v] );
+        profileMins.push_back( 0.0f );
+        profileMaxes.push_back( maxes[v] );
+        profileMaxes.push_back( qMax( 1e-6f, *std::max_element( stdDevs[v].begin(), stdDevs[v].end() ) ) );
+    }
+
+    std::vector<Fib> centerFibs;
+    const std::vector<float>& centers = tp.centers();
+    for ( int b = 0; b < tp.numBundles(); ++b )
+    {
+        if ( tp.bundleSizes()[b] == 0 )
+        {
+            continue;
+        }
+        size_t base = static_cast<size_t>( b ) * nodes;
+        for ( int k = 0; k < nodes; ++k )
+        {
+            verts[k] = QVector3D( centers[( base + k ) * 3], centers[( base + k ) * 3 + 1], centers[( base + k ) * 3 + 2] );
+        }
+        Fib fib( verts );
+        for ( unsigned int v = 0; v < means.size(); ++v )
+        {
+            std::vector<float> mean( means[v].begin() + base, means[v].begin() + base + nodes );
+            std::vector<float> stdDev( stdDevs[v].begin() + base, stdDevs[v].begin() + base + nodes );
+            if ( v == 0 )
+            {
+                fib.setDataField( 0, mean );
+            }
+            else
+            {
+                fib.addDataField( mean );
+            }
+            fib.addDataField( stdDev );
+        }
+        centerFibs.push_back( fib );
+    }
+
+    DatasetFibers* profiles = new DatasetFibers( QDir( "tract profiles" ), centerFibs, profileNames );
+    profiles->setDataMins( profileMins );
+    profiles->setDataMaxes( profileMaxes );
+    l.push_back( profiles );
+
+    return l;
+}
+
 nifti_image* Fibers::createHeader( int dim )
 {
     nifti_image* out = nifti_simple_init_nim();
@@ -12,8 +12,10 @@
 
 #include "../thirdparty/nifti/nifti1_io.h"
 
+#include <QList>
 #include <QVector>
 
+class Dataset;
 class DatasetFibers;
 class DatasetScalar;
 class Dataset3D;
@@ -25,14 +27,15 @@ public:
     virtual ~Fibers();
 
     DatasetFibers* thinOut();
-    DatasetScalar* tractDensity();
+    QList<Dataset*> tractDensity();
     Dataset3D* tractColor();
     DatasetFibers* downSample();
+    QList<Dataset*> tractProfile( QList<Dataset*> volumes, int nodes );
 
 private:
     DatasetFibers* m_dataset;
 
-    Fib mergeFibs( Fib& lhs, Fib& rhs );
+    void initGrid();
     nifti_image* createHeader( int dim );
 
     int m_nx;
@@ -45,14 +48,6 @@ private:
     float m_ay;
     float m_az;
     int m_blockSize;
-
-    int getID( float x, float y, float z )
-    {
-        int id = (int) ( ( x - m_ax ) / m_dx ) + (int) ( ( y - m_ay ) / m_dy ) * m_nx + (int) ( ( z - m_az ) / m_dz ) * m_ny * m_nx;
-
-        id = std::max( (int) 0, std::min( m_blockSize - 1, id ) );
-        return id;
-    }
 };
 
 #endif /* FIBERS_H_ */
@@ -0,0 +1,168 @@
+/*
+ * fiberspatialindex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "fiberspatialindex.h"
+
+#include "kdtree.h"
+#include "voxelfiberindex.h"
+
+#include <QDebug>
+
+#include <math.h>
+
+FiberSpatialIndex::FiberSpatialIndex( std::vector<Fib>& fibs, std::vector<float>* verts ) :
+    m_numLines( fibs.size() ),
+    m_numPoints( 0 ),
+    m_ownVerts( verts == 0 ),
+    m_verts( verts ),
+    m_kdTree( 0 )
+{
+    qDebug() << "start creating kdtree";
+    for ( int i = 0; i < m_numLines; ++i )
+    {
+        m_numPoints += fibs[i].length();
+    }
+
+    try
+    {
+        m_reverseIndexes.reserve( m_numPoints );
+        m_lineStarts.reserve( m_numLines );
+        m_lineLengths.reserve( m_numLines );
+        if ( m_ownVerts )
+        {
+            m_verts = new std::vector<float>();
+            m_verts->reserve( m_numPoints * 3 );
+        }
+
+        int ls = 0;
+        for ( int i = 0; i < m_numLines; ++i )
+        {
+            m_lineStarts.push_back( ls );
+            m_lineLengths.push_back( fibs[i].length() );
+            for ( unsigned int k = 0; k < fibs[i].length(); ++k )
+            {
+                if ( m_ownVerts )
+                {
+                    m_verts->push_back( fibs[i][k].x() );
+                    m_verts->push_back( fibs[i][k].y() );
+                    m_verts->push_back( fibs[i][k].z() );
+                }
+                m_reverseIndexes.push_back( i );
+                ++ls;
+            }
+        }
+    }
+    catch ( std::bad_alloc& )
+    {
+        qCritical() << "***error*** failed to allocate enough memory for kd tree";
+        exit ( 0 );
+    }
+
+    m_kdTree = new KdTree( m_numPoints, m_verts->data() );
+    qDebug() << "end creating kdTree";
+}
+
+FiberSpatialIndex::~FiberSpatialIndex()
+{
+    for ( unsigned int i = 0; i < m_voxelIndexes.size(); ++i )
+    {
+        delete m_voxelIndexes[i];
+    }
+    delete m_kdTree;
+    if ( m_ownVerts )
+    {
+        delete m_verts;
+    }
+}
+
+int FiberSpatialIndex::numLines()
+{
+    return m_numLines;
+}
+
+int FiberSpatialIndex::numPoints()
+{
+    return m_numPoints;
+}
+
+VoxelFiberIndex* FiberSpatialIndex::voxelIndex( int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az )
+{
+    for ( unsigned int i = 0; i < m_voxelIndexes.size(); ++i )
+    {
+        if ( m_voxelIndexes[i]->matches( nx, ny, nz, dx, dy, dz, ax, ay, az ) )
+        {
+            return m_voxelIndexes[i];
+        }
+    }
+    VoxelFiberIndex* index = new VoxelFiberIndex( m_verts->data(), m_lineStarts, m_lineLengths, nx, ny, nz, dx, dy, dz, ax, ay, az );
+    m_voxelIndexes.push_back( index );
+    return index;
+}
+
+void FiberSpatialIndex::selectBox( const float* min, const float* max, std::vector<bool>& out )
+{
+    boxTest( out, 0, m_numPoints - 1, 0, min, max );
+}
+
+void FiberSpatialIndex::boxTest( std::vector<bool>& workfield, int left, int right, int axis, const float* min, const float* max )
+{
+    // abort condition
+    if ( left > right )
+        return;
+
+    int root = left + ( ( right - left ) / 2 );
+    int axis1 = ( axis + 1 ) % 3;
+    int pointIndex = m_kdTree->m_tree[root] * 3;
+
+    if ( m_verts->at( pointIndex + axis ) < min[axis] )
+    {
+        boxTest( workfield, root + 1, right, axis1, min, max );
+    }
+    else if ( m_verts->at( pointIndex + axis ) > max[axis] )
+    {
+        boxTest( workfield, left, root - 1, axis1, min, max );
+    }
+    else
+    {
+        int axis2 = ( axis + 2 ) % 3;
+        if ( m_verts->at( pointIndex + axis1 ) <= max[axis1] && m_verts->at( pointIndex + axis1 )
+                >= min[axis1] && m_verts->at( pointIndex + axis2 ) <= max[axis2]
+                && m_verts->at( pointIndex + axis2 ) >= min[axis2] )
+        {
+            workfield[m_reverseIndexes[ m_kdTree->m_tree[root] ]] = true;
+        }
+        boxTest( workfield, left, root - 1, axis1, min, max );
+        boxTest( workfield, root + 1, right, axis1, min, max );
+    }
+}
+
+void FiberSpatialIndex::restrictToEllipsoid( const float* center, const float* radii, std::vector<bool>& out )
+{
+    float vx,vy,vz;
+    bool hit;
+    for ( int i = 0; i < m_numLines; ++i )
+    {
+        int ls = m_lineStarts[i] * 3;
+        if ( out[i] )
+        {
+            hit = false;
+            for ( int k = 0; k < m_lineLengths[i]; ++k )
+            {
+                vx = ( m_verts->at(  ls + k*3     ) - center[0] ) / radii[0];
+                vy = ( m_verts->at(  ls + k*3 + 1 ) - center[1] ) / radii[1];
+                vz = ( m_verts->at(  ls + k*3 + 2 ) - center[2] ) / radii[2];
+                float r = sqrt( vx * vx + vy * vy + vz * vz );
+                if ( r < 1.0 )
+                {
+                    hit = true;
+                    break;
+                }
+            }
+            out[i] = hit;
+        }
+    }
+}
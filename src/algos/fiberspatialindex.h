@@ -0,0 +1,57 @@
+/*
+ * fiberspatialindex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FIBERSPATIALINDEX_H_
+#define FIBERSPATIALINDEX_H_
+
+#include "fib.h"
+
+#include <vector>
+
+class KdTree;
+class VoxelFiberIndex;
+
+/*
+ * Spatial lookups behind the fiber selection, free of the roi model: a kd tree over all fiber points for
+ * box and ellipsoid rois and one inverted voxel index per roi grid, built on first use.
+ */
+class FiberSpatialIndex
+{
+public:
+    // verts holds the points of all fibers as x, y, z in fiber order, it is flattened from fibs if not given
+    FiberSpatialIndex( std::vector<Fib>& fibs, std::vector<float>* verts = 0 );
+    virtual ~FiberSpatialIndex();
+
+    int numLines();
+    int numPoints();
+
+    // sets out[fiber] for every fiber with a point inside the box, out is not cleared
+    void selectBox( const float* min, const float* max, std::vector<bool>& out );
+
+    // clears out[fiber] for every selected fiber without a point inside the ellipsoid
+    void restrictToEllipsoid( const float* center, const float* radii, std::vector<bool>& out );
+
+    // fibers per voxel of the given grid, shared with all volume rois on that grid
+    VoxelFiberIndex* voxelIndex( int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az );
+
+private:
+    void boxTest( std::vector<bool>& workfield, int left, int right, int axis, const float* min, const float* max );
+
+    int m_numLines;
+    int m_numPoints;
+
+    bool m_ownVerts;
+    std::vector<float>* m_verts;
+    std::vector<int> m_reverseIndexes;
+    std::vector<int> m_lineStarts;
+    std::vector<int> m_lineLengths;
+
+    KdTree* m_kdTree;
+    std::vector<VoxelFiberIndex*> m_voxelIndexes;
+};
+
+#endif /* FIBERSPATIALINDEX_H_ */
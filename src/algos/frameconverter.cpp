@@ -0,0 +1,124 @@
+/*
+ * frameconverter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "frameconverter.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // scales a float in [0,1] so its bits shifted by 13 are the half with the exponent rebiased from 127 to 15,
+    // values below the smallest normal half end up as float denormals which shift into half denormals,
+    // rounded twice there, which is at most one denormal step off
+    const float REBIAS = 1.92592994e-34f; // 2^-112
+
+    quint16 rebiasedToHalf( quint32 bits )
+    {
+        // round to nearest even on the 13 dropped mantissa bits
+        bits += 0x0fff + ( ( bits >> 13 ) & 1 );
+        return static_cast<quint16>( bits >> 13 );
+    }
+}
+
+quint16 FrameConverter::floatToHalf( float value )
+{
+    // also maps nan to 0
+    if ( !( value > 0.0f ) )
+    {
+        return 0;
+    }
+    if ( value > 1.0f )
+    {
+        value = 1.0f;
+    }
+    value *= REBIAS;
+    quint32 bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    return rebiasedToHalf( bits );
+}
+
+float FrameConverter::halfToFloat( quint16 value )
+{
+    int exponent = ( value >> 10 ) & 0x1f;
+    int mantissa = value & 0x3ff;
+    float result;
+    if ( exponent == 0 )
+    {
+        result = mantissa / 16777216.0f;
+    }
+    else if ( exponent == 31 )
+    {
+        result = mantissa ? 0.0f : 65504.0f;
+    }
+    else
+    {
+        quint32 bits = ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+        memcpy( &result, &bits, sizeof( result ) );
+    }
+    return ( value & 0x8000 ) ? -result : result;
+}
+
+void FrameConverter::toHalf( const float* in, unsigned int size, float min, float max, quint16* out )
+{
+    float scale = ( max > min ) ? 1.0f / ( max - min ) : 0.0f;
+    unsigned int i = 0;
+
+#ifdef __SSE2__
+    const __m128 vMin = _mm_set1_ps( min );
+    const __m128 vScale = _mm_set1_ps( scale );
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vOne = _mm_set1_ps( 1.0f );
+    const __m128 vRebias = _mm_set1_ps( REBIAS );
+    const __m128i vRound = _mm_set1_epi32( 0x0fff );
+    const __m128i vOdd = _mm_set1_epi32( 1 );
+
+    for ( ; i + 8 <= size; i += 8 )
+    {
+        __m128i halves[2];
+        for ( int k = 0; k < 2; ++k )
+        {
+            __m128 v = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( in + i + 4 * k ), vMin ), vScale );
+            // max takes the second operand for nan, so nan becomes 0 like in the scalar path
+            v = _mm_min_ps( _mm_max_ps( v, vZero ), vOne );
+            __m128i bits = _mm_castps_si128( _mm_mul_ps( v, vRebias ) );
+            bits = _mm_add_epi32( bits, _mm_add_epi32( vRound, _mm_and_si128( _mm_srli_epi32( bits, 13 ), vOdd ) ) );
+            halves[k] = _mm_srli_epi32( bits, 13 );
+        }
+        // all halves are at most 0x3c00, so the signed saturation of the pack never kicks in
+        _mm_storeu_si128( reinterpret_cast<__m128i*>( out + i ), _mm_packs_epi32( halves[0], halves[1] ) );
+    }
+#endif
+
+    for ( ; i < size; ++i )
+    {
+        out[i] = floatToHalf( ( in[i] - min ) * scale );
+    }
+}
+
+void FrameConverter::toPackedRGBA( const float* data, int nx, int ny, const int* min, const int* max, float lo, float hi, unsigned char* out )
+{
+    for ( int z = min[2]; z <= max[2]; ++z )
+    {
+        for ( int y = min[1]; y <= max[1]; ++y )
+        {
+            const float* row = data + y * nx + z * nx * ny;
+            for ( int x = min[0]; x <= max[0]; ++x )
+            {
+                unsigned int tmp = ( ( row[x] - lo ) / ( hi - lo ) ) * 256 * 256 * 256 * 256;
+                out[3] = ( tmp / ( 256 * 256 * 256 ) ) % 256;
+                out[2] = ( tmp / ( 256 * 256 ) ) % 256;
+                out[1] = ( tmp / 256 ) % 256;
+                out[0] = tmp % 256;
+                out += 4;
+            }
+        }
+    }
+}
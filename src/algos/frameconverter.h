@@ -0,0 +1,32 @@
+/*
+ * frameconverter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FRAMECONVERTER_H_
+#define FRAMECONVERTER_H_
+
+#include <QtGlobal>
+
+/*
+ * Converts frames of a float series into the half float texture format. Values are normalized to
+ * [0,1] with the min and max of the whole series and clamped, so the shaders see the same range as
+ * for the packed rgba textures. Four values at a time with SSE2 where available, no GL involved.
+ * The packed rgba format of the scalar textures is built here too, for a whole volume or a box of it.
+ */
+class FrameConverter
+{
+public:
+    static void toHalf( const float* in, unsigned int size, float min, float max, quint16* out );
+
+    // the box [min, max] of a volume, x fastest, the value normalized with lo and hi spread over the
+    // four bytes of a texel, lowest byte first
+    static void toPackedRGBA( const float* data, int nx, int ny, const int* min, const int* max, float lo, float hi, unsigned char* out );
+
+    static quint16 floatToHalf( float value );
+    static float halfToFloat( quint16 value );
+};
+
+#endif /* FRAMECONVERTER_H_ */
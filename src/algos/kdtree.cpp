@@ -6,6 +6,7 @@
  */
 
 #include "kdtree.h"
+#include "trace.h"
 
 KdTree::KdTree( int size, float *pointArray, bool useThreads )
 :   m_size( size ),
@@ -75,6 +76,8 @@ KdTreeThread::KdTreeThread(float *pointArray, std::vector<int>* tree, int left,
 
 void KdTreeThread::run()
 {
+    TRACE_SCOPE( "KdTreeThread::run" );
+
     buildTree(m_left, m_right, m_axis);
 
 }
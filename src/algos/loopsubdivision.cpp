@@ -6,157 +6,305 @@
  */
 
 #include "loopsubdivision.h"
+#include "loopsubdivisionthread.h"
 
 #include "../data/mesh/trianglemesh2.h"
 
+#include "../gui/gl/glfunctions.h"
+
 #include <QDebug>
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
-LoopSubdivision::~LoopSubdivision()
+namespace
 {
+    const unsigned int NO_VERT = std::numeric_limits<unsigned int>::max();
 }
 
-LoopSubdivision::LoopSubdivision( TriangleMesh2* mesh ) :
-    m_mesh( mesh )
+LoopSubdivision::~LoopSubdivision()
 {
-    m_mesh = new TriangleMesh2( mesh );
-
-    m_numVerts = m_mesh->numVerts();
-    m_numTris = m_mesh->numTris();
-
-    m_mesh->resize( m_numVerts * 4, m_numTris * 4 );
+}
 
-    std::vector<QVector3D> newVertexPositions( m_numVerts );
+LoopSubdivision::LoopSubdivision( TriangleMesh2* mesh, int levels ) :
+    m_mesh( 0 ),
+    m_numVerts( mesh->numVerts() ),
+    m_numTris( mesh->numTris() ),
+    m_numEdges( 0 ),
+    m_outVerts( 0 ),
+    m_outStride( 3 ),
+    m_outTris( 0 )
+{
+    levels = qMax( 1, levels );
 
+    // flat working copy of the input, positions only
+    float* inVerts = mesh->getVertices();
+    unsigned int inStride = mesh->bufferSize();
+    m_verts.resize( m_numVerts * 3 );
     for ( unsigned int i = 0; i < m_numVerts; ++i )
     {
-        newVertexPositions[i] = calcNewPosition( i );
+        m_verts[i * 3    ] = inVerts[i * inStride    ];
+        m_verts[i * 3 + 1] = inVerts[i * inStride + 1];
+        m_verts[i * 3 + 2] = inVerts[i * inStride + 2];
     }
+    unsigned int* inTris = mesh->getIndexes();
+    m_tris.assign( inTris, inTris + m_numTris * 3 );
 
-    for ( unsigned int i = 0; i < m_numTris; ++i )
+    for ( int level = 0; level < levels; ++level )
     {
-        insertCenterTriangle( i );
-    }
+        buildEdgeTable();
 
-    for ( unsigned int i = 0; i < m_numTris; ++i )
-    {
-        insertCornerTriangles( i );
-    }
+        unsigned int newNumVerts = m_numVerts + m_numEdges;
+        unsigned int newNumTris = m_numTris * 4;
 
-    for ( unsigned int i = 0; i < m_numVerts; ++i )
-    {
-        m_mesh->setVertex( i, newVertexPositions[i] );
+        if ( level == levels - 1 )
+        {
+            // last level, write straight into the preallocated result mesh
+            m_mesh = new TriangleMesh2( newNumVerts, newNumTris );
+            std::fill( m_mesh->getVertexColors(), m_mesh->getVertexColors() + newNumVerts * 4, 1.0f );
+            subdivide( m_mesh->getVertices(), m_mesh->bufferSize(), m_mesh->getIndexes() );
+        }
+        else
+        {
+            std::vector<float> newVerts( newNumVerts * 3 );
+            std::vector<unsigned int> newTris( newNumTris * 3 );
+            subdivide( newVerts.data(), 3, newTris.data() );
+            m_verts.swap( newVerts );
+            m_tris.swap( newTris );
+        }
+        qDebug() << "loop subdivision level" << level + 1 << ": num verts:" << newNumVerts << "num tris:" << newNumTris;
+
+        m_numVerts = newNumVerts;
+        m_numTris = newNumTris;
     }
 
-    m_numVerts = m_mesh->numVerts();
-    m_numTris = m_mesh->numTris();
+    m_verts.clear();
+    m_tris.clear();
+    m_edgeKeys.clear();
+    m_halfEdgeToEdge.clear();
+    m_edgeVerts.clear();
+    m_neighborOffsets.clear();
+    m_neighbors.clear();
+    m_isBoundaryEdge.clear();
 
+    m_mesh->rebuildStars();
     m_mesh->finalize();
-
-    newVertexPositions.clear();
 }
 
-QVector3D LoopSubdivision::calcNewPosition( unsigned int vertNum )
+void LoopSubdivision::subdivide( float* outVerts, unsigned int outStride, unsigned int* outTris )
 {
-    std::vector<unsigned int> starP = m_mesh->getStar( vertNum );
-    unsigned int starSize = starP.size();
-
-    QVector3D oldPos = m_mesh->getVertex( vertNum );
-    double alpha = getAlpha( starSize );
-    oldPos *= ( 1.0 - ( (double) starSize * alpha ) );
-
-    QVector3D newPos;
-    unsigned int edgeV = 0;
-    for ( unsigned int i = 0; i < starSize; i++ )
-    {
-        edgeV = m_mesh->getNextVertex( starP[i], vertNum );
-        newPos += m_mesh->getVertex( edgeV );
-    }
-    newPos *= alpha;
+    m_outVerts = outVerts;
+    m_outStride = outStride;
+    m_outTris = outTris;
 
-    return oldPos + newPos;
+    runPass( LoopSubdivisionThread::EVEN_VERTS, m_numVerts );
+    runPass( LoopSubdivisionThread::ODD_VERTS, m_numEdges );
+    runPass( LoopSubdivisionThread::SPLIT_TRIS, m_numTris );
 }
 
-void LoopSubdivision::insertCenterTriangle( unsigned int triNum )
+void LoopSubdivision::runPass( int pass, unsigned int size )
 {
+    int numThreads = GLFunctions::idealThreadCount;
 
-    std::vector<unsigned int> intP = m_mesh->getTriangle( triNum );
-    unsigned int edgeVerts[3];
-
-    for ( unsigned int i = 0; i < 3; ++i )
+    std::vector<LoopSubdivisionThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new LoopSubdivisionThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
     {
-        edgeVerts[i] = calcEdgeVert( triNum, intP[i], intP[( i + 1 ) % 3], intP[( i + 2 ) % 3] );
+        threads[i]->wait();
+        delete threads[i];
     }
-    m_mesh->addTriangle( edgeVerts[0], edgeVerts[1], edgeVerts[2] );
 }
 
-void LoopSubdivision::insertCornerTriangles( unsigned int triNum )
+void LoopSubdivision::buildEdgeTable()
 {
+    unsigned int numHalfEdges = m_numTris * 3;
 
-    // comment:     center are twisted from the orignal vertices.
-    // original:    0, 1, 2
-    // center:      a, b, c
-    // reAsgnOrig:  0, a, c
-    // addTris:     1, b, a
-    // addTris:     2, c, b
-    //
-    std::vector<unsigned int> originalTri = m_mesh->getTriangle( triNum );
-    std::vector<unsigned int> centerTri = m_mesh->getTriangle( triNum + m_numTris );
-
-    m_mesh->addTriangle( originalTri[1], centerTri[1], centerTri[0] );
-    m_mesh->addTriangle( originalTri[2], centerTri[2], centerTri[1] );
-    m_mesh->setTriangle( triNum, originalTri[0], centerTri[0], centerTri[2] );
-}
+    m_edgeKeys.resize( numHalfEdges );
+    runPass( LoopSubdivisionThread::EDGE_KEYS, m_numTris );
+    std::sort( m_edgeKeys.begin(), m_edgeKeys.end() );
 
-unsigned int LoopSubdivision::calcEdgeVert( unsigned int triNum, unsigned int edgeV1, unsigned int edgeV2, unsigned int V3 )
-{
+    // collapse equal keys into unique edges
+    m_halfEdgeToEdge.resize( numHalfEdges );
+    m_edgeVerts.clear();
+    m_edgeVerts.reserve( numHalfEdges / 2 * 4 + 4 );
+    m_numEdges = 0;
 
-    unsigned int vertNum = 0;
+    unsigned int i = 0;
+    while ( i < numHalfEdges )
+    {
+        quint64 key = m_edgeKeys[i].key;
+        unsigned int half = m_edgeKeys[i].halfEdge;
+        m_halfEdgeToEdge[half] = m_numEdges;
 
-    unsigned  neighborVert = 0;
-    unsigned  neighborFaceNum = 0;
-    QVector3D edgeVert;
+        m_edgeVerts.push_back( (unsigned int)( key >> 32 ) );
+        m_edgeVerts.push_back( (unsigned int)( key & 0xffffffff ) );
+        m_edgeVerts.push_back( m_tris[( half / 3 ) * 3 + ( half + 2 ) % 3] );
 
-    neighborFaceNum = m_mesh->getNeighbor( edgeV1, edgeV2, triNum );
+        unsigned int opposite = NO_VERT;
+        ++i;
+        while ( i < numHalfEdges && m_edgeKeys[i].key == key )
+        {
+            half = m_edgeKeys[i].halfEdge;
+            m_halfEdgeToEdge[half] = m_numEdges;
+            if ( opposite == NO_VERT )
+            {
+                opposite = m_tris[( half / 3 ) * 3 + ( half + 2 ) % 3];
+            }
+            ++i;
+        }
+        m_edgeVerts.push_back( opposite );
+        ++m_numEdges;
+    }
 
-    if ( neighborFaceNum == triNum )
+    // vertex neighbourhoods from the unique edges
+    m_neighborOffsets.assign( m_numVerts + 1, 0 );
+    for ( unsigned int e = 0; e < m_numEdges; ++e )
     {
-        QVector3D edgeVert = ( m_mesh->getVertex( edgeV1 ) + m_mesh->getVertex( edgeV2 ) ) / 2.0;
-        vertNum = m_mesh->currentNumVerts();
-        m_mesh->addVertex( edgeVert.x(), edgeVert.y(), edgeVert.z() );
+        ++m_neighborOffsets[m_edgeVerts[e * 4] + 1];
+        ++m_neighborOffsets[m_edgeVerts[e * 4 + 1] + 1];
     }
-
-    else if ( neighborFaceNum > triNum )
+    for ( unsigned int v = 0; v < m_numVerts; ++v )
     {
-        neighborVert = m_mesh->getThirdVert( edgeV1, edgeV2, neighborFaceNum );
+        m_neighborOffsets[v + 1] += m_neighborOffsets[v];
+    }
 
-        QVector3D edgePart = m_mesh->getVertex( edgeV1 ) + m_mesh->getVertex( edgeV2 );
-        QVector3D neighborPart = m_mesh->getVertex( neighborVert ) + m_mesh->getVertex( V3 );
+    m_neighbors.resize( m_numEdges * 2 );
+    m_isBoundaryEdge.resize( m_numEdges * 2 );
+    std::vector<unsigned int> cursor( m_neighborOffsets.begin(), m_neighborOffsets.end() - 1 );
+    for ( unsigned int e = 0; e < m_numEdges; ++e )
+    {
+        unsigned int v0 = m_edgeVerts[e * 4];
+        unsigned int v1 = m_edgeVerts[e * 4 + 1];
+        unsigned char boundary = ( m_edgeVerts[e * 4 + 3] == NO_VERT ) ? 1 : 0;
+        m_isBoundaryEdge[cursor[v0]] = boundary;
+        m_neighbors[cursor[v0]++] = v1;
+        m_isBoundaryEdge[cursor[v1]] = boundary;
+        m_neighbors[cursor[v1]++] = v0;
+    }
+}
 
-        edgeVert = ( ( edgePart * ( 3.0 / 8.0 ) ) + ( neighborPart * ( 1.0 / 8.0 ) ) );
-        vertNum = m_mesh->currentNumVerts();
-        m_mesh->addVertex( edgeVert.x(), edgeVert.y(), edgeVert.z() );
+void LoopSubdivision::edgeKeys( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int t = begin; t < end; ++t )
+    {
+        for ( unsigned int k = 0; k < 3; ++k )
+        {
+            quint64 a = m_tris[t * 3 + k];
+            quint64 b = m_tris[t * 3 + ( k + 1 ) % 3];
+            EdgeKey& ek = m_edgeKeys[t * 3 + k];
+            ek.key = ( a < b ) ? ( ( a << 32 ) | b ) : ( ( b << 32 ) | a );
+            ek.halfEdge = t * 3 + k;
+        }
     }
-    else
+}
+
+void LoopSubdivision::evenVertices( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int v = begin; v < end; ++v )
     {
-        std::vector<unsigned int> neighborCenterP = m_mesh->getTriangle( neighborFaceNum + m_numTris );
-        std::vector<unsigned int> neighborP = m_mesh->getTriangle( neighborFaceNum );
+        float* out = &m_outVerts[v * m_outStride];
+        const float* p = &m_verts[v * 3];
+
+        unsigned int first = m_neighborOffsets[v];
+        unsigned int n = m_neighborOffsets[v + 1] - first;
 
-        if ( neighborP[0] == edgeV2 )
+        float sum[3] = { 0, 0, 0 };
+        float boundarySum[3] = { 0, 0, 0 };
+        unsigned int numBoundary = 0;
+        for ( unsigned int k = first; k < first + n; ++k )
         {
-            vertNum = neighborCenterP[0];
+            const float* q = &m_verts[m_neighbors[k] * 3];
+            sum[0] += q[0];
+            sum[1] += q[1];
+            sum[2] += q[2];
+            if ( m_isBoundaryEdge[k] )
+            {
+                boundarySum[0] += q[0];
+                boundarySum[1] += q[1];
+                boundarySum[2] += q[2];
+                ++numBoundary;
+            }
         }
-        else if ( neighborP[1] == edgeV2 )
+
+        if ( n == 0 )
+        {
+            out[0] = p[0];
+            out[1] = p[1];
+            out[2] = p[2];
+        }
+        else if ( numBoundary == 2 )
         {
-            vertNum = neighborCenterP[1];
+            // crease rule, keeps open mesh borders from shrinking inwards
+            out[0] = 0.75f * p[0] + 0.125f * boundarySum[0];
+            out[1] = 0.75f * p[1] + 0.125f * boundarySum[1];
+            out[2] = 0.75f * p[2] + 0.125f * boundarySum[2];
         }
         else
         {
-            vertNum = neighborCenterP[2];
+            float alpha = getAlpha( n );
+            float self = 1.0f - (float)n * alpha;
+            out[0] = self * p[0] + alpha * sum[0];
+            out[1] = self * p[1] + alpha * sum[1];
+            out[2] = self * p[2] + alpha * sum[2];
         }
     }
-    return vertNum;
+}
+
+void LoopSubdivision::oddVertices( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int e = begin; e < end; ++e )
+    {
+        float* out = &m_outVerts[( m_numVerts + e ) * m_outStride];
+        const unsigned int* ev = &m_edgeVerts[e * 4];
+        const float* a = &m_verts[ev[0] * 3];
+        const float* b = &m_verts[ev[1] * 3];
+
+        if ( ev[3] == NO_VERT )
+        {
+            out[0] = ( a[0] + b[0] ) * 0.5f;
+            out[1] = ( a[1] + b[1] ) * 0.5f;
+            out[2] = ( a[2] + b[2] ) * 0.5f;
+        }
+        else
+        {
+            const float* c = &m_verts[ev[2] * 3];
+            const float* d = &m_verts[ev[3] * 3];
+            out[0] = ( a[0] + b[0] ) * 0.375f + ( c[0] + d[0] ) * 0.125f;
+            out[1] = ( a[1] + b[1] ) * 0.375f + ( c[1] + d[1] ) * 0.125f;
+            out[2] = ( a[2] + b[2] ) * 0.375f + ( c[2] + d[2] ) * 0.125f;
+        }
+    }
+}
+
+void LoopSubdivision::splitTriangles( unsigned int begin, unsigned int end )
+{
+    // original:    0, 1, 2
+    // edge verts:  a = 01, b = 12, c = 20
+    // corners:     0, a, c  /  1, b, a  /  2, c, b
+    // center:      a, b, c
+    for ( unsigned int t = begin; t < end; ++t )
+    {
+        unsigned int v0 = m_tris[t * 3];
+        unsigned int v1 = m_tris[t * 3 + 1];
+        unsigned int v2 = m_tris[t * 3 + 2];
+        unsigned int a = m_numVerts + m_halfEdgeToEdge[t * 3];
+        unsigned int b = m_numVerts + m_halfEdgeToEdge[t * 3 + 1];
+        unsigned int c = m_numVerts + m_halfEdgeToEdge[t * 3 + 2];
+
+        unsigned int* out = &m_outTris[t * 12];
+        out[0] = v0; out[1]  = a; out[2]  = c;
+        out[3] = v1; out[4]  = b; out[5]  = a;
+        out[6] = v2; out[7]  = c; out[8]  = b;
+        out[9] = a;  out[10] = b; out[11] = c;
+    }
 }
 
 double LoopSubdivision::getAlpha( unsigned int n )
@@ -10,28 +10,64 @@
 
 #include <QVector3D>
 
+#include <vector>
+
 class TriangleMesh2;
+class LoopSubdivisionThread;
 
 class LoopSubdivision
 {
+    friend class LoopSubdivisionThread;
+
 public:
-    LoopSubdivision( TriangleMesh2* mesh );
+    LoopSubdivision( TriangleMesh2* mesh, int levels = 1 );
     virtual ~LoopSubdivision();
 
     TriangleMesh2* getMesh() { return m_mesh; };
 
 private:
-    unsigned int calcEdgeVert( unsigned int triNum, unsigned int edgeV1, unsigned int edgeV2, unsigned int V3 );
-    QVector3D calcNewPosition( unsigned int vertNum );
-    void insertCenterTriangle( unsigned int triNum );
-    void insertCornerTriangles( unsigned int triNum );
+    struct EdgeKey
+    {
+        quint64 key;
+        unsigned int halfEdge;
+        bool operator<( const EdgeKey& other ) const { return key < other.key; };
+    };
+
+    void subdivide( float* outVerts, unsigned int outStride, unsigned int* outTris );
+    void buildEdgeTable();
+    void runPass( int pass, unsigned int size );
+
+    void edgeKeys( unsigned int begin, unsigned int end );
+    void evenVertices( unsigned int begin, unsigned int end );
+    void oddVertices( unsigned int begin, unsigned int end );
+    void splitTriangles( unsigned int begin, unsigned int end );
+
     double getAlpha( unsigned int n );
 
     TriangleMesh2* m_mesh;
-    TriangleMesh2* m_newMesh;
 
     unsigned int m_numVerts;
     unsigned int m_numTris;
+    unsigned int m_numEdges;
+
+    // current level, positions packed xyz
+    std::vector<float> m_verts;
+    std::vector<unsigned int> m_tris;
+
+    // unique edge table, built once per level from the sorted edge keys
+    std::vector<EdgeKey> m_edgeKeys;
+    std::vector<unsigned int> m_halfEdgeToEdge;
+    std::vector<unsigned int> m_edgeVerts;      // 4 per edge: v0, v1, opposite0, opposite1 ( -1 on boundary )
+
+    // vertex -> neighbour vertices in CSR layout, boundary neighbours flagged
+    std::vector<unsigned int> m_neighborOffsets;
+    std::vector<unsigned int> m_neighbors;
+    std::vector<unsigned char> m_isBoundaryEdge;
+
+    // output of the current level
+    float* m_outVerts;
+    unsigned int m_outStride;
+    unsigned int* m_outTris;
 };
 
 #endif /* LOOPSUBDIVISION_H_ */
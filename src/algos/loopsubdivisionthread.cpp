@@ -0,0 +1,57 @@
+/*
+ * loopsubdivisionthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "loopsubdivisionthread.h"
+#include "loopsubdivision.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+LoopSubdivisionThread::LoopSubdivisionThread( LoopSubdivision* loop, int pass, unsigned int size, int id ) :
+    m_loop( loop ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+LoopSubdivisionThread::~LoopSubdivisionThread()
+{
+}
+
+void LoopSubdivisionThread::run()
+{
+    TRACE_SCOPE( "LoopSubdivisionThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case EDGE_KEYS:
+            m_loop->edgeKeys( begin, end );
+            break;
+        case EVEN_VERTS:
+            m_loop->evenVertices( begin, end );
+            break;
+        case ODD_VERTS:
+            m_loop->oddVertices( begin, end );
+            break;
+        case SPLIT_TRIS:
+            m_loop->splitTriangles( begin, end );
+            break;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * loopsubdivisionthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef LOOPSUBDIVISIONTHREAD_H_
+#define LOOPSUBDIVISIONTHREAD_H_
+
+#include <QThread>
+
+class LoopSubdivision;
+
+class LoopSubdivisionThread : public QThread
+{
+public:
+    enum Pass
+    {
+        EDGE_KEYS,
+        EVEN_VERTS,
+        ODD_VERTS,
+        SPLIT_TRIS
+    };
+
+    LoopSubdivisionThread( LoopSubdivision* loop, int pass, unsigned int size, int id );
+    virtual ~LoopSubdivisionThread();
+
+private:
+    void run();
+
+    LoopSubdivision* m_loop;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* LOOPSUBDIVISIONTHREAD_H_ */
@@ -7,7 +7,9 @@
 
 #include "meshalgos.h"
 
+#include "connectedcomponents.h"
 #include "loopsubdivision.h"
+#include "meshdecimation.h"
 
 #include "../data/datasets/datasetscalar.h"
 #include "../data/datasets/datasetfmri.h"
@@ -17,11 +19,12 @@
 
 #include "../data/models.h"
 
-#include <QQueue>
+#include <algorithm>
 
 QList<Dataset*> MeshAlgos::loopSubdivision( Dataset* ds )
 {
-    LoopSubdivision loop( dynamic_cast<DatasetMesh*>( ds )->getMesh() );
+    int levels = Models::getGlobal( Fn::Property::G_SUBDIVISION_LEVELS ).toInt();
+    LoopSubdivision loop( dynamic_cast<DatasetMesh*>( ds )->getMesh(), levels );
     DatasetMesh* dsm = new DatasetMesh( loop.getMesh(), QDir("loop subdivision") );
     QList<Dataset*> l;
     l.push_back( dsm );
@@ -71,101 +74,74 @@ QList<Dataset*> MeshAlgos::biggestComponent( Dataset* ds )
     TriangleMesh2* mesh = dsm->getMesh();
     qDebug() << "in:  num verts:" << mesh->numVerts() << "num tris:" << mesh->numTris();
 
-    int numTris = mesh->numTris();
+    ConnectedComponents cc;
+    cc.labelMesh( mesh );
+    cc.removeSmallerThan( Models::getGlobal( Fn::Property::G_MIN_COMPONENT_SIZE ).toInt() );
 
-    QHash<int, int>todo;
-    for ( int i = 0; i < numTris; ++i )
+    // triangles grouped by component in one counting pass
+    const std::vector<int>& labels = cc.labels();
+    unsigned int numComponents = cc.numComponents();
+    std::vector<unsigned int> offsets( numComponents + 2, 0 );
+    for ( unsigned int i = 0; i < labels.size(); ++i )
     {
-        todo.insert( i, i );
+        ++offsets[labels[i] + 1];
     }
-    QQueue<int>queue;
-    std::vector<std::vector<int> >components;
-    int sumTris = 0;
-    do
+    for ( unsigned int i = 1; i < offsets.size(); ++i )
     {
-        std::vector<int>component;
-        int item = todo.take( todo.begin().value() );
-        queue.enqueue( item );
-        while( !queue.empty() )
-        {
-            int currentTri = queue.dequeue();
-            component.push_back( currentTri );
-            std::vector<unsigned int>tri = mesh->getTriangle( currentTri );
-
-            for( unsigned int i = 0; i < tri.size(); ++i )
-            {
-                int vert = tri[i];
-                std::vector<unsigned int>star = mesh->getStar( vert );
-                for ( unsigned int k = 0; k < star.size(); ++k )
-                {
-                    int nextTri = star[k];
-                    if ( todo.contains( nextTri ) )
-                    {
-                        todo.remove( nextTri );
-                        queue.enqueue( nextTri );
-                    }
-                }
-            }
-        }
-        components.push_back( component );
-        sumTris += component.size();
+        offsets[i] += offsets[i - 1];
+    }
+    std::vector<int> sorted( labels.size() );
+    std::vector<unsigned int> fill( offsets.begin(), offsets.end() - 1 );
+    for ( unsigned int i = 0; i < labels.size(); ++i )
+    {
+        sorted[fill[labels[i]]++] = i;
     }
-    while( sumTris < numTris );
 
     QList<Dataset*> l;
 
-    for ( unsigned int i = 0; i < components.size(); ++i )
+    for ( unsigned int i = 1; i <= numComponents; ++i )
     {
-        if ( (int)components[i].size() < Models::getGlobal( Fn::Property::G_MIN_COMPONENT_SIZE ).toInt() )
-        {
-            continue;
-        }
-
-        TriangleMesh2* newMesh = pruneMesh( mesh, components[i] );
+        std::vector<int> component( sorted.begin() + offsets[i], sorted.begin() + offsets[i + 1] );
+        TriangleMesh2* newMesh = pruneMesh( mesh, component );
         qDebug() << "out: num verts:" << newMesh->numVerts() << "num tris:" << newMesh->numTris();
         DatasetMesh* newDSM = new DatasetMesh( newMesh, "mesh component " + QString::number( i ) );
         l.push_back( newDSM );
     }
 
-
-
-
-   return l;
+    return l;
 }
 
-TriangleMesh2* MeshAlgos::pruneMesh( TriangleMesh2* mesh, std::vector<int>component )
+TriangleMesh2* MeshAlgos::pruneMesh( TriangleMesh2* mesh, const std::vector<int>& component )
 {
-    QMap<int, int>newVertIds;
+    unsigned int* triangles = mesh->getIndexes();
 
+    // used vertices in their old order, the new id is the position in that list
+    std::vector<unsigned int> verts;
+    verts.reserve( component.size() * 3 );
     for( unsigned int k = 0; k < component.size(); ++k )
     {
-        std::vector<unsigned int>tri = mesh->getTriangle( component[k] );
-        for( unsigned int l = 0; l < tri.size(); ++l )
-        {
-            if ( !newVertIds.contains( tri[l] ) )
-            {
-                newVertIds.insert( tri[l], 0 );
-            }
-        }
+        verts.push_back( triangles[component[k] * 3] );
+        verts.push_back( triangles[component[k] * 3 + 1] );
+        verts.push_back( triangles[component[k] * 3 + 2] );
     }
+    std::sort( verts.begin(), verts.end() );
+    verts.erase( std::unique( verts.begin(), verts.end() ), verts.end() );
 
-    TriangleMesh2* newMesh = new TriangleMesh2( newVertIds.size(), component.size() );
+    TriangleMesh2* newMesh = new TriangleMesh2( verts.size(), component.size() );
 
-    QMap<int, int>::iterator mapIterator = newVertIds.begin();
-    int vertInsertId = 0;
-    while ( mapIterator != newVertIds.end() )
+    for ( unsigned int k = 0; k < verts.size(); ++k )
     {
-        QVector3D vert = mesh->getVertex( mapIterator.key() );
-        newVertIds[mapIterator.key()] = vertInsertId++;
+        QVector3D vert = mesh->getVertex( verts[k] );
         newMesh->addVertex( vert.x(), vert.y(), vert.z() );
-        ++mapIterator;
     }
 
-
     for( unsigned int k = 0; k < component.size(); ++k )
     {
-        std::vector<unsigned int>tri = mesh->getTriangle( component[k] );
-        newMesh->addTriangle( newVertIds[tri[0]], newVertIds[tri[1]], newVertIds[tri[2]] );
+        unsigned int* tri = &triangles[component[k] * 3];
+        unsigned int v0 = std::lower_bound( verts.begin(), verts.end(), tri[0] ) - verts.begin();
+        unsigned int v1 = std::lower_bound( verts.begin(), verts.end(), tri[1] ) - verts.begin();
+        unsigned int v2 = std::lower_bound( verts.begin(), verts.end(), tri[2] ) - verts.begin();
+        newMesh->addTriangle( v0, v1, v2 );
     }
 
     newMesh->finalize();
@@ -182,94 +158,31 @@ QList<Dataset*> MeshAlgos::decimate( Dataset* ds )
 
     float epsilon = Models::getGlobal( Fn::Property::G_DECIMATE_EPSILON).toFloat();
 
-    QMap<QString, std::vector<int> >cells;
-    std::vector<QString>keys( mesh->numVerts() );
-
-    // put verts into cells of diameter epsilon
-    int x,y,z;
-    for ( unsigned int i = 0; i < mesh->numVerts(); ++i )
-    {
-        QVector3D vert = mesh->getVertex( i );
-        x = vert.x() / epsilon;
-        y = vert.y() / epsilon;
-        z = vert.z() / epsilon;
-        QString key = QString( x ) + "_" + QString( y ) + "_" + QString( z );
-        keys[i] = key;
-
-        if ( cells.contains( key ) )
-        {
-            cells[key].push_back( i );
-        }
-        else
-        {
-            std::vector<int> entry;
-            entry.push_back( i );
-            cells.insert( key, entry );
-        }
-    }
-
-    // for each cell compute representative vertex
-
-    QMap<QString, std::vector<int> >::iterator mapIterator = cells.begin();
+    MeshDecimation decimation( mesh );
+    TriangleMesh2* newMesh = decimation.cluster( epsilon );
 
-    QMap<QString, Point>newVerts;
-
-    int newPointId = 0;
-
-    while( mapIterator != cells.end() )
-    {
-        std::vector<int>verts = mapIterator.value();
-
-        QVector3D newVert( 0, 0, 0 );
-        for ( unsigned int i = 0; i < verts.size(); ++i )
-        {
-            newVert += mesh->getVertex( verts[i] );
-        }
-        newVert /= verts.size();
-        Point p;
-        p.newID = newPointId++;
-        p.pos = newVert;
-        newVerts.insert( mapIterator.key(), p );
+    qDebug() << "out: num verts:" << newMesh->numVerts() << "num tris:" << newMesh->numTris();
+    DatasetMesh* newDSM = new DatasetMesh( newMesh, QString("mesh decimate") );
+    l.push_back( newDSM );
 
-        ++mapIterator;
-    }
+    return l;
+}
 
-    std::vector<Triangle>newTriangles;
+QList<Dataset*> MeshAlgos::simplify( Dataset* ds )
+{
+    DatasetMesh* dsm = dynamic_cast<DatasetMesh*>( ds );
+    TriangleMesh2* mesh = dsm->getMesh();
+    QList<Dataset*> l;
 
-    // remove degenerative triangles
-    for ( unsigned int i = 0; i < mesh->numTris(); ++i )
-    {
-        Triangle t = mesh->getTriangle2( i );
-        QString key0 = keys[t.v0];
-        QString key1 = keys[t.v1];
-        QString key2 = keys[t.v2];
-        Triangle newT;
-        newT.v0 = newVerts[key0].newID;
-        newT.v1 = newVerts[key1].newID;
-        newT.v2 = newVerts[key2].newID;
-
-        if ( ( newT.v0 != newT.v1 ) &&  ( newT.v0 != newT.v2 ) &&  ( newT.v1 != newT.v2 ) )
-        {
-            newTriangles.push_back( newT );
-        }
-    }
+    qDebug() << "in:  num verts:" << mesh->numVerts() << "num tris:" << mesh->numTris();
 
-    TriangleMesh2* newMesh = new TriangleMesh2( newVerts.size(), newTriangles.size() );
+    unsigned int targetTris = Models::getGlobal( Fn::Property::G_SIMPLIFY_TARGET_TRIS ).toInt();
 
-    QMap<QString, Point>::iterator vertIterator = newVerts.begin();
+    MeshDecimation decimation( mesh );
+    TriangleMesh2* newMesh = decimation.simplify( targetTris );
 
-    while( vertIterator != newVerts.end() )
-    {
-        newMesh->setVertex( vertIterator.value().newID, vertIterator.value().pos );
-        ++vertIterator;
-    }
-    for ( unsigned int i = 0; i < newTriangles.size(); ++i )
-    {
-        newMesh->setTriangle( i, newTriangles[i] );
-    }
-    newMesh->finalize();
     qDebug() << "out: num verts:" << newMesh->numVerts() << "num tris:" << newMesh->numTris();
-    DatasetMesh* newDSM = new DatasetMesh( newMesh, QString("mesh decimate") );
+    DatasetMesh* newDSM = new DatasetMesh( newMesh, QString("mesh simplify") );
     l.push_back( newDSM );
 
     return l;
@@ -20,8 +20,9 @@ public:
     static QList<Dataset*> loopSubdivision( Dataset* ds );
     static QList<Dataset*> meshTimeSeries( Dataset* ds, TriangleMesh2* mesh );
     static QList<Dataset*> biggestComponent( Dataset* ds );
-    static TriangleMesh2* pruneMesh( TriangleMesh2* mesh, std::vector<int>component );
+    static TriangleMesh2* pruneMesh( TriangleMesh2* mesh, const std::vector<int>& component );
     static QList<Dataset*> decimate( Dataset* ds );
+    static QList<Dataset*> simplify( Dataset* ds );
 
 private:
     MeshAlgos() {};
@@ -0,0 +1,648 @@
+/*
+ * meshdecimation.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "meshdecimation.h"
+#include "meshdecimationthread.h"
+
+#include "../data/mesh/trianglemesh2.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <queue>
+
+namespace
+{
+    const unsigned int CELL_BITS = 21;
+    const unsigned int CELL_MAX = ( 1 << CELL_BITS ) - 1;
+
+    struct KeyCompare
+    {
+        KeyCompare( const std::vector<quint64>& keys ) : m_keys( keys ) {};
+        bool operator()( unsigned int a, unsigned int b ) const { return m_keys[a] < m_keys[b]; };
+        const std::vector<quint64>& m_keys;
+    };
+}
+
+MeshDecimation::MeshDecimation( TriangleMesh2* mesh ) :
+    m_mesh( mesh ),
+    m_numVerts( mesh->numVerts() ),
+    m_numTris( mesh->numTris() ),
+    m_epsilon( 1.0f )
+{
+    float* verts = mesh->getVertices();
+    unsigned int stride = mesh->bufferSize();
+    m_verts.resize( m_numVerts * 3 );
+    for ( unsigned int i = 0; i < m_numVerts; ++i )
+    {
+        m_verts[i * 3    ] = verts[i * stride    ];
+        m_verts[i * 3 + 1] = verts[i * stride + 1];
+        m_verts[i * 3 + 2] = verts[i * stride + 2];
+    }
+    unsigned int* tris = mesh->getIndexes();
+    m_tris.assign( tris, tris + m_numTris * 3 );
+}
+
+MeshDecimation::~MeshDecimation()
+{
+}
+
+void MeshDecimation::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<MeshDecimationThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new MeshDecimationThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+TriangleMesh2* MeshDecimation::cluster( float epsilon )
+{
+    m_epsilon = qMax( epsilon, 0.0001f );
+
+    float max[3];
+    m_min[0] = m_min[1] = m_min[2] = std::numeric_limits<float>::max();
+    max[0] = max[1] = max[2] = -std::numeric_limits<float>::max();
+    for ( unsigned int i = 0; i < m_numVerts; ++i )
+    {
+        for ( int k = 0; k < 3; ++k )
+        {
+            m_min[k] = qMin( m_min[k], m_verts[i * 3 + k] );
+            max[k] = qMax( max[k], m_verts[i * 3 + k] );
+        }
+    }
+
+    // a key holds CELL_BITS per axis, on a grid with more cells than that vertices far apart would
+    // share the last cell, so the cells are made large enough to cover the mesh
+    float extent = qMax( max[0] - m_min[0], qMax( max[1] - m_min[1], max[2] - m_min[2] ) );
+    if ( extent / m_epsilon >= CELL_MAX )
+    {
+        float coarse = extent / ( CELL_MAX - 1 );
+        qWarning() << "vertex clustering: cell size" << m_epsilon << "gives more than" << CELL_MAX << "cells per axis, using" << coarse;
+        m_epsilon = coarse;
+    }
+
+    // integer cell key per vertex, then group equal keys by sorting
+    m_cellKeys.resize( m_numVerts );
+    runPass( MeshDecimationThread::CELL_KEYS, m_numVerts );
+
+    m_sortedVerts.resize( m_numVerts );
+    for ( unsigned int i = 0; i < m_numVerts; ++i )
+    {
+        m_sortedVerts[i] = i;
+    }
+    std::sort( m_sortedVerts.begin(), m_sortedVerts.end(), KeyCompare( m_cellKeys ) );
+
+    m_vertToCluster.resize( m_numVerts );
+    m_clusterOffsets.clear();
+    for ( unsigned int i = 0; i < m_numVerts; ++i )
+    {
+        if ( i == 0 || m_cellKeys[m_sortedVerts[i]] != m_cellKeys[m_sortedVerts[i - 1]] )
+        {
+            m_clusterOffsets.push_back( i );
+        }
+        m_vertToCluster[m_sortedVerts[i]] = m_clusterOffsets.size() - 1;
+    }
+    unsigned int numClusters = m_clusterOffsets.size();
+    m_clusterOffsets.push_back( m_numVerts );
+
+    // every cluster is a contiguous run in m_sortedVerts, so the centroids need no locking
+    m_clusterPos.resize( numClusters * 3 );
+    runPass( MeshDecimationThread::CENTROIDS, numClusters );
+
+    // remap triangles and remove degenerate ones
+    std::vector<Triangle> newTriangles;
+    newTriangles.reserve( m_numTris );
+    for ( unsigned int i = 0; i < m_numTris; ++i )
+    {
+        Triangle newT;
+        newT.v0 = m_vertToCluster[m_tris[i * 3    ]];
+        newT.v1 = m_vertToCluster[m_tris[i * 3 + 1]];
+        newT.v2 = m_vertToCluster[m_tris[i * 3 + 2]];
+
+        if ( ( newT.v0 != newT.v1 ) && ( newT.v0 != newT.v2 ) && ( newT.v1 != newT.v2 ) )
+        {
+            newTriangles.push_back( newT );
+        }
+    }
+
+    TriangleMesh2* newMesh = new TriangleMesh2( numClusters, newTriangles.size() );
+    for ( unsigned int i = 0; i < numClusters; ++i )
+    {
+        newMesh->setVertex( i, m_clusterPos[i * 3], m_clusterPos[i * 3 + 1], m_clusterPos[i * 3 + 2] );
+    }
+    for ( unsigned int i = 0; i < newTriangles.size(); ++i )
+    {
+        newMesh->setTriangle( i, newTriangles[i] );
+    }
+    newMesh->finalize();
+
+    m_cellKeys.clear();
+    m_sortedVerts.clear();
+    m_clusterOffsets.clear();
+    m_vertToCluster.clear();
+    m_clusterPos.clear();
+
+    return newMesh;
+}
+
+void MeshDecimation::cellKeys( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        quint64 x = qMin( (unsigned int)( ( m_verts[i * 3    ] - m_min[0] ) / m_epsilon ), CELL_MAX );
+        quint64 y = qMin( (unsigned int)( ( m_verts[i * 3 + 1] - m_min[1] ) / m_epsilon ), CELL_MAX );
+        quint64 z = qMin( (unsigned int)( ( m_verts[i * 3 + 2] - m_min[2] ) / m_epsilon ), CELL_MAX );
+        m_cellKeys[i] = x | ( y << CELL_BITS ) | ( z << ( 2 * CELL_BITS ) );
+    }
+}
+
+void MeshDecimation::centroids( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int c = begin; c < end; ++c )
+    {
+        double sum[3] = { 0, 0, 0 };
+        unsigned int first = m_clusterOffsets[c];
+        unsigned int last = m_clusterOffsets[c + 1];
+        for ( unsigned int k = first; k < last; ++k )
+        {
+            const float* p = &m_verts[m_sortedVerts[k] * 3];
+            sum[0] += p[0];
+            sum[1] += p[1];
+            sum[2] += p[2];
+        }
+        double count = last - first;
+        m_clusterPos[c * 3    ] = sum[0] / count;
+        m_clusterPos[c * 3 + 1] = sum[1] / count;
+        m_clusterPos[c * 3 + 2] = sum[2] / count;
+    }
+}
+
+void MeshDecimation::faceQuadrics( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int t = begin; t < end; ++t )
+    {
+        const float* p0 = &m_verts[m_tris[t * 3    ] * 3];
+        const float* p1 = &m_verts[m_tris[t * 3 + 1] * 3];
+        const float* p2 = &m_verts[m_tris[t * 3 + 2] * 3];
+
+        double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        double n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+        double len = std::sqrt( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+
+        Quadric& q = m_faceQuadrics[t];
+        std::fill( q.q, q.q + 10, 0.0 );
+        if ( len > 0 )
+        {
+            n[0] /= len;
+            n[1] /= len;
+            n[2] /= len;
+            // area weighted plane
+            addPlane( q, n[0], n[1], n[2], -( n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2] ), len * 0.5 );
+        }
+    }
+}
+
+void MeshDecimation::vertexQuadrics( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int v = begin; v < end; ++v )
+    {
+        Quadric& q = m_quadrics[v];
+        std::fill( q.q, q.q + 10, 0.0 );
+        for ( unsigned int k = m_starOffsets[v]; k < m_starOffsets[v + 1]; ++k )
+        {
+            const Quadric& f = m_faceQuadrics[m_stars[k]];
+            for ( int i = 0; i < 10; ++i )
+            {
+                q.q[i] += f.q[i];
+            }
+        }
+    }
+}
+
+void MeshDecimation::addPlane( Quadric& q, double a, double b, double c, double d, double weight )
+{
+    q.q[0] += weight * a * a;
+    q.q[1] += weight * a * b;
+    q.q[2] += weight * a * c;
+    q.q[3] += weight * a * d;
+    q.q[4] += weight * b * b;
+    q.q[5] += weight * b * c;
+    q.q[6] += weight * b * d;
+    q.q[7] += weight * c * c;
+    q.q[8] += weight * c * d;
+    q.q[9] += weight * d * d;
+}
+
+double MeshDecimation::error( const Quadric& q, const float* p )
+{
+    double x = p[0];
+    double y = p[1];
+    double z = p[2];
+    return q.q[0] * x * x + 2 * q.q[1] * x * y + 2 * q.q[2] * x * z + 2 * q.q[3] * x
+                          +     q.q[4] * y * y + 2 * q.q[5] * y * z + 2 * q.q[6] * y
+                                               +     q.q[7] * z * z + 2 * q.q[8] * z
+                                                                    +     q.q[9];
+}
+
+bool MeshDecimation::computeCollapse( unsigned int v0, unsigned int v1, Collapse& c )
+{
+    Quadric q;
+    for ( int i = 0; i < 10; ++i )
+    {
+        q.q[i] = m_quadrics[v0].q[i] + m_quadrics[v1].q[i];
+    }
+
+    // optimal position minimizes v^T Q v, solve the 3x3 system with cramer's rule
+    double a = q.q[0], b = q.q[1], cc = q.q[2];
+    double d = q.q[4], e = q.q[5], f = q.q[7];
+    double det = a * ( d * f - e * e ) - b * ( b * f - e * cc ) + cc * ( b * e - d * cc );
+
+    const float* p0 = &m_verts[v0 * 3];
+    const float* p1 = &m_verts[v1 * 3];
+
+    double scale = a + d + f;
+    if ( std::fabs( det ) > 1e-6 * scale * scale * scale && scale > 0 )
+    {
+        double r0 = -q.q[3], r1 = -q.q[6], r2 = -q.q[8];
+        c.pos[0] = ( r0 * ( d * f - e * e ) - b * ( r1 * f - e * r2 ) + cc * ( r1 * e - d * r2 ) ) / det;
+        c.pos[1] = ( a * ( r1 * f - e * r2 ) - r0 * ( b * f - e * cc ) + cc * ( b * r2 - r1 * cc ) ) / det;
+        c.pos[2] = ( a * ( d * r2 - r1 * e ) - b * ( b * r2 - r1 * cc ) + r0 * ( b * e - d * cc ) ) / det;
+        c.cost = error( q, c.pos );
+    }
+    else
+    {
+        float mid[3] = { ( p0[0] + p1[0] ) * 0.5f, ( p0[1] + p1[1] ) * 0.5f, ( p0[2] + p1[2] ) * 0.5f };
+        const float* candidates[3] = { p0, p1, mid };
+        c.cost = std::numeric_limits<double>::max();
+        for ( int i = 0; i < 3; ++i )
+        {
+            double err = error( q, candidates[i] );
+            if ( err < c.cost )
+            {
+                c.cost = err;
+                c.pos[0] = candidates[i][0];
+                c.pos[1] = candidates[i][1];
+                c.pos[2] = candidates[i][2];
+            }
+        }
+    }
+    c.cost = qMax( 0.0, c.cost );
+    c.v0 = v0;
+    c.v1 = v1;
+    c.stamp0 = m_stamps[v0];
+    c.stamp1 = m_stamps[v1];
+    return true;
+}
+
+bool MeshDecimation::flips( unsigned int moved, unsigned int other, const float* pos )
+{
+    std::vector<unsigned int>& tris = m_vertTris[moved];
+    for ( unsigned int i = 0; i < tris.size(); ++i )
+    {
+        unsigned int t = tris[i];
+        if ( !m_triAlive[t] )
+        {
+            continue;
+        }
+        unsigned int* tri = &m_tris[t * 3];
+        if ( tri[0] == other || tri[1] == other || tri[2] == other )
+        {
+            continue;
+        }
+        const float* p[3];
+        float np[3][3];
+        for ( int k = 0; k < 3; ++k )
+        {
+            p[k] = &m_verts[tri[k] * 3];
+            const float* src = ( tri[k] == moved ) ? pos : p[k];
+            np[k][0] = src[0];
+            np[k][1] = src[1];
+            np[k][2] = src[2];
+        }
+        QVector3D n0 = QVector3D::crossProduct( QVector3D( p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] ),
+                                                QVector3D( p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] ) );
+        QVector3D n1 = QVector3D::crossProduct( QVector3D( np[1][0] - np[0][0], np[1][1] - np[0][1], np[1][2] - np[0][2] ),
+                                                QVector3D( np[2][0] - np[0][0], np[2][1] - np[0][1], np[2][2] - np[0][2] ) );
+        if ( QVector3D::dotProduct( n0, n1 ) <= 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshDecimation::ring( unsigned int v, std::vector<unsigned int>& out )
+{
+    out.clear();
+    std::vector<unsigned int>& tris = m_vertTris[v];
+    for ( unsigned int i = 0; i < tris.size(); ++i )
+    {
+        unsigned int t = tris[i];
+        if ( !m_triAlive[t] )
+        {
+            continue;
+        }
+        for ( int k = 0; k < 3; ++k )
+        {
+            if ( m_tris[t * 3 + k] != v )
+            {
+                out.push_back( m_tris[t * 3 + k] );
+            }
+        }
+    }
+    std::sort( out.begin(), out.end() );
+    out.erase( std::unique( out.begin(), out.end() ), out.end() );
+}
+
+bool MeshDecimation::linkCondition( unsigned int v0, unsigned int v1 )
+{
+    // the collapse keeps the mesh a manifold only if the vertices adjacent to both ends are exactly the
+    // tips of the triangles on the edge, any other shared neighbour would end up with a duplicate edge
+    ring( v0, m_ring0 );
+    ring( v1, m_ring1 );
+    m_shared.clear();
+    std::set_intersection( m_ring0.begin(), m_ring0.end(), m_ring1.begin(), m_ring1.end(), std::back_inserter( m_shared ) );
+
+    m_opposite.clear();
+    std::vector<unsigned int>& tris = m_vertTris[v0];
+    for ( unsigned int i = 0; i < tris.size(); ++i )
+    {
+        unsigned int t = tris[i];
+        if ( !m_triAlive[t] )
+        {
+            continue;
+        }
+        unsigned int* tri = &m_tris[t * 3];
+        if ( tri[0] == v1 || tri[1] == v1 || tri[2] == v1 )
+        {
+            for ( int k = 0; k < 3; ++k )
+            {
+                if ( tri[k] != v0 && tri[k] != v1 )
+                {
+                    m_opposite.push_back( tri[k] );
+                }
+            }
+        }
+    }
+    std::sort( m_opposite.begin(), m_opposite.end() );
+    m_opposite.erase( std::unique( m_opposite.begin(), m_opposite.end() ), m_opposite.end() );
+
+    return m_shared == m_opposite;
+}
+
+TriangleMesh2* MeshDecimation::simplify( unsigned int targetTris )
+{
+    // vertex stars in CSR layout
+    m_starOffsets.assign( m_numVerts + 1, 0 );
+    for ( unsigned int i = 0; i < m_numTris * 3; ++i )
+    {
+        ++m_starOffsets[m_tris[i] + 1];
+    }
+    for ( unsigned int v = 0; v < m_numVerts; ++v )
+    {
+        m_starOffsets[v + 1] += m_starOffsets[v];
+    }
+    m_stars.resize( m_numTris * 3 );
+    std::vector<unsigned int> cursor( m_starOffsets.begin(), m_starOffsets.end() - 1 );
+    for ( unsigned int i = 0; i < m_numTris * 3; ++i )
+    {
+        m_stars[cursor[m_tris[i]]++] = i / 3;
+    }
+
+    m_faceQuadrics.resize( m_numTris );
+    runPass( MeshDecimationThread::FACE_QUADRICS, m_numTris );
+    m_quadrics.resize( m_numVerts );
+    runPass( MeshDecimationThread::VERTEX_QUADRICS, m_numVerts );
+    m_faceQuadrics.clear();
+
+    // unique edges, boundary edges get a perpendicular constraint plane so holes keep their shape
+    std::vector<quint64> edges( m_numTris * 3 );
+    for ( unsigned int t = 0; t < m_numTris; ++t )
+    {
+        for ( unsigned int k = 0; k < 3; ++k )
+        {
+            quint64 a = m_tris[t * 3 + k];
+            quint64 b = m_tris[t * 3 + ( k + 1 ) % 3];
+            edges[t * 3 + k] = ( a < b ) ? ( ( a << 32 ) | b ) : ( ( b << 32 ) | a );
+        }
+    }
+    std::sort( edges.begin(), edges.end() );
+
+    std::vector<quint64> uniqueEdges;
+    uniqueEdges.reserve( edges.size() / 2 + 1 );
+    unsigned int i = 0;
+    while ( i < edges.size() )
+    {
+        unsigned int j = i + 1;
+        while ( j < edges.size() && edges[j] == edges[i] )
+        {
+            ++j;
+        }
+        uniqueEdges.push_back( edges[i] );
+        if ( j - i == 1 )
+        {
+            unsigned int a = edges[i] >> 32;
+            unsigned int b = edges[i] & 0xffffffff;
+            // find the face normal of the single adjacent triangle
+            for ( unsigned int k = m_starOffsets[a]; k < m_starOffsets[a + 1]; ++k )
+            {
+                unsigned int* tri = &m_tris[m_stars[k] * 3];
+                if ( tri[0] == b || tri[1] == b || tri[2] == b )
+                {
+                    const float* p0 = &m_verts[tri[0] * 3];
+                    const float* p1 = &m_verts[tri[1] * 3];
+                    const float* p2 = &m_verts[tri[2] * 3];
+                    QVector3D n = QVector3D::crossProduct( QVector3D( p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] ),
+                                                           QVector3D( p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] ) );
+                    QVector3D pa( m_verts[a * 3], m_verts[a * 3 + 1], m_verts[a * 3 + 2] );
+                    QVector3D pb( m_verts[b * 3], m_verts[b * 3 + 1], m_verts[b * 3 + 2] );
+                    QVector3D edge = pb - pa;
+                    QVector3D perp = QVector3D::crossProduct( edge, n ).normalized();
+                    double weight = 1000.0 * edge.lengthSquared();
+                    double d = -QVector3D::dotProduct( perp, pa );
+                    addPlane( m_quadrics[a], perp.x(), perp.y(), perp.z(), d, weight );
+                    addPlane( m_quadrics[b], perp.x(), perp.y(), perp.z(), d, weight );
+                    break;
+                }
+            }
+        }
+        i = j;
+    }
+    edges.clear();
+
+    m_vertTris.resize( m_numVerts );
+    for ( unsigned int v = 0; v < m_numVerts; ++v )
+    {
+        m_vertTris[v].assign( m_stars.begin() + m_starOffsets[v], m_stars.begin() + m_starOffsets[v + 1] );
+    }
+    m_stars.clear();
+    m_starOffsets.clear();
+
+    m_vertAlive.assign( m_numVerts, 1 );
+    m_triAlive.assign( m_numTris, 1 );
+    m_stamps.assign( m_numVerts, 0 );
+
+    std::priority_queue<Collapse> heap;
+    for ( unsigned int e = 0; e < uniqueEdges.size(); ++e )
+    {
+        Collapse c;
+        computeCollapse( uniqueEdges[e] >> 32, uniqueEdges[e] & 0xffffffff, c );
+        heap.push( c );
+    }
+    uniqueEdges.clear();
+
+    unsigned int liveTris = m_numTris;
+    std::vector<unsigned int> neighbors;
+
+    while ( liveTris > targetTris && !heap.empty() )
+    {
+        Collapse c = heap.top();
+        heap.pop();
+
+        if ( !m_vertAlive[c.v0] || !m_vertAlive[c.v1] || m_stamps[c.v0] != c.stamp0 || m_stamps[c.v1] != c.stamp1 )
+        {
+            // stale entry
+            continue;
+        }
+        if ( !linkCondition( c.v0, c.v1 ) || flips( c.v0, c.v1, c.pos ) || flips( c.v1, c.v0, c.pos ) )
+        {
+            continue;
+        }
+
+        // collapse v1 into v0
+        std::vector<unsigned int>& tris0 = m_vertTris[c.v0];
+        std::vector<unsigned int>& tris1 = m_vertTris[c.v1];
+        for ( unsigned int k = 0; k < tris1.size(); ++k )
+        {
+            unsigned int t = tris1[k];
+            if ( !m_triAlive[t] )
+            {
+                continue;
+            }
+            unsigned int* tri = &m_tris[t * 3];
+            if ( tri[0] == c.v0 || tri[1] == c.v0 || tri[2] == c.v0 )
+            {
+                m_triAlive[t] = 0;
+                --liveTris;
+            }
+            else
+            {
+                for ( int l = 0; l < 3; ++l )
+                {
+                    if ( tri[l] == c.v1 )
+                    {
+                        tri[l] = c.v0;
+                    }
+                }
+                tris0.push_back( t );
+            }
+        }
+        std::vector<unsigned int>().swap( tris1 );
+        m_vertAlive[c.v1] = 0;
+
+        m_verts[c.v0 * 3    ] = c.pos[0];
+        m_verts[c.v0 * 3 + 1] = c.pos[1];
+        m_verts[c.v0 * 3 + 2] = c.pos[2];
+        for ( int l = 0; l < 10; ++l )
+        {
+            m_quadrics[c.v0].q[l] += m_quadrics[c.v1].q[l];
+        }
+        ++m_stamps[c.v0];
+
+        // drop dead triangles from the star and requeue the edges around v0
+        neighbors.clear();
+        unsigned int live = 0;
+        for ( unsigned int k = 0; k < tris0.size(); ++k )
+        {
+            unsigned int t = tris0[k];
+            if ( !m_triAlive[t] )
+            {
+                continue;
+            }
+            tris0[live++] = t;
+            for ( int l = 0; l < 3; ++l )
+            {
+                if ( m_tris[t * 3 + l] != c.v0 )
+                {
+                    neighbors.push_back( m_tris[t * 3 + l] );
+                }
+            }
+        }
+        tris0.resize( live );
+        std::sort( neighbors.begin(), neighbors.end() );
+        neighbors.erase( std::unique( neighbors.begin(), neighbors.end() ), neighbors.end() );
+        for ( unsigned int k = 0; k < neighbors.size(); ++k )
+        {
+            Collapse nc;
+            computeCollapse( c.v0, neighbors[k], nc );
+            heap.push( nc );
+        }
+    }
+
+    // compact the result
+    std::vector<int> newIds( m_numVerts, -1 );
+    unsigned int numNewVerts = 0;
+    for ( unsigned int t = 0; t < m_numTris; ++t )
+    {
+        if ( !m_triAlive[t] )
+        {
+            continue;
+        }
+        for ( int l = 0; l < 3; ++l )
+        {
+            unsigned int v = m_tris[t * 3 + l];
+            if ( newIds[v] == -1 )
+            {
+                newIds[v] = numNewVerts++;
+            }
+        }
+    }
+
+    TriangleMesh2* newMesh = new TriangleMesh2( numNewVerts, liveTris );
+    for ( unsigned int v = 0; v < m_numVerts; ++v )
+    {
+        if ( newIds[v] != -1 )
+        {
+            newMesh->setVertex( newIds[v], m_verts[v * 3], m_verts[v * 3 + 1], m_verts[v * 3 + 2] );
+        }
+    }
+    unsigned int triInsertId = 0;
+    for ( unsigned int t = 0; t < m_numTris; ++t )
+    {
+        if ( m_triAlive[t] )
+        {
+            newMesh->setTriangle( triInsertId++, newIds[m_tris[t * 3]], newIds[m_tris[t * 3 + 1]], newIds[m_tris[t * 3 + 2]] );
+        }
+    }
+    newMesh->finalize();
+
+    m_quadrics.clear();
+    m_vertTris.clear();
+    m_vertAlive.clear();
+    m_triAlive.clear();
+    m_stamps.clear();
+
+    return newMesh;
+}
@@ -0,0 +1,95 @@
+/*
+ * meshdecimation.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef MESHDECIMATION_H_
+#define MESHDECIMATION_H_
+
+#include <QVector3D>
+
+#include <vector>
+
+class TriangleMesh2;
+class MeshDecimationThread;
+
+class MeshDecimation
+{
+    friend class MeshDecimationThread;
+
+public:
+    MeshDecimation( TriangleMesh2* mesh );
+    virtual ~MeshDecimation();
+
+    // vertex clustering on a regular grid with cell size epsilon
+    TriangleMesh2* cluster( float epsilon );
+
+    // quadric error metric edge collapse until at most targetTris triangles are left,
+    // works in place on the internal copy, so use a fresh object for each call
+    TriangleMesh2* simplify( unsigned int targetTris );
+
+private:
+    struct Quadric
+    {
+        double q[10];
+    };
+
+    struct Collapse
+    {
+        double cost;
+        unsigned int v0;
+        unsigned int v1;
+        unsigned int stamp0;
+        unsigned int stamp1;
+        float pos[3];
+        bool operator<( const Collapse& other ) const { return cost > other.cost; };
+    };
+
+    void runPass( int pass, unsigned int size );
+
+    void cellKeys( unsigned int begin, unsigned int end );
+    void centroids( unsigned int begin, unsigned int end );
+    void faceQuadrics( unsigned int begin, unsigned int end );
+    void vertexQuadrics( unsigned int begin, unsigned int end );
+
+    static void addPlane( Quadric& q, double a, double b, double c, double d, double weight );
+    static double error( const Quadric& q, const float* p );
+    bool computeCollapse( unsigned int v0, unsigned int v1, Collapse& c );
+    bool flips( unsigned int moved, unsigned int other, const float* pos );
+    void ring( unsigned int v, std::vector<unsigned int>& out );
+    bool linkCondition( unsigned int v0, unsigned int v1 );
+
+    TriangleMesh2* m_mesh;
+    unsigned int m_numVerts;
+    unsigned int m_numTris;
+
+    std::vector<float> m_verts;
+    std::vector<unsigned int> m_tris;
+
+    // clustering
+    float m_epsilon;
+    float m_min[3];
+    std::vector<quint64> m_cellKeys;
+    std::vector<unsigned int> m_sortedVerts;
+    std::vector<unsigned int> m_clusterOffsets;
+    std::vector<unsigned int> m_vertToCluster;
+    std::vector<float> m_clusterPos;
+
+    // quadric simplification
+    std::vector<Quadric> m_faceQuadrics;
+    std::vector<Quadric> m_quadrics;
+    std::vector<unsigned int> m_starOffsets;
+    std::vector<unsigned int> m_stars;
+    std::vector<std::vector<unsigned int> > m_vertTris;
+    std::vector<unsigned char> m_vertAlive;
+    std::vector<unsigned char> m_triAlive;
+    std::vector<unsigned int> m_stamps;
+    std::vector<unsigned int> m_ring0;
+    std::vector<unsigned int> m_ring1;
+    std::vector<unsigned int> m_shared;
+    std::vector<unsigned int> m_opposite;
+};
+
+#endif /* MESHDECIMATION_H_ */
@@ -0,0 +1,57 @@
+/*
+ * meshdecimationthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "meshdecimationthread.h"
+#include "meshdecimation.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+MeshDecimationThread::MeshDecimationThread( MeshDecimation* decimation, int pass, unsigned int size, int id ) :
+    m_decimation( decimation ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+MeshDecimationThread::~MeshDecimationThread()
+{
+}
+
+void MeshDecimationThread::run()
+{
+    TRACE_SCOPE( "MeshDecimationThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case CELL_KEYS:
+            m_decimation->cellKeys( begin, end );
+            break;
+        case CENTROIDS:
+            m_decimation->centroids( begin, end );
+            break;
+        case FACE_QUADRICS:
+            m_decimation->faceQuadrics( begin, end );
+            break;
+        case VERTEX_QUADRICS:
+            m_decimation->vertexQuadrics( begin, end );
+            break;
+    }
+}
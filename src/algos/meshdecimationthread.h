@@ -0,0 +1,38 @@
+/*
+ * meshdecimationthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef MESHDECIMATIONTHREAD_H_
+#define MESHDECIMATIONTHREAD_H_
+
+#include <QThread>
+
+class MeshDecimation;
+
+class MeshDecimationThread : public QThread
+{
+public:
+    enum Pass
+    {
+        CELL_KEYS,
+        CENTROIDS,
+        FACE_QUADRICS,
+        VERTEX_QUADRICS
+    };
+
+    MeshDecimationThread( MeshDecimation* decimation, int pass, unsigned int size, int id );
+    virtual ~MeshDecimationThread();
+
+private:
+    void run();
+
+    MeshDecimation* m_decimation;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* MESHDECIMATIONTHREAD_H_ */
@@ -0,0 +1,195 @@
+/*
+ * painthistory.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "painthistory.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+
+PaintHistory::PaintHistory( std::vector<float>* data, int nx, int ny, int nz, int brickSize, unsigned int maxSteps ) :
+    m_data( data ),
+    m_nx( nx ),
+    m_ny( ny ),
+    m_nz( nz ),
+    m_brickSize( qMax( 1, brickSize ) ),
+    m_maxSteps( qMax( 1u, maxSteps ) ),
+    m_current( 0 ),
+    m_dirty( false )
+{
+    m_bx = ( m_nx + m_brickSize - 1 ) / m_brickSize;
+    m_by = ( m_ny + m_brickSize - 1 ) / m_brickSize;
+    m_bz = ( m_nz + m_brickSize - 1 ) / m_brickSize;
+    m_inStroke.resize( m_bx * m_by * m_bz, false );
+}
+
+PaintHistory::~PaintHistory()
+{
+}
+
+void PaintHistory::touch( int x, int y, int z )
+{
+    if ( x < 0 || x >= m_nx || y < 0 || y >= m_ny || z < 0 || z >= m_nz )
+    {
+        return;
+    }
+
+    unsigned int id = x / m_brickSize + ( y / m_brickSize ) * m_bx + ( z / m_brickSize ) * m_bx * m_by;
+    if ( !m_inStroke[id] )
+    {
+        m_inStroke[id] = true;
+
+        int min[3];
+        int max[3];
+        brickBox( id, min, max );
+
+        m_stroke.push_back( Brick() );
+        Brick& brick = m_stroke.back();
+        brick.id = id;
+        brick.data.reserve( ( max[0] - min[0] + 1 ) * ( max[1] - min[1] + 1 ) * ( max[2] - min[2] + 1 ) );
+        for ( int k = min[2]; k <= max[2]; ++k )
+        {
+            for ( int j = min[1]; j <= max[1]; ++j )
+            {
+                const float* row = &( *m_data )[min[0] + j * m_nx + k * m_nx * m_ny];
+                brick.data.insert( brick.data.end(), row, row + max[0] - min[0] + 1 );
+            }
+        }
+    }
+
+    int voxel[3] = { x, y, z };
+    addDirty( voxel, voxel );
+}
+
+void PaintHistory::endStroke()
+{
+    if ( m_stroke.empty() )
+    {
+        return;
+    }
+    for ( unsigned int i = 0; i < m_stroke.size(); ++i )
+    {
+        m_inStroke[m_stroke[i].id] = false;
+    }
+
+    // a new stroke drops everything that could have been redone
+    m_steps.resize( m_current );
+    m_steps.push_back( std::vector<Brick>() );
+    m_steps.back().swap( m_stroke );
+    if ( m_steps.size() > m_maxSteps )
+    {
+        m_steps.pop_front();
+    }
+    m_current = m_steps.size();
+}
+
+bool PaintHistory::undo()
+{
+    endStroke();
+    if ( m_current == 0 )
+    {
+        return false;
+    }
+    --m_current;
+    std::vector<Brick>& step = m_steps[m_current];
+    for ( unsigned int i = 0; i < step.size(); ++i )
+    {
+        swapBrick( step[i] );
+    }
+    return true;
+}
+
+bool PaintHistory::redo()
+{
+    endStroke();
+    if ( m_current == m_steps.size() )
+    {
+        return false;
+    }
+    std::vector<Brick>& step = m_steps[m_current];
+    for ( unsigned int i = 0; i < step.size(); ++i )
+    {
+        swapBrick( step[i] );
+    }
+    ++m_current;
+    return true;
+}
+
+void PaintHistory::clear()
+{
+    for ( unsigned int i = 0; i < m_stroke.size(); ++i )
+    {
+        m_inStroke[m_stroke[i].id] = false;
+    }
+    m_stroke.clear();
+    m_steps.clear();
+    m_current = 0;
+}
+
+bool PaintHistory::takeDirty( int* min, int* max )
+{
+    if ( !m_dirty )
+    {
+        return false;
+    }
+    for ( int i = 0; i < 3; ++i )
+    {
+        min[i] = m_dirtyMin[i];
+        max[i] = m_dirtyMax[i];
+    }
+    m_dirty = false;
+    return true;
+}
+
+void PaintHistory::brickBox( unsigned int id, int* min, int* max )
+{
+    int b[3] = { static_cast<int>( id % m_bx ), static_cast<int>( ( id / m_bx ) % m_by ), static_cast<int>( id / ( m_bx * m_by ) ) };
+    int n[3] = { m_nx, m_ny, m_nz };
+    for ( int i = 0; i < 3; ++i )
+    {
+        min[i] = b[i] * m_brickSize;
+        max[i] = qMin( n[i], min[i] + m_brickSize ) - 1;
+    }
+}
+
+void PaintHistory::swapBrick( Brick& brick )
+{
+    int min[3];
+    int max[3];
+    brickBox( brick.id, min, max );
+
+    // the saved voxels go in, the current ones are kept for the way back
+    unsigned int pos = 0;
+    for ( int k = min[2]; k <= max[2]; ++k )
+    {
+        for ( int j = min[1]; j <= max[1]; ++j )
+        {
+            float* row = &( *m_data )[min[0] + j * m_nx + k * m_nx * m_ny];
+            for ( int i = 0; i <= max[0] - min[0]; ++i )
+            {
+                std::swap( row[i], brick.data[pos++] );
+            }
+        }
+    }
+    addDirty( min, max );
+}
+
+void PaintHistory::addDirty( const int* min, const int* max )
+{
+    for ( int i = 0; i < 3; ++i )
+    {
+        if ( !m_dirty || min[i] < m_dirtyMin[i] )
+        {
+            m_dirtyMin[i] = min[i];
+        }
+        if ( !m_dirty || max[i] > m_dirtyMax[i] )
+        {
+            m_dirtyMax[i] = max[i];
+        }
+    }
+    m_dirty = true;
+}
@@ -0,0 +1,70 @@
+/*
+ * painthistory.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef PAINTHISTORY_H_
+#define PAINTHISTORY_H_
+
+#include <deque>
+#include <vector>
+
+/*
+ * Undo, redo and change tracking for painting into a volume. The volume is split into bricks, the first
+ * change to a brick during a stroke saves a copy of it, so a step costs memory in proportion to the
+ * brush and not to the volume. Undo and redo swap the saved bricks with the current voxels. All changed
+ * voxels are collected in a dirty box which tells the texture what it has to upload.
+ */
+class PaintHistory
+{
+public:
+    PaintHistory( std::vector<float>* data, int nx, int ny, int nz, int brickSize = 16, unsigned int maxSteps = 32 );
+    virtual ~PaintHistory();
+
+    // call before the voxel changes
+    void touch( int x, int y, int z );
+    void endStroke();
+
+    bool undo();
+    bool redo();
+    void clear();
+
+    // inclusive bounds of all voxels changed since the last call, false if there are none
+    bool takeDirty( int* min, int* max );
+
+private:
+    struct Brick
+    {
+        unsigned int id;
+        std::vector<float> data;
+    };
+
+    void brickBox( unsigned int id, int* min, int* max );
+    void swapBrick( Brick& brick );
+    void addDirty( const int* min, const int* max );
+
+    std::vector<float>* m_data;
+    int m_nx;
+    int m_ny;
+    int m_nz;
+    int m_brickSize;
+    int m_bx;
+    int m_by;
+    int m_bz;
+    unsigned int m_maxSteps;
+
+    // steps before m_current can be undone, the ones from m_current on redone
+    std::deque<std::vector<Brick> > m_steps;
+    unsigned int m_current;
+
+    std::vector<Brick> m_stroke;
+    std::vector<bool> m_inStroke;
+
+    bool m_dirty;
+    int m_dirtyMin[3];
+    int m_dirtyMax[3];
+};
+
+#endif /* PAINTHISTORY_H_ */
@@ -0,0 +1,579 @@
+/*
+ * probtrack.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "probtrack.h"
+#include "probtrackthread.h"
+
+#include "counterrng.h"
+#include "fmath.h"
+#include "trace.h"
+
+#include "../data/mesh/tesselation.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // samples per batch and per chunk a thread takes at once
+    const unsigned int BATCH_SIZE = 16384;
+    const unsigned int CHUNK_SIZE = 16;
+
+    // tries to find a tensor direction inside the angle limit before the sample stops
+    const int MAX_TRIES = 16;
+}
+
+ProbTrack::ProbTrack( int nx, int ny, int nz, float dx, float dy, float dz ) :
+    m_nx( nx ),
+    m_ny( ny ),
+    m_nz( nz ),
+    m_dx( dx ),
+    m_dy( dy ),
+    m_dz( dz ),
+    m_numCoeffs( 0 ),
+    m_seed( 0 ),
+    m_samplesPerSeed( 1 ),
+    m_fiberSamples( 1 ),
+    m_stepSize( 0.5f * qMin( dx, qMin( dy, dz ) ) ),
+    m_cosMaxAngle( cos( 45.0 * M_PI / 180.0 ) ),
+    m_minAnisotropy( 0.2f ),
+    m_minStartAnisotropy( 0.2f ),
+    m_minLength( 10.0f ),
+    m_maxLength( 250.0f ),
+    m_sharpness( 1 ),
+    m_withDensity( true ),
+    m_sink( 0 ),
+    m_batchBegin( 0 ),
+    m_batchSize( 0 ),
+    m_next( 0 ),
+    m_numSamples( 0 )
+{
+    m_blockSize = nx * ny * nz;
+}
+
+ProbTrack::~ProbTrack()
+{
+}
+
+void ProbTrack::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<ProbTrackThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new ProbTrackThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+void ProbTrack::setTensors( std::vector<Matrix>& tensors )
+{
+    m_coeffs.clear();
+    m_numCoeffs = 0;
+    m_tensors.assign( tensors.size() * 6, 0.0f );
+    m_anisotropy.assign( tensors.size(), 0.0f );
+
+    for ( unsigned int i = 0; i < tensors.size(); ++i )
+    {
+        Matrix& t = tensors[i];
+        float xx = t( 1, 1 );
+        float xy = t( 1, 2 );
+        float xz = t( 1, 3 );
+        float yy = t( 2, 2 );
+        float yz = t( 2, 3 );
+        float zz = t( 3, 3 );
+        float trace = xx + yy + zz;
+        if ( !( trace > 0 ) )
+        {
+            continue;
+        }
+        float* out = &m_tensors[i * 6];
+        out[0] = xx / trace;
+        out[1] = xy / trace;
+        out[2] = xz / trace;
+        out[3] = yy / trace;
+        out[4] = yz / trace;
+        out[5] = zz / trace;
+
+        // fa from the frobenius norms of the tensor and its anisotropic part, no eigen decomposition needed
+        float mean = trace / 3.0f;
+        float norm = xx * xx + yy * yy + zz * zz + 2.0f * ( xy * xy + xz * xz + yz * yz );
+        float aniso = ( xx - mean ) * ( xx - mean ) + ( yy - mean ) * ( yy - mean ) + ( zz - mean ) * ( zz - mean )
+                    + 2.0f * ( xy * xy + xz * xz + yz * yz );
+        m_anisotropy[i] = qMin( 1.0f, static_cast<float>( sqrt( 1.5f * aniso / norm ) ) );
+    }
+}
+
+void ProbTrack::setSH( std::vector<ColumnVector>& coefficients )
+{
+    m_tensors.clear();
+    m_numCoeffs = coefficients.empty() ? 0 : coefficients[0].Nrows();
+    int order = ( -3 + static_cast<int>( sqrt( 8 * m_numCoeffs + 1 ) ) ) / 2;
+
+    const Matrix* vertices = tess::vertices( 3 );
+    Matrix base = FMath::sh_base( *vertices, order );
+    int numDirs = vertices->Nrows();
+    m_sphere.resize( numDirs * 3 );
+    m_base.resize( numDirs * m_numCoeffs );
+    for ( int i = 0; i < numDirs; ++i )
+    {
+        for ( int k = 0; k < 3; ++k )
+        {
+            m_sphere[i * 3 + k] = ( *vertices )( i + 1, k + 1 );
+        }
+        for ( int j = 0; j < m_numCoeffs; ++j )
+        {
+            m_base[i * m_numCoeffs + j] = base( i + 1, j + 1 );
+        }
+    }
+
+    m_coeffs.assign( coefficients.size() * m_numCoeffs, 0.0f );
+    m_anisotropy.assign( coefficients.size(), 0.0f );
+    for ( unsigned int i = 0; i < coefficients.size(); ++i )
+    {
+        if ( coefficients[i].Nrows() != m_numCoeffs )
+        {
+            continue;
+        }
+        float sum = 0;
+        for ( int j = 0; j < m_numCoeffs; ++j )
+        {
+            float c = coefficients[i]( j + 1 );
+            m_coeffs[i * m_numCoeffs + j] = c;
+            sum += c * c;
+        }
+        // generalized fa straight from the coefficients of the orthonormal basis
+        if ( sum > 0 )
+        {
+            float c0 = m_coeffs[i * m_numCoeffs];
+            m_anisotropy[i] = sqrt( qMax( 0.0f, 1.0f - c0 * c0 / sum ) );
+        }
+    }
+}
+
+void ProbTrack::setSeed( quint64 seed )
+{
+    m_seed = seed;
+}
+
+void ProbTrack::setSamplesPerSeed( unsigned int samples )
+{
+    m_samplesPerSeed = qMax( 1u, samples );
+}
+
+void ProbTrack::setFiberSamples( unsigned int samples )
+{
+    m_fiberSamples = samples;
+}
+
+void ProbTrack::setStepSize( float stepSize )
+{
+    m_stepSize = stepSize;
+}
+
+void ProbTrack::setMaxAngle( float degrees )
+{
+    m_cosMaxAngle = cos( degrees * M_PI / 180.0 );
+}
+
+void ProbTrack::setMinAnisotropy( float min, float minStart )
+{
+    m_minAnisotropy = min;
+    m_minStartAnisotropy = minStart;
+}
+
+void ProbTrack::setMinLength( float minLength )
+{
+    m_minLength = minLength;
+}
+
+void ProbTrack::setMaxLength( float maxLength )
+{
+    m_maxLength = maxLength;
+}
+
+void ProbTrack::setSharpness( int sharpness )
+{
+    m_sharpness = qMax( 1, sharpness );
+}
+
+void ProbTrack::setDensity( bool density )
+{
+    m_withDensity = density;
+}
+
+void ProbTrack::setSink( Sink* sink )
+{
+    m_sink = sink;
+}
+
+std::vector<Fib>* ProbTrack::fibs()
+{
+    return &m_fibs;
+}
+
+std::vector<float>* ProbTrack::density()
+{
+    return &m_density;
+}
+
+std::vector<float>* ProbTrack::anisotropy()
+{
+    return &m_anisotropy;
+}
+
+quint64 ProbTrack::numSamples()
+{
+    return m_numSamples;
+}
+
+void ProbTrack::run( std::vector<int> seeds )
+{
+    m_fibs.clear();
+    m_density.clear();
+    m_numSamples = 0;
+    if ( (int)m_anisotropy.size() != m_blockSize || m_stepSize <= 0 )
+    {
+        return;
+    }
+
+    m_seeds.swap( seeds );
+    if ( m_seeds.empty() )
+    {
+        for ( int i = 0; i < m_blockSize; ++i )
+        {
+            if ( m_anisotropy[i] >= m_minStartAnisotropy )
+            {
+                m_seeds.push_back( i );
+            }
+        }
+    }
+    m_numSamples = static_cast<quint64>( m_seeds.size() ) * m_samplesPerSeed;
+
+    if ( m_withDensity )
+    {
+        m_visits.assign( GLFunctions::idealThreadCount, std::vector<quint32>( m_blockSize, 0 ) );
+    }
+
+    for ( m_batchBegin = 0; m_batchBegin < m_numSamples; m_batchBegin += m_batchSize )
+    {
+        m_batchSize = static_cast<unsigned int>( qMin( static_cast<quint64>( BATCH_SIZE ), m_numSamples - m_batchBegin ) );
+        m_next.store( 0 );
+        m_batch.clear();
+        if ( m_fiberSamples > 0 )
+        {
+            m_batch.resize( m_batchSize );
+        }
+
+        runPass( ProbTrackThread::TRACK, m_batchSize );
+
+        std::vector<Fib> kept;
+        std::vector<Fib>& out = m_sink ? kept : m_fibs;
+        for ( unsigned int i = 0; i < m_batch.size(); ++i )
+        {
+            if ( m_batch[i].length() > 0 )
+            {
+                out.push_back( m_batch[i] );
+            }
+        }
+        if ( m_sink && !kept.empty() )
+        {
+            m_sink->fibers( kept );
+        }
+        if ( m_sink )
+        {
+            m_sink->batchDone( m_batchBegin + m_batchSize, m_numSamples );
+        }
+        TRACE_COUNTER( "probtrack samples", m_batchBegin + m_batchSize );
+    }
+    std::vector<Fib>().swap( m_batch );
+    std::vector<int>().swap( m_seeds );
+
+    if ( m_withDensity )
+    {
+        m_density.resize( m_blockSize );
+        runPass( ProbTrackThread::REDUCE, m_blockSize );
+        std::vector<std::vector<quint32> >().swap( m_visits );
+    }
+}
+
+void ProbTrack::trackBatch( int thread )
+{
+    Scratch scratch;
+    std::vector<quint32>* visits = m_withDensity ? &m_visits[thread] : 0;
+
+    while ( true )
+    {
+        unsigned int begin = m_next.fetchAndAddOrdered( CHUNK_SIZE );
+        if ( begin >= m_batchSize )
+        {
+            break;
+        }
+        unsigned int end = qMin( begin + CHUNK_SIZE, m_batchSize );
+
+        for ( unsigned int i = begin; i < end; ++i )
+        {
+            quint64 sample = m_batchBegin + i;
+            int seed = m_seeds[sample / m_samplesPerSeed];
+            CounterRng rng( m_seed, sample );
+
+            // start anywhere inside the seed voxel
+            float pos[3];
+            pos[0] = ( seed % m_nx + rng.uniform() - 0.5f ) * m_dx;
+            pos[1] = ( ( seed / m_nx ) % m_ny + rng.uniform() - 0.5f ) * m_dy;
+            pos[2] = ( seed / ( m_nx * m_ny ) + rng.uniform() - 0.5f ) * m_dz;
+
+            float dir[3];
+            if ( !sampleDirection( seed, 0, rng, scratch, dir ) )
+            {
+                continue;
+            }
+            trace( pos, dir, rng, scratch, scratch.forward );
+            dir[0] = -dir[0];
+            dir[1] = -dir[1];
+            dir[2] = -dir[2];
+            trace( pos, dir, rng, scratch, scratch.backward );
+
+            unsigned int numPoints = ( scratch.forward.size() + scratch.backward.size() ) / 4;
+            if ( numPoints * m_stepSize < m_minLength )
+            {
+                continue;
+            }
+
+            if ( visits )
+            {
+                // every sample counts once per voxel
+                scratch.visited.clear();
+                scratch.visited.push_back( seed );
+                for ( int k = 0; k < 2; ++k )
+                {
+                    std::vector<float>& points = ( k == 0 ) ? scratch.forward : scratch.backward;
+                    for ( unsigned int p = 0; p < points.size(); p += 4 )
+                    {
+                        int x = qBound( 0, static_cast<int>( floor( points[p] / m_dx + 0.5f ) ), m_nx - 1 );
+                        int y = qBound( 0, static_cast<int>( floor( points[p + 1] / m_dy + 0.5f ) ), m_ny - 1 );
+                        int z = qBound( 0, static_cast<int>( floor( points[p + 2] / m_dz + 0.5f ) ), m_nz - 1 );
+                        scratch.visited.push_back( x + m_nx * ( y + m_ny * z ) );
+                    }
+                }
+                std::sort( scratch.visited.begin(), scratch.visited.end() );
+                std::vector<int>::iterator last = std::unique( scratch.visited.begin(), scratch.visited.end() );
+                for ( std::vector<int>::iterator it = scratch.visited.begin(); it != last; ++it )
+                {
+                    ++( *visits )[*it];
+                }
+            }
+
+            if ( sample % m_samplesPerSeed < m_fiberSamples )
+            {
+                makeFib( pos, m_anisotropy[seed], scratch, m_batch[i] );
+            }
+        }
+    }
+}
+
+void ProbTrack::reduce( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        quint32 sum = 0;
+        for ( unsigned int t = 0; t < m_visits.size(); ++t )
+        {
+            sum += m_visits[t][i];
+        }
+        m_density[i] = sum;
+    }
+}
+
+void ProbTrack::trace( const float* start, const float* direction, CounterRng& rng, Scratch& scratch, std::vector<float>& out )
+{
+    out.clear();
+    float pos[3] = { start[0], start[1], start[2] };
+    float dir[3] = { direction[0], direction[1], direction[2] };
+    int maxSteps = static_cast<int>( m_maxLength / m_stepSize );
+
+    for ( int step = 0; step < maxSteps; ++step )
+    {
+        pos[0] += dir[0] * m_stepSize;
+        pos[1] += dir[1] * m_stepSize;
+        pos[2] += dir[2] * m_stepSize;
+
+        int voxel = sampleVoxel( pos, rng );
+        if ( voxel < 0 || m_anisotropy[voxel] < m_minAnisotropy )
+        {
+            break;
+        }
+        out.push_back( pos[0] );
+        out.push_back( pos[1] );
+        out.push_back( pos[2] );
+        out.push_back( m_anisotropy[voxel] );
+
+        float next[3];
+        if ( !sampleDirection( voxel, dir, rng, scratch, next ) )
+        {
+            break;
+        }
+        dir[0] = next[0];
+        dir[1] = next[1];
+        dir[2] = next[2];
+    }
+}
+
+int ProbTrack::sampleVoxel( const float* pos, CounterRng& rng )
+{
+    // voxel centers are on the grid points, a neighbour is picked with its trilinear weight
+    float x = pos[0] / m_dx;
+    float y = pos[1] / m_dy;
+    float z = pos[2] / m_dz;
+    if ( !( x >= -0.5f && x < m_nx - 0.5f && y >= -0.5f && y < m_ny - 0.5f && z >= -0.5f && z < m_nz - 0.5f ) )
+    {
+        return -1;
+    }
+    int ix = qBound( 0, static_cast<int>( floor( x + rng.uniform() ) ), m_nx - 1 );
+    int iy = qBound( 0, static_cast<int>( floor( y + rng.uniform() ) ), m_ny - 1 );
+    int iz = qBound( 0, static_cast<int>( floor( z + rng.uniform() ) ), m_nz - 1 );
+    return ix + m_nx * ( iy + m_ny * iz );
+}
+
+bool ProbTrack::sampleDirection( int voxel, const float* previous, CounterRng& rng, Scratch& scratch, float* out )
+{
+    if ( !m_tensors.empty() )
+    {
+        const float* t = &m_tensors[voxel * 6];
+        for ( int i = 0; i < MAX_TRIES; ++i )
+        {
+            float v[3] = { rng.normal(), rng.normal(), rng.normal() };
+            for ( int k = 0; k < m_sharpness; ++k )
+            {
+                float x = t[0] * v[0] + t[1] * v[1] + t[2] * v[2];
+                float y = t[1] * v[0] + t[3] * v[1] + t[4] * v[2];
+                float z = t[2] * v[0] + t[4] * v[1] + t[5] * v[2];
+                v[0] = x;
+                v[1] = y;
+                v[2] = z;
+            }
+            float norm = sqrt( v[0] * v[0] + v[1] * v[1] + v[2] * v[2] );
+            if ( !( norm > 0 ) )
+            {
+                return false;
+            }
+            v[0] /= norm;
+            v[1] /= norm;
+            v[2] /= norm;
+            if ( previous )
+            {
+                float dot = v[0] * previous[0] + v[1] * previous[1] + v[2] * previous[2];
+                if ( dot < 0 )
+                {
+                    v[0] = -v[0];
+                    v[1] = -v[1];
+                    v[2] = -v[2];
+                    dot = -dot;
+                }
+                if ( dot < m_cosMaxAngle )
+                {
+                    continue;
+                }
+            }
+            out[0] = v[0];
+            out[1] = v[1];
+            out[2] = v[2];
+            return true;
+        }
+        return false;
+    }
+
+    if ( m_numCoeffs == 0 )
+    {
+        return false;
+    }
+
+    // odf on the sphere directions inside the angle limit, weighted by its amplitude
+    const float* c = &m_coeffs[voxel * m_numCoeffs];
+    int numDirs = m_sphere.size() / 3;
+    scratch.candidates.clear();
+    scratch.weights.clear();
+    float total = 0;
+    for ( int i = 0; i < numDirs; ++i )
+    {
+        const float* d = &m_sphere[i * 3];
+        if ( previous && d[0] * previous[0] + d[1] * previous[1] + d[2] * previous[2] < m_cosMaxAngle )
+        {
+            continue;
+        }
+        const float* b = &m_base[i * m_numCoeffs];
+        float value = 0;
+        for ( int j = 0; j < m_numCoeffs; ++j )
+        {
+            value += b[j] * c[j];
+        }
+        if ( !( value > 0 ) )
+        {
+            continue;
+        }
+        float weight = value;
+        for ( int k = 1; k < m_sharpness; ++k )
+        {
+            weight *= value;
+        }
+        total += weight;
+        scratch.candidates.push_back( i );
+        scratch.weights.push_back( total );
+    }
+    if ( scratch.candidates.empty() )
+    {
+        return false;
+    }
+
+    float r = rng.uniform() * total;
+    unsigned int pick = std::upper_bound( scratch.weights.begin(), scratch.weights.end(), r ) - scratch.weights.begin();
+    pick = qMin( pick, static_cast<unsigned int>( scratch.candidates.size() - 1 ) );
+    const float* d = &m_sphere[scratch.candidates[pick] * 3];
+    out[0] = d[0];
+    out[1] = d[1];
+    out[2] = d[2];
+    return true;
+}
+
+void ProbTrack::makeFib( const float* seed, float anisotropy, const Scratch& scratch, Fib& fib )
+{
+    unsigned int numBackward = scratch.backward.size() / 4;
+    unsigned int numForward = scratch.forward.size() / 4;
+    std::vector<QVector3D> verts;
+    std::vector<float> data;
+    verts.reserve( numBackward + numForward + 1 );
+    data.reserve( numBackward + numForward + 1 );
+
+    for ( unsigned int i = numBackward; i > 0; --i )
+    {
+        const float* p = &scratch.backward[( i - 1 ) * 4];
+        verts.push_back( QVector3D( p[0], p[1], p[2] ) );
+        data.push_back( p[3] );
+    }
+    verts.push_back( QVector3D( seed[0], seed[1], seed[2] ) );
+    data.push_back( anisotropy );
+    for ( unsigned int i = 0; i < numForward; ++i )
+    {
+        const float* p = &scratch.forward[i * 4];
+        verts.push_back( QVector3D( p[0], p[1], p[2] ) );
+        data.push_back( p[3] );
+    }
+
+    fib = Fib( verts );
+    fib.setDataField( 0, data );
+}
@@ -0,0 +1,138 @@
+/*
+ * probtrack.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef PROBTRACK_H_
+#define PROBTRACK_H_
+
+#include "fib.h"
+
+#include "../thirdparty/newmat10/newmat.h"
+
+#include <QAtomicInt>
+
+#include <vector>
+
+class CounterRng;
+class ProbTrackThread;
+
+/*
+ * Probabilistic streamline tracking. Every step draws the next direction from the voxel's tensor
+ * (a normal vector mapped through the tensor raised to the sharpness) or from its odf sampled on a
+ * sphere, the voxel itself is drawn with trilinear weights around the current position. Each sample
+ * has its own counter based random stream keyed by seed and sample number, so fibers and visitation
+ * counts are bit identical for any number of threads. Samples are tracked in batches, fibers of a
+ * batch go to the sink or into fibs() in sample order, visits are counted per thread and summed at
+ * the end, so memory doesn't grow with the number of samples unless fibers are kept.
+ */
+class ProbTrack
+{
+    friend class ProbTrackThread;
+
+public:
+    // receives the fibers of every batch, in sample order, and the number of samples tracked so far
+    class Sink
+    {
+    public:
+        virtual ~Sink() {};
+        virtual void fibers( std::vector<Fib>& fibs ) = 0;
+        virtual void batchDone( quint64 samples, quint64 numSamples ) {};
+    };
+
+    ProbTrack( int nx, int ny, int nz, float dx, float dy, float dz );
+    virtual ~ProbTrack();
+
+    // direction model, fa or gfa is the anisotropy for seeding and stopping
+    void setTensors( std::vector<Matrix>& tensors );
+    void setSH( std::vector<ColumnVector>& coefficients );
+
+    void setSeed( quint64 seed );
+    void setSamplesPerSeed( unsigned int samples );
+    // the first samples of every seed are kept as fibers, all samples are counted in the density
+    void setFiberSamples( unsigned int samples );
+    void setStepSize( float stepSize );
+    void setMaxAngle( float degrees );
+    void setMinAnisotropy( float min, float minStart );
+    void setMinLength( float minLength );
+    void setMaxLength( float maxLength );
+    void setSharpness( int sharpness );
+    void setDensity( bool density );
+    void setSink( Sink* sink );
+
+    // seeds are voxel ids, none means every voxel above the start anisotropy
+    void run( std::vector<int> seeds = std::vector<int>() );
+
+    std::vector<Fib>* fibs();
+    // number of samples that visited each voxel
+    std::vector<float>* density();
+    std::vector<float>* anisotropy();
+    quint64 numSamples();
+
+private:
+    // per thread buffers, points are x, y, z, anisotropy
+    struct Scratch
+    {
+        std::vector<float> forward;
+        std::vector<float> backward;
+        std::vector<float> weights;
+        std::vector<int> candidates;
+        std::vector<int> visited;
+    };
+
+    void runPass( int pass, unsigned int size );
+
+    void trackBatch( int thread );
+    void reduce( unsigned int begin, unsigned int end );
+
+    void trace( const float* start, const float* direction, CounterRng& rng, Scratch& scratch, std::vector<float>& out );
+    int sampleVoxel( const float* pos, CounterRng& rng );
+    bool sampleDirection( int voxel, const float* previous, CounterRng& rng, Scratch& scratch, float* out );
+    void makeFib( const float* seed, float anisotropy, const Scratch& scratch, Fib& fib );
+
+    int m_nx;
+    int m_ny;
+    int m_nz;
+    float m_dx;
+    float m_dy;
+    float m_dz;
+    int m_blockSize;
+
+    // tensors divided by their trace, xx xy xz yy yz zz per voxel
+    std::vector<float> m_tensors;
+    // sh coefficients per voxel, the basis evaluated on the sphere directions
+    int m_numCoeffs;
+    std::vector<float> m_coeffs;
+    std::vector<float> m_sphere;
+    std::vector<float> m_base;
+    std::vector<float> m_anisotropy;
+
+    quint64 m_seed;
+    unsigned int m_samplesPerSeed;
+    unsigned int m_fiberSamples;
+    float m_stepSize;
+    float m_cosMaxAngle;
+    float m_minAnisotropy;
+    float m_minStartAnisotropy;
+    float m_minLength;
+    float m_maxLength;
+    int m_sharpness;
+    bool m_withDensity;
+    Sink* m_sink;
+
+    // current batch, threads take chunks of samples from m_next on
+    std::vector<int> m_seeds;
+    quint64 m_batchBegin;
+    unsigned int m_batchSize;
+    QAtomicInt m_next;
+    std::vector<Fib> m_batch;
+    std::vector<std::vector<quint32> > m_visits;
+
+    std::vector<Fib> m_fibs;
+    std::vector<float> m_density;
+    quint64 m_numSamples;
+};
+
+#endif /* PROBTRACK_H_ */
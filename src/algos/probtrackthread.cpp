@@ -0,0 +1,52 @@
+/*
+ * probtrackthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "probtrackthread.h"
+#include "probtrack.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+ProbTrackThread::ProbTrackThread( ProbTrack* track, int pass, unsigned int size, int id ) :
+    m_track( track ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+ProbTrackThread::~ProbTrackThread()
+{
+}
+
+void ProbTrackThread::run()
+{
+    TRACE_SCOPE( "ProbTrackThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case TRACK:
+            // samples differ a lot in length, so they are handed out in chunks instead of ranges
+            m_track->trackBatch( m_id );
+            break;
+        case REDUCE:
+            m_track->reduce( begin, end );
+            break;
+    }
+}
@@ -0,0 +1,36 @@
+/*
+ * probtrackthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef PROBTRACKTHREAD_H_
+#define PROBTRACKTHREAD_H_
+
+#include <QThread>
+
+class ProbTrack;
+
+class ProbTrackThread : public QThread
+{
+public:
+    enum Pass
+    {
+        TRACK,
+        REDUCE
+    };
+
+    ProbTrackThread( ProbTrack* track, int pass, unsigned int size, int id );
+    virtual ~ProbTrackThread();
+
+private:
+    void run();
+
+    ProbTrack* m_track;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* PROBTRACKTHREAD_H_ */
@@ -0,0 +1,44 @@
+/*
+ * probtrackworker.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "probtrackworker.h"
+
+#include <QDebug>
+
+ProbTrackWorker::ProbTrackWorker( ProbTrack* tracker ) :
+    m_tracker( tracker )
+{
+}
+
+ProbTrackWorker::~ProbTrackWorker()
+{
+    wait();
+}
+
+void ProbTrackWorker::run()
+{
+    m_fibs.clear();
+    m_tracker->setSink( this );
+    m_tracker->run();
+    m_tracker->setSink( 0 );
+    qDebug() << "probabilistic tracking:" << m_tracker->numSamples() << "samples," << m_fibs.size() << "fibers";
+}
+
+void ProbTrackWorker::fibers( std::vector<Fib>& fibs )
+{
+    m_fibs.insert( m_fibs.end(), fibs.begin(), fibs.end() );
+}
+
+void ProbTrackWorker::batchDone( quint64 samples, quint64 numSamples )
+{
+    emit( progress( static_cast<int>( 100 * samples / numSamples ) ) );
+}
+
+std::vector<Fib>* ProbTrackWorker::getFibs()
+{
+    return &m_fibs;
+}
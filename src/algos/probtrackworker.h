@@ -0,0 +1,44 @@
+/*
+ * probtrackworker.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef PROBTRACKWORKER_H_
+#define PROBTRACKWORKER_H_
+
+#include "probtrack.h"
+
+#include <QThread>
+
+#include <vector>
+
+/*
+ * Runs a probabilistic tracking off the gui thread. The worker is the sink of the tracker, it collects
+ * the fibers of every batch and reports the share of samples done after each one.
+ */
+class ProbTrackWorker : public QThread, public ProbTrack::Sink
+{
+    Q_OBJECT
+
+public:
+    ProbTrackWorker( ProbTrack* tracker );
+    virtual ~ProbTrackWorker();
+
+    void fibers( std::vector<Fib>& fibs );
+    void batchDone( quint64 samples, quint64 numSamples );
+
+    std::vector<Fib>* getFibs();
+
+private:
+    void run();
+
+    ProbTrack* m_tracker;
+    std::vector<Fib> m_fibs;
+
+signals:
+    void progress( int percent );
+};
+
+#endif /* PROBTRACKWORKER_H_ */
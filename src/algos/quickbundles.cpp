@@ -0,0 +1,455 @@
+/*
+ * quickbundles.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "quickbundles.h"
+#include "quickbundlesthread.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // number of fibers assigned serially between two parallel searches
+    const int BATCH_SIZE = 4096;
+}
+
+QuickBundles::QuickBundles( const std::vector<Fib>* fibs, float threshold, int numPoints ) :
+    m_fibs( fibs ),
+    m_threshold( threshold ),
+    m_numPoints( qMax( 2, numPoints ) ),
+    m_numFibs( fibs->size() )
+{
+}
+
+QuickBundles::~QuickBundles()
+{
+}
+
+int QuickBundles::numClusters()
+{
+    return m_counts.size();
+}
+
+int QuickBundles::numPoints()
+{
+    return m_numPoints;
+}
+
+std::vector<float>* QuickBundles::centroids()
+{
+    return &m_centroids;
+}
+
+std::vector<int>* QuickBundles::assignment()
+{
+    return &m_assignment;
+}
+
+std::vector<unsigned int>* QuickBundles::clusterStarts()
+{
+    return &m_clusterStarts;
+}
+
+std::vector<unsigned int>* QuickBundles::clusterMembers()
+{
+    return &m_clusterMembers;
+}
+
+void QuickBundles::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_points.resize( (size_t)m_numFibs * m_numPoints * 3 );
+    runThreads( QuickBundlesThread::RESAMPLE, 0, m_numFibs );
+    qDebug() << "quickbundles: resampled" << m_numFibs << "fibers in" << timer.elapsed() << "ms";
+
+    m_best.resize( m_numFibs, -1 );
+    m_bestDist.resize( m_numFibs, 0 );
+    m_bestFlip.resize( m_numFibs, 0 );
+    m_assignment.assign( m_numFibs, -1 );
+    m_flipped.assign( m_numFibs, 0 );
+
+    for ( int begin = 0; begin < m_numFibs; begin += BATCH_SIZE )
+    {
+        int end = qMin( begin + BATCH_SIZE, m_numFibs );
+        int existing = m_counts.size();
+        runThreads( QuickBundlesThread::ASSIGN, begin, end, existing );
+
+        for ( int i = begin; i < end; ++i )
+        {
+            const float* p = &m_points[(size_t)i * m_numPoints * 3];
+            int best = m_best[i];
+            float dist = m_bestDist[i];
+            bool flipped = m_bestFlip[i];
+
+            // clusters started in this batch weren't known to the search threads
+            float newDist;
+            bool newFlipped;
+            int newBest = nearest( p, existing, m_counts.size(), newDist, newFlipped );
+            if ( newBest >= 0 && ( best < 0 || newDist < dist ) )
+            {
+                best = newBest;
+                flipped = newFlipped;
+            }
+
+            if ( best >= 0 )
+            {
+                addToCluster( best, i, flipped );
+            }
+            else
+            {
+                newCluster( i );
+            }
+        }
+    }
+    qDebug() << "quickbundles:" << m_counts.size() << "clusters after" << timer.elapsed() << "ms";
+
+    // centroids moved while fibers were added, assign every fiber to its nearest final centroid
+    runThreads( QuickBundlesThread::ASSIGN, 0, m_numFibs, m_counts.size() );
+    for ( int i = 0; i < m_numFibs; ++i )
+    {
+        if ( m_best[i] >= 0 )
+        {
+            m_assignment[i] = m_best[i];
+            m_flipped[i] = m_bestFlip[i];
+        }
+    }
+    rebuildClusters();
+
+    std::vector<int>().swap( m_best );
+    std::vector<float>().swap( m_bestDist );
+    std::vector<unsigned char>().swap( m_bestFlip );
+    m_grid.clear();
+
+    qDebug() << "quickbundles:" << m_numFibs << "fibers in" << m_counts.size() << "clusters, threshold" << m_threshold
+             << "," << timer.elapsed() << "ms";
+}
+
+void QuickBundles::runThreads( int pass, int begin, int end, int numClusters )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+    int chunkSize = ( end - begin ) / numThreads;
+
+    std::vector<QuickBundlesThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        int chunkEnd = ( i == numThreads - 1 ) ? end : begin + ( i + 1 ) * chunkSize;
+        threads.push_back( new QuickBundlesThread( this, pass, begin + i * chunkSize, chunkEnd, numClusters ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        delete threads[i];
+    }
+}
+
+void QuickBundles::resample( int begin, int end )
+{
+    std::vector<float> arcLength;
+    for ( int i = begin; i < end; ++i )
+    {
+        const std::vector<QVector3D>& verts = *m_fibs->at( i ).getVerts();
+        float* out = &m_points[(size_t)i * m_numPoints * 3];
+        unsigned int numVerts = verts.size();
+
+        if ( numVerts == 0 )
+        {
+            std::fill( out, out + m_numPoints * 3, 0.0f );
+            continue;
+        }
+
+        arcLength.resize( numVerts );
+        arcLength[0] = 0;
+        for ( unsigned int k = 1; k < numVerts; ++k )
+        {
+            arcLength[k] = arcLength[k - 1] + ( verts[k] - verts[k - 1] ).length();
+        }
+        float total = arcLength[numVerts - 1];
+
+        unsigned int k = 0;
+        for ( int j = 0; j < m_numPoints; ++j )
+        {
+            float s = total * j / ( m_numPoints - 1 );
+            while ( k + 2 < numVerts && arcLength[k + 1] < s )
+            {
+                ++k;
+            }
+            QVector3D p = verts[k];
+            if ( k + 1 < numVerts )
+            {
+                float segment = arcLength[k + 1] - arcLength[k];
+                float t = ( segment > 0 ) ? qMax( 0.0f, qMin( 1.0f, ( s - arcLength[k] ) / segment ) ) : 0.0f;
+                p = verts[k] + t * ( verts[k + 1] - verts[k] );
+            }
+            out[j * 3] = p.x();
+            out[j * 3 + 1] = p.y();
+            out[j * 3 + 2] = p.z();
+        }
+    }
+}
+
+void QuickBundles::assign( int begin, int end, int numClusters )
+{
+    for ( int i = begin; i < end; ++i )
+    {
+        float dist = 0;
+        bool flipped = false;
+        m_best[i] = nearest( &m_points[(size_t)i * m_numPoints * 3], 0, numClusters, dist, flipped );
+        m_bestDist[i] = dist;
+        m_bestFlip[i] = flipped;
+    }
+}
+
+float QuickBundles::mdf( const float* a, const float* b, float limit, bool& flipped )
+{
+    float direct = 0;
+    float flip = 0;
+    float sumLimit = limit * m_numPoints;
+    const float* bFlip = b + ( m_numPoints - 1 ) * 3;
+    for ( int i = 0; i < m_numPoints; ++i )
+    {
+        float dx = a[i * 3] - b[i * 3];
+        float dy = a[i * 3 + 1] - b[i * 3 + 1];
+        float dz = a[i * 3 + 2] - b[i * 3 + 2];
+        direct += sqrt( dx * dx + dy * dy + dz * dz );
+
+        dx = a[i * 3] - bFlip[-i * 3];
+        dy = a[i * 3 + 1] - bFlip[-i * 3 + 1];
+        dz = a[i * 3 + 2] - bFlip[-i * 3 + 2];
+        flip += sqrt( dx * dx + dy * dy + dz * dz );
+
+        if ( direct >= sumLimit && flip >= sumLimit )
+        {
+            return std::numeric_limits<float>::max();
+        }
+    }
+    flipped = flip < direct;
+    return qMin( direct, flip ) / m_numPoints;
+}
+
+quint64 QuickBundles::cellKey( const float* center )
+{
+    quint64 key = 0;
+    for ( int i = 0; i < 3; ++i )
+    {
+        qint64 cell = (qint64)floor( center[i] / m_threshold ) + ( 1 << 20 );
+        key = ( key << 21 ) | ( (quint64)cell & 0x1fffff );
+    }
+    return key;
+}
+
+int QuickBundles::nearest( const float* p, int minCluster, int maxCluster, float& dist, bool& flipped )
+{
+    int best = -1;
+    dist = m_threshold;
+    if ( minCluster >= maxCluster )
+    {
+        return best;
+    }
+
+    float center[3] = { 0, 0, 0 };
+    for ( int i = 0; i < m_numPoints; ++i )
+    {
+        center[0] += p[i * 3];
+        center[1] += p[i * 3 + 1];
+        center[2] += p[i * 3 + 2];
+    }
+    for ( int i = 0; i < 3; ++i )
+    {
+        center[i] /= m_numPoints;
+    }
+
+    float probe[3];
+    for ( int x = -1; x <= 1; ++x )
+    {
+        for ( int y = -1; y <= 1; ++y )
+        {
+            for ( int z = -1; z <= 1; ++z )
+            {
+                probe[0] = center[0] + x * m_threshold;
+                probe[1] = center[1] + y * m_threshold;
+                probe[2] = center[2] + z * m_threshold;
+                QHash<quint64, std::vector<int> >::const_iterator it = m_grid.constFind( cellKey( probe ) );
+                if ( it == m_grid.constEnd() )
+                {
+                    continue;
+                }
+                const std::vector<int>& clusters = it.value();
+                for ( unsigned int k = 0; k < clusters.size(); ++k )
+                {
+                    int c = clusters[k];
+                    if ( c < minCluster || c >= maxCluster )
+                    {
+                        continue;
+                    }
+                    bool f = false;
+                    float d = mdf( p, &m_centroids[(size_t)c * m_numPoints * 3], dist, f );
+                    if ( d < dist )
+                    {
+                        dist = d;
+                        flipped = f;
+                        best = c;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void QuickBundles::addToCluster( int cluster, int fiber, bool flipped )
+{
+    const float* p = &m_points[(size_t)fiber * m_numPoints * 3];
+    double* sums = &m_sums[(size_t)cluster * m_numPoints * 3];
+    for ( int i = 0; i < m_numPoints; ++i )
+    {
+        int src = flipped ? ( m_numPoints - 1 - i ) : i;
+        sums[i * 3] += p[src * 3];
+        sums[i * 3 + 1] += p[src * 3 + 1];
+        sums[i * 3 + 2] += p[src * 3 + 2];
+    }
+    ++m_counts[cluster];
+    m_assignment[fiber] = cluster;
+    m_flipped[fiber] = flipped;
+    updateCentroid( cluster );
+}
+
+int QuickBundles::newCluster( int fiber )
+{
+    int cluster = m_counts.size();
+    m_counts.push_back( 0 );
+    m_sums.resize( m_sums.size() + m_numPoints * 3, 0.0 );
+    m_centroids.resize( m_centroids.size() + m_numPoints * 3, 0.0f );
+    m_centers.resize( m_centers.size() + 3, std::numeric_limits<float>::max() );
+    addToCluster( cluster, fiber, false );
+    return cluster;
+}
+
+void QuickBundles::updateCentroid( int cluster )
+{
+    const double* sums = &m_sums[(size_t)cluster * m_numPoints * 3];
+    float* centroid = &m_centroids[(size_t)cluster * m_numPoints * 3];
+    float* center = &m_centers[cluster * 3];
+
+    double c[3] = { 0, 0, 0 };
+    for ( int i = 0; i < m_numPoints * 3; ++i )
+    {
+        centroid[i] = sums[i] / m_counts[cluster];
+        c[i % 3] += centroid[i];
+    }
+
+    bool isNew = center[0] == std::numeric_limits<float>::max();
+    quint64 oldKey = isNew ? 0 : cellKey( center );
+    for ( int i = 0; i < 3; ++i )
+    {
+        center[i] = c[i] / m_numPoints;
+    }
+    quint64 newKey = cellKey( center );
+
+    if ( !isNew && oldKey == newKey )
+    {
+        return;
+    }
+    if ( !isNew )
+    {
+        std::vector<int>& old = m_grid[oldKey];
+        old.erase( std::find( old.begin(), old.end(), cluster ) );
+    }
+    m_grid[newKey].push_back( cluster );
+}
+
+void QuickBundles::rebuildClusters()
+{
+    int numClusters = m_counts.size();
+    std::fill( m_sums.begin(), m_sums.end(), 0.0 );
+    std::fill( m_counts.begin(), m_counts.end(), 0 );
+    for ( int i = 0; i < m_numFibs; ++i )
+    {
+        const float* p = &m_points[(size_t)i * m_numPoints * 3];
+        double* sums = &m_sums[(size_t)m_assignment[i] * m_numPoints * 3];
+        for ( int k = 0; k < m_numPoints; ++k )
+        {
+            int src = m_flipped[i] ? ( m_numPoints - 1 - k ) : k;
+            sums[k * 3] += p[src * 3];
+            sums[k * 3 + 1] += p[src * 3 + 1];
+            sums[k * 3 + 2] += p[src * 3 + 2];
+        }
+        ++m_counts[m_assignment[i]];
+    }
+
+    // drop clusters that lost all fibers in the reassignment
+    std::vector<int> newIds( numClusters, -1 );
+    int numLeft = 0;
+    for ( int c = 0; c < numClusters; ++c )
+    {
+        if ( m_counts[c] == 0 )
+        {
+            continue;
+        }
+        newIds[c] = numLeft;
+        m_counts[numLeft] = m_counts[c];
+        for ( int k = 0; k < m_numPoints * 3; ++k )
+        {
+            m_sums[(size_t)numLeft * m_numPoints * 3 + k] = m_sums[(size_t)c * m_numPoints * 3 + k];
+            m_centroids[(size_t)numLeft * m_numPoints * 3 + k] = m_sums[(size_t)c * m_numPoints * 3 + k] / m_counts[numLeft];
+        }
+        ++numLeft;
+    }
+    m_counts.resize( numLeft );
+    m_sums.resize( (size_t)numLeft * m_numPoints * 3 );
+    m_centroids.resize( (size_t)numLeft * m_numPoints * 3 );
+    m_centers.clear();
+
+    m_clusterStarts.assign( numLeft + 1, 0 );
+    for ( int i = 0; i < m_numFibs; ++i )
+    {
+        m_assignment[i] = newIds[m_assignment[i]];
+        ++m_clusterStarts[m_assignment[i] + 1];
+    }
+    for ( int c = 0; c < numLeft; ++c )
+    {
+        m_clusterStarts[c + 1] += m_clusterStarts[c];
+    }
+    m_clusterMembers.resize( m_numFibs );
+    std::vector<unsigned int> cursor( m_clusterStarts.begin(), m_clusterStarts.end() - 1 );
+    for ( int i = 0; i < m_numFibs; ++i )
+    {
+        m_clusterMembers[cursor[m_assignment[i]]++] = i;
+    }
+}
+
+std::vector<Fib> QuickBundles::centroidFibs()
+{
+    std::vector<Fib> out;
+    out.reserve( m_counts.size() );
+    for ( unsigned int c = 0; c < m_counts.size(); ++c )
+    {
+        Fib fib;
+        const float* centroid = &m_centroids[(size_t)c * m_numPoints * 3];
+        for ( int i = 0; i < m_numPoints; ++i )
+        {
+            // data field 0 holds the cluster size
+            fib.addVert( centroid[i * 3], centroid[i * 3 + 1], centroid[i * 3 + 2], m_counts[c] );
+        }
+        out.push_back( fib );
+    }
+    return out;
+}
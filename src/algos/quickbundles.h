@@ -0,0 +1,92 @@
+/*
+ * quickbundles.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef QUICKBUNDLES_H_
+#define QUICKBUNDLES_H_
+
+#include "fib.h"
+
+#include <QHash>
+
+#include <vector>
+
+class QuickBundlesThread;
+
+/*
+ * QuickBundles streamline clustering. Fibers are resampled to a fixed number of equidistant points,
+ * compared to cluster centroids with the minimum direct flip (MDF) distance and assigned to the
+ * nearest one below the threshold or start a new cluster. Centroids are hashed by their center of
+ * mass on a grid with cell size threshold, since the distance of the centers is a lower bound of the
+ * MDF distance only the 27 neighbouring cells have to be searched. Fibers are assigned in fixed size
+ * batches, the search against the clusters existing before a batch runs in parallel, so the result
+ * doesn't depend on the number of threads.
+ */
+class QuickBundles
+{
+    friend class QuickBundlesThread;
+
+public:
+    QuickBundles( const std::vector<Fib>* fibs, float threshold, int numPoints = 12 );
+    virtual ~QuickBundles();
+
+    void run();
+
+    int numClusters();
+    int numPoints();
+
+    // numClusters * numPoints * 3 floats
+    std::vector<float>* centroids();
+    // cluster id per fiber
+    std::vector<int>* assignment();
+    // members of cluster i are members[starts[i]] to members[starts[i+1]]
+    std::vector<unsigned int>* clusterStarts();
+    std::vector<unsigned int>* clusterMembers();
+
+    std::vector<Fib> centroidFibs();
+
+private:
+    void runThreads( int pass, int begin, int end, int numClusters = 0 );
+
+    void resample( int begin, int end );
+    void assign( int begin, int end, int numClusters );
+
+    float mdf( const float* a, const float* b, float limit, bool& flipped );
+    int nearest( const float* p, int minCluster, int maxCluster, float& dist, bool& flipped );
+    quint64 cellKey( const float* center );
+
+    void addToCluster( int cluster, int fiber, bool flipped );
+    int newCluster( int fiber );
+    void updateCentroid( int cluster );
+    void rebuildClusters();
+
+    const std::vector<Fib>* m_fibs;
+    float m_threshold;
+    int m_numPoints;
+    int m_numFibs;
+
+    // resampled fibers, numPoints * 3 floats each
+    std::vector<float> m_points;
+
+    // per cluster running sums, centroids and centers of mass
+    std::vector<double> m_sums;
+    std::vector<float> m_centroids;
+    std::vector<float> m_centers;
+    std::vector<unsigned int> m_counts;
+    QHash<quint64, std::vector<int> > m_grid;
+
+    // per fiber search results of the current pass
+    std::vector<int> m_best;
+    std::vector<float> m_bestDist;
+    std::vector<unsigned char> m_bestFlip;
+
+    std::vector<int> m_assignment;
+    std::vector<unsigned char> m_flipped;
+    std::vector<unsigned int> m_clusterStarts;
+    std::vector<unsigned int> m_clusterMembers;
+};
+
+#endif /* QUICKBUNDLES_H_ */
@@ -0,0 +1,37 @@
+/*
+ * quickbundlesthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "quickbundlesthread.h"
+#include "quickbundles.h"
+#include "trace.h"
+
+QuickBundlesThread::QuickBundlesThread( QuickBundles* qb, int pass, int begin, int end, int numClusters ) :
+    m_qb( qb ),
+    m_pass( pass ),
+    m_begin( begin ),
+    m_end( end ),
+    m_numClusters( numClusters )
+{
+}
+
+QuickBundlesThread::~QuickBundlesThread()
+{
+}
+
+void QuickBundlesThread::run()
+{
+    TRACE_SCOPE( "QuickBundlesThread::run" );
+    switch ( m_pass )
+    {
+        case RESAMPLE:
+            m_qb->resample( m_begin, m_end );
+            break;
+        case ASSIGN:
+            m_qb->assign( m_begin, m_end, m_numClusters );
+            break;
+    }
+}
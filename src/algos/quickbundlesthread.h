@@ -0,0 +1,37 @@
+/*
+ * quickbundlesthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef QUICKBUNDLESTHREAD_H_
+#define QUICKBUNDLESTHREAD_H_
+
+#include <QThread>
+
+class QuickBundles;
+
+class QuickBundlesThread : public QThread
+{
+public:
+    enum Pass
+    {
+        RESAMPLE,
+        ASSIGN
+    };
+
+    QuickBundlesThread( QuickBundles* qb, int pass, int begin, int end, int numClusters );
+    virtual ~QuickBundlesThread();
+
+private:
+    void run();
+
+    QuickBundles* m_qb;
+    int m_pass;
+    int m_begin;
+    int m_end;
+    int m_numClusters;
+};
+
+#endif /* QUICKBUNDLESTHREAD_H_ */
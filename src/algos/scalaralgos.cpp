@@ -5,7 +5,12 @@
  * @author Ralph Schurade
  */
 #include "scalaralgos.h"
+#include "connectedcomponents.h"
+#include "distancetransform.h"
+#include "volumefilter.h"
 
+#include "../data/datasets/datasetcomponents.h"
+#include "../data/datasets/datasetfmri.h"
 #include "../data/datasets/datasetscalar.h"
 #include "../data/datasets/datasetisosurface.h"
 #include "../data/datasets/datasetisoline.h"
@@ -16,8 +21,11 @@
 
 #include "../io/writer.h"
 
+#include <QDebug>
 #include <QQueue>
 
+#include <limits>
+
 ScalarAlgos::ScalarAlgos()
 {
 }
@@ -45,282 +53,48 @@ QList<Dataset*> ScalarAlgos::isoLine( Dataset* ds, float isoValue )
 
 QList<Dataset*> ScalarAlgos::distanceMap( Dataset* ds )
 {
-    std::vector<float>* data = static_cast<DatasetScalar*>( ds )->getData();
-    std::vector<float> out( data->size() );
-
-    int b, r, c, bb, rr, r0, b0, c0;
-    int i, istart, iend;
-    int nz, ny, nx, npixels;
-    int d, d1, d2, cc1, cc2;
-    float u, dmin, dmax;
-    bool *srcpix;
-    double g, *array;
-
-    nx = ds->properties( "maingl" ).get( Fn::Property::D_NX ).toInt();
-    ny = ds->properties( "maingl" ).get( Fn::Property::D_NY ).toInt();
-    nz = ds->properties( "maingl" ).get( Fn::Property::D_NZ ).toInt();
-
-    npixels = qMax( nz, ny );
-    array = new double[npixels];
-
-    npixels = nz * ny * nx;
-
-    out.resize( npixels );
-    for ( int i = 0; i < npixels; ++i )
-    {
-        out[i] = 0.0;
-    }
-
-    bool* bitmask = new bool[npixels];
-    for ( int i = 0; i < npixels; ++i )
-    {
-        if ( data->at( i ) < 0.01 )
-            bitmask[i] = true;
-        else
-            bitmask[i] = false;
-    }
-
-    dmax = 999999999.0f;
-
-    // first pass
-    for ( b = 0; b < nz; ++b )
-    {
-        for ( r = 0; r < ny; ++r )
-        {
-            for ( c = 0; c < nx; ++c )
-            {
-                //if (VPixel(src,b,r,c,VBit) == 1)
-                if ( bitmask[b * ny * nx + r * nx + c] )
-                {
-                    out[b * ny * nx + r * nx + c] = 0;
-                    continue;
-                }
-
-                srcpix = bitmask + b * ny * nx + r * nx + c;
-                cc1 = c;
-                while ( cc1 < nx && *srcpix++ == 0 )
-                    cc1++;
-                d1 = ( cc1 >= nx ? nx : ( cc1 - c ) );
-
-                srcpix = bitmask + b * ny * nx + r * nx + c;
-                cc2 = c;
-                while ( cc2 >= 0 && *srcpix-- == 0 )
-                    cc2--;
-                d2 = ( cc2 <= 0 ? nx : ( c - cc2 ) );
-
-                if ( d1 <= d2 )
-                {
-                    d = d1;
-                    c0 = cc1;
-                }
-                else
-                {
-                    d = d2;
-                    c0 = cc2;
-                }
-                out[b * ny * nx + r * nx + c] = (float) ( d * d );
-            }
-        }
-    }
+    PropertyGroup& props = ds->properties( "maingl" );
+    int nx = props.get( Fn::Property::D_NX ).toInt();
+    int ny = props.get( Fn::Property::D_NY ).toInt();
+    int nz = props.get( Fn::Property::D_NZ ).toInt();
+    float dx = props.get( Fn::Property::D_DX ).toFloat();
+    float dy = props.get( Fn::Property::D_DY ).toFloat();
+    float dz = props.get( Fn::Property::D_DZ ).toFloat();
 
-    // second pass
-    for ( b = 0; b < nz; ++b )
+    std::vector<float>* data = static_cast<DatasetScalar*>( ds )->getData();
+    std::vector<bool> features( data->size() );
+    for ( unsigned int i = 0; i < data->size(); ++i )
     {
-        for ( c = 0; c < nx; ++c )
-        {
-            for ( r = 0; r < ny; ++r )
-                array[r] = (double) out[b * ny * nx + r * nx + c];
-
-            for ( r = 0; r < ny; ++r )
-            {
-                if ( bitmask[b * ny * nx + r * nx + c] == 1 )
-                    continue;
-
-                dmin = dmax;
-                r0 = r;
-                g = sqrt( array[r] );
-                istart = r - (int) g;
-                if ( istart < 0 )
-                    istart = 0;
-                iend = r + (int) g + 1;
-                if ( iend >= ny )
-                    iend = ny;
-
-                for ( rr = istart; rr < iend; rr++ )
-                {
-                    u = array[rr] + ( r - rr ) * ( r - rr );
-                    if ( u < dmin )
-                    {
-                        dmin = u;
-                        r0 = rr;
-                    }
-                }
-                out[b * ny * nx + r * nx + c] = dmin;
-            }
-        }
+        features[i] = data->at( i ) < 0.01;
     }
 
-    // third pass
-
-    for ( r = 0; r < ny; ++r )
+    DistanceTransform transform( nx, ny, nz, dx, dy, dz );
+    std::vector<float> dist;
+    transform.distance( features, dist );
+    if ( dist.empty() )
     {
-        for ( c = 0; c < nx; ++c )
-        {
-            for ( b = 0; b < nz; ++b )
-                array[b] = (double) out[b * ny * nx + r * nx + c];
-
-            for ( b = 0; b < nz; ++b )
-            {
-                if ( bitmask[b * ny * nx + r * nx + c] == 1 )
-                    continue;
-
-                dmin = dmax;
-                b0 = b;
-
-                g = sqrt( array[b] );
-                istart = b - (int) g - 1;
-                if ( istart < 0 )
-                    istart = 0;
-                iend = b + (int) g + 1;
-                if ( iend >= nz )
-                    iend = nz;
-
-                for ( bb = istart; bb < iend; bb++ )
-                {
-                    u = array[bb] + ( b - bb ) * ( b - bb );
-                    if ( u < dmin )
-                    {
-                        dmin = u;
-                        b0 = bb;
-                    }
-                }
-                out[b * ny * nx + r * nx + c] = dmin;
-            }
-        }
+        dist.resize( data->size(), 0.0f );
     }
 
-    delete[] array;
-
     float max = 0;
-    for ( i = 0; i < npixels; ++i )
+    for ( unsigned int i = 0; i < dist.size(); ++i )
     {
-        out[i] = sqrt( (double) out[i] );
-        if ( out[i] > max )
-            max = out[i];
+        max = qMax( max, dist[i] );
     }
-    for ( i = 0; i < npixels; ++i )
+    if ( max > 0 )
     {
-        out[i] = out[i] / max;
-
-    }
-
-    // filter with gauss
-    // create the filter kernel
-    double sigma = 3;
-
-    int dim = (int) ( 3.0 * sigma + 1 );
-    int n = 2 * dim + 1;
-    double step = 1;
-
-    float* kernel = new float[n];
-
-    double sum = 0;
-    double x = -(float) dim;
-
-    double uu;
-    for ( int i = 0; i < n; ++i )
-    {
-        uu = xxgauss( x, sigma );
-        sum += uu;
-        kernel[i] = uu;
-        x += step;
-    }
-
-    /* normalize */
-    for ( int i = 0; i < n; ++i )
-    {
-        uu = kernel[i];
-        uu /= sum;
-        kernel[i] = uu;
-    }
-
-    d = n / 2;
-    float* float_pp;
-    std::vector<float> tmp( npixels );
-    int c1, cc;
-
-    for ( int i = 0; i < npixels; ++i )
-    {
-        tmp[i] = 0.0;
-    }
-
-    for ( b = 0; b < nz; ++b )
-    {
-        for ( r = 0; r < ny; ++r )
-        {
-            for ( c = d; c < nx - d; ++c )
-            {
-
-                float_pp = kernel;
-                sum = 0;
-                c0 = c - d;
-                c1 = c + d;
-                for ( cc = c0; cc <= c1; ++cc )
-                {
-                    x = out[b * ny * nx + r * nx + cc];
-                    sum += x * ( *float_pp++ );
-                }
-                tmp[b * ny * nx + r * nx + c] = sum;
-            }
-        }
-    }
-    int r1;
-    for ( b = 0; b < nz; ++b )
-    {
-        for ( r = d; r < ny - d; ++r )
+        for ( unsigned int i = 0; i < dist.size(); ++i )
         {
-            for ( c = 0; c < nx; ++c )
-            {
-                float_pp = kernel;
-                sum = 0;
-                r0 = r - d;
-                r1 = r + d;
-                for ( rr = r0; rr <= r1; rr++ )
-                {
-                    x = tmp[b * ny * nx + rr * nx + c];
-                    sum += x * ( *float_pp++ );
-                }
-                out[b * ny * nx + r * nx + c] = sum;
-            }
+            dist[i] /= max;
         }
     }
-    int b1;
-    for ( b = d; b < nz - d; ++b )
-    {
-        for ( r = 0; r < ny; ++r )
-        {
-            for ( c = 0; c < nx; ++c )
-            {
-
-                float_pp = kernel;
-                sum = 0;
-                b0 = b - d;
-                b1 = b + d;
-                for ( bb = b0; bb <= b1; bb++ )
-                {
-                    x = out[bb * ny * nx + r * nx + c];
-                    sum += x * ( *float_pp++ );
-                }
-                tmp[b * ny * nx + r * nx + c] = sum;
-            }
-        }
-    }
-    delete[] bitmask;
-    delete[] kernel;
 
-    out = tmp;
+    // smooth with a sigma of 3 voxels of the finest axis
+    VolumeFilter filter( nx, ny, nz, dx, dy, dz );
+    std::vector<float> out;
+    filter.gauss( dist, out, 3.0f * qMin( dx, qMin( dy, dz ) ) );
 
-    QString name = ds->properties( "maingl" ).get( Fn::Property::D_NAME ).toString() + " (distance map)";
+    QString name = props.get( Fn::Property::D_NAME ).toString() + " (distance map)";
     Writer writer( ds, QFileInfo() );
     DatasetScalar* dsOut = new DatasetScalar( QDir( name ), out, writer.createHeader( 1 ) );
     dsOut->copyPropertyObject( ( ds->properties( "maingl" ) ), "maingl" );
@@ -336,132 +110,39 @@ QList<Dataset*> ScalarAlgos::distanceMap( Dataset* ds )
     return l;
 }
 
-QList<Dataset*> ScalarAlgos::gauss( Dataset* ds )
+QList<Dataset*> ScalarAlgos::signedDistanceMap( Dataset* ds, float threshold )
 {
-    std::vector<float>* data = static_cast<DatasetScalar*>( ds )->getData();
-    std::vector<float> out( data->size() );
-
-    for ( unsigned int i = 0; i < data->size(); ++i )
+    PropertyGroup& props = ds->properties( "maingl" );
+    int nx = props.get( Fn::Property::D_NX ).toInt();
+    int ny = props.get( Fn::Property::D_NY ).toInt();
+    int nz = props.get( Fn::Property::D_NZ ).toInt();
+    float dx = props.get( Fn::Property::D_DX ).toFloat();
+    float dy = props.get( Fn::Property::D_DY ).toFloat();
+    float dz = props.get( Fn::Property::D_DZ ).toFloat();
+
+    if ( threshold < 0 )
     {
-        out[i] = data->at( i );
+        threshold = 0.01f;
     }
 
-    int b, r, c, bb, rr, r0, b0, c0;
-
-    int nx = ds->properties( "maingl" ).get( Fn::Property::D_NX ).toInt();
-    int ny = ds->properties( "maingl" ).get( Fn::Property::D_NY ).toInt();
-    int nz = ds->properties( "maingl" ).get( Fn::Property::D_NZ ).toInt();
-    int npixels = nz * ny * nx;
-
-    // create the filter kernel
-    double sigma = Models::getGlobal( Fn::Property::G_FILTER_SIZE ).toFloat();
-
-    int dim = (int) ( sigma + 1 );
-    int n = 2 * dim + 1;
-    double step = 1;
-
-    float* kernel = new float[n];
-
-    double sum = 0;
-    double x = -(float) dim;
-
-    double uu;
-    for ( int i = 0; i < n; ++i )
-    {
-        uu = xxgauss( x, sigma );
-        sum += uu;
-        kernel[i] = uu;
-        x += step;
-    }
-
-    /* normalize */
-    for ( int i = 0; i < n; ++i )
-    {
-        uu = kernel[i];
-        uu /= sum;
-        kernel[i] = uu;
-    }
-
-    int d = n / 2;
-    float* float_pp;
-    std::vector<float> tmp( npixels );
-    int c1, cc;
-
-    for ( int i = 0; i < npixels; ++i )
+    std::vector<float>* data = static_cast<DatasetScalar*>( ds )->getData();
+    std::vector<bool> mask( data->size() );
+    for ( unsigned int i = 0; i < data->size(); ++i )
     {
-        tmp[i] = 0.0;
+        mask[i] = data->at( i ) >= threshold;
     }
 
-    for ( b = 0; b < nz; ++b )
+    DistanceTransform transform( nx, ny, nz, dx, dy, dz );
+    std::vector<float> out;
+    transform.signedDistance( mask, out );
+    if ( out.empty() )
     {
-        for ( r = 0; r < ny; ++r )
-        {
-            for ( c = d; c < nx - d; ++c )
-            {
-
-                float_pp = kernel;
-                sum = 0;
-                c0 = c - d;
-                c1 = c + d;
-                for ( cc = c0; cc <= c1; ++cc )
-                {
-                    x = out[b * ny * nx + r * nx + cc];
-                    sum += x * ( *float_pp++ );
-                }
-                tmp[b * ny * nx + r * nx + c] = sum;
-            }
-        }
-    }
-    int r1;
-    for ( b = 0; b < nz; ++b )
-    {
-        for ( r = d; r < ny - d; ++r )
-        {
-            for ( c = 0; c < nx; ++c )
-            {
-                float_pp = kernel;
-                sum = 0;
-                r0 = r - d;
-                r1 = r + d;
-                for ( rr = r0; rr <= r1; rr++ )
-                {
-                    x = tmp[b * ny * nx + rr * nx + c];
-                    sum += x * ( *float_pp++ );
-                }
-                out[b * ny * nx + r * nx + c] = sum;
-            }
-        }
-    }
-    int b1;
-    for ( b = d; b < nz - d; ++b )
-    {
-        for ( r = 0; r < ny; ++r )
-        {
-            for ( c = 0; c < nx; ++c )
-            {
-
-                float_pp = kernel;
-                sum = 0;
-                b0 = b - d;
-                b1 = b + d;
-                for ( bb = b0; bb <= b1; bb++ )
-                {
-                    x = out[bb * ny * nx + r * nx + c];
-                    sum += x * ( *float_pp++ );
-                }
-                tmp[b * ny * nx + r * nx + c] = sum;
-            }
-        }
+        out.resize( data->size(), 0.0f );
     }
 
-    delete[] kernel;
-
-    out = tmp;
-
-    QString name = ds->properties( "maingl" ).get( Fn::Property::D_NAME ).toString() + " (gauss)";
+    QString name = props.get( Fn::Property::D_NAME ).toString() + " (signed distance)";
     Writer writer( ds, QFileInfo() );
     DatasetScalar* dsOut = new DatasetScalar( QDir( name ), out, writer.createHeader( 1 ) );
-    dsOut->copyPropertyObject( ( ds->properties( "maingl" ) ), "maingl" );
     dsOut->properties().set( Fn::Property::D_NAME, name );
 
     QList<Dataset*> l;
@@ -469,12 +150,9 @@ QList<Dataset*> ScalarAlgos::gauss( Dataset* ds )
     return l;
 }
 
-double ScalarAlgos::xxgauss(double x, double sigma)
+QList<Dataset*> ScalarAlgos::gauss( Dataset* ds )
 {
-    double y, z, a = 2.506628273;
-    z = x / sigma;
-    y = exp( (double) -z * z * 0.5 ) / ( sigma * a );
-    return y;
+    return filter( ds, false );
 }
 
 QList<Dataset*> ScalarAlgos::createNew( Dataset* ds )
@@ -494,40 +172,62 @@ QList<Dataset*> ScalarAlgos::createNew( Dataset* ds )
 
 QList<Dataset*> ScalarAlgos::median( Dataset* ds )
 {
-    DatasetScalar* dss = static_cast<DatasetScalar*>( ds );
-
-    std::vector<float>* data = dss->getData();
-    std::vector<float> out( data->size() );
+    return filter( ds, true );
+}
 
-    int nx = ds->properties( "maingl" ).get( Fn::Property::D_NX ).toInt();
-    int ny = ds->properties( "maingl" ).get( Fn::Property::D_NY ).toInt();
-    int nz = ds->properties( "maingl" ).get( Fn::Property::D_NZ ).toInt();
+QList<Dataset*> ScalarAlgos::filter( Dataset* ds, bool median )
+{
+    PropertyGroup& props = ds->properties( "maingl" );
+    int nx = props.get( Fn::Property::D_NX ).toInt();
+    int ny = props.get( Fn::Property::D_NY ).toInt();
+    int nz = props.get( Fn::Property::D_NZ ).toInt();
+    float dx = props.get( Fn::Property::D_DX ).toFloat();
+    float dy = props.get( Fn::Property::D_DY ).toFloat();
+    float dz = props.get( Fn::Property::D_DZ ).toFloat();
+
+    bool isSeries = props.get( Fn::Property::D_TYPE ).toInt() == (int)Fn::DatasetType::NIFTI_FMRI;
+    std::vector<float>* data;
+    int frames = 1;
+    if ( isSeries )
+    {
+        data = static_cast<DatasetFMRI*>( ds )->getData();
+        frames = props.get( Fn::Property::D_DIM ).toInt();
+    }
+    else
+    {
+        data = static_cast<DatasetScalar*>( ds )->getData();
+    }
 
-    // create the filter kernel
-    int dist = Models::getGlobal( Fn::Property::G_FILTER_SIZE ).toInt();
+    // the filter size counts in voxels of the finest axis, coarser axes get proportionally smaller kernels,
+    // gauss takes it as sigma, median as the integer radius of the box
+    float filterSize = Models::getGlobal( Fn::Property::G_FILTER_SIZE ).toFloat();
+    float spacing = qMin( dx, qMin( dy, dz ) );
 
-    for ( int z = 0; z < nz; ++z )
+    VolumeFilter filter( nx, ny, nz, dx, dy, dz, frames );
+    std::vector<float> out;
+    if ( median )
     {
-        for ( int y = 0; y < ny; ++y )
-        {
-        for ( int x = 0; x < nx; ++x )
-            {
-                QList<int> neighs = dss->getNeighbourhoodXxX( x, y, z, dist );
-                QList<float>values;
-                for ( int i = 0; i < neighs.size(); ++i )
-                {
-                    values.push_back( data->at( neighs[i] ) );
-                }
-                qSort( values );
-                out[dss->getId( x, y, z)] = values.at( values.size() / 2 );
-            }
-        }
+        filter.percentile( *data, out, static_cast<int>( filterSize ) * spacing );
+    }
+    else
+    {
+        filter.gauss( *data, out, filterSize * spacing );
     }
 
-    QString name = ds->properties( "maingl" ).get( Fn::Property::D_NAME ).toString() + " (median)";
+    QString name = props.get( Fn::Property::D_NAME ).toString() + ( median ? " (median)" : " (gauss)" );
     Writer writer( ds, QFileInfo() );
-    DatasetScalar* dsOut = new DatasetScalar( QDir( name ), out, writer.createHeader( 1 ) );
-    dsOut->copyPropertyObject( ( ds->properties( "maingl" ) ), "maingl" );
+    Dataset* dsOut;
+    if ( isSeries )
+    {
+        nifti_image* header = writer.createHeader( frames );
+        header->dim[4] = frames;
+        dsOut = new DatasetFMRI( QDir( name ), out, header );
+    }
+    else
+    {
+        dsOut = new DatasetScalar( QDir( name ), out, writer.createHeader( 1 ) );
+        dsOut->copyPropertyObject( ( ds->properties( "maingl" ) ), "maingl" );
+    }
     dsOut->properties().set( Fn::Property::D_NAME, name );
 
     QList<Dataset*> l;
@@ -580,3 +280,51 @@ QList<Dataset*> ScalarAlgos::createROI( Dataset* ds )
     //l.push_back( dsOut );
     return l;
 }
+
+QList<Dataset*> ScalarAlgos::connectedComponents( Dataset* ds )
+{
+    PropertyGroup& props = ds->properties( "maingl" );
+    float lower = props.get( Fn::Property::D_LOWER_THRESHOLD ).toFloat();
+    float upper = props.get( Fn::Property::D_UPPER_THRESHOLD ).toFloat();
+    return components( ds, lower, upper, 26 );
+}
+
+QList<Dataset*> ScalarAlgos::connectedComponents( Dataset* ds, float threshold, int connectivity )
+{
+    return components( ds, threshold, std::numeric_limits<float>::max(), connectivity );
+}
+
+QList<Dataset*> ScalarAlgos::components( Dataset* ds, float lower, float upper, int connectivity )
+{
+    PropertyGroup& props = ds->properties( "maingl" );
+    int nx = props.get( Fn::Property::D_NX ).toInt();
+    int ny = props.get( Fn::Property::D_NY ).toInt();
+    int nz = props.get( Fn::Property::D_NZ ).toInt();
+
+    std::vector<float>* data = static_cast<DatasetScalar*>( ds )->getData();
+    std::vector<bool> mask( data->size() );
+    for ( unsigned int i = 0; i < data->size(); ++i )
+    {
+        mask[i] = data->at( i ) >= lower && data->at( i ) <= upper;
+    }
+
+    ConnectedComponents cc;
+    if ( !cc.labelVolume( mask, nx, ny, nz, connectivity ) )
+    {
+        qCritical() << "connected components: connectivity must be 6, 18 or 26, not" << connectivity;
+        return QList<Dataset*>();
+    }
+    cc.removeSmallerThan( Models::getGlobal( Fn::Property::G_MIN_COMPONENT_SIZE ).toInt() );
+
+    const std::vector<int>& labels = cc.labels();
+    std::vector<float> out( labels.begin(), labels.end() );
+
+    QString name = props.get( Fn::Property::D_NAME ).toString() + " (components)";
+    Writer writer( ds, QFileInfo() );
+    DatasetComponents* dsOut = new DatasetComponents( QDir( name ), out, writer.createHeader( 1 ), cc.components() );
+    dsOut->properties().set( Fn::Property::D_NAME, name );
+
+    QList<Dataset*> l;
+    l.push_back( dsOut );
+    return l;
+}
@@ -21,14 +21,20 @@ public:
     static QList<Dataset*> isoSurface( Dataset* ds, float isoValue = -1 );
     static QList<Dataset*> isoLine( Dataset* ds, float isoValue = -1 );
     static QList<Dataset*> distanceMap( Dataset* ds );
+    static QList<Dataset*> signedDistanceMap( Dataset* ds, float threshold = -1 );
     static QList<Dataset*> gauss( Dataset* ds );
     static QList<Dataset*> median( Dataset* ds );
     static QList<Dataset*> createROI( Dataset* ds );
+    // voxels between the lower and upper threshold of the dataset are foreground
+    static QList<Dataset*> connectedComponents( Dataset* ds );
+    // voxels at or above the threshold are foreground, connectivity is 6, 18 or 26
+    static QList<Dataset*> connectedComponents( Dataset* ds, float threshold, int connectivity = 26 );
 
     static QList<Dataset*> createNew( Dataset* ds );
 
 private:
-    static double xxgauss(double x, double sigma);
+    static QList<Dataset*> filter( Dataset* ds, bool median );
+    static QList<Dataset*> components( Dataset* ds, float lower, float upper, int connectivity );
 };
 
 #endif /* SCALARALGOS_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "sdthread.h"
+#include "trace.h"
 
 #include "../data/datasets/datasetdwi.h"
 
@@ -31,6 +32,8 @@ SDThread::~SDThread()
 
 void SDThread::run()
 {
+    TRACE_SCOPE( "SDThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
     int progressCounter = 0;
 
@@ -8,6 +8,7 @@
 #include "sharpqballthread.h"
 
 #include "fmath.h"
+#include "trace.h"
 #include "../data/datasets/datasetdwi.h"
 
 #include "../gui/gl/glfunctions.h"
@@ -37,6 +38,8 @@ std::vector<ColumnVector>& SharpQBallThread::getQBallVector()
 
 void SharpQBallThread::run()
 {
+    TRACE_SCOPE( "SharpQBallThread::run" );
+
     std::vector<QVector3D> bvecs = m_ds->getBvecs();
 
     Matrix gradients( bvecs.size(), 3 );
@@ -0,0 +1,274 @@
+/*
+ * connectedcomponents_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "../../io/test/check.h"
+
+#include "../connectedcomponents.h"
+
+#include "../../gui/gl/glfunctions.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace
+{
+    // fixed sequence, so a failure can be reproduced
+    unsigned int seed = 4711;
+
+    float next()
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return ( seed >> 8 ) / 16777216.0f;
+    }
+
+    struct Volume
+    {
+        int nx;
+        int ny;
+        int nz;
+        std::vector<bool> mask;
+
+        Volume( int x, int y, int z ) :
+            nx( x ),
+            ny( y ),
+            nz( z ),
+            mask( x * y * z, false )
+        {
+        }
+
+        int id( int x, int y, int z )
+        {
+            return x + nx * ( y + ny * z );
+        }
+
+        void box( int x0, int y0, int z0, int x1, int y1, int z1 )
+        {
+            for ( int z = z0; z < z1; ++z )
+            {
+                for ( int y = y0; y < y1; ++y )
+                {
+                    for ( int x = x0; x < x1; ++x )
+                    {
+                        mask[id( x, y, z )] = true;
+                    }
+                }
+            }
+        }
+    };
+
+    // breadth first flood fill as reference, labels from 1 in order of appearance
+    std::vector<int> floodFill( Volume& v, int connectivity, std::vector<unsigned int>& sizes )
+    {
+        std::vector<int> labels( v.mask.size(), 0 );
+        sizes.clear();
+        std::vector<int> queue;
+        for ( unsigned int start = 0; start < v.mask.size(); ++start )
+        {
+            if ( !v.mask[start] || labels[start] != 0 )
+            {
+                continue;
+            }
+            sizes.push_back( 0 );
+            int label = sizes.size();
+            labels[start] = label;
+            queue.assign( 1, start );
+            for ( unsigned int q = 0; q < queue.size(); ++q )
+            {
+                ++sizes.back();
+                int id = queue[q];
+                int x = id % v.nx;
+                int y = ( id / v.nx ) % v.ny;
+                int z = id / ( v.nx * v.ny );
+                for ( int dz = -1; dz <= 1; ++dz )
+                {
+                    for ( int dy = -1; dy <= 1; ++dy )
+                    {
+                        for ( int dx = -1; dx <= 1; ++dx )
+                        {
+                            int nonZero = ( dx != 0 ) + ( dy != 0 ) + ( dz != 0 );
+                            if ( nonZero == 0 || ( connectivity == 6 && nonZero > 1 ) || ( connectivity == 18 && nonZero > 2 ) )
+                            {
+                                continue;
+                            }
+                            int xx = x + dx;
+                            int yy = y + dy;
+                            int zz = z + dz;
+                            if ( xx < 0 || xx >= v.nx || yy < 0 || yy >= v.ny || zz < 0 || zz >= v.nz )
+                            {
+                                continue;
+                            }
+                            int n = v.id( xx, yy, zz );
+                            if ( v.mask[n] && labels[n] == 0 )
+                            {
+                                labels[n] = label;
+                                queue.push_back( n );
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return labels;
+    }
+
+    // same partition as the flood fill, components sorted by size with matching sizes and bounding boxes
+    void checkAgainstFloodFill( Volume& v, int connectivity, QString what )
+    {
+        std::vector<unsigned int> sizes;
+        std::vector<int> reference = floodFill( v, connectivity, sizes );
+
+        ConnectedComponents cc;
+        CHECK( cc.labelVolume( v.mask, v.nx, v.ny, v.nz, connectivity ), what );
+        const std::vector<int>& labels = cc.labels();
+        const std::vector<ConnectedComponents::Component>& components = cc.components();
+
+        CHECK( cc.numComponents() == sizes.size(), what << cc.numComponents() << sizes.size() );
+        if ( cc.numComponents() != sizes.size() )
+        {
+            return;
+        }
+
+        std::vector<int> map( sizes.size() + 1, -1 );
+        std::vector<unsigned int> counted( sizes.size() + 1, 0 );
+        bool partition = true;
+        for ( unsigned int i = 0; i < labels.size(); ++i )
+        {
+            if ( ( labels[i] == 0 ) != ( reference[i] == 0 ) )
+            {
+                partition = false;
+                continue;
+            }
+            if ( reference[i] == 0 )
+            {
+                continue;
+            }
+            if ( map[reference[i]] == -1 )
+            {
+                map[reference[i]] = labels[i];
+            }
+            partition &= map[reference[i]] == labels[i];
+            ++counted[labels[i]];
+        }
+        CHECK( partition, what );
+
+        std::vector<unsigned int> sorted( sizes );
+        std::sort( sorted.begin(), sorted.end(), std::greater<unsigned int>() );
+        for ( unsigned int i = 0; i < components.size(); ++i )
+        {
+            CHECK( components[i].size == sorted[i], what << "component" << i + 1 << components[i].size << sorted[i] );
+            CHECK( counted[i + 1] == components[i].size, what << "component" << i + 1 << counted[i + 1] );
+        }
+    }
+
+    // two boxes, a diagonal pair touching at an edge and one touching at a corner
+    void checkKnownVolume()
+    {
+        Volume v( 16, 12, 10 );
+        v.box( 1, 1, 1, 5, 5, 5 );
+        v.box( 8, 1, 1, 11, 4, 4 );
+        v.mask[v.id( 2, 8, 2 )] = true;
+        v.mask[v.id( 3, 9, 2 )] = true;
+        v.mask[v.id( 8, 8, 6 )] = true;
+        v.mask[v.id( 9, 9, 7 )] = true;
+
+        int connectivity[] = { 6, 18, 26 };
+        unsigned int expected[] = { 6, 5, 4 };
+        for ( int c = 0; c < 3; ++c )
+        {
+            ConnectedComponents cc;
+            QString what = QString::number( connectivity[c] ) + " connected boxes";
+            CHECK( cc.labelVolume( v.mask, v.nx, v.ny, v.nz, connectivity[c] ), what );
+            CHECK( cc.numComponents() == expected[c], what << cc.numComponents() );
+            if ( cc.numComponents() != expected[c] )
+            {
+                continue;
+            }
+            const std::vector<int>& labels = cc.labels();
+            CHECK( cc.components()[0].size == 64 && labels[v.id( 1, 1, 1 )] == 1 && labels[v.id( 4, 4, 4 )] == 1, what );
+            CHECK( cc.components()[1].size == 27 && labels[v.id( 10, 3, 3 )] == 2, what );
+            CHECK( cc.components()[0].min[0] == 1 && cc.components()[0].max[0] == 4, what );
+            CHECK( cc.components()[1].min[0] == 8 && cc.components()[1].max[2] == 3, what );
+            CHECK( labels[0] == 0 && labels[v.id( 6, 6, 6 )] == 0, what );
+            bool edgePair = labels[v.id( 2, 8, 2 )] == labels[v.id( 3, 9, 2 )];
+            bool cornerPair = labels[v.id( 8, 8, 6 )] == labels[v.id( 9, 9, 7 )];
+            CHECK( edgePair == ( connectivity[c] >= 18 ), what );
+            CHECK( cornerPair == ( connectivity[c] == 26 ), what );
+
+            cc.removeSmallerThan( 2 );
+            CHECK( cc.numComponents() == expected[c] - ( connectivity[c] == 6 ? 4 : connectivity[c] == 18 ? 2 : 0 ), what << cc.numComponents() );
+            // equal sizes keep the order of appearance
+            CHECK( labels[v.id( 3, 9, 2 )] == ( connectivity[c] >= 18 ? 3 : 0 ), what );
+            CHECK( labels[v.id( 8, 8, 6 )] == ( connectivity[c] == 26 ? 4 : 0 ), what );
+            CHECK( labels[v.id( 10, 3, 3 )] == 2, what );
+
+            cc.keepLargest( 1 );
+            CHECK( cc.numComponents() == 1 && labels[v.id( 10, 3, 3 )] == 0 && labels[v.id( 4, 4, 4 )] == 1, what );
+        }
+
+        ConnectedComponents cc;
+        CHECK( !cc.labelVolume( v.mask, v.nx, v.ny, v.nz, 8 ), "connectivity 8 is rejected" );
+        CHECK( !cc.labelVolume( v.mask, v.nx, v.ny, v.nz, 0 ), "connectivity 0 is rejected" );
+    }
+
+    // random masks around the percolation threshold give many components of all sizes and shapes
+    void checkRandomVolume()
+    {
+        int numThreads = GLFunctions::idealThreadCount;
+
+        Volume v( 37, 29, 23 );
+        for ( unsigned int i = 0; i < v.mask.size(); ++i )
+        {
+            v.mask[i] = next() < 0.3f;
+        }
+
+        int connectivity[] = { 6, 18, 26 };
+        for ( int c = 0; c < 3; ++c )
+        {
+            GLFunctions::idealThreadCount = 1;
+            ConnectedComponents single;
+            single.labelVolume( v.mask, v.nx, v.ny, v.nz, connectivity[c] );
+            single.removeSmallerThan( 3 );
+
+            int threads[] = { 1, 3, 8 };
+            for ( int t = 0; t < 3; ++t )
+            {
+                GLFunctions::idealThreadCount = threads[t];
+                QString what = QString::number( connectivity[c] ) + " connected random volume, " + QString::number( threads[t] ) + " threads";
+                checkAgainstFloodFill( v, connectivity[c], what );
+
+                ConnectedComponents multi;
+                multi.labelVolume( v.mask, v.nx, v.ny, v.nz, connectivity[c] );
+                multi.removeSmallerThan( 3 );
+                CHECK( multi.labels() == single.labels(), what );
+                CHECK( multi.numComponents() == single.numComponents(), what );
+
+                bool sizes = true;
+                for ( unsigned int i = 0; i < multi.numComponents(); ++i )
+                {
+                    sizes &= multi.components()[i].size >= 3;
+                    sizes &= i == 0 || multi.components()[i].size <= multi.components()[i - 1].size;
+                }
+                CHECK( sizes, what );
+            }
+        }
+        GLFunctions::idealThreadCount = numThreads;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    checkKnownVolume();
+    checkRandomVolume();
+
+    qDebug() << "connectedcomponents_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
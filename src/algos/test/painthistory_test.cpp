@@ -0,0 +1,205 @@
+/*
+ * painthistory_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "../../io/test/check.h"
+
+#include "../frameconverter.h"
+#include "../painthistory.h"
+
+#include <QCoreApplication>
+
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    // fixed sequence, so a failure can be reproduced
+    unsigned int seed = 4711;
+
+    float next( float min, float max )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return min + ( max - min ) * ( seed >> 8 ) / 16777216.0f;
+    }
+
+    // odd sizes, so the last bricks and the texture rows don't line up
+    const int NX = 37;
+    const int NY = 29;
+    const int NZ = 23;
+
+    bool same( const std::vector<float>& a, const std::vector<float>& b )
+    {
+        return a.size() == b.size() && memcmp( &a[0], &b[0], a.size() * sizeof( float ) ) == 0;
+    }
+
+    // what the paint tool does for a spherical brush, touch every voxel before it changes
+    void paintSphere( PaintHistory& history, std::vector<float>& data, int cx, int cy, int cz, int r, float value )
+    {
+        for ( int z = cz - r; z <= cz + r; ++z )
+        {
+            for ( int y = cy - r; y <= cy + r; ++y )
+            {
+                for ( int x = cx - r; x <= cx + r; ++x )
+                {
+                    if ( x < 0 || x >= NX || y < 0 || y >= NY || z < 0 || z >= NZ
+                         || ( x - cx ) * ( x - cx ) + ( y - cy ) * ( y - cy ) + ( z - cz ) * ( z - cz ) > r * r )
+                    {
+                        continue;
+                    }
+                    history.touch( x, y, z );
+                    data[x + NX * ( y + NY * z )] = value;
+                }
+            }
+        }
+        history.endStroke();
+    }
+
+    void packAll( const std::vector<float>& data, std::vector<unsigned char>& out )
+    {
+        int min[3] = { 0, 0, 0 };
+        int max[3] = { NX - 1, NY - 1, NZ - 1 };
+        out.resize( NX * NY * NZ * 4 );
+        FrameConverter::toPackedRGBA( &data[0], NX, NY, min, max, -1.0f, 2.0f, &out[0] );
+    }
+
+    // the dirty box holds every changed voxel, packed on its own and put into the previous texture it
+    // gives the same bytes as packing the whole volume again
+    void checkDirtyBox( PaintHistory& history, const std::vector<float>& before, const std::vector<float>& after, QString what )
+    {
+        int min[3];
+        int max[3];
+        bool dirty = history.takeDirty( min, max );
+        CHECK( dirty, what );
+        if ( !dirty )
+        {
+            return;
+        }
+        int unused[3];
+        CHECK( !history.takeDirty( unused, unused ), what << "dirty box taken twice" );
+
+        bool inside = true;
+        for ( int z = 0; z < NZ; ++z )
+        {
+            for ( int y = 0; y < NY; ++y )
+            {
+                for ( int x = 0; x < NX; ++x )
+                {
+                    int id = x + NX * ( y + NY * z );
+                    if ( memcmp( &before[id], &after[id], sizeof( float ) ) != 0 )
+                    {
+                        inside &= x >= min[0] && x <= max[0] && y >= min[1] && y <= max[1] && z >= min[2] && z <= max[2];
+                    }
+                }
+            }
+        }
+        CHECK( inside, what << "changed voxel outside the dirty box" );
+
+        std::vector<unsigned char> texture;
+        packAll( before, texture );
+        int sx = max[0] - min[0] + 1;
+        int sy = max[1] - min[1] + 1;
+        int sz = max[2] - min[2] + 1;
+        std::vector<unsigned char> box( sx * sy * sz * 4 );
+        FrameConverter::toPackedRGBA( &after[0], NX, NY, min, max, -1.0f, 2.0f, &box[0] );
+        for ( int z = 0; z < sz; ++z )
+        {
+            for ( int y = 0; y < sy; ++y )
+            {
+                int offset = ( min[0] + NX * ( min[1] + y + NY * ( min[2] + z ) ) ) * 4;
+                memcpy( &texture[offset], &box[( sx * ( y + sy * z ) ) * 4], sx * 4 );
+            }
+        }
+        std::vector<unsigned char> full;
+        packAll( after, full );
+        CHECK( texture == full, what << "dirty box upload differs from a full repack" );
+    }
+
+    void checkUndoRedo()
+    {
+        std::vector<float> data( NX * NY * NZ );
+        for ( unsigned int i = 0; i < data.size(); ++i )
+        {
+            data[i] = next( -1.0f, 2.0f );
+        }
+        PaintHistory history( &data, NX, NY, NZ, 8 );
+
+        // brushes across brick borders and the volume border
+        int brushes[4][4] = { { 10, 10, 10, 4 }, { 15, 12, 9, 6 }, { 36, 28, 22, 5 }, { 0, 5, 20, 3 } };
+        std::vector<std::vector<float> > states( 1, data );
+        for ( int i = 0; i < 4; ++i )
+        {
+            paintSphere( history, data, brushes[i][0], brushes[i][1], brushes[i][2], brushes[i][3], 0.25f * i );
+            checkDirtyBox( history, states.back(), data, "stroke " + QString::number( i ) );
+            states.push_back( data );
+        }
+
+        for ( int i = 3; i >= 0; --i )
+        {
+            CHECK( history.undo(), "undo" << i );
+            CHECK( same( data, states[i] ), "undo" << i << "restores the volume" );
+            checkDirtyBox( history, states[i + 1], data, "undo " + QString::number( i ) );
+        }
+        CHECK( !history.undo(), "nothing left to undo" );
+
+        for ( int i = 1; i <= 4; ++i )
+        {
+            CHECK( history.redo(), "redo" << i );
+            CHECK( same( data, states[i] ), "redo" << i << "restores the volume" );
+            checkDirtyBox( history, states[i - 1], data, "redo " + QString::number( i ) );
+        }
+        CHECK( !history.redo(), "nothing left to redo" );
+
+        // a new stroke after an undo drops the redo steps
+        history.undo();
+        history.undo();
+        paintSphere( history, data, 20, 20, 5, 3, 1.5f );
+        CHECK( !history.redo(), "new stroke drops redo" );
+        CHECK( history.undo() && same( data, states[2] ), "undo of the new stroke" );
+    }
+
+    void checkStepLimit()
+    {
+        std::vector<float> data( NX * NY * NZ, 0.0f );
+        PaintHistory history( &data, NX, NY, NZ );
+
+        // one voxel per stroke, so each state is told apart by its count of painted voxels
+        std::vector<std::vector<float> > states( 1, data );
+        for ( int i = 0; i < 40; ++i )
+        {
+            history.touch( i % NX, ( i * 7 ) % NY, ( i * 3 ) % NZ );
+            data[i % NX + NX * ( ( i * 7 ) % NY + NY * ( ( i * 3 ) % NZ ) )] = 1.0f + i;
+            history.endStroke();
+            states.push_back( data );
+        }
+
+        int undone = 0;
+        while ( history.undo() )
+        {
+            ++undone;
+        }
+        CHECK( undone == 32, "undo steps" << undone );
+        CHECK( same( data, states[40 - 32] ), "the oldest steps are gone" );
+
+        int redone = 0;
+        while ( history.redo() )
+        {
+            ++redone;
+        }
+        CHECK( redone == 32 && same( data, states[40] ), "redo steps" << redone );
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    checkUndoRedo();
+    checkStepLimit();
+
+    qDebug() << "painthistory_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
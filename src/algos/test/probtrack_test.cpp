@@ -0,0 +1,241 @@
+/*
+ * probtrack_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "../../io/test/check.h"
+
+#include "../fmath.h"
+#include "../probtrack.h"
+
+#include "../../data/mesh/tesselation.h"
+#include "../../gui/gl/glfunctions.h"
+
+#include <QCoreApplication>
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    const int N = 40;
+    const int NZ = 5;
+
+    // one bundle runs along x through the voxels with 18 <= y < 22, the other along y through 18 <= x < 22
+    bool inBundleX( int x, int y )
+    {
+        return y >= 18 && y < 22;
+    }
+
+    bool inBundleY( int x, int y )
+    {
+        return x >= 18 && x < 22;
+    }
+
+    int id( int x, int y, int z )
+    {
+        return x + N * ( y + N * z );
+    }
+
+    // prolate tensor with fa 0.8 along x, y or both, isotropic below the stopping anisotropy elsewhere
+    Matrix tensor( bool alongX, bool alongY )
+    {
+        const float l1 = 1.7e-3f;
+        const float l2 = 0.3e-3f;
+        const float iso = 0.7e-3f;
+
+        Matrix t( 3, 3 );
+        t = 0.0;
+        t( 1, 1 ) = ( alongX || alongY ) ? ( alongX ? l1 : l2 ) : iso;
+        t( 2, 2 ) = ( alongX || alongY ) ? ( alongY ? l1 : l2 ) : iso;
+        t( 3, 3 ) = ( alongX || alongY ) ? l2 : iso;
+        if ( alongX && alongY )
+        {
+            t( 1, 1 ) = ( l1 + l2 ) / 2;
+            t( 2, 2 ) = ( l1 + l2 ) / 2;
+        }
+        return t;
+    }
+
+    // single tensors, the crossing is the mean of both bundles
+    std::vector<Matrix> tensors()
+    {
+        std::vector<Matrix> out( N * N * NZ );
+        for ( int z = 0; z < NZ; ++z )
+        {
+            for ( int y = 0; y < N; ++y )
+            {
+                for ( int x = 0; x < N; ++x )
+                {
+                    out[id( x, y, z )] = tensor( inBundleX( x, y ), inBundleY( x, y ) );
+                }
+            }
+        }
+        return out;
+    }
+
+    // order 8 fit of the odf of two equally weighted tensors in the crossing, of one tensor in the
+    // bundles and a constant odf elsewhere
+    std::vector<ColumnVector> odfs()
+    {
+        const int order = 8;
+        const Matrix* vertices = tess::vertices( 3 );
+        Matrix base = FMath::sh_base( *vertices, order );
+        Matrix fit = FMath::pseudoInverse( base );
+
+        Matrix inverse[2] = { tensor( true, false ).i(), tensor( false, true ).i() };
+
+        std::vector<ColumnVector> out( N * N * NZ );
+        for ( int y = 0; y < N; ++y )
+        {
+            for ( int x = 0; x < N; ++x )
+            {
+                bool along[2] = { inBundleX( x, y ), inBundleY( x, y ) };
+                ColumnVector odf( vertices->Nrows() );
+                odf = 1.0;
+                if ( along[0] || along[1] )
+                {
+                    odf = 0.0;
+                    for ( int k = 0; k < 2; ++k )
+                    {
+                        if ( !along[k] )
+                        {
+                            continue;
+                        }
+                        for ( int i = 1; i <= vertices->Nrows(); ++i )
+                        {
+                            ColumnVector d = vertices->Row( i ).t();
+                            double q = ( d.t() * inverse[k] * d ).AsScalar();
+                            odf( i ) += 1.0 / pow( q, 1.5 );
+                        }
+                    }
+                }
+                ColumnVector coeffs = fit * odf;
+                coeffs /= coeffs( 1 );
+                for ( int z = 0; z < NZ; ++z )
+                {
+                    out[id( x, y, z )] = coeffs;
+                }
+            }
+        }
+        return out;
+    }
+
+    ProbTrack* createTracker( std::vector<Matrix>* tensors, std::vector<ColumnVector>* coeffs )
+    {
+        ProbTrack* track = new ProbTrack( N, N, NZ, 1, 1, 1 );
+        if ( tensors )
+        {
+            track->setTensors( *tensors );
+        }
+        else
+        {
+            track->setSH( *coeffs );
+            track->setSharpness( 4 );
+        }
+        track->setSeed( 1234 );
+        track->setSamplesPerSeed( 4 );
+        track->setFiberSamples( 2 );
+        track->setMinLength( 5 );
+        return track;
+    }
+
+    // the random stream of a sample only depends on seed and sample number, so neither fibers nor
+    // visits may change with the number of threads
+    void checkThreads( std::vector<Matrix>* tensors, std::vector<ColumnVector>* coeffs )
+    {
+        int numThreads = GLFunctions::idealThreadCount;
+        QString model = tensors ? "tensors" : "sh";
+
+        GLFunctions::idealThreadCount = 1;
+        ProbTrack* single = createTracker( tensors, coeffs );
+        single->run();
+
+        int threads[] = { 3, 8 };
+        for ( int t = 0; t < 2; ++t )
+        {
+            GLFunctions::idealThreadCount = threads[t];
+            ProbTrack* multi = createTracker( tensors, coeffs );
+            multi->run();
+
+            QString what = model + ", " + QString::number( threads[t] ) + " threads";
+            CHECK( multi->numSamples() == single->numSamples(), what );
+            CHECK( *multi->density() == *single->density(), what );
+
+            std::vector<Fib>* a = single->fibs();
+            std::vector<Fib>* b = multi->fibs();
+            CHECK( a->size() > 0, what );
+            CHECK( a->size() == b->size(), what << a->size() << b->size() );
+            for ( unsigned int i = 0; i < a->size() && i < b->size(); ++i )
+            {
+                const std::vector<QVector3D>& va = *a->at( i ).getVerts();
+                const std::vector<QVector3D>& vb = *b->at( i ).getVerts();
+                bool same = va.size() == vb.size() && memcmp( &va[0], &vb[0], va.size() * sizeof( QVector3D ) ) == 0
+                            && *a->at( i ).getDataField( 0 ) == *b->at( i ).getDataField( 0 );
+                CHECK( same, what << "fiber" << i );
+            }
+            delete multi;
+        }
+        delete single;
+        GLFunctions::idealThreadCount = numThreads;
+    }
+
+    // samples seeded at the start of either bundle must go on through the crossing to its far end,
+    // more of them than turn into the other bundle
+    void checkCrossing( std::vector<ColumnVector>& coeffs )
+    {
+        for ( int b = 0; b < 2; ++b )
+        {
+            std::vector<int> seeds;
+            for ( int z = 0; z < NZ; ++z )
+            {
+                for ( int k = 18; k < 22; ++k )
+                {
+                    seeds.push_back( b == 0 ? id( 3, k, z ) : id( k, 3, z ) );
+                }
+            }
+
+            ProbTrack* track = createTracker( 0, &coeffs );
+            track->setSamplesPerSeed( 50 );
+            track->run( seeds );
+            std::vector<float>& density = *track->density();
+
+            // samples through cross sections of the seeded bundle before and after the crossing and
+            // through both arms of the other one
+            float before = 0;
+            float after = 0;
+            float turned = 0;
+            for ( int z = 0; z < NZ; ++z )
+            {
+                for ( int k = 18; k < 22; ++k )
+                {
+                    before += density[b == 0 ? id( 12, k, z ) : id( k, 12, z )];
+                    after += density[b == 0 ? id( 30, k, z ) : id( k, 30, z )];
+                    turned += density[b == 0 ? id( k, 10, z ) : id( 10, k, z )];
+                    turned += density[b == 0 ? id( k, 30, z ) : id( 30, k, z )];
+                }
+            }
+            QString what = b == 0 ? "bundle along x" : "bundle along y";
+            CHECK( before > 0.5f * seeds.size() * 50, what << before );
+            CHECK( after > 0.5f * before, what << before << after );
+            CHECK( turned < 0.5f * after, what << after << turned );
+            delete track;
+        }
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    std::vector<Matrix> t = tensors();
+    std::vector<ColumnVector> c = odfs();
+    checkThreads( &t, 0 );
+    checkThreads( 0, &c );
+    checkCrossing( c );
+
+    qDebug() << "probtrack_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
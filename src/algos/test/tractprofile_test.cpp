@@ -0,0 +1,242 @@
+/*
+ * tractprofile_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "../../io/test/check.h"
+
+#include "../tractprofile.h"
+#include "../volumesampler.h"
+
+#include "../../gui/gl/glfunctions.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // fixed sequence, so a failure can be reproduced
+    unsigned int seed = 4711;
+
+    float next( float min, float max )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return min + ( max - min ) * ( seed >> 8 ) / 16777216.0f;
+    }
+
+    // 45 x 40 x 40 voxels of 2 x 1 x 1 mm, the first volume rises along x with 2 * x + 3,
+    // the second falls along y with 100 - y, both in world coordinates
+    const int NX = 45;
+    const int NY = 40;
+    const int NZ = 40;
+
+    std::vector<float> gradient( bool alongX )
+    {
+        std::vector<float> data( NX * NY * NZ );
+        for ( int z = 0; z < NZ; ++z )
+        {
+            for ( int y = 0; y < NY; ++y )
+            {
+                for ( int x = 0; x < NX; ++x )
+                {
+                    data[x + NX * ( y + NY * z )] = alongX ? 2.0f * ( x * 2.0f ) + 3.0f : 100.0f - y;
+                }
+            }
+        }
+        return data;
+    }
+
+    // straight fiber from start to end with irregular vertex spacing, so only arc length resampling puts
+    // the nodes at the same places
+    Fib line( QVector3D start, QVector3D end, bool reversed )
+    {
+        std::vector<float> steps( 1, 0.0f );
+        while ( steps.size() < 3 || steps.back() < 1.0f )
+        {
+            steps.push_back( steps.back() + next( 0.005f, 0.15f ) );
+        }
+        Fib fib;
+        for ( unsigned int i = 0; i < steps.size(); ++i )
+        {
+            float t = qMin( 1.0f, steps[reversed ? steps.size() - 1 - i : i] );
+            fib.addVert( start * ( 1.0f - t ) + end * t, 0.0f );
+        }
+        return fib;
+    }
+
+    bool near( float a, float b, float tolerance = 1e-3f )
+    {
+        return qAbs( a - b ) <= tolerance * qMax( 1.0f, qAbs( b ) );
+    }
+
+    void checkResample()
+    {
+        Fib fib;
+        fib.addVert( QVector3D( 0, 0, 0 ), 0 );
+        fib.addVert( QVector3D( 0.5f, 0, 0 ), 0 );
+        fib.addVert( QVector3D( 3, 0, 0 ), 0 );
+        fib.addVert( QVector3D( 3, 1, 0 ), 0 );
+
+        float nodes[15];
+        TractProfile::resample( fib, 5, nodes );
+        float expected[15] = { 0, 0, 0, 1, 0, 0, 2, 0, 0, 3, 0, 0, 3, 1, 0 };
+        bool ok = true;
+        for ( int i = 0; i < 15; ++i )
+        {
+            ok &= near( nodes[i], expected[i] );
+        }
+        CHECK( ok, "equal arc length nodes on a bent fiber" );
+    }
+
+    // one bundle along x, every other fiber stored from the far end, profiled on the x gradient
+    void checkStraightBundle()
+    {
+        const int nodes = 21;
+        std::vector<Fib> fibs;
+        for ( int i = 0; i < 40; ++i )
+        {
+            float y = next( 15.0f, 25.0f );
+            float z = next( 15.0f, 25.0f );
+            fibs.push_back( line( QVector3D( 4, y, z ), QVector3D( 84, y, z ), i % 2 == 1 ) );
+        }
+
+        std::vector<float> data = gradient( true );
+        VolumeSampler sampler( data.data(), NX, NY, NZ, 2, 1, 1 );
+        TractProfile profile( nodes );
+        std::vector<float> values;
+        std::vector<float> means;
+        std::vector<float> stdDevs;
+        profile.profile( fibs, &sampler, values, means, stdDevs );
+
+        CHECK( means.size() == nodes && stdDevs.size() == nodes, "straight bundle" );
+        CHECK( values.size() == fibs.size() * nodes, "straight bundle" );
+        CHECK( profile.numBundles() == 1 && profile.bundleSizes()[0] == 40, "straight bundle" );
+
+        // node k is at x = 4 + 4k for every fiber, in the orientation of the first one
+        for ( int k = 0; k < nodes && k < (int)means.size(); ++k )
+        {
+            float expected = 2.0f * ( 4.0f + 4.0f * k ) + 3.0f;
+            CHECK( near( means[k], expected ), "straight bundle node" << k << means[k] << expected );
+            CHECK( stdDevs[k] < 1e-2f, "straight bundle node" << k << stdDevs[k] );
+            CHECK( near( profile.centers()[k * 3], 4.0f + 4.0f * k ), "straight bundle center" << k );
+        }
+        bool aligned = true;
+        for ( unsigned int i = 0; i < fibs.size() && values.size() == fibs.size() * nodes; ++i )
+        {
+            aligned &= near( values[i * nodes], 11.0f ) && near( values[i * nodes + nodes - 1], 171.0f );
+        }
+        CHECK( aligned, "reversed fibers are flipped" );
+
+        // starting the bundle with a reversed fiber turns the whole profile around
+        std::reverse( fibs.begin(), fibs.end() );
+        profile.profile( fibs, &sampler, values, means, stdDevs );
+        CHECK( near( means[0], 171.0f ) && near( means[nodes - 1], 11.0f ), "reversed reference" << means[0] << means[nodes - 1] );
+    }
+
+    // a bundle along x and one along y on both gradients, plus fibers that belong to no bundle
+    void checkBundles()
+    {
+        const int nodes = 11;
+        std::vector<Fib> fibs;
+        std::vector<int> assignment;
+        for ( int i = 0; i < 60; ++i )
+        {
+            float a = next( 15.0f, 25.0f );
+            float b = next( 15.0f, 25.0f );
+            int bundle = i % 3 - 1;
+            assignment.push_back( bundle );
+            if ( bundle == 0 )
+            {
+                fibs.push_back( line( QVector3D( 4, a, b ), QVector3D( 84, a, b ), i % 2 == 1 ) );
+            }
+            else if ( bundle == 1 )
+            {
+                fibs.push_back( line( QVector3D( 2 * a, 2, b ), QVector3D( 2 * a, 32, b ), i % 2 == 1 ) );
+            }
+            else
+            {
+                fibs.push_back( line( QVector3D( 2 * a, a, 2 ), QVector3D( 2 * a, a, 38 ), i % 2 == 1 ) );
+            }
+        }
+
+        std::vector<float> dataX = gradient( true );
+        std::vector<float> dataY = gradient( false );
+        VolumeSampler samplerX( dataX.data(), NX, NY, NZ, 2, 1, 1 );
+        VolumeSampler samplerY( dataY.data(), NX, NY, NZ, 2, 1, 1 );
+        std::vector<VolumeSampler*> volumes;
+        volumes.push_back( &samplerX );
+        volumes.push_back( &samplerY );
+
+        TractProfile profile( nodes );
+        profile.setBundles( assignment );
+        std::vector< std::vector<float> > values;
+        std::vector< std::vector<float> > means;
+        std::vector< std::vector<float> > stdDevs;
+        profile.profile( fibs, volumes, values, means, stdDevs );
+
+        CHECK( profile.numBundles() == 2, "bundles" << profile.numBundles() );
+        CHECK( profile.bundleSizes().size() == 2 && profile.bundleSizes()[0] == 20 && profile.bundleSizes()[1] == 20, "bundle sizes" );
+        CHECK( means.size() == 2 && means[0].size() == 2 * nodes, "bundles" );
+        if ( means.size() != 2 || means[0].size() != 2 * nodes )
+        {
+            return;
+        }
+
+        // the first fiber of the x bundle is stored backward, the first of the y bundle forward
+        for ( int k = 0; k < nodes; ++k )
+        {
+            float x = 84.0f - 8.0f * k;
+            float y = 2.0f + 3.0f * k;
+            CHECK( near( means[0][k], 2.0f * x + 3.0f ), "x bundle on the x gradient, node" << k << means[0][k] );
+            CHECK( near( means[1][nodes + k], 100.0f - y ), "y bundle on the y gradient, node" << k << means[1][nodes + k] );
+            CHECK( stdDevs[0][k] < 1e-2f && stdDevs[1][nodes + k] < 1e-2f, "bundle node" << k );
+        }
+    }
+
+    // above the block size for threads, the means mustn't depend on their number
+    void checkThreads()
+    {
+        int numThreads = GLFunctions::idealThreadCount;
+
+        std::vector<Fib> fibs;
+        for ( int i = 0; i < 3000; ++i )
+        {
+            float y = next( 5.0f, 35.0f );
+            float z = next( 5.0f, 35.0f );
+            fibs.push_back( line( QVector3D( next( 2, 10 ), y, z ), QVector3D( next( 70, 86 ), y + next( -3, 3 ), z ), i % 2 == 1 ) );
+        }
+        std::vector<float> data = gradient( true );
+        VolumeSampler sampler( data.data(), NX, NY, NZ, 2, 1, 1 );
+
+        std::vector<float> values[2];
+        std::vector<float> means[2];
+        std::vector<float> stdDevs[2];
+        int threads[] = { 1, 5 };
+        for ( int t = 0; t < 2; ++t )
+        {
+            GLFunctions::idealThreadCount = threads[t];
+            TractProfile profile( 50 );
+            profile.profile( fibs, &sampler, values[t], means[t], stdDevs[t] );
+        }
+        CHECK( values[0] == values[1] && means[0] == means[1] && stdDevs[0] == stdDevs[1], "1 and 5 threads" );
+
+        GLFunctions::idealThreadCount = numThreads;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    checkResample();
+    checkStraightBundle();
+    checkBundles();
+    checkThreads();
+
+    qDebug() << "tractprofile_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
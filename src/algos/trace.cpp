@@ -0,0 +1,359 @@
+/*
+ * trace.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadStorage>
+
+#include <algorithm>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+    // count runs from 0 to 2 * BUFFER_SIZE and then wraps to BUFFER_SIZE, so it tells how many
+    // slots are valid and where the next event goes without ever overflowing
+    struct TraceBuffer
+    {
+        std::vector<Trace::Event> events;
+        QAtomicInt count;
+        bool inUse;
+    };
+
+    // owned by the thread storage, hands the buffer on to the next new thread when its thread exits,
+    // so short lived algorithm threads keep their events without growing the number of buffers
+    struct TraceHandle
+    {
+        TraceBuffer* buffer;
+        int thread;
+        ~TraceHandle();
+    };
+
+    struct FrameSummary
+    {
+        double total;
+        QList<QPair<QString, double> > parts;
+    };
+
+    struct StartedTimer
+    {
+        QElapsedTimer timer;
+        StartedTimer() { timer.start(); }
+    };
+
+    QMutex traceMutex;
+    std::vector<TraceBuffer*> traceBuffers;
+    QHash<int, QString> threadNames;
+    QHash<QString, QByteArray> internedNames;
+    QHash<QString, FrameSummary> frames;
+    QThreadStorage<TraceHandle*> handles;
+    StartedTimer traceClock;
+    int nextThread = 0;
+
+    TraceHandle::~TraceHandle()
+    {
+        QMutexLocker lock( &traceMutex );
+        buffer->inUse = false;
+    }
+
+    TraceHandle* currentHandle()
+    {
+        if ( handles.hasLocalData() )
+        {
+            return handles.localData();
+        }
+
+        TraceHandle* handle = new TraceHandle();
+        QMutexLocker lock( &traceMutex );
+        handle->buffer = 0;
+        for ( unsigned int i = 0; i < traceBuffers.size(); ++i )
+        {
+            if ( !traceBuffers[i]->inUse )
+            {
+                handle->buffer = traceBuffers[i];
+                break;
+            }
+        }
+        if ( !handle->buffer )
+        {
+            handle->buffer = new TraceBuffer();
+            handle->buffer->events.resize( Trace::BUFFER_SIZE );
+            traceBuffers.push_back( handle->buffer );
+        }
+        handle->buffer->inUse = true;
+        handle->thread = nextThread++;
+
+        QThread* thread = QThread::currentThread();
+        if ( QCoreApplication::instance() && thread == QCoreApplication::instance()->thread() )
+        {
+            threadNames[handle->thread] = "main";
+        }
+        else
+        {
+            threadNames[handle->thread] = QString( thread->metaObject()->className() ) + " " + QString::number( handle->thread );
+        }
+        lock.unlock();
+
+        handles.setLocalData( handle );
+        return handle;
+    }
+
+    void record( const char* name, const char* category, qint64 start, qint64 value, bool counter )
+    {
+        TraceHandle* handle = currentHandle();
+        TraceBuffer* buffer = handle->buffer;
+        int count = buffer->count.load();
+
+        Trace::Event& e = buffer->events[count % Trace::BUFFER_SIZE];
+        e.name = name;
+        e.category = category;
+        e.start = start;
+        e.value = value;
+        e.thread = handle->thread;
+        e.counter = counter;
+
+        ++count;
+        if ( count == 2 * (int)Trace::BUFFER_SIZE )
+        {
+            count = Trace::BUFFER_SIZE;
+        }
+        buffer->count.storeRelease( count );
+    }
+
+    bool longerPart( const QPair<QString, double>& a, const QPair<QString, double>& b )
+    {
+        return a.second > b.second;
+    }
+
+    QString escape( const char* text )
+    {
+        QString out( text );
+        out.replace( "\\", "\\\\" );
+        out.replace( "\"", "\\\"" );
+        return out;
+    }
+}
+
+const unsigned int Trace::BUFFER_SIZE;
+
+QString Trace::outputFile = "braingl_trace.json";
+
+Trace::Scope::Scope( const char* name, const char* category ) :
+    m_name( name ),
+    m_category( category ),
+    m_start( Trace::now() )
+{
+}
+
+Trace::Scope::Scope( const QString& name, const char* category ) :
+    m_name( Trace::intern( name ) ),
+    m_category( category ),
+    m_start( Trace::now() )
+{
+}
+
+Trace::Scope::~Scope()
+{
+    Trace::complete( m_name, m_category, m_start, Trace::now() - m_start );
+}
+
+Trace::Frame::Frame( const QString& target ) :
+    m_target( target ),
+    m_start( Trace::now() ),
+    m_first( currentHandle()->buffer->count.load() )
+{
+}
+
+Trace::Frame::~Frame()
+{
+    qint64 duration = Trace::now() - m_start;
+    TraceBuffer* buffer = currentHandle()->buffer;
+    unsigned int last = buffer->count.load();
+    unsigned int numEvents = ( last + BUFFER_SIZE - m_first ) % BUFFER_SIZE;
+
+    QHash<const char*, qint64> sums;
+    QList<const char*> order;
+    for ( unsigned int i = 0; i < numEvents; ++i )
+    {
+        const Event& e = buffer->events[( m_first + i ) % BUFFER_SIZE];
+        if ( e.counter || qstrcmp( e.category, "frame" ) != 0 )
+        {
+            continue;
+        }
+        if ( !sums.contains( e.name ) )
+        {
+            order.push_back( e.name );
+        }
+        sums[e.name] += e.value;
+    }
+
+    FrameSummary summary;
+    summary.total = duration / 1e6;
+    for ( int i = 0; i < order.size(); ++i )
+    {
+        summary.parts.push_back( QPair<QString, double>( QString( order[i] ), sums[order[i]] / 1e6 ) );
+    }
+    std::stable_sort( summary.parts.begin(), summary.parts.end(), longerPart );
+
+    Trace::complete( "frame", "render", m_start, duration );
+
+    QMutexLocker lock( &traceMutex );
+    frames[m_target] = summary;
+}
+
+bool Trace::isEnabled()
+{
+#ifdef __TRACE__
+    return true;
+#else
+    return false;
+#endif
+}
+
+qint64 Trace::now()
+{
+    return traceClock.timer.nsecsElapsed();
+}
+
+const char* Trace::intern( const QString& name )
+{
+    QMutexLocker lock( &traceMutex );
+    QHash<QString, QByteArray>::const_iterator it = internedNames.constFind( name );
+    if ( it == internedNames.constEnd() )
+    {
+        it = internedNames.insert( name, name.toUtf8() );
+    }
+    // the byte array is never modified, so its data stays put when the hash rehashes
+    return it.value().constData();
+}
+
+void Trace::complete( const char* name, const char* category, qint64 start, qint64 duration )
+{
+    record( name, category, start, duration, false );
+}
+
+void Trace::counter( const char* name, qint64 value )
+{
+    record( name, "counter", Trace::now(), value, true );
+}
+
+double Trace::lastFrame( const QString& target, QList<QPair<QString, double> >& parts )
+{
+    QMutexLocker lock( &traceMutex );
+    if ( !frames.contains( target ) )
+    {
+        parts.clear();
+        return 0.0;
+    }
+    parts = frames[target].parts;
+    return frames[target].total;
+}
+
+bool Trace::writeChromeTrace( QString fileName )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        qCritical() << "trace: failed to open" << fileName << "for writing";
+        return false;
+    }
+
+    QTextStream out( &file );
+    out << "{\"traceEvents\":[\n";
+
+    // threads may still be writing, events overwritten during the copy show up with odd times but are harmless
+    QMutexLocker lock( &traceMutex );
+    bool first = true;
+    QHashIterator<int, QString> tn( threadNames );
+    while ( tn.hasNext() )
+    {
+        tn.next();
+        out << ( first ? "" : ",\n" ) << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tn.key()
+            << ",\"args\":{\"name\":\"" << escape( tn.value().toUtf8().constData() ) << "\"}}";
+        first = false;
+    }
+
+    int numEvents = 0;
+    for ( unsigned int b = 0; b < traceBuffers.size(); ++b )
+    {
+        TraceBuffer* buffer = traceBuffers[b];
+        unsigned int count = buffer->count.loadAcquire();
+        unsigned int valid = qMin( count, BUFFER_SIZE );
+        unsigned int oldest = count < BUFFER_SIZE ? 0 : count % BUFFER_SIZE;
+
+        for ( unsigned int i = 0; i < valid; ++i )
+        {
+            const Event& e = buffer->events[( oldest + i ) % BUFFER_SIZE];
+            out << ( first ? "" : ",\n" );
+            first = false;
+            if ( e.counter )
+            {
+                out << "{\"name\":\"" << escape( e.name ) << "\",\"ph\":\"C\",\"ts\":" << QString::number( e.start / 1e3, 'f', 3 )
+                    << ",\"pid\":1,\"tid\":" << e.thread << ",\"args\":{\"value\":" << e.value << "}}";
+            }
+            else
+            {
+                out << "{\"name\":\"" << escape( e.name ) << "\",\"cat\":\"" << escape( e.category ) << "\",\"ph\":\"X\",\"ts\":"
+                    << QString::number( e.start / 1e3, 'f', 3 ) << ",\"dur\":" << QString::number( e.value / 1e3, 'f', 3 )
+                    << ",\"pid\":1,\"tid\":" << e.thread << "}";
+            }
+            ++numEvents;
+        }
+    }
+    out << "\n]}\n";
+    file.close();
+
+    qDebug() << "trace: wrote" << numEvents << "events to" << fileName;
+    return true;
+}
+
+void Trace::clear()
+{
+    QMutexLocker lock( &traceMutex );
+    for ( unsigned int i = 0; i < traceBuffers.size(); ++i )
+    {
+        traceBuffers[i]->count.storeRelease( 0 );
+    }
+    frames.clear();
+}
+
+quint64 Trace::peakMemory()
+{
+#ifdef Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if ( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+    {
+        return 0;
+    }
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss;
+#else
+    return static_cast<quint64>( usage.ru_maxrss ) * 1024;
+#endif
+#endif
+}
@@ -0,0 +1,96 @@
+/*
+ * trace.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/*
+ * Scoped timers and counters for the render loop and the algorithm threads. Every thread writes into
+ * its own ring buffer, so recording takes no lock, the oldest events are overwritten when a buffer
+ * is full. The macros below compile to nothing unless the build defines __TRACE__ ( cmake -DBRAINGL_TRACE=ON ).
+ */
+#ifdef __TRACE__
+#define TRACE_CONCAT_( a, b ) a##b
+#define TRACE_CONCAT( a, b ) TRACE_CONCAT_( a, b )
+#define TRACE_SCOPE( name ) Trace::Scope TRACE_CONCAT( traceScope, __LINE__ )( name )
+#define TRACE_SCOPE_CAT( name, category ) Trace::Scope TRACE_CONCAT( traceScope, __LINE__ )( name, category )
+#define TRACE_COUNTER( name, value ) Trace::counter( name, value )
+#define TRACE_FRAME( target ) Trace::Frame traceFrame( target )
+#else
+#define TRACE_SCOPE( name )
+#define TRACE_SCOPE_CAT( name, category )
+#define TRACE_COUNTER( name, value )
+#define TRACE_FRAME( target )
+#endif
+
+class Trace
+{
+public:
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        qint64 start;
+        // duration in ns for scopes, the value for counters
+        qint64 value;
+        int thread;
+        bool counter;
+    };
+
+    class Scope
+    {
+    public:
+        Scope( const char* name, const char* category = "algo" );
+        Scope( const QString& name, const char* category = "algo" );
+        ~Scope();
+
+    private:
+        const char* m_name;
+        const char* m_category;
+        qint64 m_start;
+    };
+
+    // sums the "frame" category scopes recorded by this thread while it lives, per render target
+    class Frame
+    {
+    public:
+        Frame( const QString& target );
+        ~Frame();
+
+    private:
+        QString m_target;
+        qint64 m_start;
+        unsigned int m_first;
+    };
+
+    static bool isEnabled();
+
+    static qint64 now();
+    static const char* intern( const QString& name );
+
+    static void complete( const char* name, const char* category, qint64 start, qint64 duration );
+    static void counter( const char* name, qint64 value );
+
+    // frame time and per part times in ms of the last finished frame, longest first
+    static double lastFrame( const QString& target, QList<QPair<QString, double> >& parts );
+
+    static bool writeChromeTrace( QString fileName );
+    static void clear();
+
+    // peak resident memory of the process in bytes, available without __TRACE__ as well
+    static quint64 peakMemory();
+
+    static QString outputFile;
+
+    static const unsigned int BUFFER_SIZE = 1 << 16;
+};
+
+#endif /* TRACE_H_ */
@@ -6,6 +6,7 @@
  */
 #include "trackthread.h"
 #include "fmath.h"
+#include "trace.h"
 
 #include "../gui/gl/glfunctions.h"
 
@@ -65,6 +66,8 @@ std::vector<Fib>* TrackThread::getFibs()
 
 void TrackThread::run()
 {
+    TRACE_SCOPE( "TrackThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
     int progressCounter = 0;
 
@@ -90,6 +93,7 @@ void TrackThread::run()
         ++progressCounter;
         if ( progressCounter == 100 )
         {
+            TRACE_COUNTER( "tracked fibers", m_fibs.size() );
             emit( progress() );
             progressCounter = 0;
         }
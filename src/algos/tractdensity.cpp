@@ -0,0 +1,399 @@
+/*
+ * tractdensity.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "tractdensity.h"
+#include "tractdensitythread.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TractDensity::TractDensity( const std::vector<Fib>* fibs, int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az ) :
+    m_fibs( fibs ),
+    m_nx( nx ),
+    m_ny( ny ),
+    m_nz( nz ),
+    m_dx( dx ),
+    m_dy( dy ),
+    m_dz( dz ),
+    m_ax( ax ),
+    m_ay( ay ),
+    m_az( az ),
+    m_blockSize( nx * ny * nz ),
+    m_outputs( 0 ),
+    m_colorSource( LOCAL ),
+    m_dataField( 0 ),
+    m_dataMin( 0.0f ),
+    m_dataMax( 1.0f )
+{
+}
+
+TractDensity::~TractDensity()
+{
+}
+
+void TractDensity::setColorSource( int source, int dataField, float dataMin, float dataMax, ColormapBase colormap )
+{
+    m_colorSource = source;
+    m_dataField = dataField;
+    m_dataMin = dataMin;
+    m_dataMax = dataMax;
+    m_colormap = colormap;
+}
+
+std::vector<float>* TractDensity::count()
+{
+    return &m_count;
+}
+
+std::vector<float>* TractDensity::length()
+{
+    return &m_length;
+}
+
+std::vector<float>* TractDensity::color()
+{
+    return &m_color;
+}
+
+void TractDensity::run( int outputs )
+{
+    // counts are needed to average colors
+    m_outputs = outputs | ( ( outputs & COLOR ) ? COUNT : 0 );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        m_threads.push_back( new TractDensityThread( this, TractDensityThread::TRAVERSE, m_fibs->size(), i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        m_threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        m_threads[i]->wait();
+    }
+
+    m_count.clear();
+    m_length.clear();
+    m_color.clear();
+    if ( m_outputs & COUNT )
+    {
+        m_count.resize( m_blockSize, 0 );
+    }
+    if ( m_outputs & LENGTH )
+    {
+        m_length.resize( m_blockSize, 0 );
+    }
+    if ( m_outputs & COLOR )
+    {
+        m_color.resize( m_blockSize * 3, 0 );
+    }
+
+    std::vector<TractDensityThread*> reducers;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        reducers.push_back( new TractDensityThread( this, TractDensityThread::REDUCE, m_blockSize, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        reducers[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        reducers[i]->wait();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        delete reducers[i];
+        delete m_threads[i];
+    }
+    m_threads.clear();
+}
+
+void TractDensity::fiberColor( const Fib& fib, unsigned int k, const QVector3D& dir, float* color )
+{
+    switch ( m_colorSource )
+    {
+        case LOCAL:
+        {
+            QVector3D c( fabs( dir.x() ), fabs( dir.y() ), fabs( dir.z() ) );
+            c.normalize();
+            color[0] = c.x();
+            color[1] = c.y();
+            color[2] = c.z();
+            break;
+        }
+        case GLOBAL:
+        case CUSTOM:
+        {
+            QColor c = ( m_colorSource == GLOBAL ) ? fib.globalColor() : fib.customColor();
+            color[0] = c.redF();
+            color[1] = c.greenF();
+            color[2] = c.blueF();
+            break;
+        }
+        case DATA:
+        {
+            float value = ( fib.getDataField( m_dataField )->at( k ) - m_dataMin ) / ( m_dataMax - m_dataMin );
+            QColor c = m_colormap.getColor( value );
+            color[0] = c.redF();
+            color[1] = c.greenF();
+            color[2] = c.blueF();
+            break;
+        }
+    }
+}
+
+void TractDensity::traverse( int begin, int end, TractDensityThread* thread )
+{
+    bool doCount = m_outputs & COUNT;
+    bool doLength = m_outputs & LENGTH;
+    bool doColor = m_outputs & COLOR;
+
+    if ( doCount )
+    {
+        thread->m_count.resize( m_blockSize, 0 );
+    }
+    if ( doLength )
+    {
+        thread->m_length.resize( m_blockSize, 0 );
+    }
+    if ( doColor )
+    {
+        thread->m_color.resize( m_blockSize * 3, 0 );
+    }
+    float* count = doCount ? &thread->m_count[0] : 0;
+    float* length = doLength ? &thread->m_length[0] : 0;
+    float* rgb = doColor ? &thread->m_color[0] : 0;
+
+    const float d[3] = { m_dx, m_dy, m_dz };
+    const float a[3] = { m_ax, m_ay, m_az };
+    const int n[3] = { m_nx, m_ny, m_nz };
+    const double inf = std::numeric_limits<double>::max();
+
+    // voxels touched by the current fiber, deduplicated after the fiber is done
+    std::vector<Visit> touched;
+    Visit visit;
+
+    for ( int i = begin; i < end; ++i )
+    {
+        const Fib& fib = m_fibs->at( i );
+        const std::vector<QVector3D>& verts = *fib.getVerts();
+        unsigned int numVerts = verts.size();
+        if ( numVerts == 0 )
+        {
+            continue;
+        }
+
+        touched.clear();
+        visit.voxel = -1;
+
+        unsigned int numSegments = qMax( 1u, numVerts - 1 );
+        for ( unsigned int k = 0; k < numSegments; ++k )
+        {
+            const QVector3D& p1 = verts[k];
+            const QVector3D& p2 = verts[qMin( k + 1, numVerts - 1 )];
+            QVector3D dir = p2 - p1;
+            float segLength = dir.length();
+
+            if ( doColor )
+            {
+                fiberColor( fib, k, dir, visit.color );
+            }
+
+            double u0[3] = { ( p1.x() - a[0] ) / d[0], ( p1.y() - a[1] ) / d[1], ( p1.z() - a[2] ) / d[2] };
+            double u1[3] = { ( p2.x() - a[0] ) / d[0], ( p2.y() - a[1] ) / d[1], ( p2.z() - a[2] ) / d[2] };
+
+            int cell[3];
+            int step[3];
+            double tMax[3];
+            double tDelta[3];
+            int steps = 0;
+            for ( int l = 0; l < 3; ++l )
+            {
+                double f = floor( u0[l] );
+                cell[l] = (int)f;
+                double du = u1[l] - u0[l];
+                if ( du > 0 )
+                {
+                    step[l] = 1;
+                    tDelta[l] = 1.0 / du;
+                    tMax[l] = ( f + 1.0 - u0[l] ) / du;
+                }
+                else if ( du < 0 )
+                {
+                    step[l] = -1;
+                    tDelta[l] = -1.0 / du;
+                    tMax[l] = ( u0[l] - f ) / -du;
+                }
+                else
+                {
+                    step[l] = 0;
+                    tDelta[l] = inf;
+                    tMax[l] = inf;
+                }
+                steps += abs( (int)floor( u1[l] ) - cell[l] );
+            }
+
+            double t = 0;
+            for ( int s = 0; s <= steps; ++s )
+            {
+                int axis = 0;
+                if ( tMax[1] < tMax[axis] )
+                {
+                    axis = 1;
+                }
+                if ( tMax[2] < tMax[axis] )
+                {
+                    axis = 2;
+                }
+                double tNext = ( s == steps ) ? 1.0 : qMin( 1.0, tMax[axis] );
+
+                int x = qMax( 0, qMin( cell[0], n[0] - 1 ) );
+                int y = qMax( 0, qMin( cell[1], n[1] - 1 ) );
+                int z = qMax( 0, qMin( cell[2], n[2] - 1 ) );
+                int id = x + y * m_nx + z * m_nx * m_ny;
+
+                if ( doLength )
+                {
+                    length[id] += ( tNext - t ) * segLength;
+                }
+                // consecutive visits of the same voxel are the common case
+                if ( doCount && id != visit.voxel )
+                {
+                    visit.voxel = id;
+                    visit.order = touched.size();
+                    touched.push_back( visit );
+                }
+
+                if ( s == steps )
+                {
+                    break;
+                }
+                cell[axis] += step[axis];
+                t = tNext;
+                tMax[axis] += tDelta[axis];
+            }
+        }
+
+        if ( !doCount )
+        {
+            continue;
+        }
+        // the first visit of each voxel wins
+        std::sort( touched.begin(), touched.end() );
+        for ( unsigned int k = 0; k < touched.size(); ++k )
+        {
+            if ( k > 0 && touched[k].voxel == touched[k - 1].voxel )
+            {
+                continue;
+            }
+            int id = touched[k].voxel;
+            count[id] += 1;
+            if ( doColor )
+            {
+                rgb[id * 3] += touched[k].color[0];
+                rgb[id * 3 + 1] += touched[k].color[1];
+                rgb[id * 3 + 2] += touched[k].color[2];
+            }
+        }
+    }
+}
+
+void TractDensity::reduce( int begin, int end )
+{
+    for ( unsigned int t = 0; t < m_threads.size(); ++t )
+    {
+        TractDensityThread* thread = m_threads[t];
+        if ( m_outputs & COUNT )
+        {
+            for ( int i = begin; i < end; ++i )
+            {
+                m_count[i] += thread->m_count[i];
+            }
+        }
+        if ( m_outputs & LENGTH )
+        {
+            for ( int i = begin; i < end; ++i )
+            {
+                m_length[i] += thread->m_length[i];
+            }
+        }
+        if ( m_outputs & COLOR )
+        {
+            for ( int i = begin * 3; i < end * 3; ++i )
+            {
+                m_color[i] += thread->m_color[i];
+            }
+        }
+    }
+    if ( m_outputs & COLOR )
+    {
+        for ( int i = begin; i < end; ++i )
+        {
+            if ( m_count[i] > 0 )
+            {
+                m_color[i * 3] /= m_count[i];
+                m_color[i * 3 + 1] /= m_count[i];
+                m_color[i * 3 + 2] /= m_count[i];
+            }
+        }
+    }
+}
+
+double TractDensity::benchmark( int numFibers, float resolution )
+{
+    // random walks with 1mm steps inside a 180mm cube, about the size of a whole brain tractogram
+    const float size = 180.0f;
+    const int numVerts = 100;
+    std::vector<Fib> fibs( numFibers );
+    unsigned int seed = 1;
+    for ( int i = 0; i < numFibers; ++i )
+    {
+        std::vector<QVector3D> verts( numVerts );
+        seed = seed * 1664525u + 1013904223u;
+        QVector3D p( ( seed >> 8 ) % 100 + 40.0f, ( seed >> 12 ) % 100 + 40.0f, ( seed >> 16 ) % 100 + 40.0f );
+        QVector3D dir( 1, 0, 0 );
+        for ( int k = 0; k < numVerts; ++k )
+        {
+            verts[k] = p;
+            seed = seed * 1664525u + 1013904223u;
+            QVector3D jitter( ( ( seed >> 8 ) & 0xff ) / 255.0f - 0.5f, ( ( seed >> 16 ) & 0xff ) / 255.0f - 0.5f, ( ( seed >> 24 ) & 0xff ) / 255.0f - 0.5f );
+            dir = ( dir + jitter * 0.5f ).normalized();
+            p += dir;
+            p.setX( qMax( 0.0f, qMin( size - 0.01f, p.x() ) ) );
+            p.setY( qMax( 0.0f, qMin( size - 0.01f, p.y() ) ) );
+            p.setZ( qMax( 0.0f, qMin( size - 0.01f, p.z() ) ) );
+        }
+        fibs[i] = Fib( verts );
+    }
+
+    int n = ceil( size / resolution );
+    TractDensity density( &fibs, n, n, n, resolution, resolution, resolution, 0, 0, 0 );
+
+    QElapsedTimer timer;
+    timer.start();
+    density.run( COUNT | LENGTH | COLOR );
+    double seconds = timer.nsecsElapsed() / 1e9;
+
+    double total = 0;
+    for ( unsigned int i = 0; i < density.count()->size(); ++i )
+    {
+        total += density.count()->at( i );
+    }
+    qDebug() << "tract density:" << numFibers << "fibers," << numVerts << "points each into" << n << "x" << n << "x" << n
+             << "grid in" << seconds << "s," << numFibers / seconds << "fibers/s, total count" << total;
+    return seconds;
+}
@@ -0,0 +1,99 @@
+/*
+ * tractdensity.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TRACTDENSITY_H_
+#define TRACTDENSITY_H_
+
+#include "colormapbase.h"
+#include "fib.h"
+
+#include <vector>
+
+class TractDensityThread;
+
+/*
+ * Tract density and tract color mapping. Every segment is walked through the grid with an exact
+ * voxel traversal (3d dda), each fiber is counted at most once per voxel. Threads accumulate into
+ * their own histograms over fiber ranges which are summed over voxel ranges at the end.
+ */
+class TractDensity
+{
+    friend class TractDensityThread;
+
+public:
+    enum Output
+    {
+        COUNT = 1,
+        LENGTH = 2,
+        COLOR = 4
+    };
+
+    enum ColorSource
+    {
+        LOCAL,      // segment direction
+        GLOBAL,     // fiber global color
+        CUSTOM,     // fiber custom color
+        DATA        // data field mapped through a colormap
+    };
+
+    TractDensity( const std::vector<Fib>* fibs, int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az );
+    virtual ~TractDensity();
+
+    void setColorSource( int source, int dataField = 0, float dataMin = 0.0f, float dataMax = 1.0f, ColormapBase colormap = ColormapBase() );
+
+    void run( int outputs );
+
+    // number of fibers per voxel
+    std::vector<float>* count();
+    // fiber length inside each voxel in mm
+    std::vector<float>* length();
+    // rgb per voxel, mean over the fibers visiting it
+    std::vector<float>* color();
+
+    static double benchmark( int numFibers, float resolution = 1.0f );
+
+private:
+    struct Visit
+    {
+        int voxel;
+        unsigned int order;
+        float color[3];
+        bool operator<( const Visit& other ) const { return voxel < other.voxel || ( voxel == other.voxel && order < other.order ); };
+    };
+
+    void traverse( int begin, int end, TractDensityThread* thread );
+    void reduce( int begin, int end );
+    void fiberColor( const Fib& fib, unsigned int k, const QVector3D& dir, float* color );
+
+    const std::vector<Fib>* m_fibs;
+
+    int m_nx;
+    int m_ny;
+    int m_nz;
+    float m_dx;
+    float m_dy;
+    float m_dz;
+    float m_ax;
+    float m_ay;
+    float m_az;
+    int m_blockSize;
+
+    int m_outputs;
+    int m_colorSource;
+    int m_dataField;
+    float m_dataMin;
+    float m_dataMax;
+    ColormapBase m_colormap;
+
+    std::vector<TractDensityThread*> m_threads;
+
+    std::vector<float> m_count;
+    std::vector<float> m_length;
+    std::vector<float> m_color;
+};
+
+#endif /* TRACTDENSITY_H_ */
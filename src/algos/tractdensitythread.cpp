@@ -0,0 +1,51 @@
+/*
+ * tractdensitythread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "tractdensitythread.h"
+#include "trace.h"
+#include "tractdensity.h"
+
+#include "../gui/gl/glfunctions.h"
+
+TractDensityThread::TractDensityThread( TractDensity* density, int pass, int size, int id ) :
+    m_density( density ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+TractDensityThread::~TractDensityThread()
+{
+}
+
+void TractDensityThread::run()
+{
+    TRACE_SCOPE( "TractDensityThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    int chunkSize = m_size / numThreads;
+
+    int begin = m_id * chunkSize;
+    int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case TRAVERSE:
+            m_density->traverse( begin, end, this );
+            break;
+        case REDUCE:
+            m_density->reduce( begin, end );
+            break;
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * tractdensitythread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TRACTDENSITYTHREAD_H_
+#define TRACTDENSITYTHREAD_H_
+
+#include <QThread>
+
+#include <vector>
+
+class TractDensity;
+
+class TractDensityThread : public QThread
+{
+    friend class TractDensity;
+
+public:
+    enum Pass
+    {
+        TRAVERSE,   // fiber range
+        REDUCE      // voxel range
+    };
+
+    TractDensityThread( TractDensity* density, int pass, int size, int id );
+    virtual ~TractDensityThread();
+
+private:
+    void run();
+
+    TractDensity* m_density;
+    int m_pass;
+    int m_size;
+    int m_id;
+
+    // per thread histograms
+    std::vector<float> m_count;
+    std::vector<float> m_length;
+    std::vector<float> m_color;
+};
+
+#endif /* TRACTDENSITYTHREAD_H_ */
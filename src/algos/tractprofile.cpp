@@ -0,0 +1,324 @@
+/*
+ * tractprofile.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "tractprofile.h"
+#include "tractprofilethread.h"
+#include "volumesampler.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // fibers per block, bounds the node and sample buffers for huge tractograms
+    const unsigned int BLOCK_SIZE = 65536;
+
+    // below this many fibers a block isn't worth the threads
+    const unsigned int MIN_THREADED = 1024;
+}
+
+TractProfile::TractProfile( int nodes ) :
+    m_nodes( qMax( 2, nodes ) ),
+    m_numBundles( 1 ),
+    m_fibs( 0 ),
+    m_blockBegin( 0 ),
+    m_values( 0 )
+{
+}
+
+TractProfile::~TractProfile()
+{
+}
+
+void TractProfile::setBundles( const std::vector<int>& assignment )
+{
+    m_assignment = assignment;
+    m_numBundles = 0;
+    for ( unsigned int i = 0; i < m_assignment.size(); ++i )
+    {
+        m_numBundles = qMax( m_numBundles, m_assignment[i] + 1 );
+    }
+}
+
+int TractProfile::numNodes()
+{
+    return m_nodes;
+}
+
+int TractProfile::numBundles()
+{
+    return m_numBundles;
+}
+
+const std::vector<int>& TractProfile::bundleSizes()
+{
+    return m_bundleSizes;
+}
+
+const std::vector<float>& TractProfile::centers()
+{
+    return m_centers;
+}
+
+void TractProfile::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<TractProfileThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new TractProfileThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+void TractProfile::resample( const Fib& fib, int nodes, float* out )
+{
+    const std::vector<QVector3D>* verts = fib.getVerts();
+    unsigned int length = verts->size();
+    if ( length == 0 )
+    {
+        std::fill( out, out + nodes * 3, 0.0f );
+        return;
+    }
+
+    std::vector<float> arc( length, 0.0f );
+    for ( unsigned int i = 1; i < length; ++i )
+    {
+        arc[i] = arc[i - 1] + ( verts->at( i ) - verts->at( i - 1 ) ).length();
+    }
+    float total = arc[length - 1];
+
+    unsigned int segment = 0;
+    for ( int k = 0; k < nodes; ++k )
+    {
+        QVector3D pos;
+        if ( length == 1 || total <= 0.0f )
+        {
+            pos = verts->at( 0 );
+        }
+        else
+        {
+            float s = total * k / ( nodes - 1 );
+            while ( segment < length - 2 && arc[segment + 1] < s )
+            {
+                ++segment;
+            }
+            float segLength = arc[segment + 1] - arc[segment];
+            float t = segLength > 0.0f ? qBound( 0.0f, ( s - arc[segment] ) / segLength, 1.0f ) : 0.0f;
+            pos = verts->at( segment ) * ( 1.0f - t ) + verts->at( segment + 1 ) * t;
+        }
+        out[k * 3] = pos.x();
+        out[k * 3 + 1] = pos.y();
+        out[k * 3 + 2] = pos.z();
+    }
+}
+
+void TractProfile::profile( const std::vector<Fib>& fibs, VolumeSampler* volume, std::vector<float>& values, std::vector<float>& means, std::vector<float>& stdDevs )
+{
+    std::vector<VolumeSampler*> volumes( 1, volume );
+    std::vector< std::vector<float> > v;
+    std::vector< std::vector<float> > m;
+    std::vector< std::vector<float> > s;
+    profile( fibs, volumes, v, m, s );
+    values.swap( v[0] );
+    means.swap( m[0] );
+    stdDevs.swap( s[0] );
+}
+
+void TractProfile::profile( const std::vector<Fib>& fibs, const std::vector<VolumeSampler*>& volumes,
+                            std::vector< std::vector<float> >& values,
+                            std::vector< std::vector<float> >& means,
+                            std::vector< std::vector<float> >& stdDevs,
+                            std::vector<float>* positions )
+{
+    unsigned int numFibs = fibs.size();
+    unsigned int numVolumes = volumes.size();
+    size_t numValues = static_cast<size_t>( numFibs ) * m_nodes;
+
+    if ( m_assignment.size() != numFibs )
+    {
+        m_assignment.assign( numFibs, 0 );
+        m_numBundles = 1;
+    }
+
+    // the first fiber of each bundle is its reference orientation
+    m_bundleSizes.assign( m_numBundles, 0 );
+    m_references.assign( m_numBundles * m_nodes * 3, 0.0f );
+    for ( unsigned int i = 0; i < numFibs; ++i )
+    {
+        int bundle = m_assignment[i];
+        if ( bundle >= 0 )
+        {
+            if ( m_bundleSizes[bundle] == 0 )
+            {
+                resample( fibs[i], m_nodes, &m_references[bundle * m_nodes * 3] );
+            }
+            ++m_bundleSizes[bundle];
+        }
+    }
+
+    values.assign( numVolumes, std::vector<float>( numValues, 0.0f ) );
+    m_sums.assign( numVolumes, std::vector<double>( m_numBundles * m_nodes, 0.0 ) );
+    m_squares.assign( numVolumes, std::vector<double>( m_numBundles * m_nodes, 0.0 ) );
+    m_positionSums.assign( m_numBundles * m_nodes * 3, 0.0 );
+    if ( positions )
+    {
+        positions->resize( numValues * 3 );
+    }
+
+    m_fibs = &fibs;
+    m_values = &values;
+    for ( m_blockBegin = 0; m_blockBegin < numFibs; m_blockBegin += BLOCK_SIZE )
+    {
+        unsigned int blockFibs = qMin( BLOCK_SIZE, numFibs - m_blockBegin );
+        m_blockNodes.resize( static_cast<size_t>( blockFibs ) * m_nodes * 3 );
+
+        if ( blockFibs < MIN_THREADED )
+        {
+            resampleRange( 0, blockFibs );
+        }
+        else
+        {
+            runPass( TractProfileThread::RESAMPLE, blockFibs );
+        }
+
+        size_t offset = static_cast<size_t>( m_blockBegin ) * m_nodes;
+        for ( unsigned int v = 0; v < numVolumes; ++v )
+        {
+            volumes[v]->sample( m_blockNodes.data(), blockFibs * m_nodes, &values[v][offset] );
+        }
+
+        if ( blockFibs < MIN_THREADED )
+        {
+            statsRange( 0, m_nodes );
+        }
+        else
+        {
+            runPass( TractProfileThread::STATS, m_nodes );
+        }
+
+        if ( positions )
+        {
+            std::copy( m_blockNodes.begin(), m_blockNodes.end(), positions->begin() + offset * 3 );
+        }
+    }
+    m_fibs = 0;
+    m_values = 0;
+    std::vector<float>().swap( m_blockNodes );
+
+    means.assign( numVolumes, std::vector<float>( m_numBundles * m_nodes, 0.0f ) );
+    stdDevs.assign( numVolumes, std::vector<float>( m_numBundles * m_nodes, 0.0f ) );
+    m_centers.assign( m_numBundles * m_nodes * 3, 0.0f );
+    for ( int b = 0; b < m_numBundles; ++b )
+    {
+        int count = m_bundleSizes[b];
+        if ( count == 0 )
+        {
+            continue;
+        }
+        for ( int k = b * m_nodes; k < ( b + 1 ) * m_nodes; ++k )
+        {
+            for ( unsigned int v = 0; v < numVolumes; ++v )
+            {
+                double mean = m_sums[v][k] / count;
+                means[v][k] = mean;
+                stdDevs[v][k] = sqrt( qMax( 0.0, m_squares[v][k] / count - mean * mean ) );
+            }
+            for ( int c = 0; c < 3; ++c )
+            {
+                m_centers[k * 3 + c] = m_positionSums[k * 3 + c] / count;
+            }
+        }
+    }
+    std::vector< std::vector<double> >().swap( m_sums );
+    std::vector< std::vector<double> >().swap( m_squares );
+    std::vector<double>().swap( m_positionSums );
+}
+
+void TractProfile::resampleRange( unsigned int begin, unsigned int end )
+{
+    int n3 = m_nodes * 3;
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        unsigned int fiber = m_blockBegin + i;
+        float* nodes = &m_blockNodes[static_cast<size_t>( i ) * n3];
+        resample( m_fibs->at( fiber ), m_nodes, nodes );
+
+        int bundle = m_assignment[fiber];
+        if ( bundle < 0 )
+        {
+            continue;
+        }
+
+        // flip the fiber if its reversed nodes are closer to the reference
+        const float* ref = &m_references[bundle * n3];
+        double forward = 0.0;
+        double backward = 0.0;
+        for ( int k = 0; k < m_nodes; ++k )
+        {
+            const float* a = &nodes[k * 3];
+            const float* f = &ref[k * 3];
+            const float* b = &ref[( m_nodes - 1 - k ) * 3];
+            for ( int c = 0; c < 3; ++c )
+            {
+                forward += ( a[c] - f[c] ) * ( a[c] - f[c] );
+                backward += ( a[c] - b[c] ) * ( a[c] - b[c] );
+            }
+        }
+        if ( backward < forward )
+        {
+            for ( int k = 0; k < m_nodes / 2; ++k )
+            {
+                std::swap_ranges( &nodes[k * 3], &nodes[k * 3 + 3], &nodes[( m_nodes - 1 - k ) * 3] );
+            }
+        }
+    }
+}
+
+void TractProfile::statsRange( unsigned int begin, unsigned int end )
+{
+    // every thread owns a range of nodes, so the sums need no locking
+    unsigned int blockFibs = m_blockNodes.size() / ( m_nodes * 3 );
+    unsigned int numVolumes = m_values->size();
+    for ( unsigned int i = 0; i < blockFibs; ++i )
+    {
+        int bundle = m_assignment[m_blockBegin + i];
+        if ( bundle < 0 )
+        {
+            continue;
+        }
+        size_t valueBase = static_cast<size_t>( m_blockBegin + i ) * m_nodes;
+        const float* nodes = &m_blockNodes[static_cast<size_t>( i ) * m_nodes * 3];
+        for ( unsigned int k = begin; k < end; ++k )
+        {
+            int id = bundle * m_nodes + k;
+            for ( unsigned int v = 0; v < numVolumes; ++v )
+            {
+                double value = m_values->at( v )[valueBase + k];
+                m_sums[v][id] += value;
+                m_squares[v][id] += value * value;
+            }
+            for ( int c = 0; c < 3; ++c )
+            {
+                m_positionSums[id * 3 + c] += nodes[k * 3 + c];
+            }
+        }
+    }
+}
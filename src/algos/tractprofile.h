@@ -0,0 +1,83 @@
+/*
+ * tractprofile.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TRACTPROFILE_H_
+#define TRACTPROFILE_H_
+
+#include "fib.h"
+
+#include <vector>
+
+class TractProfileThread;
+class VolumeSampler;
+
+/*
+ * Along tract profiles. Every fiber is resampled to the same number of nodes at equal arc length and
+ * flipped if needed so that node i of all fibers of a bundle lies at the same end of the bundle. The
+ * volumes are then sampled at the nodes and averaged per bundle and node. Fibers are processed in blocks,
+ * the resampling and the statistics are split over the threads, the sampling over the sampler's threads.
+ */
+class TractProfile
+{
+    friend class TractProfileThread;
+
+public:
+    TractProfile( int nodes = 100 );
+    virtual ~TractProfile();
+
+    // bundle id per fiber, fibers with a negative id are profiled but belong to no bundle,
+    // without an assignment all fibers form one bundle
+    void setBundles( const std::vector<int>& assignment );
+
+    // values gets fibers * nodes entries per volume, means and stdDevs bundles * nodes per volume,
+    // positions the aligned node positions as xyz triplets if not 0
+    void profile( const std::vector<Fib>& fibs, const std::vector<VolumeSampler*>& volumes,
+                  std::vector< std::vector<float> >& values,
+                  std::vector< std::vector<float> >& means,
+                  std::vector< std::vector<float> >& stdDevs,
+                  std::vector<float>* positions = 0 );
+
+    void profile( const std::vector<Fib>& fibs, VolumeSampler* volume, std::vector<float>& values, std::vector<float>& means, std::vector<float>& stdDevs );
+
+    int numNodes();
+    int numBundles();
+
+    // number of fibers per bundle and the mean node positions of each bundle after the last profile
+    const std::vector<int>& bundleSizes();
+    const std::vector<float>& centers();
+
+    // equal arc length resampling of a single fiber into out, nodes xyz triplets
+    static void resample( const Fib& fib, int nodes, float* out );
+
+private:
+    void runPass( int pass, unsigned int size );
+
+    void resampleRange( unsigned int begin, unsigned int end );
+    void statsRange( unsigned int begin, unsigned int end );
+
+    int m_nodes;
+    int m_numBundles;
+    std::vector<int> m_assignment;
+    std::vector<int> m_bundleSizes;
+
+    // first fiber of every bundle resampled, the others are aligned to it
+    std::vector<float> m_references;
+
+    // current block of fibers and its resampled nodes
+    const std::vector<Fib>* m_fibs;
+    unsigned int m_blockBegin;
+    std::vector<float> m_blockNodes;
+    const std::vector< std::vector<float> >* m_values;
+
+    // per volume sums over the fibers of a bundle, bundles * nodes, and the summed positions
+    std::vector< std::vector<double> > m_sums;
+    std::vector< std::vector<double> > m_squares;
+    std::vector<double> m_positionSums;
+    std::vector<float> m_centers;
+};
+
+#endif /* TRACTPROFILE_H_ */
@@ -0,0 +1,51 @@
+/*
+ * tractprofilethread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "tractprofilethread.h"
+#include "tractprofile.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+TractProfileThread::TractProfileThread( TractProfile* profile, int pass, unsigned int size, int id ) :
+    m_profile( profile ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+TractProfileThread::~TractProfileThread()
+{
+}
+
+void TractProfileThread::run()
+{
+    TRACE_SCOPE( "TractProfileThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case RESAMPLE:
+            m_profile->resampleRange( begin, end );
+            break;
+        case STATS:
+            m_profile->statsRange( begin, end );
+            break;
+    }
+}
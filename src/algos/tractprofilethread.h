@@ -0,0 +1,36 @@
+/*
+ * tractprofilethread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TRACTPROFILETHREAD_H_
+#define TRACTPROFILETHREAD_H_
+
+#include <QThread>
+
+class TractProfile;
+
+class TractProfileThread : public QThread
+{
+public:
+    enum Pass
+    {
+        RESAMPLE,
+        STATS
+    };
+
+    TractProfileThread( TractProfile* profile, int pass, unsigned int size, int id );
+    virtual ~TractProfileThread();
+
+private:
+    void run();
+
+    TractProfile* m_profile;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* TRACTPROFILETHREAD_H_ */
@@ -13,7 +13,11 @@ Tree::Tree(  int id, float value ) :
     m_id( id ),
     m_value( value ),
     m_texturePosition( QVector3D( 0, 0, 0 ) ),
-    m_parent( 0 )
+    m_parent( 0 ),
+    m_numLeaves( -1 ),
+    m_numNodes( 1 ),
+    m_firstNode( -1 ),
+    m_firstLeaf( -1 )
 {
     QColor color1( 255, 0, 0 );
     QColor color2( 128, 128, 128 );
@@ -41,6 +45,11 @@ void Tree::setParent( Tree* parent )
 void Tree::addChild( Tree* child )
 {
     m_children.push_back( child );
+
+    for ( Tree* node = this; node && node->m_numLeaves != -1; node = node->m_parent )
+    {
+        node->m_numLeaves = -1;
+    }
 }
 
 QList<Tree*> Tree::getChildren()
@@ -69,25 +78,6 @@ void Tree::setColor( int id, QColor& color, bool propagateUp, bool propagateDown
     }
 }
 
-void Tree::setColor( int id, int colorId, QColor& color )
-{
-    if ( id == m_id )
-    {
-        m_colors[colorId] = color;
-        for ( int i = 0; i < m_children.size(); ++i )
-        {
-            m_children[i]->setColor( m_children[i]->getId(), colorId, color );
-        }
-    }
-    else
-    {
-        for ( int i = 0; i < m_children.size(); ++i )
-        {
-            m_children[i]->setColor( id, colorId, color );
-        }
-    }
-}
-
 int Tree::getId()
 {
     return m_id;
@@ -105,20 +95,83 @@ void Tree::setValue( float value )
 
 int Tree::getNumLeaves()
 {
-    int numLeaves = 0;
+    if ( m_numLeaves == -1 )
+    {
+        if ( m_children.size() > 0 )
+        {
+            m_numLeaves = 0;
+            for ( int i = 0; i < m_children.size(); ++i )
+            {
+                m_numLeaves += m_children[i]->getNumLeaves();
+            }
+        }
+        else
+        {
+            m_numLeaves = 1;
+        }
+    }
+    return m_numLeaves;
+}
 
-    if ( m_children.size() > 0 )
+void Tree::index( std::vector<Tree*>& nodes, std::vector<Tree*>& leaves )
+{
+    // explicit stack, clusterings of large parcellations are often deep chains
+    unsigned int begin = nodes.size();
+    std::vector<Tree*> todo;
+    todo.push_back( this );
+    while ( !todo.empty() )
     {
-        for ( int i = 0; i < m_children.size(); ++i )
+        Tree* node = todo.back();
+        todo.pop_back();
+
+        node->m_firstNode = nodes.size();
+        node->m_firstLeaf = leaves.size();
+        nodes.push_back( node );
+        if ( node->m_children.empty() )
         {
-            numLeaves += m_children[i]->getNumLeaves();
+            leaves.push_back( node );
+        }
+        for ( int i = node->m_children.size() - 1; i >= 0; --i )
+        {
+            todo.push_back( node->m_children[i] );
         }
     }
-    else
+
+    // children come after their parent, so going backwards the subtrees are complete
+    for ( unsigned int i = nodes.size(); i > begin; --i )
     {
-        numLeaves = 1;
+        Tree* node = nodes[i - 1];
+        if ( node->m_children.empty() )
+        {
+            node->m_numNodes = 1;
+            node->m_numLeaves = 1;
+        }
+        else
+        {
+            node->m_numNodes = 1;
+            node->m_numLeaves = 0;
+            for ( int k = 0; k < node->m_children.size(); ++k )
+            {
+                node->m_numNodes += node->m_children[k]->m_numNodes;
+                node->m_numLeaves += node->m_children[k]->m_numLeaves;
+            }
+        }
     }
-    return numLeaves;
+}
+
+int Tree::getFirstNode()
+{
+    return m_firstNode;
+}
+
+int Tree::getNumNodes()
+{
+    return m_numNodes;
+}
+
+int Tree::getFirstLeaf()
+{
+    return m_firstLeaf;
 }
 
 QVector3D Tree::getTexturePosition()
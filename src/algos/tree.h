@@ -13,6 +13,13 @@
 #include <QVector>
 #include <QVector3D>
 
+#include <vector>
+
+/*
+ * Node of a hierarchical clustering. After index() every node knows its position in the depth first
+ * order of the tree and the size of its subtree, so the nodes and leaves below a node are contiguous
+ * ranges of the order arrays and need no walk to be found.
+ */
 class Tree
 {
 public:
@@ -24,7 +31,6 @@ public:
 
     QColor getColor( int id );
     void setColor( int colorId, QColor& color, bool propagateUp, bool propagateDown );
-    void setColor( int id, int colorId, QColor& color );
 
     int getId();
 
@@ -37,8 +43,17 @@ public:
     QVector3D getTexturePosition();
     void setTexturePosition( QVector3D value );
 
+    // cached, reset when a child is added below the node
     int getNumLeaves();
 
+    // numbers the subtree in depth first order starting at this node, appends its nodes and its leaves
+    void index( std::vector<Tree*>& nodes, std::vector<Tree*>& leaves );
+
+    // position in the depth first order and subtree size, valid after index()
+    int getFirstNode();
+    int getNumNodes();
+    int getFirstLeaf();
+
 private:
     int m_id;
     float m_value;   // some value, may be interpreted as height of the node, thus leafs have 0.0 and the root <= 1.0
@@ -47,6 +62,11 @@ private:
 
     Tree* m_parent;
     QList<Tree*>m_children;
+
+    int m_numLeaves;
+    int m_numNodes;
+    int m_firstNode;
+    int m_firstLeaf;
 };
 
 #endif /* TREE_H_ */
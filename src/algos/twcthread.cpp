@@ -7,6 +7,7 @@
 #include "twcthread.h"
 
 #include "fmath.h"
+#include "trace.h"
 
 #include "../gui/gl/glfunctions.h"
 
@@ -57,6 +58,8 @@ std::vector<Fib>* TWCThread::getFibs()
 
 void TWCThread::run()
 {
+    TRACE_SCOPE( "TWCThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
     int progressCounter = 0;
 
@@ -0,0 +1,347 @@
+/*
+ * volumefilter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "volumefilter.h"
+#include "volumefilterthread.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cmath>
+
+VolumeFilter::VolumeFilter( int nx, int ny, int nz, float dx, float dy, float dz, int frames ) :
+    m_frames( qMax( 1, frames ) ),
+    m_border( CLAMP ),
+    m_src( 0 ),
+    m_dst( 0 ),
+    m_percentile( 0.5f )
+{
+    m_dims[0] = nx;
+    m_dims[1] = ny;
+    m_dims[2] = nz;
+    m_spacing[0] = dx > 0 ? dx : 1.0f;
+    m_spacing[1] = dy > 0 ? dy : 1.0f;
+    m_spacing[2] = dz > 0 ? dz : 1.0f;
+    m_radius[0] = m_radius[1] = m_radius[2] = 0;
+}
+
+VolumeFilter::~VolumeFilter()
+{
+}
+
+void VolumeFilter::setBorder( Border border )
+{
+    m_border = border;
+}
+
+std::vector<float> VolumeFilter::gaussKernel( float sigma )
+{
+    int radius = qMax( 1, static_cast<int>( ceil( 3.0f * sigma ) ) );
+    std::vector<float> kernel( 2 * radius + 1 );
+    double sum = 0;
+    for ( int i = -radius; i <= radius; ++i )
+    {
+        double value = exp( -0.5 * ( i * i ) / ( sigma * sigma ) );
+        kernel[i + radius] = value;
+        sum += value;
+    }
+    for ( unsigned int i = 0; i < kernel.size(); ++i )
+    {
+        kernel[i] /= sum;
+    }
+    return kernel;
+}
+
+int VolumeFilter::borderIndex( int i, int n )
+{
+    if ( i >= 0 && i < n )
+    {
+        return i;
+    }
+    switch ( m_border )
+    {
+        case CLAMP:
+            return i < 0 ? 0 : n - 1;
+        case MIRROR:
+        {
+            if ( n == 1 )
+            {
+                return 0;
+            }
+            int period = 2 * n - 2;
+            i = i % period;
+            if ( i < 0 )
+            {
+                i += period;
+            }
+            return i < n ? i : period - i;
+        }
+        case ZERO:
+            break;
+    }
+    return -1;
+}
+
+void VolumeFilter::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<VolumeFilterThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new VolumeFilterThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+void VolumeFilter::gauss( const std::vector<float>& in, std::vector<float>& out, float sigma )
+{
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int nz = m_dims[2];
+    size_t size = static_cast<size_t>( nx ) * ny * nz * m_frames;
+    if ( in.size() < size )
+    {
+        out = in;
+        return;
+    }
+
+    for ( int a = 0; a < 3; ++a )
+    {
+        float s = sigma / m_spacing[a];
+        if ( s < 0.1f || m_dims[a] == 1 )
+        {
+            m_kernels[a] = std::vector<float>( 1, 1.0f );
+        }
+        else
+        {
+            m_kernels[a] = gaussKernel( s );
+        }
+        m_radius[a] = m_kernels[a].size() / 2;
+    }
+
+    out.resize( size );
+    std::vector<float> tmp( size );
+    unsigned int numTiles = ( nx + TILE - 1 ) / TILE;
+
+    m_src = in.data();
+    m_dst = out.data();
+    runPass( VolumeFilterThread::GAUSS_X, m_frames * nz * ny );
+
+    m_src = out.data();
+    m_dst = tmp.data();
+    runPass( VolumeFilterThread::GAUSS_Y, m_frames * nz * numTiles );
+
+    m_src = tmp.data();
+    m_dst = out.data();
+    runPass( VolumeFilterThread::GAUSS_Z, m_frames * ny * numTiles );
+}
+
+void VolumeFilter::percentile( const std::vector<float>& in, std::vector<float>& out, float radius, float percentile )
+{
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int nz = m_dims[2];
+    size_t size = static_cast<size_t>( nx ) * ny * nz * m_frames;
+    if ( in.size() < size )
+    {
+        out = in;
+        return;
+    }
+
+    for ( int a = 0; a < 3; ++a )
+    {
+        m_radius[a] = m_dims[a] == 1 ? 0 : qMax( 0, static_cast<int>( radius / m_spacing[a] + 0.5f ) );
+    }
+    m_percentile = qBound( 0.0f, percentile, 1.0f );
+
+    out.resize( size );
+    m_src = in.data();
+    m_dst = out.data();
+    runPass( VolumeFilterThread::PERCENTILE, m_frames * nz * ny );
+}
+
+void VolumeFilter::convolveX( unsigned int begin, unsigned int end )
+{
+    int nx = m_dims[0];
+    int r = m_radius[0];
+    int kn = 2 * r + 1;
+    const float* kernel = m_kernels[0].data();
+
+    // per thread buffers, reused for every row of the chunk
+    std::vector<int> map( nx + 2 * r );
+    std::vector<float> line( nx + 2 * r );
+    std::vector<float> acc( nx );
+    for ( int j = 0; j < nx + 2 * r; ++j )
+    {
+        map[j] = borderIndex( j - r, nx );
+    }
+
+    for ( unsigned int u = begin; u < end; ++u )
+    {
+        const float* src = m_src + static_cast<size_t>( u ) * nx;
+        for ( int j = 0; j < nx + 2 * r; ++j )
+        {
+            line[j] = map[j] < 0 ? 0.0f : src[map[j]];
+        }
+
+        std::fill( acc.begin(), acc.end(), 0.0f );
+        for ( int i = 0; i < kn; ++i )
+        {
+            float k = kernel[i];
+            const float* l = &line[i];
+            for ( int x = 0; x < nx; ++x )
+            {
+                acc[x] += k * l[x];
+            }
+        }
+        std::copy( acc.begin(), acc.end(), m_dst + static_cast<size_t>( u ) * nx );
+    }
+}
+
+void VolumeFilter::convolveTiles( unsigned int begin, unsigned int end, int axis )
+{
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int nz = m_dims[2];
+    int n = m_dims[axis];
+    int r = m_radius[axis];
+    int kn = 2 * r + 1;
+    const float* kernel = m_kernels[axis].data();
+
+    size_t frameSize = static_cast<size_t>( nx ) * ny * nz;
+    size_t stride = ( axis == 1 ) ? nx : static_cast<size_t>( nx ) * ny;
+    int other = ( axis == 1 ) ? nz : ny;
+    int numTiles = ( nx + TILE - 1 ) / TILE;
+
+    // the padded lines of one tile, TILE neighbouring x columns side by side
+    std::vector<int> map( n + 2 * r );
+    std::vector<float> block( ( n + 2 * r ) * TILE );
+    float acc[TILE];
+    for ( int j = 0; j < n + 2 * r; ++j )
+    {
+        map[j] = borderIndex( j - r, n );
+    }
+
+    for ( unsigned int u = begin; u < end; ++u )
+    {
+        int tile = u % numTiles;
+        int rest = u / numTiles;
+        int o = rest % other;
+        int frame = rest / other;
+
+        int x0 = tile * TILE;
+        int w = qMin( TILE, nx - x0 );
+        size_t base = frame * frameSize + x0 + ( axis == 1 ? o * static_cast<size_t>( nx ) * ny : o * static_cast<size_t>( nx ) );
+
+        for ( int j = 0; j < n + 2 * r; ++j )
+        {
+            float* b = &block[j * TILE];
+            if ( map[j] < 0 )
+            {
+                std::fill( b, b + w, 0.0f );
+            }
+            else
+            {
+                const float* src = m_src + base + map[j] * stride;
+                std::copy( src, src + w, b );
+            }
+        }
+
+        for ( int y = 0; y < n; ++y )
+        {
+            std::fill( acc, acc + TILE, 0.0f );
+            for ( int i = 0; i < kn; ++i )
+            {
+                float k = kernel[i];
+                const float* b = &block[( y + i ) * TILE];
+                for ( int x = 0; x < TILE; ++x )
+                {
+                    acc[x] += k * b[x];
+                }
+            }
+            std::copy( acc, acc + w, m_dst + base + y * stride );
+        }
+    }
+}
+
+void VolumeFilter::percentileRows( unsigned int begin, unsigned int end )
+{
+    int nx = m_dims[0];
+    int ny = m_dims[1];
+    int nz = m_dims[2];
+    int rx = m_radius[0];
+    int ry = m_radius[1];
+    int rz = m_radius[2];
+    size_t frameSize = static_cast<size_t>( nx ) * ny * nz;
+
+    int width = 2 * rx + 1;
+    int numRows = ( 2 * ry + 1 ) * ( 2 * rz + 1 );
+    int count = width * numRows;
+    int kth = static_cast<int>( m_percentile * ( count - 1 ) + 0.5f );
+
+    std::vector<int> colMap( nx + 2 * rx );
+    std::vector<long long> rowBases( numRows );
+    std::vector<float> values( count );
+    for ( int j = 0; j < nx + 2 * rx; ++j )
+    {
+        colMap[j] = borderIndex( j - rx, nx );
+    }
+
+    for ( unsigned int u = begin; u < end; ++u )
+    {
+        int y = u % ny;
+        int z = ( u / ny ) % nz;
+        int frame = u / ( ny * nz );
+
+        int row = 0;
+        for ( int dz = -rz; dz <= rz; ++dz )
+        {
+            int zz = borderIndex( z + dz, nz );
+            for ( int dy = -ry; dy <= ry; ++dy )
+            {
+                int yy = borderIndex( y + dy, ny );
+                rowBases[row++] = ( zz < 0 || yy < 0 ) ? -1 : static_cast<long long>( frame * frameSize + ( zz * ny + yy ) * static_cast<size_t>( nx ) );
+            }
+        }
+
+        float* dst = m_dst + static_cast<size_t>( u ) * nx;
+        for ( int x = 0; x < nx; ++x )
+        {
+            const int* cols = &colMap[x];
+            float* v = &values[0];
+            for ( int i = 0; i < numRows; ++i )
+            {
+                if ( rowBases[i] < 0 )
+                {
+                    std::fill( v, v + width, 0.0f );
+                }
+                else
+                {
+                    const float* src = m_src + rowBases[i];
+                    for ( int dx = 0; dx < width; ++dx )
+                    {
+                        v[dx] = cols[dx] < 0 ? 0.0f : src[cols[dx]];
+                    }
+                }
+                v += width;
+            }
+            std::nth_element( values.begin(), values.begin() + kth, values.end() );
+            dst[x] = values[kth];
+        }
+    }
+}
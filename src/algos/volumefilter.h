@@ -0,0 +1,70 @@
+/*
+ * volumefilter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef VOLUMEFILTER_H_
+#define VOLUMEFILTER_H_
+
+#include <vector>
+
+class VolumeFilterThread;
+
+/*
+ * Separable gauss and box percentile filters for scalar volumes and 4D series, frames are stored one
+ * after the other. Filter sizes are given in mm, so anisotropic voxels get a kernel per axis. Lines
+ * along y and z are processed in tiles of neighbouring x columns to keep memory access contiguous.
+ */
+class VolumeFilter
+{
+    friend class VolumeFilterThread;
+
+public:
+    enum Border
+    {
+        CLAMP,  // repeat the edge voxel
+        MIRROR, // reflect at the edge voxel
+        ZERO    // treat everything outside as 0
+    };
+
+    VolumeFilter( int nx, int ny, int nz, float dx, float dy, float dz, int frames = 1 );
+    virtual ~VolumeFilter();
+
+    void setBorder( Border border );
+
+    // sigma in mm, axes with a sigma below a tenth of their voxel size are left alone
+    void gauss( const std::vector<float>& in, std::vector<float>& out, float sigma );
+
+    // percentile of the box with the given radius in mm, 0.5 is the median
+    void percentile( const std::vector<float>& in, std::vector<float>& out, float radius, float percentile = 0.5f );
+
+    // normalized kernel of radius ceil( 3 sigma ) voxels, sigma in voxels
+    static std::vector<float> gaussKernel( float sigma );
+
+private:
+    static const int TILE = 32;
+
+    void runPass( int pass, unsigned int size );
+
+    void convolveX( unsigned int begin, unsigned int end );
+    void convolveTiles( unsigned int begin, unsigned int end, int axis );
+    void percentileRows( unsigned int begin, unsigned int end );
+
+    int borderIndex( int i, int n );
+
+    int m_dims[3];
+    float m_spacing[3];
+    int m_frames;
+    Border m_border;
+
+    const float* m_src;
+    float* m_dst;
+
+    std::vector<float> m_kernels[3];
+    int m_radius[3];
+    float m_percentile;
+};
+
+#endif /* VOLUMEFILTER_H_ */
@@ -0,0 +1,57 @@
+/*
+ * volumefilterthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "volumefilterthread.h"
+#include "trace.h"
+#include "volumefilter.h"
+
+#include "../gui/gl/glfunctions.h"
+
+VolumeFilterThread::VolumeFilterThread( VolumeFilter* filter, int pass, unsigned int size, int id ) :
+    m_filter( filter ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+VolumeFilterThread::~VolumeFilterThread()
+{
+}
+
+void VolumeFilterThread::run()
+{
+    TRACE_SCOPE( "VolumeFilterThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case GAUSS_X:
+            m_filter->convolveX( begin, end );
+            break;
+        case GAUSS_Y:
+            m_filter->convolveTiles( begin, end, 1 );
+            break;
+        case GAUSS_Z:
+            m_filter->convolveTiles( begin, end, 2 );
+            break;
+        case PERCENTILE:
+            m_filter->percentileRows( begin, end );
+            break;
+    }
+}
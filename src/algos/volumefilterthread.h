@@ -0,0 +1,38 @@
+/*
+ * volumefilterthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef VOLUMEFILTERTHREAD_H_
+#define VOLUMEFILTERTHREAD_H_
+
+#include <QThread>
+
+class VolumeFilter;
+
+class VolumeFilterThread : public QThread
+{
+public:
+    enum Pass
+    {
+        GAUSS_X,
+        GAUSS_Y,
+        GAUSS_Z,
+        PERCENTILE
+    };
+
+    VolumeFilterThread( VolumeFilter* filter, int pass, unsigned int size, int id );
+    virtual ~VolumeFilterThread();
+
+private:
+    void run();
+
+    VolumeFilter* m_filter;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* VOLUMEFILTERTHREAD_H_ */
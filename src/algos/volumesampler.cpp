@@ -0,0 +1,226 @@
+/*
+ * volumesampler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "volumesampler.h"
+#include "volumesamplerthread.h"
+
+#include "../data/enums.h"
+#include "../data/datasets/datasetfmri.h"
+#include "../data/datasets/datasetscalar.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+
+VolumeSampler::VolumeSampler( Dataset* ds, Mode mode ) :
+    m_points( 0 ),
+    m_outer( 0 ),
+    m_out( 0 ),
+    m_steps( 1 )
+{
+    PropertyGroup& props = ds->properties( "maingl" );
+    int nx = props.get( Fn::Property::D_NX ).toInt();
+    int ny = props.get( Fn::Property::D_NY ).toInt();
+    int nz = props.get( Fn::Property::D_NZ ).toInt();
+
+    const float* data = 0;
+    int type = props.get( Fn::Property::D_TYPE ).toInt();
+    if ( type == (int)Fn::DatasetType::NIFTI_SCALAR )
+    {
+        data = static_cast<DatasetScalar*>( ds )->getData()->data();
+    }
+    else if ( type == (int)Fn::DatasetType::NIFTI_FMRI )
+    {
+        int dim = props.get( Fn::Property::D_DIM ).toInt();
+        int frame = qMax( 0, qMin( props.get( Fn::Property::D_SELECTED_TEXTURE ).toInt(), dim - 1 ) );
+        data = static_cast<DatasetFMRI*>( ds )->getData()->data() + static_cast<size_t>( nx ) * ny * nz * frame;
+    }
+
+    init( data, nx, ny, nz,
+          props.get( Fn::Property::D_DX ).toFloat(), props.get( Fn::Property::D_DY ).toFloat(), props.get( Fn::Property::D_DZ ).toFloat(),
+          props.get( Fn::Property::D_ADJUST_X ).toFloat(), props.get( Fn::Property::D_ADJUST_Y ).toFloat(), props.get( Fn::Property::D_ADJUST_Z ).toFloat(),
+          mode );
+}
+
+VolumeSampler::VolumeSampler( const float* data, int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az, Mode mode ) :
+    m_points( 0 ),
+    m_outer( 0 ),
+    m_out( 0 ),
+    m_steps( 1 )
+{
+    init( data, nx, ny, nz, dx, dy, dz, ax, ay, az, mode );
+}
+
+VolumeSampler::~VolumeSampler()
+{
+}
+
+void VolumeSampler::init( const float* data, int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az, Mode mode )
+{
+    m_data = ( nx > 0 && ny > 0 && nz > 0 ) ? data : 0;
+    m_dims[0] = nx;
+    m_dims[1] = ny;
+    m_dims[2] = nz;
+    m_spacing[0] = dx > 0 ? dx : 1.0f;
+    m_spacing[1] = dy > 0 ? dy : 1.0f;
+    m_spacing[2] = dz > 0 ? dz : 1.0f;
+    m_adjust[0] = ax;
+    m_adjust[1] = ay;
+    m_adjust[2] = az;
+    m_mode = mode;
+}
+
+bool VolumeSampler::isValid()
+{
+    return m_data != 0;
+}
+
+void VolumeSampler::runPass( int pass, unsigned int size )
+{
+    // not worth a thread for a few points
+    if ( size < 4096 )
+    {
+        if ( pass == VolumeSamplerThread::POINTS )
+        {
+            sampleRange( 0, size );
+        }
+        else
+        {
+            sampleRibbonRange( 0, size );
+        }
+        return;
+    }
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<VolumeSamplerThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new VolumeSamplerThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+void VolumeSampler::sample( const float* points, unsigned int n, float* out )
+{
+    if ( !m_data )
+    {
+        std::fill( out, out + n, 0.0f );
+        return;
+    }
+    m_points = points;
+    m_out = out;
+    runPass( VolumeSamplerThread::POINTS, n );
+}
+
+void VolumeSampler::sampleRibbon( const float* inner, const float* outer, unsigned int n, int steps, float* out )
+{
+    if ( !m_data )
+    {
+        std::fill( out, out + n, 0.0f );
+        return;
+    }
+    m_points = inner;
+    m_outer = outer;
+    m_out = out;
+    m_steps = qMax( 1, steps );
+    runPass( VolumeSamplerThread::RIBBON, n );
+}
+
+float VolumeSampler::valueAt( float x, float y, float z )
+{
+    if ( !m_data )
+    {
+        return 0.0f;
+    }
+    return ( m_mode == NEAREST ) ? nearest( x, y, z ) : trilinear( x, y, z );
+}
+
+void VolumeSampler::sampleRange( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        const float* p = m_points + 3 * i;
+        m_out[i] = valueAt( p[0], p[1], p[2] );
+    }
+}
+
+void VolumeSampler::sampleRibbonRange( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        const float* a = m_points + 3 * i;
+        const float* b = m_outer + 3 * i;
+        if ( m_steps == 1 )
+        {
+            m_out[i] = valueAt( 0.5f * ( a[0] + b[0] ), 0.5f * ( a[1] + b[1] ), 0.5f * ( a[2] + b[2] ) );
+            continue;
+        }
+        float sum = 0.0f;
+        for ( int s = 0; s < m_steps; ++s )
+        {
+            float t = static_cast<float>( s ) / ( m_steps - 1 );
+            sum += valueAt( a[0] + t * ( b[0] - a[0] ), a[1] + t * ( b[1] - a[1] ), a[2] + t * ( b[2] - a[2] ) );
+        }
+        m_out[i] = sum / m_steps;
+    }
+}
+
+float VolumeSampler::nearest( float x, float y, float z )
+{
+    // same voxel lookup as DatasetNifti::getIdFromPos
+    int px = ( x + m_spacing[0] / 2 - m_adjust[0] ) / m_spacing[0];
+    int py = ( y + m_spacing[1] / 2 - m_adjust[1] ) / m_spacing[1];
+    int pz = ( z + m_spacing[2] / 2 - m_adjust[2] ) / m_spacing[2];
+    px = qMax( 0, qMin( px, m_dims[0] - 1 ) );
+    py = qMax( 0, qMin( py, m_dims[1] - 1 ) );
+    pz = qMax( 0, qMin( pz, m_dims[2] - 1 ) );
+    return m_data[ px + ( py + static_cast<size_t>( pz ) * m_dims[1] ) * m_dims[0] ];
+}
+
+float VolumeSampler::trilinear( float x, float y, float z )
+{
+    // continuous voxel coordinates with the voxel centers on the integers, clamped to the volume
+    float g[3] = { ( x - m_adjust[0] ) / m_spacing[0], ( y - m_adjust[1] ) / m_spacing[1], ( z - m_adjust[2] ) / m_spacing[2] };
+    int i0[3];
+    int i1[3];
+    float t[3];
+    for ( int a = 0; a < 3; ++a )
+    {
+        float v = qMax( 0.0f, qMin( g[a], static_cast<float>( m_dims[a] - 1 ) ) );
+        i0[a] = static_cast<int>( v );
+        i1[a] = qMin( i0[a] + 1, m_dims[a] - 1 );
+        t[a] = v - i0[a];
+    }
+
+    size_t nx = m_dims[0];
+    size_t nxy = nx * m_dims[1];
+    size_t z0 = i0[2] * nxy;
+    size_t z1 = i1[2] * nxy;
+    size_t y0 = i0[1] * nx;
+    size_t y1 = i1[1] * nx;
+
+    float c00 = m_data[z0 + y0 + i0[0]] * ( 1.0f - t[0] ) + m_data[z0 + y0 + i1[0]] * t[0];
+    float c10 = m_data[z0 + y1 + i0[0]] * ( 1.0f - t[0] ) + m_data[z0 + y1 + i1[0]] * t[0];
+    float c01 = m_data[z1 + y0 + i0[0]] * ( 1.0f - t[0] ) + m_data[z1 + y0 + i1[0]] * t[0];
+    float c11 = m_data[z1 + y1 + i0[0]] * ( 1.0f - t[0] ) + m_data[z1 + y1 + i1[0]] * t[0];
+
+    float c0 = c00 * ( 1.0f - t[1] ) + c10 * t[1];
+    float c1 = c01 * ( 1.0f - t[1] ) + c11 * t[1];
+
+    return c0 * ( 1.0f - t[2] ) + c1 * t[2];
+}
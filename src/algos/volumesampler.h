@@ -0,0 +1,70 @@
+/*
+ * volumesampler.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef VOLUMESAMPLER_H_
+#define VOLUMESAMPLER_H_
+
+#include <vector>
+
+class Dataset;
+class VolumeSamplerThread;
+
+/*
+ * Samples a scalar volume at arbitrary world positions. Dimensions, voxel size, offset and the data
+ * pointer are read once, the points are then split over the threads. Besides single points it averages
+ * along the segments between corresponding vertices of two surfaces, e.g. white and pial for the
+ * cortical ribbon. For series the selected frame is sampled.
+ */
+class VolumeSampler
+{
+    friend class VolumeSamplerThread;
+
+public:
+    enum Mode
+    {
+        NEAREST,
+        TRILINEAR
+    };
+
+    VolumeSampler( Dataset* ds, Mode mode = TRILINEAR );
+    VolumeSampler( const float* data, int nx, int ny, int nz, float dx, float dy, float dz, float ax = 0.0f, float ay = 0.0f, float az = 0.0f, Mode mode = TRILINEAR );
+    virtual ~VolumeSampler();
+
+    // false for datasets without a scalar volume
+    bool isValid();
+
+    // points and out hold xyz triplets and one value per point
+    void sample( const float* points, unsigned int n, float* out );
+
+    // mean of steps samples evenly spaced from inner to outer, both ends included, a single step takes the midpoint
+    void sampleRibbon( const float* inner, const float* outer, unsigned int n, int steps, float* out );
+
+    float valueAt( float x, float y, float z );
+
+private:
+    void init( const float* data, int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az, Mode mode );
+    void runPass( int pass, unsigned int size );
+
+    void sampleRange( unsigned int begin, unsigned int end );
+    void sampleRibbonRange( unsigned int begin, unsigned int end );
+
+    float nearest( float x, float y, float z );
+    float trilinear( float x, float y, float z );
+
+    const float* m_data;
+    int m_dims[3];
+    float m_spacing[3];
+    float m_adjust[3];
+    Mode m_mode;
+
+    const float* m_points;
+    const float* m_outer;
+    float* m_out;
+    int m_steps;
+};
+
+#endif /* VOLUMESAMPLER_H_ */
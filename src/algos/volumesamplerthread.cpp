@@ -0,0 +1,51 @@
+/*
+ * volumesamplerthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "volumesamplerthread.h"
+#include "volumesampler.h"
+#include "trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+VolumeSamplerThread::VolumeSamplerThread( VolumeSampler* sampler, int pass, unsigned int size, int id ) :
+    m_sampler( sampler ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+VolumeSamplerThread::~VolumeSamplerThread()
+{
+}
+
+void VolumeSamplerThread::run()
+{
+    TRACE_SCOPE( "VolumeSamplerThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case POINTS:
+            m_sampler->sampleRange( begin, end );
+            break;
+        case RIBBON:
+            m_sampler->sampleRibbonRange( begin, end );
+            break;
+    }
+}
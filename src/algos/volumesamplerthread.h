@@ -0,0 +1,36 @@
+/*
+ * volumesamplerthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef VOLUMESAMPLERTHREAD_H_
+#define VOLUMESAMPLERTHREAD_H_
+
+#include <QThread>
+
+class VolumeSampler;
+
+class VolumeSamplerThread : public QThread
+{
+public:
+    enum Pass
+    {
+        POINTS,
+        RIBBON
+    };
+
+    VolumeSamplerThread( VolumeSampler* sampler, int pass, unsigned int size, int id );
+    virtual ~VolumeSamplerThread();
+
+private:
+    void run();
+
+    VolumeSampler* m_sampler;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* VOLUMESAMPLERTHREAD_H_ */
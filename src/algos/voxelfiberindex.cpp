@@ -0,0 +1,269 @@
+/*
+ * voxelfiberindex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "voxelfiberindex.h"
+#include "voxelfiberindexthread.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+VoxelFiberIndex::VoxelFiberIndex( const float* verts, const std::vector<int>& lineStarts, const std::vector<int>& lineLengths,
+                                  int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az ) :
+    m_verts( verts ),
+    m_lineStarts( lineStarts ),
+    m_lineLengths( lineLengths ),
+    m_nx( nx ),
+    m_ny( ny ),
+    m_nz( nz ),
+    m_dx( dx ),
+    m_dy( dy ),
+    m_dz( dz ),
+    m_ax( ax ),
+    m_ay( ay ),
+    m_az( az ),
+    m_numVoxels( nx * ny * nz )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    int numThreads = GLFunctions::idealThreadCount;
+    int numLines = m_lineStarts.size();
+
+    std::vector<VoxelFiberIndexThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new VoxelFiberIndexThread( this, VoxelFiberIndexThread::LINE_VOXELS, numLines, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+    }
+
+    // counting sort of the (voxel, line) pairs, threads hold ascending line ranges so every
+    // posting list comes out sorted
+    m_postingStarts.resize( m_numVoxels + 1, 0 );
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        const std::vector<int>& voxels = threads[i]->m_voxels;
+        for ( unsigned int k = 0; k < voxels.size(); ++k )
+        {
+            ++m_postingStarts[voxels[k] + 1];
+        }
+    }
+    for ( int i = 0; i < m_numVoxels; ++i )
+    {
+        m_postingStarts[i + 1] += m_postingStarts[i];
+    }
+    m_postings.resize( m_postingStarts[m_numVoxels] );
+
+    std::vector<unsigned int> cursor( m_postingStarts.begin(), m_postingStarts.end() - 1 );
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        const std::vector<int>& voxels = threads[i]->m_voxels;
+        const std::vector<unsigned int>& counts = threads[i]->m_counts;
+        unsigned int pos = 0;
+        for ( unsigned int k = 0; k < counts.size(); ++k )
+        {
+            unsigned int line = threads[i]->m_begin + k;
+            for ( unsigned int l = 0; l < counts[k]; ++l )
+            {
+                m_postings[cursor[voxels[pos++]]++] = line;
+            }
+        }
+        delete threads[i];
+    }
+    threads.clear();
+
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new VoxelFiberIndexThread( this, VoxelFiberIndexThread::ENCODE, m_numVoxels, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+    }
+
+    quint64 numBytes = 0;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        numBytes += threads[i]->m_bytes.size();
+    }
+    m_bytes.reserve( numBytes );
+    m_offsets.resize( m_numVoxels + 1 );
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        quint64 base = m_bytes.size();
+        const std::vector<quint64>& offsets = threads[i]->m_offsets;
+        for ( unsigned int k = 0; k < offsets.size(); ++k )
+        {
+            m_offsets[threads[i]->m_begin + k] = base + offsets[k];
+        }
+        m_bytes.insert( m_bytes.end(), threads[i]->m_bytes.begin(), threads[i]->m_bytes.end() );
+        delete threads[i];
+    }
+    m_offsets[m_numVoxels] = m_bytes.size();
+
+    qDebug() << "voxel fiber index:" << m_postings.size() << "entries," << byteSize() / 1000000.0 << "MB, built in" << timer.elapsed() << "ms";
+
+    std::vector<unsigned int>().swap( m_postingStarts );
+    std::vector<unsigned int>().swap( m_postings );
+}
+
+VoxelFiberIndex::~VoxelFiberIndex()
+{
+}
+
+bool VoxelFiberIndex::matches( int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az )
+{
+    return nx == m_nx && ny == m_ny && nz == m_nz && dx == m_dx && dy == m_dy && dz == m_dz && ax == m_ax && ay == m_ay && az == m_az;
+}
+
+int VoxelFiberIndex::voxelId( const float* p )
+{
+    int px = ( p[0] + m_dx / 2 - m_ax ) / m_dx;
+    int py = ( p[1] + m_dy / 2 - m_ay ) / m_dy;
+    int pz = ( p[2] + m_dz / 2 - m_az ) / m_dz;
+
+    px = qMax( 0, qMin( px, m_nx - 1 ) );
+    py = qMax( 0, qMin( py, m_ny - 1 ) );
+    pz = qMax( 0, qMin( pz, m_nz - 1 ) );
+
+    return px + py * m_nx + pz * m_nx * m_ny;
+}
+
+void VoxelFiberIndex::lineVoxels( int begin, int end, std::vector<int>& voxels, std::vector<unsigned int>& counts )
+{
+    counts.reserve( end - begin );
+    for ( int i = begin; i < end; ++i )
+    {
+        unsigned int first = voxels.size();
+        const float* p = m_verts + m_lineStarts[i] * 3;
+        for ( int k = 0; k < m_lineLengths[i]; ++k )
+        {
+            int id = voxelId( p + k * 3 );
+            // consecutive points mostly stay in the same voxel
+            if ( voxels.size() == first || voxels.back() != id )
+            {
+                voxels.push_back( id );
+            }
+        }
+        std::sort( voxels.begin() + first, voxels.end() );
+        voxels.erase( std::unique( voxels.begin() + first, voxels.end() ), voxels.end() );
+        counts.push_back( voxels.size() - first );
+    }
+}
+
+void VoxelFiberIndex::encode( int begin, int end, std::vector<unsigned char>& bytes, std::vector<quint64>& offsets )
+{
+    offsets.resize( end - begin );
+    for ( int i = begin; i < end; ++i )
+    {
+        offsets[i - begin] = bytes.size();
+        unsigned int prev = 0;
+        for ( unsigned int k = m_postingStarts[i]; k < m_postingStarts[i + 1]; ++k )
+        {
+            unsigned int delta = m_postings[k] - prev;
+            prev = m_postings[k];
+            while ( delta >= 0x80 )
+            {
+                bytes.push_back( ( delta & 0x7f ) | 0x80 );
+                delta >>= 7;
+            }
+            bytes.push_back( delta );
+        }
+    }
+}
+
+void VoxelFiberIndex::select( const std::vector<float>& data, float threshold, std::vector<bool>& out )
+{
+    int size = qMin( (int)data.size(), m_numVoxels );
+    const unsigned char* bytes = m_bytes.empty() ? 0 : &m_bytes[0];
+    for ( int i = 0; i < size; ++i )
+    {
+        if ( data[i] - threshold > 0 )
+        {
+            unsigned int fiber = 0;
+            unsigned int value = 0;
+            int shift = 0;
+            for ( quint64 k = m_offsets[i]; k < m_offsets[i + 1]; ++k )
+            {
+                value |= ( bytes[k] & 0x7f ) << shift;
+                if ( bytes[k] & 0x80 )
+                {
+                    shift += 7;
+                }
+                else
+                {
+                    fiber += value;
+                    out[fiber] = true;
+                    value = 0;
+                    shift = 0;
+                }
+            }
+        }
+    }
+}
+
+void VoxelFiberIndex::fibers( int voxel, std::vector<unsigned int>& out )
+{
+    out.clear();
+    unsigned int fiber = 0;
+    unsigned int value = 0;
+    int shift = 0;
+    for ( quint64 k = m_offsets[voxel]; k < m_offsets[voxel + 1]; ++k )
+    {
+        value |= ( m_bytes[k] & 0x7f ) << shift;
+        if ( m_bytes[k] & 0x80 )
+        {
+            shift += 7;
+        }
+        else
+        {
+            fiber += value;
+            out.push_back( fiber );
+            value = 0;
+            shift = 0;
+        }
+    }
+}
+
+unsigned int VoxelFiberIndex::numFibers( int voxel )
+{
+    // every encoded id ends with exactly one byte without continuation bit
+    unsigned int count = 0;
+    for ( quint64 k = m_offsets[voxel]; k < m_offsets[voxel + 1]; ++k )
+    {
+        count += ( m_bytes[k] & 0x80 ) ? 0 : 1;
+    }
+    return count;
+}
+
+void VoxelFiberIndex::density( std::vector<float>& out )
+{
+    out.resize( m_numVoxels );
+    for ( int i = 0; i < m_numVoxels; ++i )
+    {
+        out[i] = numFibers( i );
+    }
+}
+
+quint64 VoxelFiberIndex::byteSize()
+{
+    return m_bytes.size() + m_offsets.size() * sizeof( quint64 );
+}
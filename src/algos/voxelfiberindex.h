@@ -0,0 +1,71 @@
+/*
+ * voxelfiberindex.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef VOXELFIBERINDEX_H_
+#define VOXELFIBERINDEX_H_
+
+#include <QtGlobal>
+
+#include <vector>
+
+class VoxelFiberIndexThread;
+
+/*
+ * Inverted index from the voxels of a regular grid to the fibers passing through them. Posting lists
+ * are stored as CSR over all voxels, each list holds sorted fiber ids as variable length encoded deltas.
+ */
+class VoxelFiberIndex
+{
+    friend class VoxelFiberIndexThread;
+
+public:
+    VoxelFiberIndex( const float* verts, const std::vector<int>& lineStarts, const std::vector<int>& lineLengths,
+                     int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az );
+    virtual ~VoxelFiberIndex();
+
+    bool matches( int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az );
+
+    // sets out[fiber] for every fiber passing through a voxel with data > threshold, out is not cleared
+    void select( const std::vector<float>& data, float threshold, std::vector<bool>& out );
+
+    void fibers( int voxel, std::vector<unsigned int>& out );
+    unsigned int numFibers( int voxel );
+
+    // number of fibers per voxel
+    void density( std::vector<float>& out );
+
+    quint64 byteSize();
+
+private:
+    int voxelId( const float* p );
+    void lineVoxels( int begin, int end, std::vector<int>& voxels, std::vector<unsigned int>& counts );
+    void encode( int begin, int end, std::vector<unsigned char>& bytes, std::vector<quint64>& offsets );
+
+    const float* m_verts;
+    const std::vector<int>& m_lineStarts;
+    const std::vector<int>& m_lineLengths;
+
+    int m_nx;
+    int m_ny;
+    int m_nz;
+    float m_dx;
+    float m_dy;
+    float m_dz;
+    float m_ax;
+    float m_ay;
+    float m_az;
+    int m_numVoxels;
+
+    // uncompressed posting lists, only alive during construction
+    std::vector<unsigned int> m_postingStarts;
+    std::vector<unsigned int> m_postings;
+
+    std::vector<quint64> m_offsets;
+    std::vector<unsigned char> m_bytes;
+};
+
+#endif /* VOXELFIBERINDEX_H_ */
@@ -0,0 +1,51 @@
+/*
+ * voxelfiberindexthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "voxelfiberindexthread.h"
+#include "trace.h"
+#include "voxelfiberindex.h"
+
+#include "../gui/gl/glfunctions.h"
+
+VoxelFiberIndexThread::VoxelFiberIndexThread( VoxelFiberIndex* index, int pass, int size, int id ) :
+    m_index( index ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id ),
+    m_begin( 0 ),
+    m_end( 0 )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    int chunkSize = m_size / numThreads;
+
+    m_begin = m_id * chunkSize;
+    m_end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        m_end = m_size;
+    }
+}
+
+VoxelFiberIndexThread::~VoxelFiberIndexThread()
+{
+}
+
+void VoxelFiberIndexThread::run()
+{
+    TRACE_SCOPE( "VoxelFiberIndexThread::run" );
+    switch ( m_pass )
+    {
+        case LINE_VOXELS:
+            m_index->lineVoxels( m_begin, m_end, m_voxels, m_counts );
+            break;
+        case ENCODE:
+            m_index->encode( m_begin, m_end, m_bytes, m_offsets );
+            break;
+    }
+}
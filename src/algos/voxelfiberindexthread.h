@@ -0,0 +1,50 @@
+/*
+ * voxelfiberindexthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef VOXELFIBERINDEXTHREAD_H_
+#define VOXELFIBERINDEXTHREAD_H_
+
+#include <QThread>
+
+#include <vector>
+
+class VoxelFiberIndex;
+
+class VoxelFiberIndexThread : public QThread
+{
+    friend class VoxelFiberIndex;
+
+public:
+    enum Pass
+    {
+        LINE_VOXELS,    // line range
+        ENCODE          // voxel range
+    };
+
+    VoxelFiberIndexThread( VoxelFiberIndex* index, int pass, int size, int id );
+    virtual ~VoxelFiberIndexThread();
+
+private:
+    void run();
+
+    VoxelFiberIndex* m_index;
+    int m_pass;
+    int m_size;
+    int m_id;
+    int m_begin;
+    int m_end;
+
+    // LINE_VOXELS: unique voxels of each line in line order and their number per line
+    std::vector<int> m_voxels;
+    std::vector<unsigned int> m_counts;
+
+    // ENCODE: encoded posting lists of the voxel range, offsets relative to the thread buffer
+    std::vector<unsigned char> m_bytes;
+    std::vector<quint64> m_offsets;
+};
+
+#endif /* VOXELFIBERINDEXTHREAD_H_ */
@@ -0,0 +1,603 @@
+/*
+ * benchmark.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "benchmark.h"
+
+#include "../algos/compatibilities.h"
+#include "../algos/compatibilitiesthread.h"
+#include "../algos/correlation.h"
+#include "../algos/edge.h"
+#include "../algos/fiberspatialindex.h"
+#include "../algos/fmath.h"
+#include "../algos/kdtree.h"
+#include "../algos/loopsubdivision.h"
+#include "../algos/marchingsquares.h"
+#include "../algos/trace.h"
+#include "../algos/trackthread.h"
+#include "../algos/tractdensity.h"
+#include "../algos/voxelfiberindex.h"
+
+#include "../data/mesh/isosurface.h"
+#include "../data/mesh/trianglemesh2.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+#include <QEventLoop>
+#include <QFile>
+#include <QTextStream>
+
+#include <cmath>
+
+Benchmark::Benchmark( float scale ) :
+    m_scale( qMax( 0.01f, scale ) ),
+    m_seed( 1 )
+{
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+QStringList Benchmark::kernels()
+{
+    return QStringList() << "kdtree" << "fiberselector" << "tractdensity" << "fittensors" << "track" << "isosurface"
+                         << "marchingsquares" << "loopsubdivision" << "correlation" << "compatibilities";
+}
+
+bool Benchmark::run( QString kernel, QString baselineFile )
+{
+    QStringList names = kernels();
+    if ( kernel != "all" && !names.contains( kernel ) )
+    {
+        qCritical() << "benchmark: unknown kernel" << kernel << ", one of" << names.join( ", " );
+        return false;
+    }
+
+    QTextStream out( stdout );
+    out << "kernel\tsize\tms\tthroughput\tunit\tpeak_mb\tcheck" << endl;
+
+    for ( int i = 0; i < names.size(); ++i )
+    {
+        if ( kernel != "all" && kernel != names[i] )
+        {
+            continue;
+        }
+        // every kernel starts from the same seed, so a single kernel run matches its line in a full run
+        m_seed = 1;
+        switch ( i )
+        {
+            case 0: kdTree(); break;
+            case 1: fiberSelector(); break;
+            case 2: tractDensity(); break;
+            case 3: fitTensors(); break;
+            case 4: track(); break;
+            case 5: isoSurface(); break;
+            case 6: marchingSquares(); break;
+            case 7: loopSubdivision(); break;
+            case 8: correlation(); break;
+            case 9: compatibilities(); break;
+        }
+        Result& r = m_results.back();
+        out << r.kernel << "\t" << r.size << "\t" << QString::number( r.ms, 'f', 1 ) << "\t" << QString::number( r.throughput, 'f', 0 )
+            << "\t" << r.unit << "\t" << QString::number( r.peakMemory / ( 1024. * 1024. ), 'f', 1 ) << "\t" << r.check << endl;
+    }
+
+    if ( !baselineFile.isEmpty() )
+    {
+        return compare( baselineFile );
+    }
+    return true;
+}
+
+bool Benchmark::compare( QString baselineFile )
+{
+    QFile file( baselineFile );
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        qCritical() << "benchmark: couldn't open baseline" << baselineFile;
+        return false;
+    }
+    QTextStream in( &file );
+    QTextStream out( stdout );
+    bool ok = true;
+    while ( !in.atEnd() )
+    {
+        QStringList fields = in.readLine().split( "\t" );
+        if ( fields.size() < 7 || fields[0] == "kernel" )
+        {
+            continue;
+        }
+        for ( unsigned int i = 0; i < m_results.size(); ++i )
+        {
+            Result& r = m_results[i];
+            if ( r.kernel != fields[0] || r.size != fields[1] )
+            {
+                continue;
+            }
+            double baseMs = fields[2].toDouble();
+            if ( r.check != fields[6] )
+            {
+                out << "REGRESSION\t" << r.kernel << "\tcheck " << r.check << " != " << fields[6] << endl;
+                ok = false;
+            }
+            else if ( r.ms > baseMs * 1.2 )
+            {
+                out << "REGRESSION\t" << r.kernel << "\t" << QString::number( r.ms, 'f', 1 ) << " ms vs "
+                    << QString::number( baseMs, 'f', 1 ) << " ms" << endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+void Benchmark::start()
+{
+    m_timer.start();
+}
+
+void Benchmark::stop( QString kernel, QString size, double items, QString unit, QString check )
+{
+    Result r;
+    r.kernel = kernel;
+    r.size = size;
+    r.ms = m_timer.nsecsElapsed() / 1e6;
+    r.throughput = items / qMax( 1e-9, r.ms / 1000. );
+    r.unit = unit;
+    r.peakMemory = Trace::peakMemory();
+    r.check = check;
+    m_results.push_back( r );
+}
+
+unsigned int Benchmark::random()
+{
+    m_seed = m_seed * 1664525u + 1013904223u;
+    return m_seed >> 8;
+}
+
+float Benchmark::randomFloat()
+{
+    return ( random() & 0xffff ) / 65535.0f;
+}
+
+void Benchmark::tractogram( int numFibers, int numVerts, float size, std::vector<Fib>& out )
+{
+    // random walks with 1mm steps, clamped to the cube
+    out.resize( numFibers );
+    std::vector<QVector3D> verts( numVerts );
+    for ( int i = 0; i < numFibers; ++i )
+    {
+        QVector3D p( randomFloat() * size, randomFloat() * size, randomFloat() * size );
+        QVector3D dir( randomFloat() - 0.5f, randomFloat() - 0.5f, randomFloat() - 0.5f );
+        dir.normalize();
+        for ( int k = 0; k < numVerts; ++k )
+        {
+            verts[k] = p;
+            QVector3D jitter( randomFloat() - 0.5f, randomFloat() - 0.5f, randomFloat() - 0.5f );
+            dir = ( dir + jitter * 0.5f ).normalized();
+            p += dir;
+            p.setX( qMax( 0.0f, qMin( size - 0.01f, p.x() ) ) );
+            p.setY( qMax( 0.0f, qMin( size - 0.01f, p.y() ) ) );
+            p.setZ( qMax( 0.0f, qMin( size - 0.01f, p.z() ) ) );
+        }
+        out[i] = Fib( verts );
+    }
+}
+
+void Benchmark::tensorField( int n, std::vector<Matrix>& tensors, std::vector<Matrix>& logTensors )
+{
+    // isotropic background with three straight tracts along the axes and a half ring in the upper part,
+    // tract voxels are prolate with fa 0.8 along the tract direction
+    const float l1 = 1.7e-3f;
+    const float l2 = 0.3e-3f;
+    const float iso = 0.7e-3f;
+    const float radius = n / 16.0f + 1.0f;
+
+    int blockSize = n * n * n;
+    tensors.resize( blockSize );
+    logTensors.resize( blockSize );
+    for ( int z = 0; z < n; ++z )
+    {
+        for ( int y = 0; y < n; ++y )
+        {
+            for ( int x = 0; x < n; ++x )
+            {
+                QVector3D dir( 0, 0, 0 );
+                if ( qAbs( y - n / 4 ) < radius && qAbs( z - n / 2 ) < radius )
+                {
+                    dir = QVector3D( 1, 0, 0 );
+                }
+                else if ( qAbs( x - n / 2 ) < radius && qAbs( z - n / 4 ) < radius )
+                {
+                    dir = QVector3D( 0, 1, 0 );
+                }
+                else if ( qAbs( x - 3 * n / 4 ) < radius && qAbs( y - 3 * n / 4 ) < radius )
+                {
+                    dir = QVector3D( 0, 0, 1 );
+                }
+                else if ( y > n / 2 && qAbs( z - 3 * n / 4 ) < radius )
+                {
+                    float dx = x - n / 2.0f;
+                    float dy = y - n / 2.0f;
+                    float r = sqrt( dx * dx + dy * dy );
+                    if ( qAbs( r - n / 3.0f ) < radius )
+                    {
+                        dir = QVector3D( -dy, dx, 0 ).normalized();
+                    }
+                }
+
+                // D = l2 * I + ( l1 - l2 ) * e * e^T, log( D ) has the same eigenvectors
+                float a = dir.isNull() ? iso : l2;
+                float b = dir.isNull() ? 0 : l1 - l2;
+                float la = log( a );
+                float lb = dir.isNull() ? 0 : log( l1 ) - log( l2 );
+                float e[3] = { dir.x(), dir.y(), dir.z() };
+                Matrix t( 3, 3 );
+                Matrix lt( 3, 3 );
+                for ( int i = 0; i < 3; ++i )
+                {
+                    for ( int k = 0; k < 3; ++k )
+                    {
+                        float ee = e[i] * e[k];
+                        t( i + 1, k + 1 ) = ( i == k ? a : 0 ) + b * ee;
+                        lt( i + 1, k + 1 ) = ( i == k ? la : 0 ) + lb * ee;
+                    }
+                }
+                int id = x + y * n + z * n * n;
+                tensors[id] = t;
+                logTensors[id] = lt;
+            }
+        }
+    }
+}
+
+void Benchmark::gradients( int numDirections, std::vector<QVector3D>& out )
+{
+    // fibonacci points on the half sphere
+    out.resize( numDirections );
+    const float golden = M_PI * ( 3.0f - sqrt( 5.0f ) );
+    for ( int i = 0; i < numDirections; ++i )
+    {
+        float z = 1.0f - ( i + 0.5f ) / numDirections;
+        float r = sqrt( 1.0f - z * z );
+        out[i] = QVector3D( r * cos( golden * i ), r * sin( golden * i ), z );
+    }
+}
+
+void Benchmark::sphere( int n, std::vector<float>& out )
+{
+    // distance to the volume center, the isosurface at n / 3 is a sphere
+    out.resize( n * n * n );
+    float c = ( n - 1 ) / 2.0f;
+    for ( int z = 0; z < n; ++z )
+    {
+        for ( int y = 0; y < n; ++y )
+        {
+            for ( int x = 0; x < n; ++x )
+            {
+                out[x + y * n + z * n * n] = sqrt( ( x - c ) * ( x - c ) + ( y - c ) * ( y - c ) + ( z - c ) * ( z - c ) );
+            }
+        }
+    }
+}
+
+TriangleMesh2* Benchmark::octahedron()
+{
+    TriangleMesh2* mesh = new TriangleMesh2( 6, 8 );
+    mesh->addVertex( 1, 0, 0 );
+    mesh->addVertex( -1, 0, 0 );
+    mesh->addVertex( 0, 1, 0 );
+    mesh->addVertex( 0, -1, 0 );
+    mesh->addVertex( 0, 0, 1 );
+    mesh->addVertex( 0, 0, -1 );
+    mesh->addTriangle( 0, 2, 4 );
+    mesh->addTriangle( 2, 1, 4 );
+    mesh->addTriangle( 1, 3, 4 );
+    mesh->addTriangle( 3, 0, 4 );
+    mesh->addTriangle( 2, 0, 5 );
+    mesh->addTriangle( 1, 2, 5 );
+    mesh->addTriangle( 3, 1, 5 );
+    mesh->addTriangle( 0, 3, 5 );
+    mesh->finalize();
+    return mesh;
+}
+
+void Benchmark::kdTree()
+{
+    int numPoints = 2000000 * m_scale;
+    std::vector<float> points( numPoints * 3 );
+    for ( int i = 0; i < numPoints * 3; ++i )
+    {
+        points[i] = randomFloat() * 180.0f;
+    }
+
+    start();
+    KdTree tree( numPoints, points.data() );
+    stop( "kdtree", QString::number( numPoints ) + " points", numPoints, "points/s", QString::number( tree.m_tree.size() ) );
+}
+
+void Benchmark::fiberSelector()
+{
+    int numFibers = 100000 * m_scale;
+    const int numVerts = 100;
+    std::vector<Fib> fibs;
+    tractogram( numFibers, numVerts, 180.0f, fibs );
+
+    // what the fiber selector builds for a dataset and a volume roi on a 1mm grid, then the selection of a
+    // spherical volume roi and of a sphere roi of the same size
+    start();
+    FiberSpatialIndex index( fibs );
+    std::vector<float> roi;
+    sphere( 180, roi );
+    for ( unsigned int i = 0; i < roi.size(); ++i )
+    {
+        roi[i] = roi[i] < 30 ? 1 : 0;
+    }
+    std::vector<bool> selected( numFibers, false );
+    index.voxelIndex( 180, 180, 180, 1, 1, 1, 0, 0, 0 )->select( roi, 0.5f, selected );
+
+    float center[3] = { 90, 90, 90 };
+    float radii[3] = { 30, 30, 30 };
+    float boxMin[3] = { 60, 60, 60 };
+    float boxMax[3] = { 120, 120, 120 };
+    std::vector<bool> inSphere( numFibers, false );
+    index.selectBox( boxMin, boxMax, inSphere );
+    index.restrictToEllipsoid( center, radii, inSphere );
+
+    int numSelected = 0;
+    int numInSphere = 0;
+    for ( int i = 0; i < numFibers; ++i )
+    {
+        numSelected += selected[i];
+        numInSphere += inSphere[i];
+    }
+    stop( "fiberselector", QString::number( numFibers ) + " fibers", numFibers, "fibers/s", QString::number( numSelected ) + "/" + QString::number( numInSphere ) );
+}
+
+void Benchmark::tractDensity()
+{
+    int numFibers = 100000 * m_scale;
+    const int numVerts = 100;
+    std::vector<Fib> fibs;
+    tractogram( numFibers, numVerts, 180.0f, fibs );
+
+    start();
+    TractDensity density( &fibs, 180, 180, 180, 1, 1, 1, 0, 0, 0 );
+    density.run( TractDensity::COUNT | TractDensity::LENGTH | TractDensity::COLOR );
+    double total = 0;
+    for ( unsigned int i = 0; i < density.count()->size(); ++i )
+    {
+        total += density.count()->at( i );
+    }
+    stop( "tractdensity", QString::number( numFibers ) + " fibers", numFibers, "fibers/s", QString::number( total, 'f', 0 ) );
+}
+
+void Benchmark::fitTensors()
+{
+    int n = 64 * pow( m_scale, 1.0f / 3.0f );
+    const int numDirections = 30;
+    const float bValue = 1000.0f;
+    const float s0 = 1000.0f;
+
+    std::vector<Matrix> tensors;
+    std::vector<Matrix> logTensors;
+    tensorField( n, tensors, logTensors );
+    std::vector<QVector3D> bvecs;
+    gradients( numDirections, bvecs );
+    std::vector<float> bvals( numDirections, bValue );
+
+    // signal of each direction as s0 * exp( -b g^T D g ), one volume after the other
+    int blockSize = n * n * n;
+    std::vector<float> b0( blockSize, s0 );
+    std::vector<float> data( blockSize * numDirections );
+    for ( int i = 0; i < blockSize; ++i )
+    {
+        for ( int j = 0; j < numDirections; ++j )
+        {
+            float g[3] = { bvecs[j].x(), bvecs[j].y(), bvecs[j].z() };
+            double adc = 0;
+            for ( int a = 0; a < 3; ++a )
+            {
+                for ( int b = 0; b < 3; ++b )
+                {
+                    adc += g[a] * tensors[i]( a + 1, b + 1 ) * g[b];
+                }
+            }
+            data[j * blockSize + i] = s0 * exp( -bValue * adc );
+        }
+    }
+
+    std::vector<Matrix> fitted;
+    start();
+    FMath::fitTensors( data, b0, bvecs, bvals, fitted );
+    stop( "fittensors", QString::number( n ) + "^3 voxels", blockSize, "voxels/s", "" );
+
+    // largest fa difference to the generating field in thousandths
+    std::vector<float> faIn;
+    std::vector<float> faOut;
+    FMath::fa( tensors, faIn );
+    FMath::fa( fitted, faOut );
+    float maxDiff = 0;
+    for ( int i = 0; i < blockSize; ++i )
+    {
+        maxDiff = qMax( maxDiff, qAbs( faIn[i] - faOut[i] ) );
+    }
+    m_results.back().check = QString::number( qRound( maxDiff * 1000 ) );
+}
+
+void Benchmark::track()
+{
+    int n = 64 * pow( m_scale, 1.0f / 3.0f );
+    std::vector<Matrix> tensors;
+    std::vector<Matrix> logTensors;
+    tensorField( n, tensors, logTensors );
+    std::vector<float> fa;
+    std::vector<QVector3D> evec1;
+    FMath::fa( tensors, fa );
+    FMath::evec1( tensors, evec1 );
+
+    // same defaults as Track, seeds in every voxel above the start fa
+    start();
+    int numThreads = GLFunctions::idealThreadCount;
+    std::vector<TrackThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new TrackThread( &tensors, &logTensors, &fa, &evec1, n, n, n, 1, 1, 1, i, 10, 0.2f, 0.2f, 1.0f, 0.0f ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+    }
+    int numFibers = 0;
+    quint64 numPoints = 0;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        std::vector<Fib>* fibs = threads[i]->getFibs();
+        numFibers += fibs->size();
+        for ( unsigned int k = 0; k < fibs->size(); ++k )
+        {
+            numPoints += fibs->at( k ).length();
+        }
+        delete threads[i];
+    }
+    stop( "track", QString::number( n ) + "^3 voxels", numFibers, "fibers/s", QString::number( numFibers ) + "/" + QString::number( numPoints ) );
+}
+
+void Benchmark::isoSurface()
+{
+    int n = 128 * pow( m_scale, 1.0f / 3.0f );
+    std::vector<float> field;
+    sphere( n, field );
+
+    // what the iso surface dataset runs for every new iso value
+    start();
+    IsoSurface isoSurface( &field, n, n, n, 1, 1, 1 );
+    TriangleMesh2* mesh = isoSurface.run( n / 3.0f );
+    stop( "isosurface", QString::number( n ) + "^3 voxels", n * n * n, "voxels/s", QString::number( mesh->numTris() ) );
+    delete mesh;
+}
+
+void Benchmark::marchingSquares()
+{
+    int n = 256 * pow( m_scale, 1.0f / 3.0f );
+    std::vector<float> volume;
+    sphere( n, volume );
+
+    std::vector<float> slice( n * n );
+    quint64 numValues = 0;
+    start();
+    for ( int z = 0; z < n; ++z )
+    {
+        slice.assign( volume.begin() + z * n * n, volume.begin() + ( z + 1 ) * n * n );
+        MarchingSquares squares( &slice, n / 3.0f, n, n, 1, 1 );
+        numValues += squares.run().size();
+    }
+    stop( "marchingsquares", QString::number( n ) + " slices of " + QString::number( n ) + "^2", n * n * n, "pixels/s", QString::number( numValues ) );
+}
+
+void Benchmark::loopSubdivision()
+{
+    int levels = m_scale < 1 ? 6 : 7;
+    TriangleMesh2* mesh = octahedron();
+
+    start();
+    LoopSubdivision loop( mesh, levels );
+    TriangleMesh2* out = loop.getMesh();
+    stop( "loopsubdivision", QString::number( levels ) + " levels", out->numTris(), "triangles/s", QString::number( out->numVerts() ) + "/" + QString::number( out->numTris() ) );
+
+    delete out;
+    delete mesh;
+}
+
+void Benchmark::correlation()
+{
+    // random series on a 4098 vertex sphere, one vertex after the other as the time series dataset keeps them
+    TriangleMesh2* mesh = octahedron();
+    LoopSubdivision loop( mesh, 5 );
+    delete mesh;
+    mesh = loop.getMesh();
+    int numVerts = mesh->numVerts();
+    delete mesh;
+
+    int numFrames = 200 * m_scale;
+    std::vector<float> frames( numVerts * numFrames );
+    for ( int i = 0; i < numVerts * numFrames; ++i )
+    {
+        frames[i] = randomFloat();
+    }
+    std::vector<float> series( numVerts * numFrames );
+    for ( int i = 0; i < numVerts; ++i )
+    {
+        for ( int k = 0; k < numFrames; ++k )
+        {
+            series[i * numFrames + k] = frames[k * numVerts + i];
+        }
+    }
+
+    Correlation* correlation = new Correlation( series.data(), numVerts, numFrames );
+    QEventLoop loopEvents;
+    QObject::connect( correlation, SIGNAL( finished() ), &loopEvents, SLOT( quit() ) );
+
+    start();
+    correlation->start();
+    loopEvents.exec();
+    float** result = correlation->getResult();
+    double pairs = 0.5 * numVerts * ( numVerts + 1.0 );
+    stop( "correlation", QString::number( numVerts ) + " x " + QString::number( numFrames ), pairs, "pairs/s",
+          QString::number( result[0][numVerts - 1], 'f', 4 ) );
+
+    for ( int i = 0; i < numVerts; ++i )
+    {
+        delete[] result[i];
+    }
+    delete[] result;
+    delete correlation;
+}
+
+void Benchmark::compatibilities()
+{
+    int numEdges = 3000 * sqrt( m_scale );
+    QList<Edge*> edges;
+    for ( int i = 0; i < numEdges; ++i )
+    {
+        QVector3D fn( randomFloat() * 100, randomFloat() * 100, randomFloat() * 100 );
+        QVector3D tn( randomFloat() * 100, randomFloat() * 100, randomFloat() * 100 );
+        edges.push_back( new Edge( fn, tn ) );
+    }
+
+    start();
+    Compatibilities* comps = new Compatibilities( numEdges );
+    int numThreads = GLFunctions::idealThreadCount;
+    std::vector<CompatibilitiesThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new CompatibilitiesThread( i, 0.8f, edges, comps ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+    quint64 numComps = 0;
+    for ( int i = 0; i < numEdges; ++i )
+    {
+        numComps += comps->idxs->at( i )->size();
+    }
+    stop( "compatibilities", QString::number( numEdges ) + " edges", 1.0 * numEdges * numEdges, "pairs/s", QString::number( numComps ) );
+
+    delete comps;
+    qDeleteAll( edges );
+}
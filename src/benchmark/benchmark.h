@@ -0,0 +1,84 @@
+/*
+ * benchmark.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include "../algos/fib.h"
+
+#include "../thirdparty/newmat10/newmat.h"
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+class TriangleMesh2;
+
+/*
+ * Runs the hot kernels on deterministic synthetic inputs and prints one tab separated line per kernel
+ * with time, throughput, peak memory and a result check value. Given the output of an earlier run as
+ * baseline, kernels that got more than 20% slower or whose check value changed are reported as regressions.
+ * scale multiplies the input sizes, 1 is roughly a whole brain dataset. The kernels are driven directly,
+ * without datasets or models, so the benchmark links only the algorithm sources.
+ */
+class Benchmark
+{
+public:
+    Benchmark( float scale = 1.0f );
+    virtual ~Benchmark();
+
+    // runs a single kernel or "all", returns false on an unknown kernel or a regression
+    bool run( QString kernel = "all", QString baselineFile = "" );
+
+    static QStringList kernels();
+
+private:
+    struct Result
+    {
+        QString kernel;
+        QString size;
+        double ms;
+        double throughput;
+        QString unit;
+        quint64 peakMemory;
+        QString check;
+    };
+
+    void kdTree();
+    void fiberSelector();
+    void tractDensity();
+    void fitTensors();
+    void track();
+    void isoSurface();
+    void marchingSquares();
+    void loopSubdivision();
+    void correlation();
+    void compatibilities();
+
+    // synthetic inputs
+    unsigned int random();
+    float randomFloat();
+    void tractogram( int numFibers, int numVerts, float size, std::vector<Fib>& out );
+    void tensorField( int n, std::vector<Matrix>& tensors, std::vector<Matrix>& logTensors );
+    void gradients( int numDirections, std::vector<QVector3D>& out );
+    void sphere( int n, std::vector<float>& out );
+    TriangleMesh2* octahedron();
+
+    void start();
+    void stop( QString kernel, QString size, double items, QString unit, QString check );
+
+    bool compare( QString baselineFile );
+
+    float m_scale;
+    unsigned int m_seed;
+    QElapsedTimer m_timer;
+    std::vector<Result> m_results;
+};
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,31 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "benchmark.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    QStringList args = app.arguments();
+    if ( args.contains( "-h" ) || args.contains( "--help" ) )
+    {
+        qDebug() << "braingl_benchmark [kernel] [scale] [baseline] : times kernels on synthetic data, compares against an earlier output";
+        qDebug() << "    kernels: all," << Benchmark::kernels().join( ", " );
+        return 0;
+    }
+
+    QString kernel = args.size() > 1 ? args.at( 1 ) : "all";
+    float scale = args.size() > 2 ? args.at( 2 ).toFloat() : 1.0f;
+    QString baseline = args.size() > 3 ? args.at( 3 ) : "";
+
+    Benchmark benchmark( scale );
+    return benchmark.run( kernel, baseline ) ? 0 : 1;
+}
@@ -6,9 +6,12 @@
  */
 #include "dataset.h"
 
+#include "../../algos/trace.h"
+
 Dataset::Dataset( QDir fileName, Fn::DatasetType type ) :
     m_textureGLuint( 0 ),
-    m_resetRenderer( false )
+    m_resetRenderer( false ),
+    m_traceName( 0 )
 {
     PropertyGroup props;
     // add standard properties
@@ -32,6 +35,17 @@ Dataset::~Dataset()
 {
 }
 
+const char* Dataset::traceName()
+{
+    QString name = properties().get( Fn::Property::D_NAME ).toString();
+    if ( m_traceName == 0 || name != m_tracedName )
+    {
+        m_traceName = Trace::intern( name );
+        m_tracedName = name;
+    }
+    return m_traceName;
+}
+
 GLuint Dataset::getTextureGLuint()
 {
     if ( m_textureGLuint == 0 )
@@ -76,6 +90,11 @@ bool Dataset::rightMouseDrag( int pickId, QVector3D dir, Qt::KeyboardModifiers m
     return false;
 }
 
+void Dataset::rightMouseUp( QString target )
+{
+    // do nothing here
+}
+
 
 QString Dataset::getColormapShader( int num )
 {
@@ -31,7 +31,7 @@ public:
 
     PropertyGroup& properties( QString target = "maingl" );
 
-    GLuint getTextureGLuint();
+    virtual GLuint getTextureGLuint();
 
     virtual void draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target ) = 0;
 
@@ -40,6 +40,7 @@ public:
 
     virtual bool mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers modifiers, QString target );
     virtual bool rightMouseDrag( int pickId, QVector3D dir, Qt::KeyboardModifiers modifiers, QString target );
+    virtual void rightMouseUp( QString target );
     void copySettings( QString target );
     void copyPropertyObject( PropertyGroup& props, QString target );
 
@@ -49,6 +50,10 @@ public:
 
     virtual QPair<QVector3D, QVector3D>getBoundingBox();
 
+    // name for the frame trace, the current D_NAME, interned again only after a rename so drawing
+    // doesn't take the trace lock
+    const char* traceName();
+
 protected:
     virtual void createTexture();
     virtual void calcBoundingBox();
@@ -59,6 +64,9 @@ protected:
     QPair<QVector3D, QVector3D>m_boundingBox;
 
     bool m_resetRenderer;
+
+    const char* m_traceName;
+    QString m_tracedName;
 };
 
 #endif /* DATASET_H_ */
@@ -0,0 +1,73 @@
+/*
+ * datasetcomponents.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "datasetcomponents.h"
+
+#include "../models.h"
+#include "../roiarea.h"
+
+DatasetComponents::DatasetComponents( QDir filename, std::vector<float> data, nifti_image* header, const std::vector<ConnectedComponents::Component>& components ) :
+    DatasetScalar( filename, data, header ),
+    m_components( components )
+{
+    // background stays transparent, neighbouring labels get distinct colors
+    m_properties["maingl"].set( Fn::Property::D_COLORMAP, 1 );
+    m_properties["maingl"].set( Fn::Property::D_LOWER_THRESHOLD, 0.5f );
+
+    int count = m_components.size();
+    m_properties["maingl"].createInt( Fn::Property::D_COMPONENT, qMin( 1, count ), qMin( 1, count ), count, "components" );
+    m_properties["maingl"].createButton( Fn::Property::D_COMPONENT_ROI, "components" );
+    connect( m_properties["maingl"].getProperty( Fn::Property::D_COMPONENT_ROI ), SIGNAL( valueChanged( QVariant ) ), this, SLOT( createROI() ) );
+}
+
+DatasetComponents::~DatasetComponents()
+{
+}
+
+QString DatasetComponents::getValueAsString( float x, float y, float z )
+{
+    int label = getData()->at( getIdFromPos( x, y, z ) );
+    if ( label < 1 || label > (int)m_components.size() )
+    {
+        return QString( "background" );
+    }
+    return QString( "component " ) + QString::number( label ) + QString( ", " ) + QString::number( m_components[label - 1].size ) + QString( " voxels" );
+}
+
+void DatasetComponents::createROI()
+{
+    int label = m_properties["maingl"].get( Fn::Property::D_COMPONENT ).toInt();
+    if ( label < 1 || label > (int)m_components.size() )
+    {
+        return;
+    }
+
+    const ConnectedComponents::Component& component = m_components[label - 1];
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+
+    // only the bounding box can hold the component
+    std::vector<float>* data = getData();
+    std::vector<float> out( data->size(), 0.0f );
+    for ( int z = component.min[2]; z <= component.max[2]; ++z )
+    {
+        for ( int y = component.min[1]; y <= component.max[1]; ++y )
+        {
+            for ( int x = component.min[0]; x <= component.max[0]; ++x )
+            {
+                int id = x + nx * ( y + ny * z );
+                if ( (int)data->at( id ) == label )
+                {
+                    out[id] = 1.0f;
+                }
+            }
+        }
+    }
+
+    ROIArea* roi = new ROIArea( out, m_properties["maingl"] );
+    Models::addROIArea( roi );
+}
@@ -0,0 +1,36 @@
+/*
+ * datasetcomponents.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef DATASETCOMPONENTS_H_
+#define DATASETCOMPONENTS_H_
+
+#include "datasetscalar.h"
+
+#include "../../algos/connectedcomponents.h"
+
+/*
+ * Label volume of connected components, voxel values are the component numbers from 1 on, 0 is the
+ * background. Keeps size and bounding box of every component and turns a selected one into an ROI.
+ */
+class DatasetComponents : public DatasetScalar
+{
+    Q_OBJECT
+
+public:
+    DatasetComponents( QDir filename, std::vector<float> data, nifti_image* header, const std::vector<ConnectedComponents::Component>& components );
+    virtual ~DatasetComponents();
+
+    QString getValueAsString( float x, float y, float z );
+
+private:
+    std::vector<ConnectedComponents::Component> m_components;
+
+private slots:
+    void createROI();
+};
+
+#endif /* DATASETCOMPONENTS_H_ */
@@ -309,6 +309,7 @@ void DatasetFibers::draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, in
         m_selector = new FiberSelector( m_kdVerts, m_numPoints );
         m_selector->init( m_fibs );
         connect( m_selector, SIGNAL( changed() ), Models::d(), SLOT( submit() ) );
+        clusterChanged();
     }
 
     if ( properties( target ).get( Fn::Property::D_FIBER_RENDERMODE).toInt() == 0 )
@@ -401,7 +402,7 @@ void DatasetFibers::applyTransform()
 
 QString DatasetFibers::getSaveFilter()
 {
-    return QString( "fib files binary(*.fib *.vtk);;fib files ascii (*.fib *.vtk);;fib files json (*.json);;trackvis (*.trk);;all files (*.*)" );
+    return QString( "fib files binary(*.fib *.vtk);;fib files ascii (*.fib *.vtk);;fib files json (*.json);;trackvis (*.trk);;fiber container (*.bgf);;fiber container half data (*.bgf);;fiber container 8 bit data (*.bgf);;mrtrix tracks (*.tck);;all files (*.*)" );
 }
 
 QString DatasetFibers::getDefaultSuffix()
@@ -569,6 +570,54 @@ void DatasetFibers::setDataMaxes( std::vector<float> maxes )
     m_dataMaxes = maxes;
 }
 
+void DatasetFibers::setClusters( std::vector<int> assignment )
+{
+    m_clusters = assignment;
+
+    int numClusters = 0;
+    for ( unsigned int i = 0; i < m_clusters.size(); ++i )
+    {
+        numClusters = qMax( numClusters, m_clusters[i] + 1 );
+    }
+
+    // -1 shows all clusters
+    if ( m_properties["maingl"].contains( Fn::Property::D_FIBER_CLUSTER ) )
+    {
+        m_properties["maingl"].setMax( Fn::Property::D_FIBER_CLUSTER, numClusters - 1 );
+        m_properties["maingl"].set( Fn::Property::D_FIBER_CLUSTER, -1 );
+    }
+    else
+    {
+        m_properties["maingl"].createInt( Fn::Property::D_FIBER_CLUSTER, -1, -1, numClusters - 1, "general" );
+        connect( m_properties["maingl"].getProperty( Fn::Property::D_FIBER_CLUSTER ), SIGNAL( valueChanged( QVariant ) ), this, SLOT( clusterChanged() ) );
+    }
+    clusterChanged();
+}
+
+std::vector<int>* DatasetFibers::getClusters()
+{
+    return &m_clusters;
+}
+
+void DatasetFibers::clusterChanged()
+{
+    if ( m_selector == 0 || !m_properties["maingl"].contains( Fn::Property::D_FIBER_CLUSTER ) )
+    {
+        // applied when the selector is created
+        return;
+    }
+    int cluster = m_properties["maingl"].get( Fn::Property::D_FIBER_CLUSTER ).toInt();
+    if ( cluster < 0 || m_clusters.size() != m_fibs.size() )
+    {
+        m_selector->clearClusters();
+        return;
+    }
+    int numClusters = m_properties["maingl"].getProperty( Fn::Property::D_FIBER_CLUSTER )->getMax().toInt() + 1;
+    std::vector<bool> clusters( numClusters, false );
+    clusters[qMin( cluster, numClusters - 1 )] = true;
+    m_selector->selectClusters( m_clusters, clusters );
+}
+
 unsigned int DatasetFibers::numVerts()
 {
     return m_numPoints;
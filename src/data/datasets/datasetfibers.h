@@ -46,6 +46,10 @@ public:
     void setDataMins( std::vector<float> mins );
     void setDataMaxes( std::vector<float> maxes );
 
+    // cluster id per fiber, the cluster property restricts the selection to one whole cluster
+    void setClusters( std::vector<int> assignment );
+    std::vector<int>* getClusters();
+
     void draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target );
 
 protected:
@@ -61,6 +65,8 @@ protected:
     std::vector<float> m_dataMins;
     std::vector<float> m_dataMaxes;
 
+    std::vector<int> m_clusters;
+
     FiberRenderer* m_renderer;
     TubeRenderer* m_tubeRenderer;
 
@@ -83,6 +89,7 @@ private slots:
     void globalChanged();
     void sourceMRIChanged();
     void updateSourceMRI();
+    void clusterChanged();
 };
 
 #endif /* DATASETFIBERS_H_ */
@@ -6,6 +6,7 @@
  */
 
 #include "datasetfmri.h"
+#include "fmriframering.h"
 #include "../models.h"
 
 #include "../../gui/gl/glfunctions.h"
@@ -14,7 +15,9 @@
 
 DatasetFMRI::DatasetFMRI( QDir filename, std::vector<float> data, nifti_image* header ) :
     DatasetNifti( filename, Fn::DatasetType::NIFTI_FMRI, header ),
-    m_data( data )
+    m_data( data ),
+    m_frames( 0 ),
+    m_uploadedFrame( -1 )
 {
     m_properties["maingl"].createBool( Fn::Property::D_INTERPOLATION, false, "general" );
     m_properties["maingl"].createFloat( Fn::Property::D_ALPHA, 1.0f, 0.0, 1.0, "general" );
@@ -31,10 +34,19 @@ DatasetFMRI::DatasetFMRI( QDir filename, std::vector<float> data, nifti_image* h
     m_properties["maingl"].createBool( Fn::Property::D_AUTOPLAY, false, "autoplay" );
     m_properties["maingl"].createInt( Fn::Property::D_AUTOPLAY_INTERVAL, 25, 10, 1000, "autoplay" );
     connect( m_properties["maingl"].getProperty( Fn::Property::D_AUTOPLAY ), SIGNAL( valueChanged( QVariant ) ), this, SLOT( autoplay() ) );
+
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+    int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
+    int dim = m_properties["maingl"].get( Fn::Property::D_DIM ).toInt();
+    float min = m_properties["maingl"].get( Fn::Property::D_MIN ).toFloat();
+    float max = m_properties["maingl"].get( Fn::Property::D_MAX ).toFloat();
+    m_frames = new FMRIFrameRing( &m_data, nx * ny * nz, dim, min, max );
 }
 
 DatasetFMRI::~DatasetFMRI()
 {
+    delete m_frames;
 }
 
 std::vector<float>* DatasetFMRI::getData()
@@ -87,10 +99,28 @@ void DatasetFMRI::examineDataset()
     connect ( &m_properties["maingl"], SIGNAL( signalSetProp( int ) ), this, SLOT( slotPropSet( int ) ) );
 }
 
-void DatasetFMRI::createTexture()
+GLuint DatasetFMRI::getTextureGLuint()
 {
-    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    if ( m_textureGLuint == 0 )
+    {
+        createTexture();
+    }
+    else if ( m_uploadedFrame != selectedFrame() )
+    {
+        uploadFrame();
+    }
+    return m_textureGLuint;
+}
+
+int DatasetFMRI::selectedFrame()
+{
+    int dim = m_properties["maingl"].get( Fn::Property::D_DIM ).toInt();
+    int frame = m_properties["maingl"].get( Fn::Property::D_SELECTED_TEXTURE ).toInt();
+    return qMax( 0, qMin( frame, dim - 1 ) );
+}
 
+void DatasetFMRI::createTexture()
+{
     glGenTextures( 1, &m_textureGLuint );
 
     glBindTexture( GL_TEXTURE_3D, m_textureGLuint );
@@ -101,39 +131,46 @@ void DatasetFMRI::createTexture()
     glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
     glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE );
 
+    // the shaders unpack a float from rgba as a + b/256 + ..., so the single channel goes to alpha
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_SWIZZLE_R, GL_ZERO );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_SWIZZLE_G, GL_ZERO );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_SWIZZLE_B, GL_ZERO );
+    glTexParameteri( GL_TEXTURE_3D, GL_TEXTURE_SWIZZLE_A, GL_RED );
+
     int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
     int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
     int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
 
-    float min = m_properties["maingl"].get( Fn::Property::D_MIN ).toFloat();
-    float max = m_properties["maingl"].get( Fn::Property::D_MAX ).toFloat();
-    max = max + ( (max-min)/100. );
+    // storage only, the frames go in with glTexSubImage3D
+    GLFunctions::f->glTexImage3D( GL_TEXTURE_3D, 0, GL_R16F, nx, ny, nz, 0, GL_RED, GL_HALF_FLOAT, NULL );
 
-    int dim = m_properties["maingl"].get( Fn::Property::D_DIM ).toInt();
-    int frame = m_properties["maingl"].get( Fn::Property::D_SELECTED_TEXTURE ).toInt();
-    if ( frame < 0 )
-    {
-        frame = 0;
-    }
+    m_uploadedFrame = -1;
+    uploadFrame();
+}
 
-    if ( frame > dim - 1 )
+void DatasetFMRI::uploadFrame()
+{
+    int frame = selectedFrame();
+    if ( !m_frames->take( frame, m_frameBuffer ) )
     {
-        frame = dim - 1;
+        m_frames->convert( frame, m_frameBuffer );
     }
-    int offset = nx * ny * nz * frame;
+    // keep the worker one step ahead
+    m_frames->setPlayhead( frame + 1 );
 
-    unsigned char* tmpData = new unsigned char[nx * ny * nz * 4];
-    for ( int i = 0; i < nx * ny * nz; ++i )
-    {
-        unsigned int tmp = ( ( m_data[i + offset] - min ) / ( max - min ) ) * 256 * 256 * 256 * 256;
-        tmpData[4 * i + 3 ] = (tmp / (256 * 256 * 256)) % 256;
-        tmpData[4 * i + 2 ] = (tmp / (256 * 256)) % 256;
-        tmpData[4 * i + 1 ] = (tmp / (256)) % 256;
-        tmpData[4 * i + 0 ] = tmp % 256 ;
-    }
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+    int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
 
-    GLFunctions::f->glTexImage3D( GL_TEXTURE_3D, 0, GL_RGBA, nx, ny, nz, 0, GL_RGBA, GL_UNSIGNED_BYTE, tmpData );
-    delete[] tmpData;
+    // we get called while the texture units are set up, so leave the current binding alone
+    GLint bound = 0;
+    glGetIntegerv( GL_TEXTURE_BINDING_3D, &bound );
+    glBindTexture( GL_TEXTURE_3D, m_textureGLuint );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    GLFunctions::f->glTexSubImage3D( GL_TEXTURE_3D, 0, 0, 0, 0, nx, ny, nz, GL_RED, GL_HALF_FLOAT, m_frameBuffer.data() );
+    glBindTexture( GL_TEXTURE_3D, bound );
+
+    m_uploadedFrame = frame;
 }
 
 void DatasetFMRI::draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target )
@@ -152,8 +189,8 @@ bool DatasetFMRI::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers mo
 
 void DatasetFMRI::selectTexture()
 {
-    glDeleteTextures( 1, &m_textureGLuint );
-    m_textureGLuint = 0;
+    // the upload happens with the next getTextureGLuint, until then the worker can get the frame ready
+    m_frames->setPlayhead( selectedFrame() );
 }
 
 void DatasetFMRI::autoplay()
@@ -186,6 +223,7 @@ void DatasetFMRI::slotPropSet( int id )
 
 void DatasetFMRI::flipX()
 {
+    m_frames->invalidate();
     glDeleteTextures( 1, &m_textureGLuint );
     m_textureGLuint = 0;
 
@@ -215,6 +253,7 @@ void DatasetFMRI::flipX()
 
 void DatasetFMRI::flipY()
 {
+    m_frames->invalidate();
     glDeleteTextures( 1, &m_textureGLuint );
     m_textureGLuint = 0;
 
@@ -244,6 +283,7 @@ void DatasetFMRI::flipY()
 
 void DatasetFMRI::flipZ()
 {
+    m_frames->invalidate();
     glDeleteTextures( 1, &m_textureGLuint );
     m_textureGLuint = 0;
 
@@ -10,6 +10,8 @@
 
 #include "datasetnifti.h"
 
+class FMRIFrameRing;
+
 class DatasetFMRI: public DatasetNifti
 {
     Q_OBJECT
@@ -20,6 +22,8 @@ public:
 
     std::vector<float>* getData();
 
+    GLuint getTextureGLuint();
+
     void draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target );
     QString getValueAsString( int x, int y, int z );
 
@@ -32,10 +36,16 @@ public:
 private:
     std::vector<float> m_data;
 
+    FMRIFrameRing* m_frames;
+    std::vector<quint16> m_frameBuffer; //!< last uploaded frame, swapped with the ready buffers of the ring
+    int m_uploadedFrame;
+
 //    ColormapRenderer* m_colormapRenderer;
 
     void examineDataset(); //!< calls misc function to determine properties like min/max of the dataset
     void createTexture();
+    void uploadFrame();
+    int selectedFrame();
 
 private slots:
     void selectTexture();
@@ -1286,20 +1286,16 @@ void DatasetGlyphset::slotCopyColors()
     int n = properties( "maingl" ).get( Fn::Property::D_SURFACE ).toInt();
     TriangleMesh2* mesh = m_mesh[n];
 
-    QColor color;
-
     float selectedMin = properties( "maingl" ).get( Fn::Property::D_SELECTED_MIN ).toFloat();
     float selectedMax = properties( "maingl" ).get( Fn::Property::D_SELECTED_MAX ).toFloat();
+    ColormapBase cmap = ColormapFunctions::getColormap( properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt() );
 
+    std::vector<float> values( m_n );
     for ( int i = 0; i < m_n; ++i )
     {
-        ColormapBase cmap = ColormapFunctions::getColormap( properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt() );
-
-        float value = ( m_correlations->getValue( m_prevPickedID, i ) - selectedMin ) / ( selectedMax - selectedMin );
-        color = cmap.getColor( qMax( 0.0f, qMin( 1.0f, value ) ) );
-
-        mesh->setVertexColor( i, color );
+        values[i] = m_correlations->getValue( m_prevPickedID, i );
     }
+    cmap.map( values.data(), values.size(), selectedMin, selectedMax, mesh->getVertexColors() );
 }
 
 void DatasetGlyphset::thresholdChanged( QVariant v )
@@ -8,10 +8,10 @@
 
 #include "datasetmesh.h"
 #include "datasetscalar.h"
-#include "isosurfacethread.h"
 
 #include "../models.h"
 
+#include "../mesh/isosurface.h"
 #include "../mesh/trianglemesh2.h"
 
 #include "../../gui/gl/glfunctions.h"
@@ -71,36 +71,26 @@ DatasetIsosurface::DatasetIsosurface( DatasetScalar* ds, float isoValue ) :
     }
 
 
-    m_nX = m_properties["maingl"].get( Fn::Property::D_NX ).toInt() - 1;
-    m_nY = m_properties["maingl"].get( Fn::Property::D_NY ).toInt() - 1;
-    m_nZ = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt() - 1;
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+    int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
 
-    m_dX = m_properties["maingl"].get( Fn::Property::D_DX ).toFloat();
-    m_dY = m_properties["maingl"].get( Fn::Property::D_DY ).toFloat();
-    m_dZ = m_properties["maingl"].get( Fn::Property::D_DZ ).toFloat();
+    float dx = m_properties["maingl"].get( Fn::Property::D_DX ).toFloat();
+    float dy = m_properties["maingl"].get( Fn::Property::D_DY ).toFloat();
+    float dz = m_properties["maingl"].get( Fn::Property::D_DZ ).toFloat();
 
     m_plusX = ds->properties( "maingl" ).get( Fn::Property::D_ADJUST_X ).toFloat();
     m_plusY = ds->properties( "maingl" ).get( Fn::Property::D_ADJUST_Y ).toFloat();
     m_plusZ = ds->properties( "maingl" ).get( Fn::Property::D_ADJUST_Z ).toFloat();
 
-    m_nPointsInXDirection = ( m_nX + 1 );
-    m_nPointsInSlice = m_nPointsInXDirection * ( m_nY + 1 );
-
-    QMutex* mutex = new QMutex();
-
-    m_numThreads = GLFunctions::idealThreadCount;
-
-    // create threads
-    for ( int i = 0; i < m_numThreads; ++i )
-    {
-        m_threads.push_back( new IsoSurfaceThread( &m_scalarField, mutex, &m_i2pt3idVertices, &m_trivecTriangles, m_nX, m_nY, m_nZ, m_dX, m_dY, m_dZ, i ) );
-    }
+    m_isoSurface = new IsoSurface( &m_scalarField, nx, ny, nz, dx, dy, dz );
 
     generateSurface();
 }
 
 DatasetIsosurface::~DatasetIsosurface()
 {
+    delete m_isoSurface;
 }
 
 std::vector<float>* DatasetIsosurface::getData()
@@ -110,22 +100,7 @@ std::vector<float>* DatasetIsosurface::getData()
 
 void DatasetIsosurface::generateSurface()
 {
-    for ( int i = 0; i < m_numThreads; ++i )
-    {
-        m_threads[i]->setIsoLevel( m_isoLevel );
-    }
-    // run threads
-    for ( int i = 0; i < m_numThreads; ++i )
-    {
-        m_threads[i]->start();
-    }
-
-    // wait for all threads to finish
-    for ( int i = 0; i < m_numThreads; ++i )
-    {
-        m_threads[i]->wait();
-    }
-    renameVerticesAndTriangles();
+    m_mesh.push_back( m_isoSurface->run( m_isoLevel, m_plusX, m_plusY, m_plusZ ) );
 
     m_properties["maingl"].set( Fn::Property::D_START_INDEX, 0 );
     m_properties["maingl"].set( Fn::Property::D_END_INDEX, m_mesh[0]->numTris() );
@@ -133,41 +108,6 @@ void DatasetIsosurface::generateSurface()
     m_properties["maingl2"].set( Fn::Property::D_END_INDEX, m_mesh[0]->numTris() );
 }
 
-void DatasetIsosurface::renameVerticesAndTriangles()
-{
-    unsigned int nextID = 0;
-    QMap<int, POINT3DID>::iterator mapIterator = m_i2pt3idVertices.begin();
-    TRIANGLEVECTOR::iterator vecIterator = m_trivecTriangles.begin();
-
-    TriangleMesh2* mesh = new TriangleMesh2( m_i2pt3idVertices.size(), m_trivecTriangles.size() );
-    m_mesh.push_back( mesh );
-
-//    float xOff = 0.5f;
-//    float yOff = 0.5f;
-//    float zOff = 0.5f;
-    // Rename vertices.
-    while ( mapIterator != m_i2pt3idVertices.end() )
-    {
-        ( *mapIterator ).newID = nextID++;
-        //m_mesh[0]->addVertex( ( *mapIterator ).x + xOff, ( *mapIterator ).y + yOff, ( *mapIterator ).z + zOff );
-        m_mesh[0]->addVertex( ( *mapIterator ).x + m_plusX, ( *mapIterator ).y + m_plusY, ( *mapIterator ).z + m_plusZ );
-        ++mapIterator;
-    }
-    // Now rename triangles.
-    while ( vecIterator != m_trivecTriangles.end() )
-    {
-        ( *vecIterator ).pointID[ 0 ] = m_i2pt3idVertices[ ( *vecIterator ).pointID[ 0 ] ].newID;
-        ( *vecIterator ).pointID[ 1 ] = m_i2pt3idVertices[ ( *vecIterator ).pointID[ 1 ] ].newID;
-        ( *vecIterator ).pointID[ 2 ] = m_i2pt3idVertices[ ( *vecIterator ).pointID[ 2 ] ].newID;
-
-        m_mesh[0]->addTriangle( ( *vecIterator ).pointID[ 0 ], ( *vecIterator ).pointID[ 1 ], ( *vecIterator ).pointID[ 2 ] );
-        ++vecIterator;
-    }
-    m_mesh[0]->finalize();
-    m_i2pt3idVertices.clear();
-    m_trivecTriangles.clear();
-}
-
 void DatasetIsosurface::draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target )
 {
     if ( !properties( target ).get( Fn::Property::D_ACTIVE ).toBool() )
@@ -10,12 +10,10 @@
 
 #include "datasetmesh.h"
 
-#include "../mesh/isosurfaceincludes.h"
-
 class DatasetScalar;
+class IsoSurface;
 class MeshRenderer;
 class TriangleMesh2;
-class IsoSurfaceThread;
 
 class DatasetIsosurface : public DatasetMesh
 {
@@ -34,37 +32,18 @@ protected:
 
 private:
     void generateSurface();
-    void renameVerticesAndTriangles();
 
     std::vector<float> m_scalarField;
 
     float m_oldIsoValue;
 
     float m_isoLevel;
-    // List of POINT3Ds which form the isosurface.
-    ID2POINT3DID m_i2pt3idVertices;
-
-    // List of TRIANGLES which form the triangulation of the isosurface.
-    TRIANGLEVECTOR m_trivecTriangles;
-
-
-    int m_nX;
-    int m_nY;
-    int m_nZ;
-
-    float m_dX;
-    float m_dY;
-    float m_dZ;
 
     float m_plusX;
     float m_plusY;
     float m_plusZ;
 
-    int m_nPointsInXDirection;
-    int m_nPointsInSlice;
-
-    int m_numThreads;
-    std::vector<IsoSurfaceThread*> m_threads;
+    IsoSurface* m_isoSurface;
 };
 
 #endif /* DATASETISOSURFACE_H_ */
@@ -12,6 +12,8 @@
 
 #include "../mesh/trianglemesh2.h"
 
+#include "../../algos/volumesampler.h"
+
 #include "../../gui/gl/glfunctions.h"
 #include "../../gui/gl/colormapfunctions.h"
 #include "../../gui/gl/meshrenderer.h"
@@ -19,6 +21,21 @@
 #include <QFile>
 #include <QFileDialog>
 
+namespace
+{
+    void vertexPositions( TriangleMesh2* mesh, std::vector<float>& points )
+    {
+        points.resize( 3 * mesh->numVerts() );
+        for ( unsigned int i = 0; i < mesh->numVerts(); ++i )
+        {
+            QVector3D v = mesh->getVertex( i );
+            points[3 * i] = v.x();
+            points[3 * i + 1] = v.y();
+            points[3 * i + 2] = v.z();
+        }
+    }
+}
+
 DatasetMesh::DatasetMesh( TriangleMesh2* mesh, QDir fileName ) :
     Dataset( fileName, Fn::DatasetType::MESH_BINARY ),
     m_renderer( 0 )
@@ -159,6 +176,14 @@ void DatasetMesh::setProperties()
     m_properties["maingl"].createList( Fn::Property::D_SURFACE, m_displayList, 0, "general" );
     //m_properties["maingl2"].create( Fn::Property::D_SURFACE, m_displayList, 0, "general" );
 
+    // copy colors and values can average along the segments between two surfaces instead of sampling the shown one
+    if ( m_displayList.size() > 1 )
+    {
+        m_properties["maingl"].createList( Fn::Property::D_RIBBON_INNER, m_displayList, 0, "ribbon" );
+        m_properties["maingl"].createList( Fn::Property::D_RIBBON_OUTER, m_displayList, 1, "ribbon" );
+        m_properties["maingl"].createInt( Fn::Property::D_RIBBON_SAMPLES, 0, 0, 20, "ribbon" );
+    }
+
     if( m_mesh.size() > 0 )
     {
         m_properties["maingl"].set( Fn::Property::D_START_INDEX, 0 );
@@ -452,34 +477,36 @@ void DatasetMesh::slotCopyColors()
 
     if( m_properties["maingl"].get( Fn::Property::D_COLORMODE ).toInt() == 3 )
     {
-        QColor color;
-
         float selectedMin = properties( "maingl" ).get( Fn::Property::D_SELECTED_MIN ).toFloat();
         float selectedMax = properties( "maingl" ).get( Fn::Property::D_SELECTED_MAX ).toFloat();
+        ColormapBase cmap = ColormapFunctions::getColormap( properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt() );
 
-        m_renderer->beginUpdateColor();
+        std::vector<float> values( mesh->numVerts() );
         for ( unsigned int i = 0; i < mesh->numVerts(); ++i )
         {
-            ColormapBase cmap = ColormapFunctions::getColormap( properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt() );
-
-            float value = ( mesh->getVertexData( i ) - selectedMin ) / ( selectedMax - selectedMin );
-            color = cmap.getColor( qMax( 0.0f, qMin( 1.0f, value ) ) );
-
-            mesh->setVertexColor( i, color );
+            values[i] = mesh->getVertexData( i );
         }
+
+        m_renderer->beginUpdateColor();
+        cmap.map( values.data(), values.size(), selectedMin, selectedMax, mesh->getVertexColors() );
         m_renderer->endUpdateColor();
     }
     else
     {
         QList<QVariant>dsl =  Models::d()->data( Models::d()->index( 0, (int)Fn::Property::D_DATASET_LIST ), Qt::DisplayRole ).toList();
 
-        QList<DatasetScalar*> texList;
+        QList<Dataset*> texList;
         for ( int k = 0; k < dsl.size(); ++k )
         {
             Dataset* ds = VPtr<Dataset>::asPtr( dsl[k] );
+            int type = ds->properties().get( Fn::Property::D_TYPE ).toInt();
+            if ( type != (int)Fn::DatasetType::NIFTI_SCALAR && type != (int)Fn::DatasetType::NIFTI_FMRI )
+            {
+                continue;
+            }
             if ( ds->properties().get( Fn::Property::D_ACTIVE ).toBool() && ds->properties().get( Fn::Property::D_HAS_TEXTURE ).toBool() )
             {
-                texList.push_back( VPtr<DatasetScalar>::asPtr( dsl[k] ) );
+                texList.push_back( ds );
                 if ( texList.size() == 5 )
                 {
                     break;
@@ -492,25 +519,62 @@ void DatasetMesh::slotCopyColors()
             return;
         }
 
-        //TriangleMesh2* mesh = getMesh();
-        m_renderer->beginUpdateColor();
-        for ( unsigned int i = 0; i < mesh->numVerts(); ++i )
+        unsigned int numVerts = mesh->numVerts();
+        std::vector<float> colors( 4 * numVerts );
+        std::vector<float> layer( 4 * numVerts );
+        std::vector<float> values;
+        for ( int k = 0; k < texList.size(); ++k )
         {
-            QColor c = texList[0]->getColorAtPos( mesh->getVertex( i ) );
-            for ( int k = 1; k < texList.size(); ++k )
+            sampleVolume( texList[k], true, values );
+
+            // same as ColormapFunctions::getColor, values outside the thresholds or not above 0 stay transparent
+            PropertyGroup& props = texList[k]->properties( "maingl" );
+            float min = props.get( Fn::Property::D_SELECTED_MIN ).toFloat();
+            float max = props.get( Fn::Property::D_SELECTED_MAX ).toFloat();
+            float lower = props.get( Fn::Property::D_LOWER_THRESHOLD ).toFloat();
+            float upper = props.get( Fn::Property::D_UPPER_THRESHOLD ).toFloat();
+            float alpha = props.get( Fn::Property::D_ALPHA ).toFloat();
+            ColormapBase cmap = ColormapFunctions::getColormap( props.get( Fn::Property::D_COLORMAP ).toInt() );
+
+            float* out = ( k == 0 ) ? colors.data() : layer.data();
+            cmap.map( values.data(), numVerts, min, max, out );
+            for ( unsigned int i = 0; i < numVerts; ++i )
+            {
+                float* c = out + 4 * i;
+                if ( values[i] < lower || values[i] > upper || !( values[i] > 0 ) )
+                {
+                    c[0] = c[1] = c[2] = c[3] = 0.0f;
+                }
+                else
+                {
+                    c[3] = alpha;
+                }
+            }
+
+            if ( k > 0 )
             {
-                QColor c2 = texList[k]->getColorAtPos( mesh->getVertex( i ) );
-                c.setRedF( ( 1.0 - c2.alphaF() ) * c.redF() + c2.alphaF() * c2.redF() );
-                c.setGreenF( ( 1.0 - c2.alphaF() ) * c.greenF() + c2.alphaF() * c2.greenF() );
-                c.setBlueF( ( 1.0 - c2.alphaF() ) * c.blueF() + c2.alphaF() * c2.blueF() );
+                for ( unsigned int i = 0; i < numVerts; ++i )
+                {
+                    float* c = &colors[4 * i];
+                    const float* c2 = &layer[4 * i];
+                    c[0] = ( 1.0f - c2[3] ) * c[0] + c2[3] * c2[0];
+                    c[1] = ( 1.0f - c2[3] ) * c[1] + c2[3] * c2[1];
+                    c[2] = ( 1.0f - c2[3] ) * c[2] + c2[3] * c2[2];
+                }
             }
-            if ( c.redF() + c.greenF() + c.blueF() > 0 )
+        }
+
+        QColor col = m_properties["maingl"].get( Fn::Property::D_COLOR ).value<QColor>();
+        m_renderer->beginUpdateColor();
+        for ( unsigned int i = 0; i < numVerts; ++i )
+        {
+            const float* c = &colors[4 * i];
+            if ( c[0] + c[1] + c[2] > 0 )
             {
-                mesh->setVertexColor( i, c );
+                mesh->setVertexColor( i, c[0], c[1], c[2], c[3] );
             }
             else
             {
-                QColor col = m_properties["maingl"].get( Fn::Property::D_COLOR ).value<QColor>();
                 mesh->setVertexColor( i, col );
             }
         }
@@ -532,18 +596,18 @@ void DatasetMesh::slotCopyValues()
         return;
     }
 
+    std::vector<float> values;
+    sampleVolume( texList[0], false, values );
+
     float min = std::numeric_limits<float>::max();
     float max = -std::numeric_limits<float>::max();
 
-    DatasetScalar* ds = dynamic_cast<DatasetScalar*>( texList[0] );
-    //TriangleMesh2* mesh = getMesh();
     m_renderer->beginUpdateColor();
     for ( unsigned int i = 0; i < mesh->numVerts(); ++i )
     {
-        float value = ds->getValueAtPos( mesh->getVertex( i ) );
-        min = qMin( value, min );
-        max = qMax( value, max );
-        mesh->setVertexData( i, value );
+        min = qMin( values[i], min );
+        max = qMax( values[i], max );
+        mesh->setVertexData( i, values[i] );
     }
     m_renderer->endUpdateColor();
     m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setValue( min );
@@ -554,3 +618,36 @@ void DatasetMesh::slotCopyValues()
     m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setValue( max );
     m_properties["maingl"].set( Fn::Property::D_COLORMODE, 3 );
 }
+
+void DatasetMesh::sampleVolume( Dataset* ds, bool interpolate, std::vector<float>& values )
+{
+    VolumeSampler sampler( ds, interpolate ? VolumeSampler::TRILINEAR : VolumeSampler::NEAREST );
+
+    int n = properties( "maingl" ).get( Fn::Property::D_SURFACE ).toInt();
+    values.resize( m_mesh[n]->numVerts() );
+
+    int steps = 0;
+    int inner = 0;
+    int outer = 0;
+    if ( m_properties["maingl"].contains( Fn::Property::D_RIBBON_SAMPLES ) )
+    {
+        steps = m_properties["maingl"].get( Fn::Property::D_RIBBON_SAMPLES ).toInt();
+        inner = m_properties["maingl"].get( Fn::Property::D_RIBBON_INNER ).toInt();
+        outer = m_properties["maingl"].get( Fn::Property::D_RIBBON_OUTER ).toInt();
+    }
+
+    std::vector<float> points;
+    if ( steps > 0 && inner != outer && inner < (int)m_mesh.size() && outer < (int)m_mesh.size() )
+    {
+        // all surfaces share the vertex count, see addMesh
+        std::vector<float> outerPoints;
+        vertexPositions( m_mesh[inner], points );
+        vertexPositions( m_mesh[outer], outerPoints );
+        sampler.sampleRibbon( points.data(), outerPoints.data(), values.size(), steps, values.data() );
+    }
+    else
+    {
+        vertexPositions( m_mesh[n], points );
+        sampler.sample( points.data(), values.size(), values.data() );
+    }
+}
@@ -42,6 +42,9 @@ public:
     virtual QString getDefaultSuffix();
 
 protected:
+    // values of a scalar volume or the selected frame of a series at the vertices, or averaged over the ribbon
+    void sampleVolume( Dataset* ds, bool interpolate, std::vector<float>& values );
+
     std::vector<TriangleMesh2*> m_mesh;
     MeshRenderer* m_renderer;
     std::vector<QString> m_displayList;
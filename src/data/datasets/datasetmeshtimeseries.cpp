@@ -15,12 +15,19 @@
 
 #include "../../algos/colormapbase.h"
 
+#include "../../io/timeseriescache.h"
+
 #include <QFile>
 #include <QFileDialog>
 
 
 DatasetMeshTimeSeries::DatasetMeshTimeSeries( QDir fn, Fn::DatasetType type ) :
-    DatasetMesh( fn, type )
+    DatasetMesh( fn, type ),
+    m_cache( 0 ),
+    m_frames( 0 ),
+    m_series( 0 ),
+    m_numVerts( 0 ),
+    m_numFrames( 0 )
 {
     m_dataMin = std::numeric_limits<float>().max();
     m_dataMax = std::numeric_limits<float>().min();
@@ -29,6 +36,7 @@ DatasetMeshTimeSeries::DatasetMeshTimeSeries( QDir fn, Fn::DatasetType type ) :
 
 DatasetMeshTimeSeries::~DatasetMeshTimeSeries()
 {
+    delete m_cache;
 }
 
 void DatasetMeshTimeSeries::addMesh( TriangleMesh2* tm, QString displayString )
@@ -42,11 +50,23 @@ void DatasetMeshTimeSeries::addMesh( TriangleMesh2* tm, QString displayString )
     m_properties["maingl"].set( Fn::Property::D_END_INDEX, m_mesh[0]->numTris() );
 }
 
-void DatasetMeshTimeSeries::addData( std::vector<float> data )
+void DatasetMeshTimeSeries::addData( const std::vector<float>& data )
 {
     if ( data.size() == m_mesh[0]->numVerts() )
     {
-        m_data.push_back( data );
+        if ( m_cache )
+        {
+            m_frameData.assign( m_frames, m_frames + m_numFrames * m_numVerts );
+            delete m_cache;
+            m_cache = 0;
+        }
+        m_numVerts = data.size();
+        m_frameData.insert( m_frameData.end(), data.begin(), data.end() );
+        ++m_numFrames;
+        m_frames = &m_frameData[0];
+        // the vertex major copy is rebuilt in setProperties()
+        m_seriesData.clear();
+        m_series = 0;
 
         for ( unsigned int i = 0; i < data.size(); ++i )
         {
@@ -55,36 +75,76 @@ void DatasetMeshTimeSeries::addData( std::vector<float> data )
         }
         qDebug() << "min/max" << m_dataMin << m_dataMax;
 
-        m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setMin( m_dataMin );
-        m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setMax( m_dataMax );
-        m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setValue( m_dataMin );
+        updateMinMax();
+    }
+}
+
+void DatasetMeshTimeSeries::setData( TimeSeriesCache* cache )
+{
+    if ( m_cache )
+    {
+        delete m_cache;
+    }
+    std::vector<float>().swap( m_frameData );
+    std::vector<float>().swap( m_seriesData );
+
+    m_cache = cache;
+    m_numVerts = cache->numVerts();
+    m_numFrames = cache->numFrames();
+    m_frames = cache->frames();
+    m_series = cache->series();
+
+    m_dataMin = cache->min();
+    m_dataMax = cache->max();
+    qDebug() << "min/max" << m_dataMin << m_dataMax;
+
+    updateMinMax();
+}
+
+void DatasetMeshTimeSeries::updateMinMax()
+{
+    m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setMin( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setMax( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_MIN )->setValue( m_dataMin );
 
-        m_properties["maingl"].getProperty( Fn::Property::D_MAX )->setMin( m_dataMin );
-        m_properties["maingl"].getProperty( Fn::Property::D_MAX )->setMax( m_dataMax );
-        m_properties["maingl"].getProperty( Fn::Property::D_MAX )->setValue( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_MAX )->setMin( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_MAX )->setMax( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_MAX )->setValue( m_dataMax );
 
-        m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MIN )->setMin( m_dataMin );
-        m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MIN )->setMax( m_dataMax );
-        m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MIN )->setValue( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MIN )->setMin( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MIN )->setMax( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MIN )->setValue( m_dataMin );
 
-        m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MAX )->setMin( m_dataMin );
-        m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MAX )->setMax( m_dataMax );
-        m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MAX )->setValue( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MAX )->setMin( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MAX )->setMax( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_MAX )->setValue( m_dataMax );
 
-        m_properties["maingl"].getProperty( Fn::Property::D_LOWER_THRESHOLD )->setMin( m_dataMin );
-        m_properties["maingl"].getProperty( Fn::Property::D_LOWER_THRESHOLD )->setMax( m_dataMax );
-        m_properties["maingl"].getProperty( Fn::Property::D_LOWER_THRESHOLD )->setValue( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_LOWER_THRESHOLD )->setMin( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_LOWER_THRESHOLD )->setMax( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_LOWER_THRESHOLD )->setValue( m_dataMin );
 
-        m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setMin( m_dataMin );
-        m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setMax( m_dataMax );
-        m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setValue( m_dataMax );
-    }
+    m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setMin( m_dataMin );
+    m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setMax( m_dataMax );
+    m_properties["maingl"].getProperty( Fn::Property::D_UPPER_THRESHOLD )->setValue( m_dataMax );
 }
 
 void DatasetMeshTimeSeries::setProperties()
 {
+    if ( m_series == 0 && m_numFrames > 0 )
+    {
+        m_seriesData.resize( m_frameData.size() );
+        for ( unsigned int i = 0; i < m_numVerts; ++i )
+        {
+            for ( unsigned int k = 0; k < m_numFrames; ++k )
+            {
+                m_seriesData[i * m_numFrames + k] = m_frameData[k * m_numVerts + i];
+            }
+        }
+        m_series = &m_seriesData[0];
+    }
+
     m_properties["maingl"].createList( Fn::Property::D_SURFACE, m_displayList, 0, "general" );
-    m_properties["maingl"].createInt( Fn::Property::D_SELECTED_TEXTURE, 0, 0, m_data.size() - 1, "general" );
+    m_properties["maingl"].createInt( Fn::Property::D_SELECTED_TEXTURE, 0, 0, m_numFrames - 1, "general" );
     connect( m_properties["maingl"].getProperty( Fn::Property::D_SELECTED_TEXTURE ), SIGNAL( valueChanged( QVariant ) ), this, SLOT( selectFrame() ) );
     connect ( &m_properties["maingl"], SIGNAL( signalSetProp( int ) ), this, SLOT( slotPropSet( int ) ) );
     m_properties["maingl2"].createList( Fn::Property::D_SURFACE, m_displayList, 0, "general" );
@@ -118,8 +178,8 @@ void DatasetMeshTimeSeries::selectFrame()
     int frame = properties( "maingl" ).get( Fn::Property::D_SELECTED_TEXTURE ).toInt();
     int n = properties( "maingl" ).get( Fn::Property::D_SURFACE ).toInt();
     TriangleMesh2* mesh = m_mesh[n];
-    std::vector<float>data = m_data[frame];
-    for ( unsigned int i = 0; i < data.size(); ++i )
+    const float* data = getFrame( frame );
+    for ( unsigned int i = 0; i < m_numVerts; ++i )
     {
         mesh->setVertexData( i, data[i] );
     }
@@ -138,30 +198,31 @@ void DatasetMeshTimeSeries::slotCopyColors()
     int frame = properties( "maingl" ).get( Fn::Property::D_SELECTED_TEXTURE ).toInt();
     int n = properties( "maingl" ).get( Fn::Property::D_SURFACE ).toInt();
     TriangleMesh2* mesh = m_mesh[n];
-    std::vector<float>data = m_data[frame];
-
-    QColor color;
+    const float* data = getFrame( frame );
 
     float selectedMin = properties( "maingl" ).get( Fn::Property::D_SELECTED_MIN ).toFloat();
     float selectedMax = properties( "maingl" ).get( Fn::Property::D_SELECTED_MAX ).toFloat();
+    ColormapBase cmap = ColormapFunctions::getColormap( properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt() );
 
-    for ( unsigned int i = 0; i < data.size(); ++i )
-    {
-        ColormapBase cmap = ColormapFunctions::getColormap( properties( "maingl" ).get( Fn::Property::D_COLORMAP ).toInt() );
-
-        float value = ( data[i] - selectedMin ) / ( selectedMax - selectedMin );
-        color = cmap.getColor( qMax( 0.0f, qMin( 1.0f, value ) ) );
-
-        mesh->setVertexColor( i, color );
-    }
+    cmap.map( data, qMin( m_numVerts, mesh->numVerts() ), selectedMin, selectedMax, mesh->getVertexColors() );
 }
 
 int DatasetMeshTimeSeries::getNumDataPoints()
 {
-    return m_data.size();
+    return m_numFrames;
 }
 
 float DatasetMeshTimeSeries::getData( int id, int dataPoint )
 {
-    return m_data.at(dataPoint).at( id );
+    return m_series[id * m_numFrames + dataPoint];
+}
+
+const float* DatasetMeshTimeSeries::getFrame( int dataPoint )
+{
+    return m_frames + dataPoint * m_numVerts;
+}
+
+const float* DatasetMeshTimeSeries::getSeries( int id )
+{
+    return m_series + id * m_numFrames;
 }
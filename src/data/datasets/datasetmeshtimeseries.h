@@ -12,6 +12,7 @@
 
 class TriangleMesh2;
 class MeshRenderer;
+class TimeSeriesCache;
 
 class DatasetMeshTimeSeries : public DatasetMesh
 {
@@ -22,10 +23,16 @@ public:
     virtual ~DatasetMeshTimeSeries();
 
     void addMesh( TriangleMesh2* tm, QString displayString = "unknown mesh" );
-    void addData( std::vector<float> data );
+    void addData( const std::vector<float>& data );
+    // takes ownership of the loaded cache, replaces data added so far
+    void setData( TimeSeriesCache* cache );
 
     int getNumDataPoints();
     float getData( int id, int dataPoint );
+    // numVerts values of one frame
+    const float* getFrame( int dataPoint );
+    // all frames of one vertex
+    const float* getSeries( int id );
 
     void setProperties();
 
@@ -33,8 +40,18 @@ public:
     bool mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers modifiers, QString target );
 
 private:
+    void updateMinMax();
+
     std::vector<QString> m_displayList;
-    std::vector<std::vector<float> >m_data;
+
+    // frame major and vertex major copies, either owned here or mapped by the cache
+    std::vector<float> m_frameData;
+    std::vector<float> m_seriesData;
+    TimeSeriesCache* m_cache;
+    const float* m_frames;
+    const float* m_series;
+    unsigned int m_numVerts;
+    unsigned int m_numFrames;
 
     float m_dataMin;
     float m_dataMax;
@@ -11,12 +11,16 @@
 #include "../../gui/gl/colormaprenderer.h"
 #include "../../gui/gl/glfunctions.h"
 
+#include "../../algos/frameconverter.h"
+#include "../../algos/painthistory.h"
+
 #include <QDebug>
 #include <QMessageBox>
 
 DatasetScalar::DatasetScalar( QDir filename, std::vector<float> data, nifti_image* header ) :
     DatasetNifti( filename, Fn::DatasetType::NIFTI_SCALAR, header ),
-    m_data( data )
+    m_data( data ),
+    m_history( 0 )
 {
     m_properties["maingl"].createBool( Fn::Property::D_INTERPOLATION, false, "general" );
     m_properties["maingl"].createFloat( Fn::Property::D_ALPHA, 1.0f, 0.0, 1.0, "general" );
@@ -50,6 +54,7 @@ DatasetScalar::~DatasetScalar()
     m_properties["maingl"].set( Fn::Property::D_ACTIVE, false );
     m_data.clear();
     std::vector<float>().swap( m_data );
+    delete m_history;
     GLFunctions::deleteTexture( m_textureGLuint );
     //glDeleteTextures( 1, &m_textureGLuint );
 }
@@ -98,6 +103,10 @@ void DatasetScalar::examineDataset()
     m_properties["maingl"].createInt( Fn::Property::D_PAINTSIZE, 1, 1, 10, "paint" );
     m_properties["maingl"].createFloat( Fn::Property::D_PAINTVALUE, max - 1.0, min, max - 1.0, "paint" );
     m_properties["maingl"].createBool( Fn::Property::D_PAINT_LINK_CURSOR, false );
+    m_properties["maingl"].createButton( Fn::Property::D_PAINT_UNDO, "paint" );
+    m_properties["maingl"].createButton( Fn::Property::D_PAINT_REDO, "paint" );
+    connect( m_properties["maingl"].getProperty( Fn::Property::D_PAINT_UNDO ), SIGNAL( valueChanged( QVariant ) ), this, SLOT( undoPaint() ) );
+    connect( m_properties["maingl"].getProperty( Fn::Property::D_PAINT_REDO ), SIGNAL( valueChanged( QVariant ) ), this, SLOT( redoPaint() ) );
 }
 
 void DatasetScalar::createTexture()
@@ -122,18 +131,62 @@ void DatasetScalar::createTexture()
     float max = m_properties["maingl"].get( Fn::Property::D_MAX ).toFloat();
     max = max + ( (max-min)/100. );
 
-    unsigned char* tmpData = new unsigned char[nx * ny * nz * 4];
-    for ( int i = 0; i < nx * ny * nz; ++i )
+    int boxMin[3] = { 0, 0, 0 };
+    int boxMax[3] = { nx - 1, ny - 1, nz - 1 };
+    std::vector<unsigned char> tmpData( nx * ny * nz * 4 );
+    FrameConverter::toPackedRGBA( m_data.data(), nx, ny, boxMin, boxMax, min, max, tmpData.data() );
+
+    GLFunctions::f->glTexImage3D( GL_TEXTURE_3D, 0, GL_RGBA, nx, ny, nz, 0, GL_RGBA, GL_UNSIGNED_BYTE, tmpData.data() );
+
+    // everything is up to date now
+    if ( m_history )
     {
-        unsigned int tmp = ( ( m_data[i] - min ) / ( max - min ) ) * 256 * 256 * 256 * 256;
-        tmpData[4 * i + 3 ] = (tmp / (256 * 256 * 256)) % 256;
-        tmpData[4 * i + 2 ] = (tmp / (256 * 256)) % 256;
-        tmpData[4 * i + 1 ] = (tmp / (256)) % 256;
-        tmpData[4 * i + 0 ] = tmp % 256 ;
+        m_history->takeDirty( boxMin, boxMax );
     }
+}
 
-    GLFunctions::f->glTexImage3D( GL_TEXTURE_3D, 0, GL_RGBA, nx, ny, nz, 0, GL_RGBA, GL_UNSIGNED_BYTE, tmpData );
-    delete[] tmpData;
+GLuint DatasetScalar::getTextureGLuint()
+{
+    if ( m_textureGLuint == 0 )
+    {
+        createTexture();
+    }
+    else if ( m_history )
+    {
+        uploadDirty();
+    }
+    return m_textureGLuint;
+}
+
+void DatasetScalar::uploadDirty()
+{
+    int boxMin[3];
+    int boxMax[3];
+    if ( !m_history->takeDirty( boxMin, boxMax ) )
+    {
+        return;
+    }
+
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+
+    float min = m_properties["maingl"].get( Fn::Property::D_MIN ).toFloat();
+    float max = m_properties["maingl"].get( Fn::Property::D_MAX ).toFloat();
+    max = max + ( (max-min)/100. );
+
+    int sx = boxMax[0] - boxMin[0] + 1;
+    int sy = boxMax[1] - boxMin[1] + 1;
+    int sz = boxMax[2] - boxMin[2] + 1;
+    std::vector<unsigned char> tmpData( sx * sy * sz * 4 );
+    FrameConverter::toPackedRGBA( m_data.data(), nx, ny, boxMin, boxMax, min, max, tmpData.data() );
+
+    // we get called while the texture units are set up, so leave the current binding alone
+    GLint bound = 0;
+    glGetIntegerv( GL_TEXTURE_BINDING_3D, &bound );
+    glBindTexture( GL_TEXTURE_3D, m_textureGLuint );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    GLFunctions::f->glTexSubImage3D( GL_TEXTURE_3D, 0, boxMin[0], boxMin[1], boxMin[2], sx, sy, sz, GL_RGBA, GL_UNSIGNED_BYTE, tmpData.data() );
+    glBindTexture( GL_TEXTURE_3D, bound );
 }
 
 void DatasetScalar::draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target )
@@ -172,6 +225,15 @@ bool DatasetScalar::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers
 
     int brushSize = m_properties["maingl"].get( Fn::Property::D_PAINTSIZE ).toInt() - 1;
 
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+    int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
+
+    if ( m_history == 0 )
+    {
+        m_history = new PaintHistory( &m_data, nx, ny, nz );
+    }
+
     int id = getIdFromPos( pos );
 
     int x = 0;
@@ -179,6 +241,7 @@ bool DatasetScalar::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers
     int z = 0;
     getXYZ( id, x, y, z );
 
+    m_history->touch( x, y, z );
     m_data[ getId( x, y, z ) ] = paintValue;
 
     for ( int i = -brushSize; i <= brushSize; ++i )
@@ -189,15 +252,17 @@ bool DatasetScalar::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers
            {
                if ( pow( (float)( i*i + j*j + k*k ), 1.0/3.0 ) <=  (float)brushSize / 2.0 )
                {
-                   m_data[ getId( x + i, y + j, z + k ) ] = paintValue;
+                   // clamped to the volume like getId does
+                   int px = qMax( 0, qMin( x + i, nx - 1 ) );
+                   int py = qMax( 0, qMin( y + j, ny - 1 ) );
+                   int pz = qMax( 0, qMin( z + k, nz - 1 ) );
+                   m_history->touch( px, py, pz );
+                   m_data[ px + py * nx + pz * nx * ny ] = paintValue;
                }
            }
        }
     }
 
-    glDeleteTextures( 1, &m_textureGLuint );
-    m_textureGLuint = 0;
-
     if ( m_properties["maingl"].get( Fn::Property::D_PAINT_LINK_CURSOR ).toBool() )
     {
         Models::g()->setData( Models::g()->index( (int)Fn::Property::G_SAGITTAL, 0 ), pos.x() / dx );
@@ -208,6 +273,30 @@ bool DatasetScalar::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers
     return true;
 }
 
+void DatasetScalar::rightMouseUp( QString target )
+{
+    if ( m_history )
+    {
+        m_history->endStroke();
+    }
+}
+
+void DatasetScalar::undoPaint()
+{
+    if ( m_history && m_history->undo() )
+    {
+        Models::g()->submit();
+    }
+}
+
+void DatasetScalar::redoPaint()
+{
+    if ( m_history && m_history->redo() )
+    {
+        Models::g()->submit();
+    }
+}
+
 float DatasetScalar::getValueAtPos( QVector3D pos )
 {
     return m_data[ getIdFromPos( pos ) ];
@@ -282,6 +371,11 @@ void DatasetScalar::flipX()
 {
     glDeleteTextures( 1, &m_textureGLuint );
     m_textureGLuint = 0;
+    // the saved bricks don't fit the flipped volume
+    if ( m_history )
+    {
+        m_history->clear();
+    }
 
     int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
     int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
@@ -306,6 +400,11 @@ void DatasetScalar::flipY()
 {
     glDeleteTextures( 1, &m_textureGLuint );
     m_textureGLuint = 0;
+    // the saved bricks don't fit the flipped volume
+    if ( m_history )
+    {
+        m_history->clear();
+    }
 
     int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
     int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
@@ -330,6 +429,11 @@ void DatasetScalar::flipZ()
 {
     glDeleteTextures( 1, &m_textureGLuint );
     m_textureGLuint = 0;
+    // the saved bricks don't fit the flipped volume
+    if ( m_history )
+    {
+        m_history->clear();
+    }
 
     int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
     int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
@@ -10,8 +10,12 @@
 
 #include "datasetnifti.h"
 
+class PaintHistory;
+
 class DatasetScalar: public DatasetNifti
 {
+    Q_OBJECT
+
 public:
     DatasetScalar( QDir filename, std::vector<float> data, nifti_image* header );
     virtual ~DatasetScalar();
@@ -21,7 +25,10 @@ public:
     void draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target );
     QString getValueAsString( float x, float y, float z );
 
+    GLuint getTextureGLuint();
+
     bool mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers modifiers, QString target );
+    void rightMouseUp( QString target );
 
     float getValueAtPos( QVector3D pos );
     float getInterpolatedValueAtPos( QVector3D pos );
@@ -35,8 +42,16 @@ public:
 private:
     std::vector<float> m_data;
 
+    // strokes of paint mode, created with the first one
+    PaintHistory* m_history;
+
     void examineDataset(); //!< calls misc function to determine properties like min/max of the dataset
     void createTexture();
+    void uploadDirty();
+
+private slots:
+    void undoPaint();
+    void redoPaint();
 };
 
 #endif /* DATASETSCALAR_H_ */
@@ -20,9 +20,31 @@
 
 
 #include <QDebug>
-#include <QQueue>
 #include <QWidget>
 
+#include <algorithm>
+#include <queue>
+
+namespace
+{
+    // max-heap on the node value, the highest cluster is split first
+    struct LowerValue
+    {
+        bool operator()( Tree* a, Tree* b ) const
+        {
+            return a->getValue() < b->getValue();
+        }
+    };
+
+    struct DepthFirst
+    {
+        bool operator()( Tree* a, Tree* b ) const
+        {
+            return a->getFirstNode() < b->getFirstNode();
+        }
+    };
+}
+
 DatasetTree::DatasetTree( QDir fn ) :
     DatasetMesh( fn , Fn::DatasetType::TREE ),
     m_tree( 0 ),
@@ -31,6 +53,8 @@ DatasetTree::DatasetTree( QDir fn ) :
     m_treeRenderer2( 0 ),
     m_numLeaves( 0 ),
     m_numNodes( 0 ),
+    m_textureDirty( false ),
+    m_selected( -1 ),
     m_zoom( 1 ),
     m_zoom2( 1 )
 {
@@ -144,19 +168,18 @@ void DatasetTree::drawRoot( QMatrix4x4 mvpMatrix, int width, int height )
 }
 
 
-void DatasetTree::importTree( QString dims, std::vector<QString>coords, std::vector<QString>clusters )
+void DatasetTree::importTree( const std::vector<double>& dims, const std::vector<int>& coords,
+                              const std::vector<double>& clusters, const std::vector<unsigned int>& clusterOffsets )
 {
-    QStringList dl = dims.split( " " );
-
-    int nx = dl[0].toInt();
-    int ny = dl[1].toInt();
-    int nz = dl[2].toInt();
-    float dx = dl[3].toFloat();
-    float dy = dl[4].toFloat();
-    float dz = dl[5].toFloat();
-    float ax = dl[6].toFloat();
-    float ay = dl[7].toFloat();
-    float az = dl[8].toFloat();
+    int nx = dims[0];
+    int ny = dims[1];
+    int nz = dims[2];
+    float dx = dims[3];
+    float dy = dims[4];
+    float dz = dims[5];
+    float ax = dims[6];
+    float ay = dims[7];
+    float az = dims[8];
 
 
     m_properties["maingl"].createInt( Fn::Property::D_NX, nx );
@@ -173,38 +196,38 @@ void DatasetTree::importTree( QString dims, std::vector<QString>coords, std::vec
     ny -= 1;
     nz -= 1;
 
-    m_numLeaves = coords.size();
-    m_numNodes = clusters.size();
+    m_numLeaves = coords.size() / 3;
+    m_numNodes = clusterOffsets.empty() ? 0 : clusterOffsets.size() - 1;
 
     m_properties["maingl"].setMax( Fn::Property::D_TREE_SELECTED_CLUSTER, m_numLeaves + m_numNodes );
 
     qDebug() << "num leaves:" << m_numLeaves << "num nodes:" << m_numNodes;
 
-    unsigned int currentId = coords.size();
+    unsigned int currentId = m_numLeaves;
 
     ColormapBase cmap = ColormapFunctions::getColormap( 2 );
 
-    for ( unsigned int i = 0; i < coords.size(); ++i )
+    for ( int i = 0; i < m_numLeaves; ++i )
     {
         Tree* leaf = new Tree( i, 0.0 );
-        QStringList cList = coords[i].split( " " );
-        QVector3D pos( cList[0].toInt(), cList[1].toInt(), cList[2].toInt() );
+        QVector3D pos( coords[i * 3], coords[i * 3 + 1], coords[i * 3 + 2] );
         leaf->setTexturePosition( pos );
         m_nodes.push_back( leaf );
     }
 
-    for( unsigned int i = 0; i < clusters.size(); ++i )
+    for( int i = 0; i < m_numNodes; ++i )
     {
-        QStringList cl = clusters[i].split( " " );
-        float value = cl[0].toFloat();
+        unsigned int first = clusterOffsets[i];
+        unsigned int last = clusterOffsets[i + 1];
+        float value = ( first < last ) ? clusters[first] : 0.0f;
 
         m_tree = new Tree( currentId++, value );
 
         m_nodes.push_back( m_tree );
 
-        for ( int k = 1; k < cl.size(); ++k )
+        for ( unsigned int k = first + 1; k < last; ++k )
         {
-            unsigned int id = cl[k].toUInt();
+            unsigned int id = clusters[k];
 
             if ( id > m_nodes.size() - 1 )
             {
@@ -215,11 +238,33 @@ void DatasetTree::importTree( QString dims, std::vector<QString>coords, std::vec
         }
     }
 
+    std::vector<float> values( m_numLeaves );
     for( int i = 0; i < m_numLeaves; ++i )
     {
-        float v = ( (float)i/(float)m_numLeaves );
-        QColor c = cmap.getColor( qMax( 0.0f, qMin( 1.0f, v ) ) );
-        m_nodes[i]->setColor( 0, c, true, false );
+        values[i] = i;
+    }
+    std::vector<float> rgba( 4 * m_numLeaves );
+    cmap.map( values.data(), values.size(), 0.0f, m_numLeaves, rgba.data() );
+    std::vector<int> lastLeaf( m_nodes.size(), -1 );
+    for( int i = 0; i < m_numLeaves; ++i )
+    {
+        QColor c = QColor::fromRgbF( rgba[4 * i], rgba[4 * i + 1], rgba[4 * i + 2] );
+        m_nodes[i]->setColor( 0, c, false, false );
+        lastLeaf[i] = i;
+    }
+    // a node gets the color of its highest leaf, children always have lower ids than their parent
+    for ( unsigned int i = m_numLeaves; i < m_nodes.size(); ++i )
+    {
+        QList<Tree*> children = m_nodes[i]->getChildren();
+        for ( int k = 0; k < children.size(); ++k )
+        {
+            lastLeaf[i] = qMax( lastLeaf[i], lastLeaf[children[k]->getId()] );
+        }
+        if ( lastLeaf[i] != -1 )
+        {
+            QColor c = m_nodes[lastLeaf[i]]->getColor( 0 );
+            m_nodes[i]->setColor( 0, c, false, false );
+        }
     }
 
 //    for ( int i = 0; i < m_projection.size(); ++i )
@@ -233,10 +278,11 @@ void DatasetTree::importTree( QString dims, std::vector<QString>coords, std::vec
 //    }
 
     m_root = m_tree;
+    buildIndex();
 
     QColor unselectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_UNSELECTED_CLUSTER_COLOR ).value<QColor>();
-    m_tree->setColor( 2, unselectedColor , false, true );
-    m_tree->setColor( 3, unselectedColor , false, true );
+    colorCluster( m_root->getId(), 2, unselectedColor );
+    colorCluster( m_root->getId(), 3, unselectedColor );
 
     qDebug() << "test num leaves:" << m_tree->getNumLeaves();
 
@@ -246,6 +292,103 @@ void DatasetTree::importTree( QString dims, std::vector<QString>coords, std::vec
     m_properties["maingl"].set( Fn::Property::D_TREE_SELECTED_CLUSTER, m_root->getId() );
 }
 
+void DatasetTree::buildIndex()
+{
+    m_order.clear();
+    m_leaves.clear();
+    m_root->index( m_order, m_leaves );
+
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+
+    m_leafTexels.resize( m_leaves.size() );
+    for ( unsigned int i = 0; i < m_leaves.size(); ++i )
+    {
+        QVector3D pos = m_leaves[i]->getTexturePosition();
+        m_leafTexels[i] = pos.x() + pos.y() * nx + pos.z() * nx * ny;
+    }
+    buildVertexIndex();
+}
+
+void DatasetTree::setProjection( std::vector<int> projection )
+{
+    m_projection = projection;
+    buildVertexIndex();
+}
+
+void DatasetTree::buildVertexIndex()
+{
+    m_vertexOffsets.clear();
+    m_vertexIds.clear();
+    if ( m_order.empty() )
+    {
+        return;
+    }
+
+    // vertices grouped by the depth first position of their node, a subtree owns a contiguous block
+    m_vertexOffsets.resize( m_order.size() + 1, 0 );
+    for ( unsigned int i = 0; i < m_projection.size(); ++i )
+    {
+        int id = m_projection[i];
+        if ( id >= 0 && id < static_cast<int>( m_nodes.size() ) && m_nodes[id]->getFirstNode() != -1 )
+        {
+            ++m_vertexOffsets[m_nodes[id]->getFirstNode() + 1];
+        }
+    }
+    for ( unsigned int i = 1; i < m_vertexOffsets.size(); ++i )
+    {
+        m_vertexOffsets[i] += m_vertexOffsets[i - 1];
+    }
+    m_vertexIds.resize( m_vertexOffsets.back() );
+    std::vector<unsigned int> next( m_vertexOffsets.begin(), m_vertexOffsets.end() - 1 );
+    for ( unsigned int i = 0; i < m_projection.size(); ++i )
+    {
+        int id = m_projection[i];
+        if ( id >= 0 && id < static_cast<int>( m_nodes.size() ) && m_nodes[id]->getFirstNode() != -1 )
+        {
+            m_vertexIds[next[m_nodes[id]->getFirstNode()]++] = i;
+        }
+    }
+}
+
+GLuint DatasetTree::getTextureGLuint()
+{
+    if ( m_textureGLuint == 0 )
+    {
+        createTexture();
+    }
+    else if ( m_textureDirty )
+    {
+        int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+        int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+
+        // we get called while the texture units are set up, so leave the current binding alone
+        GLint bound = 0;
+        glGetIntegerv( GL_TEXTURE_BINDING_3D, &bound );
+        glBindTexture( GL_TEXTURE_3D, m_textureGLuint );
+
+        // only the box around the changed texels, cut out of the full volume
+        glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+        glPixelStorei( GL_UNPACK_ROW_LENGTH, nx );
+        glPixelStorei( GL_UNPACK_IMAGE_HEIGHT, ny );
+        glPixelStorei( GL_UNPACK_SKIP_PIXELS, m_dirtyMin[0] );
+        glPixelStorei( GL_UNPACK_SKIP_ROWS, m_dirtyMin[1] );
+        glPixelStorei( GL_UNPACK_SKIP_IMAGES, m_dirtyMin[2] );
+        GLFunctions::f->glTexSubImage3D( GL_TEXTURE_3D, 0, m_dirtyMin[0], m_dirtyMin[1], m_dirtyMin[2],
+                                         m_dirtyMax[0] - m_dirtyMin[0] + 1, m_dirtyMax[1] - m_dirtyMin[1] + 1, m_dirtyMax[2] - m_dirtyMin[2] + 1,
+                                         GL_RGB, GL_FLOAT, m_textureData.data() );
+        glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+        glPixelStorei( GL_UNPACK_IMAGE_HEIGHT, 0 );
+        glPixelStorei( GL_UNPACK_SKIP_PIXELS, 0 );
+        glPixelStorei( GL_UNPACK_SKIP_ROWS, 0 );
+        glPixelStorei( GL_UNPACK_SKIP_IMAGES, 0 );
+
+        glBindTexture( GL_TEXTURE_3D, bound );
+    }
+    m_textureDirty = false;
+    return m_textureGLuint;
+}
+
 void DatasetTree::createTexture()
 {
     glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
@@ -264,53 +407,112 @@ void DatasetTree::createTexture()
     int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
     int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
 
-    int blockSize = nx * ny * nz;
-    m_textureData.resize( blockSize * 3 );
-    for ( int i = 0; i < blockSize * 3; ++i )
+    if ( m_textureData.empty() )
     {
-        m_textureData[i] = 0.0;
+        m_textureData.resize( nx * ny * nz * 3, 0.0f );
+        updateTexture( m_root );
     }
-
-    createTextureRec( m_tree );
     GLFunctions::f->glTexImage3D( GL_TEXTURE_3D, 0, GL_RGBA, nx, ny, nz, 0, GL_RGB, GL_FLOAT, m_textureData.data() );
+    m_textureDirty = false;
 }
 
-void DatasetTree::createTextureRec( Tree* tree )
+void DatasetTree::updateTexture( Tree* node )
 {
-    QList<Tree*>children = tree->getChildren();
-    if ( children.size() > 0 )
+    if ( m_textureData.empty() || node->getFirstLeaf() == -1 )
     {
-        for( int i = 0; i < children.size(); ++i )
+        return;
+    }
+
+    int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
+    int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
+    int colorId = m_properties["maingl"].get( Fn::Property::D_TREE_COLOR_SELECTION ).toInt();
+
+    int first = node->getFirstLeaf();
+    int last = first + node->getNumLeaves();
+    for ( int i = first; i < last; ++i )
+    {
+        int texel = m_leafTexels[i];
+        QColor color = m_leaves[i]->getColor( colorId );
+
+        m_textureData[texel * 3] = color.redF();
+        m_textureData[texel * 3 + 1] = color.greenF();
+        m_textureData[texel * 3 + 2] = color.blueF();
+
+        int pos[3] = { texel % nx, ( texel / nx ) % ny, texel / ( nx * ny ) };
+        for ( int k = 0; k < 3; ++k )
         {
-            createTextureRec( children[i] );
+            if ( !m_textureDirty || pos[k] < m_dirtyMin[k] )
+            {
+                m_dirtyMin[k] = pos[k];
+            }
+            if ( !m_textureDirty || pos[k] > m_dirtyMax[k] )
+            {
+                m_dirtyMax[k] = pos[k];
+            }
         }
+        m_textureDirty = true;
     }
-    else
-    {
-        int nx = m_properties["maingl"].get( Fn::Property::D_NX ).toInt();
-        int ny = m_properties["maingl"].get( Fn::Property::D_NY ).toInt();
-        //int nz = m_properties["maingl"].get( Fn::Property::D_NZ ).toInt();
+}
 
-        QVector3D pos = tree->getTexturePosition();
-        QColor color = tree->getColor( m_properties["maingl"].get( Fn::Property::D_TREE_COLOR_SELECTION ).toInt() );
+void DatasetTree::colorCluster( int id, int colorId, QColor color )
+{
+    if ( id < 0 || id >= static_cast<int>( m_nodes.size() ) || m_nodes[id]->getFirstNode() == -1 )
+    {
+        return;
+    }
+    Tree* node = m_nodes[id];
 
-        int id = ( pos.x() + pos.y() * nx + pos.z() * nx * ny ) * 3;
+    int first = node->getFirstNode();
+    int last = first + node->getNumNodes();
+    for ( int i = first; i < last; ++i )
+    {
+        m_order[i]->setColor( colorId, color, false, false );
+    }
 
-        m_textureData[id] = color.redF();
-        m_textureData[id+1] = color.greenF();
-        m_textureData[id+2] = color.blueF();
+    if ( colorId == m_properties["maingl"].get( Fn::Property::D_TREE_COLOR_SELECTION ).toInt() )
+    {
+        updateTexture( node );
+        updateMeshColor( node );
     }
 }
 
-void DatasetTree::selectCluster( QVariant id )
+void DatasetTree::selectNode( int id )
 {
+    if ( id < 0 || id >= static_cast<int>( m_nodes.size() ) || m_root == 0 )
+    {
+        return;
+    }
+
     QColor unselectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_UNSELECTED_CLUSTER_COLOR ).value<QColor>();
     QColor selectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_SELECTED_CLUSTER_COLOR ).value<QColor>();
-    m_tree->setColor( 1, unselectedColor , false, true );
-    m_tree->setColor( id.toInt(), 1, selectedColor );
 
-    m_treeRenderer->update();
-    updateMeshColor();
+    if ( m_selected == -1 || unselectedColor != m_unselectedColor )
+    {
+        colorCluster( m_root->getId(), 1, unselectedColor );
+    }
+    else if ( id == m_selected && selectedColor == m_selectedColor )
+    {
+        return;
+    }
+    else
+    {
+        colorCluster( m_selected, 1, unselectedColor );
+    }
+    colorCluster( id, 1, selectedColor );
+
+    m_selected = id;
+    m_selectedColor = selectedColor;
+    m_unselectedColor = unselectedColor;
+}
+
+void DatasetTree::selectCluster( QVariant id )
+{
+    selectNode( id.toInt() );
+
+    if ( m_treeRenderer != 0 )
+    {
+        m_treeRenderer->update();
+    }
 }
 
 bool DatasetTree::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers modifiers, QString target )
@@ -337,20 +539,13 @@ bool DatasetTree::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers mo
                 m_tree = m_nodes[id]->getParent();
             }
             m_properties["maingl"].set( Fn::Property::D_TREE_SELECTED_CLUSTER, id );
-            QColor unselectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_UNSELECTED_CLUSTER_COLOR ).value<QColor>();
-            QColor selectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_SELECTED_CLUSTER_COLOR ).value<QColor>();
-            m_root->setColor( 1, unselectedColor , false, true );
-            m_tree->setColor( id, 1, selectedColor );
+            selectNode( id );
             m_treeRenderer->setTree( m_tree );
             m_treeRenderer->setSelected( id );
             m_treeRenderer->update();
             m_treeRenderer2->setSelected( id );
             m_treeRenderer2->update();
 
-            glDeleteTextures( 1, &m_textureGLuint );
-            m_textureGLuint = 0;
-            updateMeshColor();
-
             Models::g()->submit();
         }
         return true;
@@ -378,20 +573,13 @@ bool DatasetTree::mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers mo
                 m_tree = m_nodes[id]->getParent();
             }
             m_properties["maingl"].set( Fn::Property::D_TREE_SELECTED_CLUSTER, id );
-            QColor unselectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_UNSELECTED_CLUSTER_COLOR ).value<QColor>();
-            QColor selectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_SELECTED_CLUSTER_COLOR ).value<QColor>();
-            m_root->setColor( 1, unselectedColor , false, true );
-            m_tree->setColor( id, 1, selectedColor );
+            selectNode( id );
             m_treeRenderer->setTree( m_tree );
             m_treeRenderer->setSelected( id );
             m_treeRenderer->update();
             m_treeRenderer2->setSelected( id );
             m_treeRenderer2->update();
 
-            glDeleteTextures( 1, &m_textureGLuint );
-            m_textureGLuint = 0;
-            updateMeshColor();
-
             Models::g()->submit();
         }
         return true;
@@ -439,9 +627,11 @@ void DatasetTree::colorSelectionChanged( QVariant value )
         m_treeRenderer->update();
     }
 
-    glDeleteTextures( 1, &m_textureGLuint );
-    m_textureGLuint = 0;
-    updateMeshColor();
+    if ( m_root != 0 )
+    {
+        updateTexture( m_root );
+        updateMeshColor( m_root );
+    }
     Models::g()->submit();
 }
 
@@ -449,13 +639,9 @@ void DatasetTree::setClusterColor()
 {
     QColor color = m_properties["maingl"].get( Fn::Property::D_TREE_USER_CLUSTER_COLOR ).value<QColor>();
     int id = m_properties["maingl"].get( Fn::Property::D_TREE_SELECTED_CLUSTER ).toInt();
-    m_tree->setColor( id, 2, color );
+    colorCluster( id, 2, color );
 
     m_treeRenderer->update();
-
-    glDeleteTextures( 1, &m_textureGLuint );
-    m_textureGLuint = 0;
-    updateMeshColor();
     Models::g()->submit();
 }
 
@@ -481,42 +667,34 @@ void DatasetTree::applyPartitionMode()
     int mode = m_properties["maingl"].get( Fn::Property::D_TREE_PARTITION_MODE ).toInt();
 
     int id = m_properties["maingl"].get( Fn::Property::D_TREE_SELECTED_CLUSTER ).toInt();
+    if ( id < 0 || id >= static_cast<int>( m_nodes.size() ) )
+    {
+        return;
+    }
     Tree* selected = m_nodes[id];
+    ColormapBase cmap = ColormapFunctions::getColormap( 2 );
+
+    std::priority_queue<Tree*, std::vector<Tree*>, LowerValue> todo;
+    todo.push( selected );
 
     switch ( mode )
     {
         case 0:
         {
             float value = m_properties["maingl"].get( Fn::Property::D_TREE_PARTITION_LEVEL ).toFloat();
-            QList<int>parts;
-            QQueue<Tree*>todo;
-            todo.enqueue( selected );
 
             QColor unselectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_UNSELECTED_CLUSTER_COLOR ).value<QColor>();
-            m_tree->setColor( 3, unselectedColor , false, true );
+            colorCluster( m_tree->getId(), 3, unselectedColor );
 
-            while( !todo.empty() )
+            // split the highest cluster until all are below the level
+            while( !todo.empty() && todo.top()->getValue() >= value )
             {
-                Tree* current = todo.dequeue();
-                if ( current->getValue() < value )
+                Tree* current = todo.top();
+                todo.pop();
+                QList<Tree*> childs = current->getChildren();
+                for ( int i = 0; i < childs.size(); ++i )
                 {
-                    parts.push_back( current->getId() );
-                }
-                else
-                {
-                    QList<Tree*> childs = current->getChildren();
-                    for ( int i = 0; i < childs.size(); ++i )
-                    {
-                        todo.enqueue( childs[i] );
-                    }
-                }
-
-                ColormapBase cmap = ColormapFunctions::getColormap( 2 );
-                for ( int i = 0; i < parts.size(); ++i )
-                {
-                    float v = ( (float)i/(float)parts.size() );
-                    QColor c = cmap.getColor( qMax( 0.0f, qMin( 1.0f, v ) ) );
-                    m_tree->setColor( parts[i], 3, c );
+                    todo.push( childs[i] );
                 }
             }
             break;
@@ -524,71 +702,61 @@ void DatasetTree::applyPartitionMode()
         case 1:
         {
             int targetCount = m_properties["maingl"].get( Fn::Property::D_TREE_PARTITION_SIZE ).toInt();
-            QList<int>parts;
-            QQueue<Tree*>todo;
-            todo.enqueue( selected );
 
-            QColor unselectedColor = m_properties["maingl"].get( Fn::Property::D_TREE_UNSELECTED_CLUSTER_COLOR ).value<QColor>();
-            //m_tree->setColor( 3, unselectedColor , false, true );
-
-            while( !todo.empty() )
+            // split the highest cluster until there are enough or only leaves are left
+            while( static_cast<int>( todo.size() ) < targetCount && !todo.top()->getChildren().empty() )
             {
-                if ( todo.size() >= targetCount )
-                {
-                    break;
-                }
-                else
+                Tree* current = todo.top();
+                todo.pop();
+                QList<Tree*> childs = current->getChildren();
+                for ( int i = 0; i < childs.size(); ++i )
                 {
-                    // order current partitions by size
-                    qSort( todo.begin(), todo.end(), PtrGreater() );
-                    // take highest
-                    Tree* current = todo.dequeue();
-                    // enqueue children
-                    QList<Tree*> childs = current->getChildren();
-                    for ( int i = 0; i < childs.size(); ++i )
-                    {
-                        todo.enqueue( childs[i] );
-                    }
-                }
-
-                ColormapBase cmap = ColormapFunctions::getColormap( 2 );
-                for ( int i = 0; i < todo.size(); ++i )
-                {
-                    float v = ( (float)i/(float)todo.size() );
-                    QColor c = cmap.getColor( qMax( 0.0f, qMin( 1.0f, v ) ) );
-                    m_tree->setColor( todo[i]->getId(), 3, c );
+                    todo.push( childs[i] );
                 }
             }
             break;
         }
     }
+
+    // colors run along the dendrogram from left to right
+    std::vector<Tree*> parts;
+    parts.reserve( todo.size() );
+    while ( !todo.empty() )
+    {
+        parts.push_back( todo.top() );
+        todo.pop();
+    }
+    std::sort( parts.begin(), parts.end(), DepthFirst() );
+
+    for ( unsigned int i = 0; i < parts.size(); ++i )
+    {
+        float v = ( (float)i/(float)parts.size() );
+        QColor c = cmap.getColor( qMax( 0.0f, qMin( 1.0f, v ) ) );
+        colorCluster( parts[i]->getId(), 3, c );
+    }
+
     m_treeRenderer->update();
-    glDeleteTextures( 1, &m_textureGLuint );
-    m_textureGLuint = 0;
-    updateMeshColor();
     Models::g()->submit();
 }
 
-void DatasetTree::updateMeshColor()
+void DatasetTree::updateMeshColor( Tree* node )
 {
-    int colorID = m_properties["maingl"].get( Fn::Property::D_TREE_COLOR_SELECTION ).toInt();
-    qDebug() << colorID;
-    qDebug() << "+++" << m_projection.size() << " - " << m_mesh[0]->numVerts();
-    if ( m_renderer != 0 )
+    if ( m_vertexOffsets.empty() || node->getFirstNode() == -1 )
     {
-        m_renderer->beginUpdateColor();
+        return;
+    }
+    int colorId = m_properties["maingl"].get( Fn::Property::D_TREE_COLOR_SELECTION ).toInt();
 
-        for ( unsigned int i = 0; i < m_projection.size(); ++i )
+    // the renderer takes the colors from the mesh
+    int first = node->getFirstNode();
+    int last = first + node->getNumNodes();
+    for ( unsigned int k = m_vertexOffsets[first]; k < m_vertexOffsets[last]; ++k )
+    {
+        unsigned int vertex = m_vertexIds[k];
+        QColor color = m_nodes[ m_projection[vertex] ]->getColor( colorId );
+        for ( unsigned int m = 0; m < m_mesh.size(); ++m )
         {
-            if ( m_projection[i] != -1 )
-            {
-                for ( unsigned int m = 0; m < m_mesh.size(); ++m )
-                {
-                    m_mesh[m]->setVertexColor( i, m_nodes[ m_projection[i] ]->getColor( colorID ) );
-                }
-            }
-
+            m_mesh[m]->setVertexColor( vertex, color );
         }
-        m_renderer->endUpdateColor();
     }
 }
@@ -17,15 +17,6 @@
 
 class TreeRenderer;
 
-struct PtrGreater // public std::binary_function<bool, const T*, const T*>
-{
-  bool operator()( Tree* a, Tree* b )
-  {
-    // may want to check that the pointers aren't zero...
-    return ( a->getValue() > b->getValue() );
-  }
-};
-
 class DatasetTree : public DatasetMesh
 {
     Q_OBJECT
@@ -34,11 +25,16 @@ public:
     DatasetTree( QDir fn = QDir( "hierarchical tree" ) );
     virtual ~DatasetTree();
 
+    GLuint getTextureGLuint();
+
     void draw( QMatrix4x4 pMatrix, QMatrix4x4 mvMatrix, int width, int height, int renderMode, QString target );
     void drawTree( QMatrix4x4 mvpMatrix, int width, int height );
     void drawRoot( QMatrix4x4 mvpMatrix, int width, int height );
 
-    void importTree( QString dims, std::vector<QString>coords, std::vector<QString>clusters );
+    // dims: nx ny nz dx dy dz ax ay az, coords: 3 voxel coords per leaf,
+    // clusters: one row per node ( value, child ids... ) delimited by clusterOffsets
+    void importTree( const std::vector<double>& dims, const std::vector<int>& coords,
+                     const std::vector<double>& clusters, const std::vector<unsigned int>& clusterOffsets );
 
     Tree* getTree() { return m_tree; };
     Tree* getRoot() { return m_root; };
@@ -46,15 +42,24 @@ public:
     bool mousePick( int pickId, QVector3D pos, Qt::KeyboardModifiers modifiers, QString target );
     void setZoom( int zoom ) { m_zoom = zoom; };
 
-    void setProjection( std::vector<int> projection ) { m_projection = projection; };
+    void setProjection( std::vector<int> projection );
 
 private:
     void createTexture();
 
-    void createTextureRec( Tree* tree );
     int pickClusterRec( Tree* tree, int left, int right, float x, float y );
 
-    void updateMeshColor();
+    void buildIndex();
+    void buildVertexIndex();
+
+    // colors the node and its subtree, texels and vertices follow if colorId is the one shown
+    void colorCluster( int id, int colorId, QColor color );
+    // recolors only the previous and the new selection
+    void selectNode( int id );
+
+    // texels of the leaves and vertices of the nodes below node
+    void updateTexture( Tree* node );
+    void updateMeshColor( Tree* node );
 
     Tree* m_tree;
     Tree* m_root;
@@ -63,12 +68,29 @@ private:
 
     std::vector<Tree*>m_nodes;
 
+    // depth first order of the nodes below m_root and of its leaves, a subtree is a range in both
+    std::vector<Tree*>m_order;
+    std::vector<Tree*>m_leaves;
+    std::vector<int>m_leafTexels;
+    // mesh vertices projected onto the node at each depth first position
+    std::vector<unsigned int>m_vertexOffsets;
+    std::vector<unsigned int>m_vertexIds;
+
     int m_numLeaves;
     int m_numNodes;
 
     std::vector<float>m_textureData;
     std::vector<int>m_projection;
 
+    // texels changed since the last upload
+    bool m_textureDirty;
+    int m_dirtyMin[3];
+    int m_dirtyMax[3];
+
+    int m_selected;
+    QColor m_selectedColor;
+    QColor m_unselectedColor;
+
     int m_width;
     int m_height;
     int m_picked;
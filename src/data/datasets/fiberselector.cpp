@@ -13,6 +13,9 @@
 #include "../roi.h"
 #include "../roiarea.h"
 
+#include "../../algos/fiberspatialindex.h"
+#include "../../algos/voxelfiberindex.h"
+
 #include <QDebug>
 
 #include <math.h>
@@ -21,24 +24,23 @@ FiberSelector::FiberSelector( int numPoints, int numLines ) :
     m_numLines( numLines ),
     m_numPoints( numPoints ),
     m_isInitialized( false ),
-    m_kdVerts( 0 )
+    m_kdVerts( 0 ),
+    m_index( 0 )
 {
-    m_boxMin.resize( 3 );
-    m_boxMax.resize( 3 );
 }
 
 FiberSelector::FiberSelector( std::vector<float>* kdVerts, int numPoints, int numLines ) :
     m_numLines( numLines ),
     m_numPoints( numPoints ),
     m_isInitialized( false ),
-    m_kdVerts( kdVerts )
+    m_kdVerts( kdVerts ),
+    m_index( 0 )
 {
-    m_boxMin.resize( 3 );
-    m_boxMax.resize( 3 );
 }
 
 FiberSelector::~FiberSelector()
 {
+    delete m_index;
 }
 
 std::vector<bool>* FiberSelector::getSelection()
@@ -49,71 +51,9 @@ std::vector<bool>* FiberSelector::getSelection()
 
 void FiberSelector::init( std::vector<Fib>& fibs )
 {
-    qDebug() << "start creating kdtree";
     m_numLines = fibs.size();
-    int ls = 0;
-
-    if ( m_numPoints > 0 )
-    {
-        try
-        {
-            m_reverseIndexes.reserve( m_numPoints );
-            m_lineStarts.reserve( m_numLines );
-            m_lineLengths.reserve( m_numLines );
-        }
-        catch ( std::bad_alloc& )
-        {
-            qCritical() << "***error*** failed to allocate enough memory for kd tree";
-            exit ( 0 );
-        }
-    }
-
-    try
-    {
-        if ( m_kdVerts == 0 )
-        {
-            qDebug() << "copy kdVerts";
-            m_kdVerts = new std::vector<float>();
-            m_kdVerts->reserve( m_numPoints * 3 );
-            //m_numPoints = 0;
-            for ( int i = 0; i < m_numLines; ++i )
-            {
-                m_lineStarts.push_back( ls );
-                m_lineLengths.push_back( fibs[i].length() );
-                for( unsigned int k = 0; k < fibs[i].length(); ++k )
-                {
-                    m_kdVerts->push_back( fibs[i][k].x() );
-                    m_kdVerts->push_back( fibs[i][k].y() );
-                    m_kdVerts->push_back( fibs[i][k].z() );
-                    m_reverseIndexes.push_back( i );
-                    //++m_numPoints;
-                    ++ls;
-                }
-            }
-        }
-        else
-        {
-            qDebug() << "copy kdVerts 2";
-            for ( int i = 0; i < m_numLines; ++i )
-            {
-                m_lineStarts.push_back( ls );
-                m_lineLengths.push_back( fibs[i].length() );
-                for( unsigned int k = 0; k < fibs[i].length(); ++k )
-                {
-                    m_reverseIndexes.push_back( i );
-                    ++ls;
-                }
-            }
-        }
-    }
-    catch ( std::bad_alloc& )
-    {
-        qCritical() << "***error*** failed to allocate enough memory for kd tree";
-        exit ( 0 );
-    }
-
-    m_kdTree = new KdTree( m_numPoints, m_kdVerts->data() );
-    qDebug() << "end creating kdTree";
+    m_index = new FiberSpatialIndex( fibs, m_kdVerts );
+    m_numPoints = m_index->numPoints();
 
     connect( Models::r(), SIGNAL( dataChanged( QModelIndex, QModelIndex ) ), this, SLOT( roiChanged( QModelIndex, QModelIndex ) ) );
     connect( Models::r(), SIGNAL( rowsInserted( QModelIndex, int, int ) ), this, SLOT( roiInserted( QModelIndex, int, int ) ) );
@@ -154,6 +94,11 @@ void FiberSelector::updatePresentRois()
     }
 }
 
+VoxelFiberIndex* FiberSelector::voxelIndex( int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az )
+{
+    return m_index->voxelIndex( nx, ny, nz, dx, dy, dz, ax, ay, az );
+}
+
 void FiberSelector::roiChanged( const QModelIndex &topLeft, const QModelIndex &bottomRight )
 {
     if ( topLeft.row() == -1 ) return;
@@ -250,50 +195,28 @@ void FiberSelector::updateROI( int branch, int pos )
             {
                 m_bitfields[branch][pos][i] = false;
             }
-            for ( unsigned int i = 0; i < m_kdVerts->size() / 3; ++i )
-            {
-                float x = m_kdVerts->at( i*3 );
-                float y = m_kdVerts->at( i*3+1 );
-                float z = m_kdVerts->at( i*3+2 );
-
-                int px = ( x + dx / 2 - ax ) / dx;
-                int py = ( y + dy / 2 - ay ) / dy;
-                int pz = ( z + dz / 2 - az ) / dz;
-
-                px = qMax( 0, qMin( px, nx - 1 ) );
-                py = qMax( 0, qMin( py, ny - 1 ) );
-                pz = qMax( 0, qMin( pz, nz - 1 ) );
-
-                int id = px + py * nx + pz * nx * ny;
-
-                if( data->at( id) - threshold > 0 )
-                {
-                    m_bitfields[branch][pos][m_reverseIndexes[ i ]] = true;
-                }
-            }
+            voxelIndex( nx, ny, nz, dx, dy, dz, ax, ay, az )->select( *data, threshold, m_bitfields[branch][pos] );
         }
         else
         {
-            m_x = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_X ), Qt::DisplayRole ).toFloat();
-            m_y = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_Y ), Qt::DisplayRole ).toFloat();
-            m_z = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_Z ), Qt::DisplayRole ).toFloat();
-            m_dx = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_DX ), Qt::DisplayRole ).toFloat() / 2;
-            m_dy = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_DY ), Qt::DisplayRole ).toFloat() / 2;
-            m_dz = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_DZ ), Qt::DisplayRole ).toFloat() / 2;
-            m_boxMin[0] = m_x - m_dx;
-            m_boxMax[0] = m_x + m_dx;
-            m_boxMin[1] = m_y - m_dy;
-            m_boxMax[1] = m_y + m_dy;
-            m_boxMin[2] = m_z - m_dz;
-            m_boxMax[2] = m_z + m_dz;
+            float center[3];
+            float radii[3];
+            center[0] = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_X ), Qt::DisplayRole ).toFloat();
+            center[1] = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_Y ), Qt::DisplayRole ).toFloat();
+            center[2] = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_Z ), Qt::DisplayRole ).toFloat();
+            radii[0] = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_DX ), Qt::DisplayRole ).toFloat() / 2;
+            radii[1] = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_DY ), Qt::DisplayRole ).toFloat() / 2;
+            radii[2] = Models::r()->data( createIndex( branch, pos, (int)Fn::Property::D_DZ ), Qt::DisplayRole ).toFloat() / 2;
+            float boxMin[3] = { center[0] - radii[0], center[1] - radii[1], center[2] - radii[2] };
+            float boxMax[3] = { center[0] + radii[0], center[1] + radii[1], center[2] + radii[2] };
             for ( int i = 0; i < m_numLines; ++i )
             {
                 m_bitfields[branch][pos][i] = false;
             }
-            boxTest( m_bitfields[branch][pos], 0, m_numPoints - 1, 0 );
+            m_index->selectBox( boxMin, boxMax, m_bitfields[branch][pos] );
             if ( shape == 0 || shape == 1 )
             {
-                sphereTest( m_bitfields[branch][pos] );
+                m_index->restrictToEllipsoid( center, radii, m_bitfields[branch][pos] );
             }
         }
     }
@@ -312,65 +235,6 @@ void FiberSelector::updateROI( int branch, int pos )
     }
 }
 
-void FiberSelector::boxTest( std::vector<bool>& workfield, int left, int right, int axis )
-{
-    // abort condition
-    if ( left > right )
-        return;
-
-    int root = left + ( ( right - left ) / 2 );
-    int axis1 = ( axis + 1 ) % 3;
-    int pointIndex = m_kdTree->m_tree[root] * 3;
-
-    if ( m_kdVerts->at( pointIndex + axis ) < m_boxMin[axis] )
-    {
-        boxTest( workfield, root + 1, right, axis1 );
-    }
-    else if ( m_kdVerts->at( pointIndex + axis ) > m_boxMax[axis] )
-    {
-        boxTest( workfield, left, root - 1, axis1 );
-    }
-    else
-    {
-        int axis2 = ( axis + 2 ) % 3;
-        if ( m_kdVerts->at( pointIndex + axis1 ) <= m_boxMax[axis1] && m_kdVerts->at( pointIndex + axis1 )
-                >= m_boxMin[axis1] && m_kdVerts->at( pointIndex + axis2 ) <= m_boxMax[axis2]
-                && m_kdVerts->at( pointIndex + axis2 ) >= m_boxMin[axis2] )
-        {
-            workfield[m_reverseIndexes[ m_kdTree->m_tree[root] ]] = true;
-        }
-        boxTest( workfield, left, root - 1, axis1 );
-        boxTest( workfield, root + 1, right, axis1 );
-    }
-}
-
-void FiberSelector::sphereTest( std::vector<bool>& workfield )
-{
-    float vx,vy,vz;
-    bool hit;
-    for ( int i = 0; i < m_numLines; ++i )
-    {
-        int ls = m_lineStarts[i] * 3;
-        if ( workfield[i] )
-        {
-            hit = false;
-            for ( int k = 0; k < m_lineLengths[i]; ++k )
-            {
-                vx = ( m_kdVerts->at(  ls + k*3     ) - m_x ) / m_dx;
-                vy = ( m_kdVerts->at(  ls + k*3 + 1 ) - m_y ) / m_dy;
-                vz = ( m_kdVerts->at(  ls + k*3 + 2 ) - m_z ) / m_dz;
-                float r = sqrt( vx * vx + vy * vy + vz * vz );
-                if ( r < 1.0 )
-                {
-                    hit = true;
-                    break;
-                }
-            }
-            workfield[i] = hit;
-        }
-    }
-}
-
 void FiberSelector::updateBranch( int branch )
 {
     int current = 0;
@@ -455,5 +319,30 @@ void FiberSelector::updateRoot()
             m_rootfield[i] = true;
         }
     }
+
+    if ( m_clusterfield.size() == m_rootfield.size() )
+    {
+        for ( int i = 0; i < m_numLines; ++i )
+        {
+            m_rootfield[i] = m_rootfield[i] & m_clusterfield[i];
+        }
+    }
     emit( changed() );
 }
+
+void FiberSelector::selectClusters( const std::vector<int>& assignment, const std::vector<bool>& clusters )
+{
+    m_clusterfield.resize( m_numLines );
+    for ( int i = 0; i < m_numLines; ++i )
+    {
+        int cluster = ( i < (int)assignment.size() ) ? assignment[i] : -1;
+        m_clusterfield[i] = cluster >= 0 && cluster < (int)clusters.size() && clusters[cluster];
+    }
+    updateRoot();
+}
+
+void FiberSelector::clearClusters()
+{
+    m_clusterfield.clear();
+    updateRoot();
+}
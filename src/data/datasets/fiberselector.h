@@ -9,12 +9,14 @@
 #define FIBERSELECTOR_H_
 
 #include "../../algos/fib.h"
-#include "../../algos/kdtree.h"
 
 #include <QVector>
 #include <QObject>
 #include <QAbstractItemModel>
 
+class FiberSpatialIndex;
+class VoxelFiberIndex;
+
 class FiberSelector : public QObject
 {
     Q_OBJECT
@@ -29,6 +31,13 @@ public:
     std::vector<bool>* getSelection();
     QModelIndex createIndex( int branch, int pos, int column );
 
+    // restricts the selection to fibers of the selected clusters, assignment holds the cluster id per fiber
+    void selectClusters( const std::vector<int>& assignment, const std::vector<bool>& clusters );
+    void clearClusters();
+
+    // fibers per voxel of the given grid, shared with all volume rois on that grid
+    VoxelFiberIndex* voxelIndex( int nx, int ny, int nz, float dx, float dy, float dz, float ax, float ay, float az );
+
 private:
     void updatePresentRois();
 
@@ -37,34 +46,20 @@ private:
 
     bool m_isInitialized;
 
-    KdTree* m_kdTree;
     std::vector<float>* m_kdVerts;
-    std::vector<int>m_reverseIndexes;
-    std::vector<int>m_lineStarts;
-    std::vector<int>m_lineLengths;
+    FiberSpatialIndex* m_index;
 
     std::vector<bool>m_rootfield;
+    std::vector<bool>m_clusterfield;
     QList<std::vector<bool> >m_branchfields;
     QList<QList<std::vector<bool> > >m_bitfields;
 
-    std::vector<float> m_boxMin;
-    std::vector<float> m_boxMax;
-
-    float m_x;
-    float m_y;
-    float m_z;
-    float m_dx;
-    float m_dy;
-    float m_dz;
-
 private slots:
     void roiChanged( const QModelIndex &topLeft, const QModelIndex &bottomRight );
     void roiInserted( const QModelIndex &parent, int start, int end );
     void roiDeleted( const QModelIndex &parent, int start, int end );
 
     void updateROI( int branch, int pos );
-    void boxTest( std::vector<bool>& workfield, int left, int right, int axis );
-    void sphereTest( std::vector<bool>& workfield );
 
     void updateBranch( int branch );
     void updateRoot();
@@ -0,0 +1,185 @@
+/*
+ * fmriframering.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "fmriframering.h"
+#include "fmriframeringthread.h"
+
+#include "../../algos/frameconverter.h"
+#include "../../algos/trace.h"
+
+#include <QMutexLocker>
+
+FMRIFrameRing::FMRIFrameRing( const std::vector<float>* data, unsigned int frameSize, int numFrames, float min, float max, int numSlots ) :
+    m_data( data ),
+    m_frameSize( frameSize ),
+    m_numFrames( qMax( 1, numFrames ) ),
+    m_min( min ),
+    m_max( max ),
+    m_slots( qMax( 1, qMin( numSlots, numFrames ) ) ),
+    m_head( -1 ),
+    m_stop( false ),
+    m_thread( 0 )
+{
+    for ( unsigned int i = 0; i < m_slots.size(); ++i )
+    {
+        m_slots[i].frame = -1;
+        m_slots[i].ready = false;
+        m_slots[i].busy = false;
+    }
+}
+
+FMRIFrameRing::~FMRIFrameRing()
+{
+    if ( m_thread )
+    {
+        m_mutex.lock();
+        m_stop = true;
+        m_wake.wakeAll();
+        m_mutex.unlock();
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void FMRIFrameRing::setPlayhead( int frame )
+{
+    QMutexLocker locker( &m_mutex );
+    m_head = ( ( frame % m_numFrames ) + m_numFrames ) % m_numFrames;
+    if ( !m_thread )
+    {
+        m_thread = new FMRIFrameRingThread( this );
+        m_thread->start();
+    }
+    m_wake.wakeAll();
+}
+
+bool FMRIFrameRing::take( int frame, std::vector<quint16>& buffer )
+{
+    QMutexLocker locker( &m_mutex );
+    for ( unsigned int i = 0; i < m_slots.size(); ++i )
+    {
+        Slot& slot = m_slots[i];
+        // the worker is on it already, waiting is cheaper than converting it a second time
+        while ( slot.busy && slot.frame == frame )
+        {
+            m_done.wait( &m_mutex );
+        }
+        if ( slot.ready && slot.frame == frame )
+        {
+            slot.data.swap( buffer );
+            slot.ready = false;
+            slot.frame = -1;
+            m_wake.wakeAll();
+            return true;
+        }
+    }
+    return false;
+}
+
+void FMRIFrameRing::convert( int frame, std::vector<quint16>& buffer )
+{
+    TRACE_SCOPE( "FMRIFrameRing::convert" );
+
+    buffer.resize( m_frameSize );
+    size_t offset = static_cast<size_t>( m_frameSize ) * frame;
+    if ( offset + m_frameSize <= m_data->size() )
+    {
+        FrameConverter::toHalf( m_data->data() + offset, m_frameSize, m_min, m_max, buffer.data() );
+    }
+}
+
+void FMRIFrameRing::invalidate()
+{
+    QMutexLocker locker( &m_mutex );
+    m_head = -1;
+    while ( true )
+    {
+        bool busy = false;
+        for ( unsigned int i = 0; i < m_slots.size(); ++i )
+        {
+            busy |= m_slots[i].busy;
+        }
+        if ( !busy )
+        {
+            break;
+        }
+        m_done.wait( &m_mutex );
+    }
+    for ( unsigned int i = 0; i < m_slots.size(); ++i )
+    {
+        m_slots[i].frame = -1;
+        m_slots[i].ready = false;
+    }
+}
+
+bool FMRIFrameRing::inWindow( int frame )
+{
+    return m_head >= 0 && frame >= 0 && ( ( frame - m_head + m_numFrames ) % m_numFrames ) < static_cast<int>( m_slots.size() );
+}
+
+int FMRIFrameRing::nextJob( int& frame )
+{
+    if ( m_head < 0 )
+    {
+        return -1;
+    }
+    // the nearest frame ahead of the playhead that has no slot yet
+    for ( unsigned int k = 0; k < m_slots.size(); ++k )
+    {
+        int f = ( m_head + k ) % m_numFrames;
+        bool present = false;
+        for ( unsigned int i = 0; i < m_slots.size(); ++i )
+        {
+            present |= ( m_slots[i].frame == f );
+        }
+        if ( present )
+        {
+            continue;
+        }
+        for ( unsigned int i = 0; i < m_slots.size(); ++i )
+        {
+            if ( !m_slots[i].busy && !inWindow( m_slots[i].frame ) )
+            {
+                frame = f;
+                return i;
+            }
+        }
+        return -1;
+    }
+    return -1;
+}
+
+void FMRIFrameRing::work()
+{
+    m_mutex.lock();
+    while ( !m_stop )
+    {
+        int frame;
+        int id = nextJob( frame );
+        if ( id < 0 )
+        {
+            m_done.wakeAll();
+            m_wake.wait( &m_mutex );
+            continue;
+        }
+
+        Slot& slot = m_slots[id];
+        slot.frame = frame;
+        slot.ready = false;
+        slot.busy = true;
+        m_mutex.unlock();
+
+        convert( frame, slot.data );
+
+        m_mutex.lock();
+        slot.busy = false;
+        slot.ready = true;
+        m_done.wakeAll();
+    }
+    m_done.wakeAll();
+    m_mutex.unlock();
+}
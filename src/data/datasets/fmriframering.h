@@ -0,0 +1,74 @@
+/*
+ * fmriframering.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FMRIFRAMERING_H_
+#define FMRIFRAMERING_H_
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <vector>
+
+class FMRIFrameRingThread;
+
+/*
+ * Prepares the frames following the playhead of a series on a worker thread, so switching frames only
+ * has to upload a ready half float buffer. Ready buffers are swapped out, not copied, the caller hands
+ * its previous buffer back into the ring in exchange.
+ */
+class FMRIFrameRing
+{
+    friend class FMRIFrameRingThread;
+
+public:
+    FMRIFrameRing( const std::vector<float>* data, unsigned int frameSize, int numFrames, float min, float max, int numSlots = 4 );
+    virtual ~FMRIFrameRing();
+
+    // the worker prepares the frames from frame on, wrapping around at the end of the series
+    void setPlayhead( int frame );
+
+    // swaps the prepared frame into buffer, returns false if it isn't ready yet
+    bool take( int frame, std::vector<quint16>& buffer );
+
+    // converts on the calling thread
+    void convert( int frame, std::vector<quint16>& buffer );
+
+    // drops all prepared frames and returns once the worker is idle, call it before changing the data,
+    // the worker stays idle until the next setPlayhead
+    void invalidate();
+
+private:
+    struct Slot
+    {
+        int frame;
+        bool ready;
+        bool busy;
+        std::vector<quint16> data;
+    };
+
+    void work();
+    bool inWindow( int frame );
+    int nextJob( int& frame );
+
+    const std::vector<float>* m_data;
+    unsigned int m_frameSize;
+    int m_numFrames;
+    float m_min;
+    float m_max;
+
+    std::vector<Slot> m_slots;
+    int m_head;
+    bool m_stop;
+
+    QMutex m_mutex;
+    QWaitCondition m_wake; // new playhead or a slot was freed
+    QWaitCondition m_done; // a frame is ready or the worker went idle
+
+    FMRIFrameRingThread* m_thread;
+};
+
+#endif /* FMRIFRAMERING_H_ */
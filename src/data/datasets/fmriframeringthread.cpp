@@ -0,0 +1,27 @@
+/*
+ * fmriframeringthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "fmriframeringthread.h"
+#include "fmriframering.h"
+
+#include "../../algos/trace.h"
+
+FMRIFrameRingThread::FMRIFrameRingThread( FMRIFrameRing* ring ) :
+    m_ring( ring )
+{
+}
+
+FMRIFrameRingThread::~FMRIFrameRingThread()
+{
+}
+
+void FMRIFrameRingThread::run()
+{
+    TRACE_SCOPE( "FMRIFrameRingThread::run" );
+
+    m_ring->work();
+}
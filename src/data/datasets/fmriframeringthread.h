@@ -0,0 +1,27 @@
+/*
+ * fmriframeringthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FMRIFRAMERINGTHREAD_H_
+#define FMRIFRAMERINGTHREAD_H_
+
+#include <QThread>
+
+class FMRIFrameRing;
+
+class FMRIFrameRingThread : public QThread
+{
+public:
+    FMRIFrameRingThread( FMRIFrameRing* ring );
+    virtual ~FMRIFrameRingThread();
+
+private:
+    void run();
+
+    FMRIFrameRing* m_ring;
+};
+
+#endif /* FMRIFRAMERINGTHREAD_H_ */
@@ -6,6 +6,8 @@
  */
 #include "isosurfacethread.h"
 
+#include "../../algos/trace.h"
+
 #include "../../gui/gl/glfunctions.h"
 
 #include <QDebug>
@@ -49,6 +51,8 @@ void IsoSurfaceThread::getXYZ( int id, int &x, int &y, int &z )
 
 void IsoSurfaceThread::run()
 {
+    TRACE_SCOPE( "IsoSurfaceThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
 
     int chunkSize = m_scalarField->size() / numThreads;
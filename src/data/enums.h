@@ -90,6 +90,7 @@ namespace Fn
         MESH_CORRELATION,
         MESH_BIGGEST_COMPONENT,
         MESH_DECIMATE,
+        MESH_SIMPLIFY,
         FIBER_DOWNSAMPLE,
         CONS_TO_GLYPHSET,
         FIBER_BUNDLING,
@@ -100,7 +101,10 @@ namespace Fn
         BRAINGL_MATH,
         FLIP_X,
         FLIP_Y,
-        FLIP_Z
+        FLIP_Z,
+        TRACT_PROFILE,
+        CONNECTED_COMPONENTS,
+        PROB_TRACK
     };
 
     enum class Orient : int
@@ -295,6 +299,14 @@ namespace Fn
         D_FIBER_THIN_OUT,
         D_RENDER_MESH,
         D_COPY_VALUES,
+        D_RIBBON_INNER,
+        D_RIBBON_OUTER,
+        D_RIBBON_SAMPLES,
+        D_PAINT_UNDO,
+        D_PAINT_REDO,
+        D_COMPONENT,
+        D_COMPONENT_ROI,
+        D_FIBER_CLUSTER,
         // Global Settings
         G_FIRST = 500, // insert all global properties after this one
         G_LOCK_WIDGETS,
@@ -379,6 +391,11 @@ namespace Fn
         G_ORIENTHELPER_Z,
         G_ORIENTHELPER_SIZE,
         G_FIBERS_INITIAL_PERCENTAGE,
+        G_SUBDIVISION_LEVELS,
+        G_SIMPLIFY_TARGET_TRIS,
+        G_TRACT_SUPERSAMPLING,
+        G_CLUSTER_THRESHOLD,
+        G_CLUSTER_POINTS,
         G_LAST, // insert all global properties before this one
         // ROI Properties
         D_X = 1000,
@@ -566,6 +583,14 @@ namespace Fn
                 case Property::D_FIBER_THIN_OUT: return QString( "D_FIBER_THIN_OUT" ); break;
                 case Property::D_RENDER_MESH: return QString( "D_RENDER_MESH" ); break;
                 case Property::D_COPY_VALUES: return QString( "D_COPY_VALUES" ); break;
+                case Property::D_RIBBON_INNER: return QString( "D_RIBBON_INNER" ); break;
+                case Property::D_RIBBON_OUTER: return QString( "D_RIBBON_OUTER" ); break;
+                case Property::D_RIBBON_SAMPLES: return QString( "D_RIBBON_SAMPLES" ); break;
+                case Property::D_PAINT_UNDO: return QString( "D_PAINT_UNDO" ); break;
+                case Property::D_PAINT_REDO: return QString( "D_PAINT_REDO" ); break;
+                case Property::D_COMPONENT: return QString( "D_COMPONENT" ); break;
+                case Property::D_COMPONENT_ROI: return QString( "D_COMPONENT_ROI" ); break;
+                case Property::D_FIBER_CLUSTER: return QString( "D_FIBER_CLUSTER" ); break;
                 //
                 case Property::G_FIRST: return QString( "G_FIRST" ); break;
                 case Property::G_LOCK_WIDGETS: return QString( "G_LOCK_WIDGETS" ); break;
@@ -649,6 +674,11 @@ namespace Fn
                 case Property::G_ORIENTHELPER_Z: return QString( "G_ORIENTHELPER_Z" ); break;
                 case Property::G_ORIENTHELPER_SIZE: return QString( "G_ORIENTHELPER_SIZE" ); break;
                 case Property::G_FIBERS_INITIAL_PERCENTAGE: return QString( "G_FIBERS_INITIAL_PERCENTAGE" ); break;
+                case Property::G_SUBDIVISION_LEVELS: return QString( "G_SUBDIVISION_LEVELS" ); break;
+                case Property::G_SIMPLIFY_TARGET_TRIS: return QString( "G_SIMPLIFY_TARGET_TRIS" ); break;
+                case Property::G_TRACT_SUPERSAMPLING: return QString( "G_TRACT_SUPERSAMPLING" ); break;
+                case Property::G_CLUSTER_THRESHOLD: return QString( "G_CLUSTER_THRESHOLD" ); break;
+                case Property::G_CLUSTER_POINTS: return QString( "G_CLUSTER_POINTS" ); break;
                 case Property::G_LAST: return QString( "G_LAST" ); break;
                 //
                 case Property::D_X: return QString( "D_X" ); break;
@@ -836,6 +866,14 @@ namespace Fn
                 case Property::D_FIBER_THIN_OUT: return QString( "render percentage of fibers" ); break;
                 case Property::D_RENDER_MESH: return QString( "render mesh" ); break;
                 case Property::D_COPY_VALUES: return QString( "copy values" ); break;
+                case Property::D_RIBBON_INNER: return QString( "ribbon inner surface" ); break;
+                case Property::D_RIBBON_OUTER: return QString( "ribbon outer surface" ); break;
+                case Property::D_RIBBON_SAMPLES: return QString( "ribbon samples" ); break;
+                case Property::D_PAINT_UNDO: return QString( "undo" ); break;
+                case Property::D_PAINT_REDO: return QString( "redo" ); break;
+                case Property::D_COMPONENT: return QString( "component" ); break;
+                case Property::D_COMPONENT_ROI: return QString( "create ROI" ); break;
+                case Property::D_FIBER_CLUSTER: return QString( "cluster" ); break;
                 // Global Settings
                 case Property::G_FIRST: return QString( "placeholder global first" ); break;
                 case Property::G_LOCK_WIDGETS: return QString( "lock widgets" ); break;
@@ -919,6 +957,11 @@ namespace Fn
                 case Property::G_ORIENTHELPER_Z: return QString( "orient helper z" ); break;
                 case Property::G_ORIENTHELPER_SIZE: return QString( "orient helper size" ); break;
                 case Property::G_FIBERS_INITIAL_PERCENTAGE: return QString( "initial percentage of fibers shown" ); break;
+                case Property::G_SUBDIVISION_LEVELS: return QString( "loop subdivision levels" ); break;
+                case Property::G_SIMPLIFY_TARGET_TRIS: return QString( "target triangles for simplify" ); break;
+                case Property::G_TRACT_SUPERSAMPLING: return QString( "tract texture supersampling" ); break;
+                case Property::G_CLUSTER_THRESHOLD: return QString( "fiber cluster threshold (mm)" ); break;
+                case Property::G_CLUSTER_POINTS: return QString( "fiber cluster resample points" ); break;
                 case Property::G_LAST: return QString( "placeholder global last" ); break;
                 // ROI Properties
                 case Property::D_X: return QString( "x" ); break;
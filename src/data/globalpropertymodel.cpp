@@ -52,6 +52,11 @@ GlobalPropertyModel::GlobalPropertyModel()
     m_properties->createRadioGroup( Fn::Property::G_TRACT_TEXT_SOURCE, {"local", "global", "user defined", "data"}, 0, "algos" );
     m_properties->createColor( Fn::Property::G_ISOLINE_STANDARD_COLOR, QColor( 0, 0, 0 ), "algos" );
     m_properties->createFloat( Fn::Property::G_FIBERS_INITIAL_PERCENTAGE, 100.0f, 0.1f, 100.f, "algos" );
+    m_properties->createInt( Fn::Property::G_SUBDIVISION_LEVELS, 1, 1, 4, "algos" );
+    m_properties->createInt( Fn::Property::G_SIMPLIFY_TARGET_TRIS, 100000, 100, 100000000, "algos" );
+    m_properties->createInt( Fn::Property::G_TRACT_SUPERSAMPLING, 1, 1, 4, "algos" );
+    m_properties->createFloat( Fn::Property::G_CLUSTER_THRESHOLD, 10.0f, 0.5f, 100.f, "algos" );
+    m_properties->createInt( Fn::Property::G_CLUSTER_POINTS, 12, 3, 100, "algos" );
 
     m_properties->createFloat( Fn::Property::G_ARCBALL_DISTANCE, 500.0f, 1.0f, 20000.0f, "arcball" );
     m_properties->createBool( Fn::Property::G_SHOW_ORIENTHELPER, false, "arcball" );
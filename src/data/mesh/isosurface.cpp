@@ -0,0 +1,77 @@
+/*
+ * isosurface.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "isosurface.h"
+#include "trianglemesh2.h"
+
+#include "../datasets/isosurfacethread.h"
+
+#include "../../gui/gl/glfunctions.h"
+
+IsoSurface::IsoSurface( std::vector<float>* scalarField, int nx, int ny, int nz, float dx, float dy, float dz )
+{
+    // the threads count cells, one less than the points in each direction
+    for ( int i = 0; i < GLFunctions::idealThreadCount; ++i )
+    {
+        m_threads.push_back( new IsoSurfaceThread( scalarField, &m_mutex, &m_i2pt3idVertices, &m_trivecTriangles, nx - 1, ny - 1, nz - 1, dx, dy, dz, i ) );
+    }
+}
+
+IsoSurface::~IsoSurface()
+{
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        delete m_threads[i];
+    }
+}
+
+TriangleMesh2* IsoSurface::run( float isoLevel, float offsetX, float offsetY, float offsetZ )
+{
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->setIsoLevel( isoLevel );
+    }
+    // run threads
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->start();
+    }
+
+    // wait for all threads to finish
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->wait();
+    }
+
+    unsigned int nextID = 0;
+    QMap<int, POINT3DID>::iterator mapIterator = m_i2pt3idVertices.begin();
+    TRIANGLEVECTOR::iterator vecIterator = m_trivecTriangles.begin();
+
+    TriangleMesh2* mesh = new TriangleMesh2( m_i2pt3idVertices.size(), m_trivecTriangles.size() );
+
+    // Rename vertices.
+    while ( mapIterator != m_i2pt3idVertices.end() )
+    {
+        ( *mapIterator ).newID = nextID++;
+        mesh->addVertex( ( *mapIterator ).x + offsetX, ( *mapIterator ).y + offsetY, ( *mapIterator ).z + offsetZ );
+        ++mapIterator;
+    }
+    // Now rename triangles.
+    while ( vecIterator != m_trivecTriangles.end() )
+    {
+        ( *vecIterator ).pointID[ 0 ] = m_i2pt3idVertices[ ( *vecIterator ).pointID[ 0 ] ].newID;
+        ( *vecIterator ).pointID[ 1 ] = m_i2pt3idVertices[ ( *vecIterator ).pointID[ 1 ] ].newID;
+        ( *vecIterator ).pointID[ 2 ] = m_i2pt3idVertices[ ( *vecIterator ).pointID[ 2 ] ].newID;
+
+        mesh->addTriangle( ( *vecIterator ).pointID[ 0 ], ( *vecIterator ).pointID[ 1 ], ( *vecIterator ).pointID[ 2 ] );
+        ++vecIterator;
+    }
+    mesh->finalize();
+    m_i2pt3idVertices.clear();
+    m_trivecTriangles.clear();
+    return mesh;
+}
@@ -0,0 +1,44 @@
+/*
+ * isosurface.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef ISOSURFACE_H_
+#define ISOSURFACE_H_
+
+#include "isosurfaceincludes.h"
+
+#include <QMutex>
+
+#include <vector>
+
+class IsoSurfaceThread;
+class TriangleMesh2;
+
+/*
+ * Marching cubes over a scalar volume. The threads split the slices and share one vertex map, which is
+ * renamed into a triangle mesh afterwards. The field isn't copied and has to outlive the object.
+ */
+class IsoSurface
+{
+public:
+    IsoSurface( std::vector<float>* scalarField, int nx, int ny, int nz, float dx, float dy, float dz );
+    virtual ~IsoSurface();
+
+    // vertices are moved by the offset, the mesh belongs to the caller
+    TriangleMesh2* run( float isoLevel, float offsetX = 0, float offsetY = 0, float offsetZ = 0 );
+
+private:
+    QMutex m_mutex;
+
+    // List of POINT3Ds which form the isosurface.
+    ID2POINT3DID m_i2pt3idVertices;
+    // List of TRIANGLES which form the triangulation of the isosurface.
+    TRIANGLEVECTOR m_trivecTriangles;
+
+    std::vector<IsoSurfaceThread*> m_threads;
+};
+
+#endif /* ISOSURFACE_H_ */
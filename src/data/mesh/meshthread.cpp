@@ -6,6 +6,8 @@
  */
 #include "meshthread.h"
 
+#include "../../algos/trace.h"
+
 #include "../../gui/gl/glfunctions.h"
 
 MeshThread::MeshThread( std::vector<float>* vertices, std::vector<unsigned int>* triangles, unsigned int numTris, unsigned int bufferSize, int id ) :
@@ -29,6 +31,8 @@ std::vector<QVector3D>* MeshThread::getTriNormals()
 
 void MeshThread::run()
 {
+    TRACE_SCOPE( "MeshThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
 
     int chunkSize = m_numTris / numThreads;
@@ -144,6 +144,31 @@ void TriangleMesh2::finalize()
     calcVertNormals();
 }
 
+void TriangleMesh2::rebuildStars()
+{
+    // for buffers filled directly through getIndexes()
+    std::vector<unsigned int> valence( m_numVerts, 0 );
+    for ( unsigned int i = 0; i < m_numTris * 3; ++i )
+    {
+        ++valence[m_triangles[i]];
+    }
+    for ( unsigned int i = 0; i < m_numVerts; ++i )
+    {
+        m_vertIsInTriangle[i].clear();
+        m_vertIsInTriangle[i].reserve( valence[i] );
+    }
+    for ( unsigned int i = 0; i < m_numTris; ++i )
+    {
+        m_vertIsInTriangle[m_triangles[i * 3    ]].push_back( i );
+        m_vertIsInTriangle[m_triangles[i * 3 + 1]].push_back( i );
+        m_vertIsInTriangle[m_triangles[i * 3 + 2]].push_back( i );
+    }
+    // buffers are completely filled now
+    m_vertexInsertId = m_numVerts * m_bufferSize;
+    m_colorInsertId = m_numVerts * 4;
+    m_triangleInsertId = m_numTris * 3;
+}
+
 void TriangleMesh2::setVertex( unsigned int id, float x, float y, float z )
 {
     m_vertices[ id * m_bufferSize     ] = x;
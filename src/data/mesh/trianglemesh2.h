@@ -54,6 +54,7 @@ public:
     unsigned int getNeighbor( unsigned int coVert1, unsigned int coVert2, unsigned int triangleNum );
     unsigned int getThirdVert( unsigned int coVert1, unsigned int coVert2, unsigned int triangleNum );
 
+    void rebuildStars();
     void finalize();
 
     float* getVertices();
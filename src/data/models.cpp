@@ -351,6 +351,14 @@ void Models::initPropMap()
     m_propMap.insert( "D_FIBER_THIN_OUT", Fn::Property::D_FIBER_THIN_OUT );
     m_propMap.insert( "D_RENDER_MESH", Fn::Property::D_RENDER_MESH );
     m_propMap.insert( "D_COPY_VALUES", Fn::Property::D_COPY_VALUES );
+    m_propMap.insert( "D_RIBBON_INNER", Fn::Property::D_RIBBON_INNER );
+    m_propMap.insert( "D_RIBBON_OUTER", Fn::Property::D_RIBBON_OUTER );
+    m_propMap.insert( "D_RIBBON_SAMPLES", Fn::Property::D_RIBBON_SAMPLES );
+    m_propMap.insert( "D_PAINT_UNDO", Fn::Property::D_PAINT_UNDO );
+    m_propMap.insert( "D_PAINT_REDO", Fn::Property::D_PAINT_REDO );
+    m_propMap.insert( "D_COMPONENT", Fn::Property::D_COMPONENT );
+    m_propMap.insert( "D_COMPONENT_ROI", Fn::Property::D_COMPONENT_ROI );
+    m_propMap.insert( "D_FIBER_CLUSTER", Fn::Property::D_FIBER_CLUSTER );
     m_propMap.insert( "G_FIRST", Fn::Property::G_FIRST );
     m_propMap.insert( "G_LOCK_WIDGETS", Fn::Property::G_LOCK_WIDGETS );
     m_propMap.insert( "G_RENDER_CROSSHAIRS", Fn::Property::G_RENDER_CROSSHAIRS );
@@ -433,6 +441,11 @@ void Models::initPropMap()
     m_propMap.insert( "G_ORIENTHELPER_Z", Fn::Property::G_ORIENTHELPER_Z );
     m_propMap.insert( "G_ORIENTHELPER_SIZE", Fn::Property::G_ORIENTHELPER_SIZE );
     m_propMap.insert( "G_FIBERS_INITIAL_PERCENTAGE", Fn::Property::G_FIBERS_INITIAL_PERCENTAGE );
+    m_propMap.insert( "G_SUBDIVISION_LEVELS", Fn::Property::G_SUBDIVISION_LEVELS );
+    m_propMap.insert( "G_SIMPLIFY_TARGET_TRIS", Fn::Property::G_SIMPLIFY_TARGET_TRIS );
+    m_propMap.insert( "G_TRACT_SUPERSAMPLING", Fn::Property::G_TRACT_SUPERSAMPLING );
+    m_propMap.insert( "G_CLUSTER_THRESHOLD", Fn::Property::G_CLUSTER_THRESHOLD );
+    m_propMap.insert( "G_CLUSTER_POINTS", Fn::Property::G_CLUSTER_POINTS );
     m_propMap.insert( "G_LAST", Fn::Property::G_LAST );
     m_propMap.insert( "D_X", Fn::Property::D_X );
     m_propMap.insert( "D_Y", Fn::Property::D_Y );
@@ -449,6 +462,11 @@ void Models::initPropMap()
 
 }
 
+bool Models::hasProperty( QString s )
+{
+    return m_propMap.contains( s );
+}
+
 Fn::Property Models::s2p( QString s )
 {
     if ( m_propMap.contains( s ) )
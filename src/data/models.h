@@ -53,6 +53,8 @@ public:
     static void addDataset( Dataset* ds );
 
     static Fn::Property s2p( QString s );
+    // s2p exits on an unknown name, check with this first where the name comes from outside
+    static bool hasProperty( QString s );
 
     static float zoom;
 
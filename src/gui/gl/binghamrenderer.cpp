@@ -15,6 +15,7 @@
 #include "../../data/vptr.h"
 #include "../../algos/fmath.h"
 #include "../../algos/qball.h"
+#include "../../algos/trace.h"
 
 #include "../../data/mesh/tesselation.h"
 #include "../../data/properties/propertygroup.h"
@@ -129,6 +130,8 @@ void BinghamRenderer::setShaderVars( PropertyGroup& props )
 
 void BinghamRenderer::initGeometry( PropertyGroup& props )
 {
+    TRACE_SCOPE_CAT( "BinghamRenderer::initGeometry", "geometry" );
+
     float x = Models::getGlobal( Fn::Property::G_SAGITTAL ).toFloat();
     float y = Models::getGlobal( Fn::Property::G_CORONAL ).toFloat();
     float z = Models::getGlobal( Fn::Property::G_AXIAL ).toFloat();
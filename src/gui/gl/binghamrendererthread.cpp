@@ -9,6 +9,7 @@
 #include "glfunctions.h"
 
 #include "../../algos/fmath.h"
+#include "../../algos/trace.h"
 
 #include "../../data/models.h"
 #include "../../data/mesh/tesselation.h"
@@ -82,6 +83,8 @@ std::vector<float>* BinghamRendererThread::getVerts()
 
 void BinghamRendererThread::run()
 {
+    TRACE_SCOPE( "BinghamRendererThread::run" );
+
     const Matrix* vertices = tess::vertices( m_lod );
     int numVerts = tess::n_vertices( m_lod );
 
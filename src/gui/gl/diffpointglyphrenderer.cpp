@@ -9,6 +9,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include <QtOpenGL/QGLShaderProgram>
 
 #include "qmatrix4x4.h"
@@ -189,6 +191,8 @@ void DiffPointGlyphRenderer::setShaderVars( PropertyGroup& props )
 
 void DiffPointGlyphRenderer::initGeometry( float* points, int number )
 {
+    TRACE_SCOPE_CAT( "DiffPointGlyphRenderer::initGeometry", "geometry" );
+
     ps = points;
     np = number;
 
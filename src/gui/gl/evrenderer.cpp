@@ -8,6 +8,7 @@
 #include "glfunctions.h"
 
 #include "../../algos/fmath.h"
+#include "../../algos/trace.h"
 #include "../../data/enums.h"
 #include "../../data/models.h"
 #include "../../data/properties/propertygroup.h"
@@ -122,6 +123,8 @@ void EVRenderer::setShaderVars( PropertyGroup& props )
 
 void EVRenderer::initGeometry( PropertyGroup& props )
 {
+    TRACE_SCOPE_CAT( "EVRenderer::initGeometry", "geometry" );
+
     float nx = props.get( Fn::Property::D_NX ).toFloat();
     float ny = props.get( Fn::Property::D_NY ).toFloat();
     float nz = props.get( Fn::Property::D_NZ ).toFloat();
@@ -8,6 +8,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include "../../data/enums.h"
 #include "../../data/models.h"
 #include "../../data/datasets/fiberselector.h"
@@ -215,6 +217,8 @@ void FiberRenderer::setShaderVars( PropertyGroup& props )
 
 void FiberRenderer::initGeometry()
 {
+    TRACE_SCOPE_CAT( "FiberRenderer::initGeometry", "geometry" );
+
     if ( m_isInitialized )
     {
         return;
@@ -8,6 +8,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include <QVector3D>
 
 #include <math.h>
@@ -38,6 +40,8 @@ std::vector<QVector3D>* FiberRendererThread::getGlobalColors()
 
 void FiberRendererThread::run()
 {
+    TRACE_SCOPE( "FiberRendererThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
 
     int chunkSize = m_data->size() / numThreads;
@@ -24,7 +24,6 @@
 #include <QAbstractItemModel>
 #include <QHash>
 #include <QFile>
-#include <QThread>
 #include <QGLShaderProgram>
 #include <QVector3D>
 #include <QMatrix4x4>
@@ -33,7 +32,6 @@
 
 #define NUM_TEXTURES 5
 
-int GLFunctions::idealThreadCount = qMax( 1, QThread::idealThreadCount() - 1 );
 int GLFunctions::maxDim = 250;
 
 OrientationHelperRenderer* GLFunctions::m_orientationRenderer = new OrientationHelperRenderer();
@@ -0,0 +1,13 @@
+/*
+ * idealthreadcount.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "glfunctions.h"
+
+#include <QThread>
+
+// in its own file, so the algorithm threads that read it link without the rest of the gl code
+int GLFunctions::idealThreadCount = qMax( 1, QThread::idealThreadCount() - 1 );
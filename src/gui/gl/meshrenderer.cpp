@@ -8,6 +8,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include "../../data/enums.h"
 #include "../../data/models.h"
 #include "../../data/mesh/trianglemesh2.h"
@@ -232,6 +234,8 @@ void MeshRenderer::setShaderVars( QGLShaderProgram* program )
 
 void MeshRenderer::initGeometry()
 {
+    TRACE_SCOPE_CAT( "MeshRenderer::initGeometry", "geometry" );
+
     int bufferSize = m_mesh->bufferSize();
 
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, vboIds[ 0 ] );
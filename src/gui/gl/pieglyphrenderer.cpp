@@ -9,6 +9,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include <QtOpenGL/QGLShaderProgram>
 
 PieGlyphRenderer::PieGlyphRenderer() :
@@ -165,6 +167,8 @@ void PieGlyphRenderer::setShaderVars( PropertyGroup& props )
 
 void PieGlyphRenderer::initGeometry( std::vector<float*>* pieArrays, std::vector<int>* numbers, int maxNodeCount )
 {
+    TRACE_SCOPE_CAT( "PieGlyphRenderer::initGeometry", "geometry" );
+
     m_numbers = numbers;
     m_maxNodeCount = maxNodeCount;
     qDebug() << "maxNodeCount: " << m_maxNodeCount;
@@ -9,6 +9,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include <QtOpenGL/QGLShaderProgram>
 
 PointGlyphRenderer::PointGlyphRenderer() :
@@ -174,6 +176,8 @@ void PointGlyphRenderer::setShaderVars( PropertyGroup& props )
 
 void PointGlyphRenderer::initGeometry( float* points, int number )
 {
+    TRACE_SCOPE_CAT( "PointGlyphRenderer::initGeometry", "geometry" );
+
     ps = points;
     np = number;
 
@@ -17,12 +17,17 @@
 #include "../../data/vptr.h"
 #include "../../data/roi.h"
 
+#include "../../algos/trace.h"
+
+#include "../../io/framewriter.h"
+
 #include "../../thirdparty/newmat10/newmat.h"
 
 #include <QGLShaderProgram>
 #include <QDebug>
 
 #include <math.h>
+#include <cstring>
 #include <iostream>
 
 #ifndef GL_MULTISAMPLE
@@ -36,10 +41,17 @@ SceneRenderer::SceneRenderer( QString renderTarget ) :
     m_width( 1 ),
     m_height( 1 ),
     m_renderMode( 0 ),
+    m_showProfile( false ),
     pbo_a( 0 ),
     pbo_b( 0 ),
     RBO( 0 ),
-    FBO( 0 )
+    FBO( 0 ),
+    m_frameWriter( 0 ),
+    m_exportRBO( 0 ),
+    m_exportFBO( 0 ),
+    m_exportWidth( 0 ),
+    m_exportHeight( 0 ),
+    m_exportSlot( 0 )
 {
     m_mvMatrix.setToIdentity();
     m_pMatrix.setToIdentity();
@@ -47,6 +59,7 @@ SceneRenderer::SceneRenderer( QString renderTarget ) :
 
 SceneRenderer::~SceneRenderer()
 {
+    delete m_frameWriter;
 }
 
 void SceneRenderer::initGL()
@@ -130,6 +143,8 @@ void SceneRenderer::resizeGL( int width, int height )
 
 void SceneRenderer::draw( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix )
 {
+    TRACE_FRAME( m_renderTarget );
+
     if ( Models::g()->data( Models::g()->index( (int) Fn::Property::G_NEED_SHADER_UPDATE, 0 ) ).toBool() )
     {
         GLFunctions::reloadShaders();
@@ -148,10 +163,16 @@ void SceneRenderer::draw( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix )
     //***************************************************************************************************/
 
     renderMerge();
+
+    if ( m_showProfile )
+    {
+        renderProfile();
+    }
 }
 
 void SceneRenderer::renderScene()
 {
+    TRACE_SCOPE_CAT( "renderScene", "render" );
     GLFunctions::getAndPrintGLError( "before render scene" );
     QColor bgColor;
     if ( m_renderTarget == "maingl2" )
@@ -294,17 +315,24 @@ void SceneRenderer::renderScenePart( int renderMode, QString target0, QString ta
     setRenderTargets( target0, target1 );
 
     GLFunctions::getAndPrintGLError( m_renderTarget + "---" );
-    GLFunctions::renderSlices( m_pMatrix, m_mvMatrix, m_width, m_height, m_renderMode, m_renderTarget );
-    GLFunctions::renderOrientHelper( m_pMatrix, m_mvMatrix, m_width, m_height, m_renderMode, m_renderTarget );
+    {
+        TRACE_SCOPE_CAT( "slices", "frame" );
+        GLFunctions::renderSlices( m_pMatrix, m_mvMatrix, m_width, m_height, m_renderMode, m_renderTarget );
+        GLFunctions::renderOrientHelper( m_pMatrix, m_mvMatrix, m_width, m_height, m_renderMode, m_renderTarget );
+    }
     //GLFunctions::getAndPrintGLError( m_renderTarget + "+++" );
     renderDatasets();
-    renderRois();
+    {
+        TRACE_SCOPE_CAT( "rois", "frame" );
+        renderRois();
+    }
 
     glBindFramebuffer( GL_FRAMEBUFFER, 0 );
 }
 
 void SceneRenderer::renderMerge()
 {
+    TRACE_SCOPE_CAT( "merge", "frame" );
     m_renderMode = 0;
 
     // Tell OpenGL which VBOs to use
@@ -385,6 +413,18 @@ QImage* SceneRenderer::screenshot( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix )
     int tmpWidth = m_width;
     int tmpHeight = m_height;
     resizeGL( screenshotWidth, screenshotHeight );
+    renderScreenshot();
+
+    QImage* screenshot = getOffscreenTexture( m_width, m_height );
+
+    glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+    resizeGL( tmpWidth, tmpHeight );
+
+    return screenshot;
+}
+
+void SceneRenderer::renderScreenshot()
+{
     renderScene();
     setRenderTarget( "SCREENSHOT" );
     QColor bgColor;
@@ -399,13 +439,138 @@ QImage* SceneRenderer::screenshot( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix )
     glClearColor( bgColor.redF(), bgColor.greenF(), bgColor.blueF(), 1.0 );
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
     renderMerge();
+}
 
-    QImage* screenshot = getOffscreenTexture( m_width, m_height );
+void SceneRenderer::prepareExport( int width, int height )
+{
+    if ( m_frameWriter && width == m_exportWidth && height == m_exportHeight )
+    {
+        return;
+    }
+    endExport();
+
+    // the targets are built while swapped in, so the ones of the screen stay untouched
+    swapExportTargets();
+    m_width = width;
+    m_height = height;
+    initFBO( width, height );
+    swapExportTargets();
+
+    m_exportPBOs.resize( 3 );
+    glGenBuffers( m_exportPBOs.size(), &m_exportPBOs[0] );
+    for ( unsigned int i = 0; i < m_exportPBOs.size(); ++i )
+    {
+        glBindBuffer( GL_PIXEL_PACK_BUFFER, m_exportPBOs[i] );
+        glBufferData( GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ );
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    m_exportNames.assign( m_exportPBOs.size(), QString() );
+    m_exportWidths.assign( m_exportPBOs.size(), 0 );
+    m_exportHeights.assign( m_exportPBOs.size(), 0 );
+    m_exportSlot = 0;
+
+    m_frameWriter = new FrameWriter();
+}
+
+void SceneRenderer::exportFrame( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix, QString fileName )
+{
+    TRACE_SCOPE( "SceneRenderer::exportFrame" );
+
+    if ( !m_frameWriter )
+    {
+        return;
+    }
+
+    m_mvMatrix = mvMatrix;
+    m_pMatrix = pMatrix;
+
+    swapExportTargets();
+    glViewport( 0, 0, m_width, m_height );
+
+    renderScreenshot();
+
+    // the buffer about to be reused holds the oldest frame, its read finished while the newer ones rendered
+    unsigned int slot = m_exportSlot;
+    if ( !m_exportNames[slot].isEmpty() )
+    {
+        readExportSlot( slot );
+    }
+    glReadBuffer( GL_COLOR_ATTACHMENT0 );
+    glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, m_exportPBOs[slot] );
+    glReadPixels( 0, 0, m_width, m_height, GL_BGRA, GL_UNSIGNED_BYTE, 0 );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    m_exportNames[slot] = fileName;
+    m_exportWidths[slot] = m_width;
+    m_exportHeights[slot] = m_height;
+    m_exportSlot = ( slot + 1 ) % m_exportPBOs.size();
 
     glBindFramebuffer( GL_FRAMEBUFFER, 0 );
-    resizeGL( tmpWidth, tmpHeight );
+    swapExportTargets();
+    glViewport( 0, 0, m_width, m_height );
+}
 
-    return screenshot;
+void SceneRenderer::readExportSlot( unsigned int slot )
+{
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, m_exportPBOs[slot] );
+    GLubyte* ptr = (GLubyte*) glMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY );
+    if ( ptr )
+    {
+        m_exportPixels.resize( m_exportWidths[slot] * m_exportHeights[slot] * 4 );
+        memcpy( &m_exportPixels[0], ptr, m_exportPixels.size() );
+        glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+        m_frameWriter->push( m_exportNames[slot], m_exportWidths[slot], m_exportHeights[slot], m_exportPixels );
+    }
+    else
+    {
+        qCritical() << "failed to map pixel buffer for" << m_exportNames[slot];
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 );
+    m_exportNames[slot].clear();
+}
+
+bool SceneRenderer::endExport()
+{
+    if ( !m_frameWriter )
+    {
+        return true;
+    }
+
+    // oldest first
+    for ( unsigned int i = 0; i < m_exportPBOs.size(); ++i )
+    {
+        unsigned int slot = ( m_exportSlot + i ) % m_exportPBOs.size();
+        if ( !m_exportNames[slot].isEmpty() )
+        {
+            readExportSlot( slot );
+        }
+    }
+    glDeleteBuffers( m_exportPBOs.size(), &m_exportPBOs[0] );
+    m_exportPBOs.clear();
+    m_exportNames.clear();
+    m_exportWidths.clear();
+    m_exportHeights.clear();
+    m_exportPixels.clear();
+
+    swapExportTargets();
+    deleteFBO();
+    swapExportTargets();
+    m_exportWidth = 0;
+    m_exportHeight = 0;
+
+    bool ok = m_frameWriter->finish();
+    delete m_frameWriter;
+    m_frameWriter = 0;
+    return ok;
+}
+
+void SceneRenderer::swapExportTargets()
+{
+    textures.swap( m_exportTextures );
+    qSwap( FBO, m_exportFBO );
+    qSwap( RBO, m_exportRBO );
+    qSwap( m_width, m_exportWidth );
+    qSwap( m_height, m_exportHeight );
 }
 
 void SceneRenderer::renderDatasets()
@@ -414,6 +579,7 @@ void SceneRenderer::renderDatasets()
     for ( int i = 0; i < countDatasets; ++i )
     {
         Dataset* ds = VPtr<Dataset>::asPtr( Models::d()->data( Models::d()->index( i, (int) Fn::Property::D_DATASET_POINTER ), Qt::DisplayRole ) );
+        TRACE_SCOPE_CAT( ds->traceName(), "frame" );
         ds->draw( m_pMatrix, m_mvMatrix, m_width, m_height, m_renderMode, m_renderTarget );
     }
 }
@@ -444,6 +610,36 @@ void SceneRenderer::renderRois()
     }
 }
 
+void SceneRenderer::renderProfile()
+{
+    QList<QPair<QString, double> > parts;
+    double frameTime = Trace::lastFrame( m_renderTarget, parts );
+
+    // text positions are in a 1000 x 1000 canvas, origin bottom left
+    int size = 20;
+    int y = 1000 - 2 * size;
+    QColor color( 255, 255, 0 );
+
+    glDisable( GL_DEPTH_TEST );
+    GLFunctions::renderText( "frame " + QString::number( frameTime, 'f', 2 ) + " ms", 10, y, size, m_width, m_height, color, 0 );
+    for ( int i = 0; i < parts.size() && i < 20; ++i )
+    {
+        y -= size;
+        GLFunctions::renderText( QString::number( parts[i].second, 'f', 2 ) + " ms  " + parts[i].first, 10, y, size, m_width, m_height, color, 0 );
+    }
+    glEnable( GL_DEPTH_TEST );
+}
+
+void SceneRenderer::setShowProfile( bool show )
+{
+    m_showProfile = show;
+}
+
+bool SceneRenderer::getShowProfile()
+{
+    return m_showProfile;
+}
+
 void SceneRenderer::renderPick()
 {
     // render
@@ -650,13 +846,7 @@ void SceneRenderer::initFBO( int width, int height )
 {
     if ( textures.size() > 0 )
     {
-        foreach ( GLuint tex, textures )
-        {
-            glDeleteTextures( 1, &tex );
-        }
-        glDeleteFramebuffers( 1, &FBO );
-        glDeleteRenderbuffers( 1, &RBO );
-
+        deleteFBO();
     }
 
     textures[ "C0" ] = createTexture( width, height );
@@ -701,6 +891,19 @@ void SceneRenderer::initFBO( int width, int height )
     glBindFramebuffer( GL_FRAMEBUFFER, 0 );
 }
 
+void SceneRenderer::deleteFBO()
+{
+    foreach ( GLuint tex, textures )
+    {
+        glDeleteTextures( 1, &tex );
+    }
+    textures.clear();
+    glDeleteFramebuffers( 1, &FBO );
+    glDeleteRenderbuffers( 1, &RBO );
+    FBO = 0;
+    RBO = 0;
+}
+
 GLuint SceneRenderer::createTexture( int width, int height )
 {
     /* generate a texture id */
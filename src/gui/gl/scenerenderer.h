@@ -16,8 +16,11 @@
 #include <QMatrix4x4>
 #include <QModelIndex>
 
+#include <vector>
+
 class ArcBall;
 class DataStore;
+class FrameWriter;
 class QItemSelectionModel;
 
 class SceneRenderer : public ObjectRenderer
@@ -33,6 +36,14 @@ public:
 	void renderMerge();
 	QImage* screenshot( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix );
 
+    // frame export for animations, the frames are rendered into a second set of targets of the export
+    // size and read back through a ring of pixel buffers, so the read of a frame overlaps the rendering of
+    // the next ones, encoding and writing run on the threads of a FrameWriter
+    void prepareExport( int width, int height );
+    void exportFrame( QMatrix4x4 mvMatrix, QMatrix4x4 pMatrix, QString fileName );
+    // hands on the frames still in flight and waits until all are written
+    bool endExport();
+
     QVector3D mapMouse2World( int x, int y, int z );
     QVector2D mapWorld2Mouse( float x, float y, float z );
     QVector3D mapMouse2World( float x, float y );
@@ -43,15 +54,24 @@ public:
 
     QString getRenderTarget();
 
+    // frame time breakdown by dataset, only has content when built with tracing
+    void setShowProfile( bool show );
+    bool getShowProfile();
+
 private:
 	void renderScene();
+	void renderScreenshot();
 	void renderScenePart( int renderMode, QString target0, QString target1 );
 
 	void renderDatasets();
 	void renderRois();
+	void renderProfile();
 
     void generate_pixel_buffer_objects( int width, int height );
 	void initFBO( int width, int height );
+    void deleteFBO();
+    void swapExportTargets();
+    void readExportSlot( unsigned int slot );
     GLuint createTexture( int width, int height );
     void setRenderTarget( QString target );
     void setRenderTargets( QString target0, QString target1 );
@@ -65,6 +85,7 @@ private:
 	int m_width;
 	int m_height;
 	int m_renderMode;
+	bool m_showProfile;
 
 	QMatrix4x4 m_mvMatrix;
 	QMatrix4x4 m_pMatrix;
@@ -75,6 +96,19 @@ private:
     QHash<QString, GLuint>textures;
     GLuint RBO;
     GLuint FBO;
+
+    FrameWriter* m_frameWriter;
+    QHash<QString, GLuint>m_exportTextures;
+    GLuint m_exportRBO;
+    GLuint m_exportFBO;
+    int m_exportWidth;
+    int m_exportHeight;
+    std::vector<GLuint>m_exportPBOs;
+    std::vector<QString>m_exportNames; // file of the frame waiting in each pixel buffer
+    std::vector<int>m_exportWidths; // its size, the targets may be swapped back when it is read
+    std::vector<int>m_exportHeights;
+    unsigned int m_exportSlot;
+    std::vector<unsigned char>m_exportPixels;
 };
 
 #endif /* SCENERENDERER_H_ */
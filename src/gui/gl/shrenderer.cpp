@@ -14,6 +14,7 @@
 #include "../../data/vptr.h"
 #include "../../algos/fmath.h"
 #include "../../algos/qball.h"
+#include "../../algos/trace.h"
 
 #include "../../data/mesh/tesselation.h"
 #include "../../data/mesh/trianglemesh2.h"
@@ -260,6 +261,8 @@ void SHRenderer::setRenderParams( PropertyGroup& props )
 
 void SHRenderer::initGeometry( PropertyGroup& props )
 {
+    TRACE_SCOPE_CAT( "SHRenderer::initGeometry", "geometry" );
+
     float x = Models::getGlobal( Fn::Property::G_SAGITTAL ).toFloat();
     float y = Models::getGlobal( Fn::Property::G_CORONAL ).toFloat();
     float z = Models::getGlobal( Fn::Property::G_AXIAL ).toFloat();
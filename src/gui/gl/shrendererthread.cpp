@@ -9,6 +9,7 @@
 #include "glfunctions.h"
 
 #include "../../algos/fmath.h"
+#include "../../algos/trace.h"
 #include "../../data/mesh/tesselation.h"
 #include "../../data/models.h"
 
@@ -82,6 +83,8 @@ SHRendererThread::~SHRendererThread()
 
 void SHRendererThread::run()
 {
+    TRACE_SCOPE( "SHRendererThread::run" );
+
     const Matrix* vertices = tess::vertices( m_lod );
     const int* faces = tess::faces( m_lod );
 
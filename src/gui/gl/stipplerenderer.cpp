@@ -9,6 +9,7 @@
 #include "glfunctions.h"
 
 #include "../../algos/fmath.h"
+#include "../../algos/trace.h"
 #include "../../data/enums.h"
 #include "../../data/models.h"
 #include "../../data/properties/propertygroup.h"
@@ -160,6 +161,8 @@ void StippleRenderer::setShaderVars( PropertyGroup& props )
 
 void StippleRenderer::initGeometry( PropertyGroup& props )
 {
+    TRACE_SCOPE_CAT( "StippleRenderer::initGeometry", "geometry" );
+
     m_nx = props.get( Fn::Property::D_NX ).toFloat();
     m_ny = props.get( Fn::Property::D_NY ).toFloat();
     m_nz = props.get( Fn::Property::D_NZ ).toFloat();
@@ -9,6 +9,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include "../../data/enums.h"
 #include "../../data/datasets/fiberselector.h"
 #include "../../data/properties/propertygroup.h"
@@ -184,6 +186,8 @@ void TubeRenderer::setShaderVars( PropertyGroup& props )
 
 void TubeRenderer::initGeometry()
 {
+    TRACE_SCOPE_CAT( "TubeRenderer::initGeometry", "geometry" );
+
     if ( m_isInitialized )
     {
         return;
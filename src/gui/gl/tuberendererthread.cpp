@@ -8,6 +8,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include <QVector3D>
 
 #include <math.h>
@@ -31,6 +33,8 @@ std::vector<float>* TubeRendererThread::getVerts()
 
 void TubeRendererThread::run()
 {
+    TRACE_SCOPE( "TubeRendererThread::run" );
+
     int numThreads = GLFunctions::idealThreadCount;
 
     int chunkSize = m_fibs->size() / numThreads;
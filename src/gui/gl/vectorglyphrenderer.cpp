@@ -9,6 +9,8 @@
 
 #include "glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include <QtOpenGL/QGLShaderProgram>
 
 VectorGlyphRenderer::VectorGlyphRenderer() :
@@ -167,6 +169,8 @@ void VectorGlyphRenderer::setShaderVars( PropertyGroup& props )
 
 void VectorGlyphRenderer::initGeometry( float* points, int number )
 {
+    TRACE_SCOPE_CAT( "VectorGlyphRenderer::initGeometry", "geometry" );
+
     ps = points;
     np = number;
 
@@ -332,7 +332,7 @@ void MainWindow::open()
 {
     QString fn = Models::getGlobal(  Fn::Property::G_LAST_PATH ).toString();
 
-    QString filter( "all files (*.*);;niftii (*.nii *.nii.gz);;fib files (*.fib *.vtk *.asc *.json);;surfaces (*.vtk *.asc)" );
+    QString filter( "all files (*.*);;niftii (*.nii *.nii.gz);;fib files (*.fib *.vtk *.asc *.json *.bgf *.tck);;surfaces (*.vtk *.asc)" );
 
     fd = new QFileDialog( this, "Open File", fn, filter );
     fd->setFileMode( QFileDialog::ExistingFiles );
@@ -1394,7 +1394,8 @@ void MainWindow::createDockWindows()
     m_centralWidget->addDockWidget( Qt::LeftDockWidgetArea, dockSW );
     viewMenu->addAction( dockSW->toggleViewAction() );
     connect( lockDockTitlesAct, SIGNAL( triggered() ), dockSW, SLOT( toggleTitleWidget() ) );
-    connect( m_scriptWidget, SIGNAL( screenshot() ), this, SLOT( screenshot() ) );
+    connect( m_scriptWidget, SIGNAL( exportFrame() ), this, SLOT( exportFrame() ) );
+    connect( m_scriptWidget, SIGNAL( exportFinished() ), this, SLOT( finishExport() ) );
     //connect( mainGLWidget, SIGNAL( signalCameraChanged() ), m_scriptWidget, SLOT( slotCameraChanged() ) );
     connect( mainGLWidget, SIGNAL( signalCopyCameraToScript( int ) ), m_scriptWidget, SLOT( slotCopyCamera( int ) ) );
     m_centralWidget->tabifiedDockWidgets( dockSW );
@@ -1571,24 +1572,36 @@ void MainWindow::slotRenderCrosshairs( bool value )
     Models::g()->setData( Models::g()->index( (int) Fn::Property::G_RENDER_CROSSHAIRS, 0 ), value );
 }
 
-void MainWindow::screenshot( bool exitAfter )
+QString MainWindow::nextScreenshotNumber()
 {
-    QString path = Models::getGlobal(  Fn::Property::G_SCREENSHOT_PATH ).toString();
-    if ( !path.endsWith( QDir::separator() ) )
-    {
-        path += QDir::separator();
-    }
     QString numberString = Models::getGlobal( Fn::Property::G_SCREENSHOT_CURRENT_NUMBER ).toString();
     Models::setGlobal( Fn::Property::G_SCREENSHOT_CURRENT_NUMBER, Models::getGlobal( Fn::Property::G_SCREENSHOT_CURRENT_NUMBER ).toInt() + 1 );
     int nss = numberString.size();
     int numDigits = Models::getGlobal( Fn::Property::G_SCREENSHOT_DIGITS ).toInt();
-    QString prefix = Models::getGlobal( Fn::Property::G_SCREENSHOT_PREFIX ).toString();
-    QString prefix2 = Models::getGlobal( Fn::Property::G_SCREENSHOT_PREFIX2 ).toString();
 
     for ( int i = 0; i < numDigits - nss; ++i )
     {
         numberString = "0" + numberString;
     }
+    return numberString;
+}
+
+QString MainWindow::screenshotPath()
+{
+    QString path = Models::getGlobal(  Fn::Property::G_SCREENSHOT_PATH ).toString();
+    if ( !path.endsWith( QDir::separator() ) )
+    {
+        path += QDir::separator();
+    }
+    return path;
+}
+
+void MainWindow::screenshot( bool exitAfter )
+{
+    QString path = screenshotPath();
+    QString numberString = nextScreenshotNumber();
+    QString prefix = Models::getGlobal( Fn::Property::G_SCREENSHOT_PREFIX ).toString();
+    QString prefix2 = Models::getGlobal( Fn::Property::G_SCREENSHOT_PREFIX2 ).toString();
 
     if ( Models::getGlobal( Fn::Property::G_SCREENSHOT_DO_MAINGL ).toBool() )
     {
@@ -1601,6 +1614,35 @@ void MainWindow::screenshot( bool exitAfter )
     Models::g()->submit();
 }
 
+void MainWindow::exportFrame()
+{
+    // frames are numbered by the screenshot counter, so a script exports the same files however fast it runs
+    QString path = screenshotPath();
+    QString numberString = nextScreenshotNumber();
+    QString prefix = Models::getGlobal( Fn::Property::G_SCREENSHOT_PREFIX ).toString();
+    QString prefix2 = Models::getGlobal( Fn::Property::G_SCREENSHOT_PREFIX2 ).toString();
+
+    if ( Models::getGlobal( Fn::Property::G_SCREENSHOT_DO_MAINGL ).toBool() )
+    {
+        mainGLWidget->exportFrame( path + prefix + numberString + QString( ".png" ) );
+    }
+    if ( Models::getGlobal( Fn::Property::G_SCREENSHOT_DO_MAINGL2 ).toBool() )
+    {
+        mainGLWidget2->exportFrame( path + prefix2 + numberString + QString( ".png" ) );
+    }
+    Models::g()->submit();
+}
+
+void MainWindow::finishExport()
+{
+    bool ok = mainGLWidget->finishExport();
+    ok &= mainGLWidget2->finishExport();
+    if ( !ok )
+    {
+        qCritical() << "error while exporting frames";
+    }
+}
+
 void MainWindow::resetSettings()
 {
     QMessageBox msgBox;
@@ -76,6 +76,10 @@ private:
 
     Dataset* selectedDataset();
 
+    QString screenshotPath();
+    // zero padded, counts up
+    QString nextScreenshotNumber();
+
     bool m_debug;
 
     QMainWindow* m_centralWidget;
@@ -170,6 +174,8 @@ private:
 
 public slots:
     void screenshot( bool exitAfter = false );
+    void exportFrame();
+    void finishExport();
     void runScript();
 
 private slots:
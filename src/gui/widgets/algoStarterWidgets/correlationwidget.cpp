@@ -26,7 +26,7 @@ CorrelationWidget::CorrelationWidget( Dataset* ds, QWidget* parent ) :
     m_progress( 0 )
 {
     m_dataset = dynamic_cast<DatasetMeshTimeSeries*>( ds );
-    m_correlation = new Correlation( m_dataset );
+    m_correlation = new Correlation( m_dataset->getSeries( 0 ), m_dataset->getMesh()->numVerts(), m_dataset->getNumDataPoints() );
     connect( m_correlation, SIGNAL( progress() ), this, SLOT( slotProgress() ), Qt::QueuedConnection );
     connect( m_correlation, SIGNAL( finished() ), this, SLOT( slotFinished() ) );
 
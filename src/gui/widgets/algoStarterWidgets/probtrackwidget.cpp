@@ -0,0 +1,94 @@
+/*
+ * probtrackwidget.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+#include "probtrackwidget.h"
+
+#include "../controls/sliderwitheditint.h"
+
+#include "../../../algos/dwialgos.h"
+#include "../../../algos/probtrack.h"
+#include "../../../algos/probtrackworker.h"
+#include "../../../data/datasets/dataset.h"
+
+#include <QPushButton>
+#include <QProgressBar>
+
+ProbTrackWidget::ProbTrackWidget( Dataset* ds, QWidget* parent ) :
+    m_dataset( ds ),
+    m_tracker( 0 ),
+    m_worker( 0 )
+{
+    m_layout = new QVBoxLayout();
+
+    QHBoxLayout* hLayout = new QHBoxLayout();
+    m_startButton = new QPushButton( tr("Start") );
+    connect( m_startButton, SIGNAL( clicked() ), this, SLOT( start() ) );
+
+    m_samples = new SliderWithEditInt( QString("samples per seed voxel") );
+    m_samples->setMin( 1 );
+    m_samples->setMax( 1000 );
+    m_samples->setValue( 10 );
+    m_layout->addWidget( m_samples );
+
+    // the same seed gives the same fibers and visitation map, for any number of threads
+    m_seed = new SliderWithEditInt( QString("random seed") );
+    m_seed->setMin( 0 );
+    m_seed->setMax( 100000 );
+    m_seed->setValue( 0 );
+    m_layout->addWidget( m_seed );
+
+    m_progressBar = new QProgressBar( this );
+    m_progressBar->setValue( 0 );
+    m_progressBar->setMaximum( 100 );
+    m_progressBar->hide();
+
+    m_layout->addWidget( m_progressBar );
+
+    hLayout->addStretch();
+    hLayout->addWidget( m_startButton );
+
+    m_layout->addLayout( hLayout );
+
+    m_layout->addStretch();
+    setLayout( m_layout );
+}
+
+ProbTrackWidget::~ProbTrackWidget()
+{
+    // waits for the tracking if the widget is closed while it runs
+    delete m_worker;
+    delete m_tracker;
+}
+
+QList<Dataset*> ProbTrackWidget::getResult()
+{
+    return DWIAlgos::probTrackResult( m_dataset, *m_worker->getFibs(), *m_tracker->density() );
+}
+
+void ProbTrackWidget::start()
+{
+    qDebug() << "prob track widget start";
+    m_startButton->hide();
+    m_samples->setEnabled( false );
+    m_seed->setEnabled( false );
+    m_progressBar->show();
+
+    m_tracker = DWIAlgos::probTracker( m_dataset, m_samples->getValue(), m_seed->getValue() );
+    m_worker = new ProbTrackWorker( m_tracker );
+    connect( m_worker, SIGNAL( progress( int ) ), this, SLOT( slotProgress( int ) ), Qt::QueuedConnection );
+    connect( m_worker, SIGNAL( finished() ), this, SLOT( slotFinished() ), Qt::QueuedConnection );
+    m_worker->start();
+}
+
+void ProbTrackWidget::slotProgress( int percent )
+{
+    m_progressBar->setValue( percent );
+}
+
+void ProbTrackWidget::slotFinished()
+{
+    emit( finished() );
+}
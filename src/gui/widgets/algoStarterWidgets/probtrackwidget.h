@@ -0,0 +1,55 @@
+/*
+ * probtrackwidget.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef PROBTRACKWIDGET_H_
+#define PROBTRACKWIDGET_H_
+
+#include "../../../data/enums.h"
+
+#include <QtWidgets>
+
+class QProgressBar;
+class QPushButton;
+class Dataset;
+class ProbTrack;
+class ProbTrackWorker;
+class SliderWithEditInt;
+
+class ProbTrackWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    ProbTrackWidget( Dataset* ds, QWidget* parent = 0 );
+    virtual ~ProbTrackWidget();
+
+    // fibers and visitation map, once finished
+    QList<Dataset*> getResult();
+
+private:
+    QVBoxLayout* m_layout;
+
+    Dataset* m_dataset;
+    ProbTrack* m_tracker;
+    ProbTrackWorker* m_worker;
+
+    QPushButton* m_startButton;
+    QProgressBar* m_progressBar;
+
+    SliderWithEditInt* m_samples;
+    SliderWithEditInt* m_seed;
+
+private slots:
+    void start();
+    void slotProgress( int percent );
+    void slotFinished();
+
+signals:
+    void finished();
+};
+
+#endif /* PROBTRACKWIDGET_H_ */
@@ -11,6 +11,8 @@
 #include "../gl/camerabase.h"
 #include "../gl/glfunctions.h"
 
+#include "../../algos/trace.h"
+
 #include "../../data/datastore.h"
 #include "../../data/enums.h"
 #include "../../data/models.h"
@@ -37,6 +39,7 @@ GLWidget::GLWidget( QString name, QItemSelectionModel* roiSelectionModel, QWidge
     m_height( 0 ),
     m_doScreenshot( false ),
     m_exitAfterScreenshot( false ),
+    m_exporting( false ),
     m_copyCameraMode( 0 )
 {
     m_arcBall = new ArcBall( 400, 400 );
@@ -66,6 +69,7 @@ GLWidget::GLWidget( QString name, QItemSelectionModel* roiSelectionModel, QWidge
     m_height( 0 ),
     m_doScreenshot( false ),
     m_exitAfterScreenshot( false ),
+    m_exporting( false ),
     m_copyCameraMode( 0 )
 {
     m_arcBall = new ArcBall( 400, 400 );
@@ -239,7 +243,7 @@ void GLWidget::calcMVPMatrix()
     float halfBB = ( boundingbox / 2 ) / zoom;
 
     float ratio = 1.0f;
-    if ( m_doScreenshot )
+    if ( m_doScreenshot || m_exporting )
     {
         float screenshotWidth = Models::getGlobal( Fn::Property::G_SCREENSHOT_WIDTH ).toFloat();
         float screenshotHeight = Models::getGlobal( Fn::Property::G_SCREENSHOT_HEIGHT ).toFloat();
@@ -379,6 +383,17 @@ void GLWidget::mouseMoveEvent( QMouseEvent *event )
 void GLWidget::mouseReleaseEvent( QMouseEvent *event )
 {
     QToolTip::hideText();
+
+    if ( event->button() == Qt::RightButton )
+    {
+        QString target = m_sceneRenderer->getRenderTarget();
+        int countDatasets = Models::d()->rowCount();
+        for ( int i = 0; i < countDatasets; ++i )
+        {
+            Dataset* ds = VPtr<Dataset>::asPtr( Models::d()->data( Models::d()->index( i, (int)Fn::Property::D_DATASET_POINTER ), Qt::DisplayRole ) );
+            ds->rightMouseUp( target );
+        }
+    }
     update();
 }
 
@@ -409,6 +424,26 @@ void GLWidget::screenshot( QString fn, bool exitAfter )
     m_screenshotFileName = fn;
 }
 
+void GLWidget::exportFrame( QString fn )
+{
+    int width = Models::getGlobal( Fn::Property::G_SCREENSHOT_WIDTH ).toInt();
+    int height = Models::getGlobal( Fn::Property::G_SCREENSHOT_HEIGHT ).toInt();
+
+    makeCurrent();
+    m_sceneRenderer->prepareExport( width, height );
+    m_exporting = true;
+    calcMVPMatrix();
+    m_sceneRenderer->exportFrame( m_mvMatrix, m_pMatrix, fn );
+    m_exporting = false;
+    calcMVPMatrix();
+}
+
+bool GLWidget::finishExport()
+{
+    makeCurrent();
+    return m_sceneRenderer->endExport();
+}
+
 void GLWidget::rightMouseDown( QMouseEvent* event )
 {
 
@@ -660,6 +695,23 @@ void GLWidget::keyPressEvent( QKeyEvent* event )
                 setView( Fn::Orient::AXIAL );
                 break;
             }
+            case Qt::Key_R:
+            {
+                if ( Trace::isEnabled() )
+                {
+                    m_sceneRenderer->setShowProfile( !m_sceneRenderer->getShowProfile() );
+                    update();
+                }
+                break;
+            }
+            case Qt::Key_T:
+            {
+                if ( Trace::isEnabled() )
+                {
+                    Trace::writeChromeTrace( Trace::outputFile );
+                }
+                break;
+            }
         }
     }
     else
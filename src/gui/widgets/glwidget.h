@@ -34,6 +34,9 @@ public:
 
     void setView( Fn::Orient view );
     void screenshot( QString fn, bool exitAfter = false );
+    // renders the current state at screenshot size into the export pipeline right away
+    void exportFrame( QString fn );
+    bool finishExport();
 
     CameraBase* getCameraInUse();
     ArcBall* getArcBall();
@@ -70,6 +73,7 @@ private:
 
     bool m_doScreenshot;
     bool m_exitAfterScreenshot;
+    bool m_exporting;
     QString m_screenshotFileName;
 
     int m_copyCameraMode;
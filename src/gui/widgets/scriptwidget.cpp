@@ -910,6 +910,7 @@ void ScriptWidget::run( bool checked )
         qDebug() << "stop script";
         m_runScript = false;
         m_pauseButton->setChecked( false );
+        emit( exportFinished() );
     }
 }
 
@@ -1204,16 +1205,23 @@ void ScriptWidget::run()
         return;
     }
 
-    if ( m_screenshotEach->checked() && line[1].toBool() )
-    {
-        emit( screenshot() );
-    }
     qint64 startTime = QDateTime::currentMSecsSinceEpoch();
     Models::g()->submit();
     qint64 endTime = QDateTime::currentMSecsSinceEpoch();
     int timeSpent = endTime - startTime;
     delay = qMax( 1, delay - timeSpent );
 
+    if ( m_screenshotEach->checked() )
+    {
+        // the frame is rendered from the state set above and queued for writing, the files are counted
+        // and not timed, so the next step follows as soon as the renderer is free again
+        if ( line[1].toBool() )
+        {
+            emit( exportFrame() );
+        }
+        delay = 1;
+    }
+
     m_render = false;
 
     QTimer::singleShot( delay, this, SLOT( run() ) );
@@ -159,7 +159,8 @@ signals:
     void editChanged( QString text, int id );
     void selectChanged( int index, int id );
     void checkBoxChanged( int state, int id );
-    void screenshot();
+    void exportFrame();
+    void exportFinished();
     void hideIndicator( bool state, int id );
 };
 
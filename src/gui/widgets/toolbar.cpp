@@ -9,6 +9,7 @@
 #include "../views/toolbarview.h"
 #include "../widgets/algoStarterWidgets/tensortrackwidget.h"
 #include "../widgets/algoStarterWidgets/crossingtrackwidget.h"
+#include "../widgets/algoStarterWidgets/probtrackwidget.h"
 #include "../widgets/algoStarterWidgets/sdwidget.h"
 #include "../widgets/algoStarterWidgets/correlationwidget.h"
 #include "../widgets/algoStarterWidgets/datasetselectionwidget.h"
@@ -73,6 +74,10 @@ void ToolBar::createActions()
     m_medianAct->setStatusTip( tr( "median filter" ) );
     connect( m_medianAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
 
+    m_componentsAct = new FNAction( QIcon( ":/icons/tmp1.png" ), tr( "connected components" ), this, Fn::Algo::CONNECTED_COMPONENTS );
+    m_componentsAct->setStatusTip( tr( "label connected components between the thresholds" ) );
+    connect( m_componentsAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
+
     m_createROIAction = new FNAction( QIcon( ":/icons/tmp1.png" ), tr( "create ROI" ), this, Fn::Algo::CREATE_ROI );
     m_createROIAction->setStatusTip( tr( "create ROI" ) );
     connect( m_createROIAction, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
@@ -122,12 +127,16 @@ void ToolBar::createActions()
     m_fiberTrackingAct->setStatusTip( tr( "tensor tracking" ) );
     connect( m_fiberTrackingAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
 
+    m_probTrackingAct = new FNAction( QIcon( ":/icons/tmpf.png" ), tr( "probabilistic tracking" ), this, Fn::Algo::PROB_TRACK );
+    m_probTrackingAct->setStatusTip( tr( "probabilistic tracking, fibers and visitation map" ) );
+    connect( m_probTrackingAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
+
     m_crossingTrackingAct = new FNAction( QIcon( ":/icons/tmpf.png" ), tr( "tensor tracking with fiber crossings" ), this, Fn::Algo::CROSSING_TRACK );
     m_crossingTrackingAct->setStatusTip( tr( "tensor tracking with crossings" ) );
     connect( m_crossingTrackingAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
 
     m_fiberThinningAct = new FNAction( QIcon( ":/icons/tmpf.png" ), tr( "fiber thinning" ), this, Fn::Algo::FIBER_THINNING );
-    m_fiberThinningAct->setStatusTip( tr( "fiber thinning" ) );
+    m_fiberThinningAct->setStatusTip( tr( "fiber thinning, clusters fibers and creates the cluster centroids" ) );
     connect( m_fiberThinningAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
 
     m_fiberTractDensityAct = new FNAction( QIcon( ":/icons/tmpf.png" ), tr( "tract density" ), this, Fn::Algo::TRACT_DENSITY );
@@ -138,6 +147,10 @@ void ToolBar::createActions()
     m_fiberTractColorAct->setStatusTip( tr( "tract color" ) );
     connect( m_fiberTractColorAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
 
+    m_fiberTractProfileAct = new FNAction( QIcon( ":/icons/tmpf.png" ), tr( "tract profile" ), this, Fn::Algo::TRACT_PROFILE );
+    m_fiberTractProfileAct->setStatusTip( tr( "samples all scalar volumes along the fibers and averages them per bundle" ) );
+    connect( m_fiberTractProfileAct, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
+
 
     m_bingham2tensorAction = new FNAction( QIcon( ":/icons/tmpx.png" ), tr( "Bingham 2 Tensor" ), this, Fn::Algo::BINGHAM_2_TENSOR );
     m_bingham2tensorAction->setStatusTip( tr( "create tensors from bingham fit" ) );
@@ -191,6 +204,10 @@ void ToolBar::createActions()
     m_meshDecimateAction->setStatusTip( tr( "decimate" ) );
     connect( m_meshDecimateAction, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
 
+    m_meshSimplifyAction = new FNAction( QIcon( ":/icons/tmpx.png" ), tr( "simplify" ), this, Fn::Algo::MESH_SIMPLIFY );
+    m_meshSimplifyAction->setStatusTip( tr( "quadric error simplification" ) );
+    connect( m_meshSimplifyAction, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
+
     m_fiberResampleAction = new FNAction( QIcon( ":/icons/tmpx.png" ), tr( "resample" ), this, Fn::Algo::FIBER_DOWNSAMPLE );
     m_fiberResampleAction->setStatusTip( tr( "resample" ) );
     connect( m_fiberResampleAction, SIGNAL( sigTriggered( Fn::Algo ) ), this, SLOT( slot( Fn::Algo ) ) );
@@ -296,6 +313,13 @@ void ToolBar::slot( Fn::Algo algo )
             m_ttw->show();
             break;
         }
+        case Fn::Algo::PROB_TRACK:
+        {
+            m_ptw = new ProbTrackWidget( ds, this->parentWidget() );
+            connect( m_ptw, SIGNAL( finished() ), this, SLOT( probTrackFinished() ) );
+            m_ptw->show();
+            break;
+        }
         case Fn::Algo::CROSSING_TRACK:
         {
             m_ctw = new CrossingTrackWidget( ds, dsList, this->parentWidget() );
@@ -321,6 +345,9 @@ void ToolBar::slot( Fn::Algo algo )
         case Fn::Algo::CREATE_ROI:
             l = ScalarAlgos::createROI( ds );
             break;
+        case Fn::Algo::CONNECTED_COMPONENTS:
+            l = ScalarAlgos::connectedComponents( ds );
+            break;
         case Fn::Algo::BRAINGL_MATH:
             m_mw = new MathWidget( dynamic_cast<DatasetScalar*>( ds ), this->parentWidget() );
             m_mw->show();
@@ -345,6 +372,9 @@ void ToolBar::slot( Fn::Algo algo )
         case Fn::Algo::TRACT_COLOR:
             l = FiberAlgos::tractColor( ds );
             break;
+        case Fn::Algo::TRACT_PROFILE:
+            l = FiberAlgos::tractProfile( ds, Models::getDatasets( Fn::DatasetType::NIFTI_SCALAR ) );
+            break;
         case Fn::Algo::BINGHAM_2_TENSOR:
             l = DWIAlgos::bingham2DWI( ds );
             break;
@@ -402,6 +432,9 @@ void ToolBar::slot( Fn::Algo algo )
         case Fn::Algo::MESH_DECIMATE:
             l = MeshAlgos::decimate( ds );
             break;
+        case Fn::Algo::MESH_SIMPLIFY:
+            l = MeshAlgos::simplify( ds );
+            break;
         case Fn::Algo::MESH_TIME_SERIES:
         {
             std::vector< QPair<QString, QList<Fn::DatasetType> > >filter;
@@ -486,6 +519,7 @@ void ToolBar::slotSelectionChanged( int type )
             this->addAction( m_gaussAct );
             this->addAction( m_medianAct );
             this->addAction( m_createROIAction );
+            this->addAction( m_componentsAct );
             this->addAction( m_brainglMathAction );
             this->addAction( m_flipXAction );
             this->addAction( m_flipYAction );
@@ -506,6 +540,7 @@ void ToolBar::slotSelectionChanged( int type )
             this->addAction( m_evAct );
             this->addAction( m_fiberTrackingAct );
             this->addAction( m_crossingTrackingAct );
+            this->addAction( m_probTrackingAct );
 //            this->addAction( m_flipXAction );
 //            this->addAction( m_flipYAction );
 //            this->addAction( m_flipZAction );
@@ -514,6 +549,8 @@ void ToolBar::slotSelectionChanged( int type )
         case Fn::DatasetType::NIFTI_FMRI:
         {
             this->addAction( m_meshTimeSeriesAction );
+            this->addAction( m_gaussAct );
+            this->addAction( m_medianAct );
             this->addAction( m_flipXAction );
             this->addAction( m_flipYAction );
             this->addAction( m_flipZAction );
@@ -522,6 +559,7 @@ void ToolBar::slotSelectionChanged( int type )
         case Fn::DatasetType::NIFTI_SH:
         {
             this->addAction( m_binghamAction );
+            this->addAction( m_probTrackingAct );
 //            this->addAction( m_sh2meshAction );
 //            this->addAction( m_flipXAction );
 //            this->addAction( m_flipYAction );
@@ -556,6 +594,7 @@ void ToolBar::slotSelectionChanged( int type )
             this->addAction( m_fiberThinningAct );
             this->addAction( m_fiberTractDensityAct );
             this->addAction( m_fiberTractColorAct );
+            this->addAction( m_fiberTractProfileAct );
             this->addAction( m_fiberResampleAction );
             this->addAction( m_fiberBundlingAction );
             break;
@@ -584,6 +623,7 @@ void ToolBar::slotSelectionChanged( int type )
             this->addAction( m_loopSubDAction );
             this->addAction( m_meshBiggestComponentAction );
             this->addAction( m_meshDecimateAction );
+            this->addAction( m_meshSimplifyAction );
             break;
         }
         case Fn::DatasetType::MESH_TIME_SERIES:
@@ -622,6 +662,20 @@ void ToolBar::crossingTrackFinished()
     destroy( m_ctw );
 }
 
+void ToolBar::probTrackFinished()
+{
+    qDebug() << "toolbar prob track finished";
+    QList<Dataset*>l = m_ptw->getResult();
+    for ( int i = 0; i < l.size(); ++i )
+    {
+        QModelIndex index = m_toolBarView->model()->index( m_toolBarView->model()->rowCount(), (int)Fn::Property::D_NEW_DATASET );
+        m_toolBarView->model()->setData( index, VPtr<Dataset>::asQVariant( l[i] ), Qt::DisplayRole );
+    }
+    m_ptw->hide();
+    // the widget owns the tracker with its visitation map
+    m_ptw->deleteLater();
+}
+
 void ToolBar::sdFinished()
 {
     qDebug() << "toolbar sd finished";
@@ -18,6 +18,7 @@ class ToolBarView;
 class CorrelationWidget;
 class TensorTrackWidget;
 class CrossingTrackWidget;
+class ProbTrackWidget;
 class SDWidget;
 class BundlingWidget;
 class FiberBundleWidget;
@@ -42,6 +43,7 @@ private:
     FNAction* m_distanceMapAct;
     FNAction* m_gaussAct;
     FNAction* m_medianAct;
+    FNAction* m_componentsAct;
     FNAction* m_createNewAct;
     FNAction* m_testAct;
     FNAction* m_vectorAction1;
@@ -54,10 +56,12 @@ private:
     FNAction* m_evAct;
     FNAction* m_meshAction1;
     FNAction* m_fiberTrackingAct;
+    FNAction* m_probTrackingAct;
     FNAction* m_crossingTrackingAct;
     FNAction* m_fiberThinningAct;
     FNAction* m_fiberTractDensityAct;
     FNAction* m_fiberTractColorAct;
+    FNAction* m_fiberTractProfileAct;
     FNAction* m_binghamAction;
     FNAction* m_bingham2tensorAction;
     FNAction* m_cutSelectedFibersAction;
@@ -72,6 +76,7 @@ private:
     FNAction* m_meshCorrelationAction;
     FNAction* m_meshBiggestComponentAction;
     FNAction* m_meshDecimateAction;
+    FNAction* m_meshSimplifyAction;
     FNAction* m_fiberResampleAction;
     FNAction* m_consToGlyphsetAction;
     FNAction* m_fiberBundlingAction;
@@ -86,6 +91,7 @@ private:
 
     TensorTrackWidget* m_ttw;
     CrossingTrackWidget* m_ctw;
+    ProbTrackWidget* m_ptw;
     SDWidget* m_sdw;
     CorrelationWidget* m_cw;
     BundlingWidget* m_bw;
@@ -100,6 +106,7 @@ private slots:
 
     void tensorTrackFinished();
     void crossingTrackFinished();
+    void probTrackFinished();
     void sdFinished();
     void correlationFinished();
     void slotMeshSelected( QList<QVariant> meshes );
@@ -0,0 +1,461 @@
+/*
+ * batchrunner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "batchrunner.h"
+
+#include "loader.h"
+#include "loadernifti.h"
+#include "writer.h"
+
+#include "../algos/dwialgos.h"
+#include "../algos/fiberalgos.h"
+#include "../algos/meshalgos.h"
+#include "../algos/scalaralgos.h"
+#include "../algos/trace.h"
+
+#include "../data/models.h"
+#include "../data/datasets/dataset.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QTextStream>
+
+namespace
+{
+    const int SCALAR = (int)Fn::DatasetType::NIFTI_SCALAR;
+    const int TENSOR = (int)Fn::DatasetType::NIFTI_TENSOR;
+    const int SH = (int)Fn::DatasetType::NIFTI_SH;
+    const int FMRI = (int)Fn::DatasetType::NIFTI_FMRI;
+    const int DWI = (int)Fn::DatasetType::NIFTI_DWI;
+    const int BINGHAM = (int)Fn::DatasetType::NIFTI_BINGHAM;
+    const int FIBERS = (int)Fn::DatasetType::FIBERS;
+    const int MESH = (int)Fn::DatasetType::MESH_ASCII | (int)Fn::DatasetType::MESH_BINARY | (int)Fn::DatasetType::MESH_ISOSURFACE;
+
+    struct AlgoTypes
+    {
+        const char* name;
+        int types;
+    };
+
+    // dataset types every algorithm casts its input to, the same the tool bar offers it for
+    const AlgoTypes ALGO_TYPES[] =
+    {
+        { "isosurface", SCALAR },
+        { "isoline", SCALAR },
+        { "distancemap", SCALAR },
+        { "signeddistance", SCALAR },
+        { "gauss", SCALAR | FMRI },
+        { "median", SCALAR | FMRI },
+        { "components", SCALAR },
+        { "tensorfit", DWI },
+        { "fa", DWI },
+        { "ev", DWI },
+        { "fafromtensor", TENSOR },
+        { "evfromtensor", TENSOR },
+        { "qball", DWI },
+        { "qballsharp", DWI },
+        { "bingham", SH },
+        { "bingham2dwi", BINGHAM },
+        { "sh2mesh", SH },
+        { "tensortrack", TENSOR },
+        { "probtrack", TENSOR | SH },
+        { "thinout", FIBERS },
+        { "tractdensity", FIBERS },
+        { "tractcolor", FIBERS },
+        { "downsample", FIBERS },
+        { "tractprofile", FIBERS },
+        { "subdivide", MESH },
+        { "biggestcomponent", MESH },
+        { "decimate", MESH },
+        { "simplify", MESH }
+    };
+
+    // 0 for unknown algorithms
+    int acceptedTypes( QString name )
+    {
+        for ( unsigned int i = 0; i < sizeof( ALGO_TYPES ) / sizeof( AlgoTypes ); ++i )
+        {
+            if ( name == ALGO_TYPES[i].name )
+            {
+                return ALGO_TYPES[i].types;
+            }
+        }
+        return 0;
+    }
+}
+
+BatchRunner::BatchRunner( QString fileName ) :
+    m_fileName( fileName ),
+    m_line( 0 )
+{
+}
+
+BatchRunner::~BatchRunner()
+{
+}
+
+QStringList BatchRunner::algorithms()
+{
+    return QStringList() << "isosurface <isoValue>" << "isoline <isoValue>" << "distancemap" << "signeddistance <threshold>" << "gauss" << "median"
+                         << "components <threshold> <connectivity>"
+                         << "tensorfit" << "fa" << "ev" << "fafromtensor" << "evfromtensor" << "qball" << "qballsharp <order>"
+                         << "bingham" << "bingham2dwi" << "sh2mesh" << "tensortrack" << "probtrack <samples> <seed>"
+                         << "thinout" << "tractdensity" << "tractcolor" << "downsample" << "tractprofile <nodes>"
+                         << "subdivide" << "biggestcomponent" << "decimate" << "simplify";
+}
+
+bool BatchRunner::run()
+{
+    QFile file( m_fileName );
+    if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+    {
+        qCritical() << "batch: couldn't open" << m_fileName;
+        return false;
+    }
+    QTextStream in( &file );
+    QStringList lines;
+    while ( !in.atEnd() )
+    {
+        lines.push_back( in.readLine() );
+    }
+    file.close();
+
+    // loaders must not wait for dialogs
+    LoaderNifti::setInteractive( false );
+
+    QElapsedTimer total;
+    total.start();
+    bool ok = true;
+    for ( int i = 0; i < lines.size() && ok; ++i )
+    {
+        QString line = lines[i];
+        if ( line.contains( "#" ) )
+        {
+            line = line.left( line.indexOf( "#" ) );
+        }
+        QStringList tokens = line.split( QRegExp( "\\s+" ), QString::SkipEmptyParts );
+        if ( tokens.isEmpty() )
+        {
+            continue;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        m_line = i + 1;
+        ok = runCommand( tokens );
+
+        Stage stage;
+        stage.command = line.simplified();
+        stage.ms = timer.elapsed();
+        stage.peakMemory = Trace::peakMemory();
+        m_stages.push_back( stage );
+
+        if ( !ok )
+        {
+            qCritical() << "batch: line" << i + 1 << "failed:" << stage.command;
+        }
+    }
+
+    Stage stage;
+    stage.command = "total";
+    stage.ms = total.elapsed();
+    stage.peakMemory = Trace::peakMemory();
+    m_stages.push_back( stage );
+
+    report();
+    return ok;
+}
+
+bool BatchRunner::runCommand( QStringList& tokens )
+{
+    QString command = tokens.takeFirst();
+    if ( command == "set" )
+    {
+        return set( tokens );
+    }
+    else if ( command == "load" )
+    {
+        return load( tokens );
+    }
+    else if ( command == "algo" )
+    {
+        return algo( tokens );
+    }
+    else if ( command == "save" )
+    {
+        return save( tokens );
+    }
+    qCritical() << "batch: unknown command" << command;
+    return false;
+}
+
+bool BatchRunner::set( QStringList& args )
+{
+    if ( args.size() < 2 || !args[0].startsWith( "G_" ) )
+    {
+        qCritical() << "batch: set needs a global property name and a value";
+        return false;
+    }
+    if ( !Models::hasProperty( args[0] ) )
+    {
+        qCritical() << "batch: line" << m_line << ": unknown property" << args[0];
+        return false;
+    }
+    Models::setGlobal( Models::s2p( args[0] ), args[1] );
+    return true;
+}
+
+bool BatchRunner::load( QStringList& args )
+{
+    if ( args.isEmpty() )
+    {
+        qCritical() << "batch: load needs a file name";
+        return false;
+    }
+    QString fileName = args.join( " " );
+    Loader loader;
+    loader.setFilename( QDir( fileName ) );
+    if ( !loader.load() )
+    {
+        qCritical() << "batch: couldn't load" << fileName;
+        return false;
+    }
+    for ( int k = 0; k < loader.getNumDatasets(); ++k )
+    {
+        m_datasets.push_back( loader.getDataset( k ) );
+    }
+    Models::setGlobal( Fn::Property::G_LAST_PATH, QFileInfo( fileName ).absoluteDir().absolutePath() );
+    return true;
+}
+
+bool BatchRunner::algo( QStringList& args )
+{
+    if ( args.isEmpty() )
+    {
+        qCritical() << "batch: algo needs a name, one of" << algorithms().join( ", " );
+        return false;
+    }
+    QString name = args.takeFirst().toLower();
+    Dataset* ds = takeDataset( args );
+    if ( !ds )
+    {
+        return false;
+    }
+
+    int accepted = acceptedTypes( name );
+    int type = ds->properties().get( Fn::Property::D_TYPE ).toInt();
+    if ( accepted != 0 && ( type & accepted ) == 0 )
+    {
+        qCritical() << "batch: algorithm" << name << "can't run on" << ds->properties().get( Fn::Property::D_NAME ).toString()
+                    << ", dataset type" << QString::number( type, 16 ) << "isn't one of" << QString::number( accepted, 16 );
+        return false;
+    }
+
+    QList<Dataset*> result = runAlgo( name, ds, args );
+    if ( result.isEmpty() )
+    {
+        qCritical() << "batch: algorithm" << name << "produced no dataset";
+        return false;
+    }
+    for ( int i = 0; i < result.size(); ++i )
+    {
+        m_datasets.push_back( result[i] );
+    }
+    return true;
+}
+
+QList<Dataset*> BatchRunner::runAlgo( QString name, Dataset* ds, QStringList& params )
+{
+    float value = params.isEmpty() ? -1 : params[0].toFloat();
+
+    if ( name == "isosurface" )
+    {
+        return ScalarAlgos::isoSurface( ds, value );
+    }
+    else if ( name == "isoline" )
+    {
+        return ScalarAlgos::isoLine( ds, value );
+    }
+    else if ( name == "distancemap" )
+    {
+        return ScalarAlgos::distanceMap( ds );
+    }
+    else if ( name == "signeddistance" )
+    {
+        return ScalarAlgos::signedDistanceMap( ds, value );
+    }
+    else if ( name == "gauss" )
+    {
+        return ScalarAlgos::gauss( ds );
+    }
+    else if ( name == "median" )
+    {
+        return ScalarAlgos::median( ds );
+    }
+    else if ( name == "components" )
+    {
+        if ( params.isEmpty() )
+        {
+            return ScalarAlgos::connectedComponents( ds );
+        }
+        return ScalarAlgos::connectedComponents( ds, value, params.size() > 1 ? params[1].toInt() : 26 );
+    }
+    else if ( name == "tensorfit" )
+    {
+        return DWIAlgos::tensorFit( ds );
+    }
+    else if ( name == "fa" )
+    {
+        return DWIAlgos::calcFAFromDWI( ds );
+    }
+    else if ( name == "ev" )
+    {
+        return DWIAlgos::calcEVFromDWI( ds );
+    }
+    else if ( name == "fafromtensor" )
+    {
+        return DWIAlgos::calcFAFromTensor( ds );
+    }
+    else if ( name == "evfromtensor" )
+    {
+        return DWIAlgos::calcEVFromTensor( ds );
+    }
+    else if ( name == "qball" )
+    {
+        return DWIAlgos::qBall( ds );
+    }
+    else if ( name == "qballsharp" )
+    {
+        return DWIAlgos::qBallSharp( ds, params.isEmpty() ? 4 : params[0].toInt() );
+    }
+    else if ( name == "bingham" )
+    {
+        return DWIAlgos::fitBingham( ds );
+    }
+    else if ( name == "bingham2dwi" )
+    {
+        return DWIAlgos::bingham2DWI( ds );
+    }
+    else if ( name == "sh2mesh" )
+    {
+        return DWIAlgos::sh2mesh( ds );
+    }
+    else if ( name == "tensortrack" )
+    {
+        return DWIAlgos::tensorTrack( ds );
+    }
+    else if ( name == "probtrack" )
+    {
+        return DWIAlgos::probTrack( ds, params.isEmpty() ? 10 : params[0].toInt(), params.size() > 1 ? params[1].toULongLong() : 0 );
+    }
+    else if ( name == "thinout" )
+    {
+        return FiberAlgos::thinOut( ds );
+    }
+    else if ( name == "tractdensity" )
+    {
+        return FiberAlgos::tractDensity( ds );
+    }
+    else if ( name == "tractcolor" )
+    {
+        return FiberAlgos::tractColor( ds );
+    }
+    else if ( name == "downsample" )
+    {
+        return FiberAlgos::downSample( ds );
+    }
+    else if ( name == "tractprofile" )
+    {
+        // every scalar volume loaded so far is sampled along the fibers
+        QList<Dataset*> volumes;
+        for ( int i = 0; i < m_datasets.size(); ++i )
+        {
+            if ( m_datasets[i]->properties().get( Fn::Property::D_TYPE ).toInt() == (int)Fn::DatasetType::NIFTI_SCALAR )
+            {
+                volumes.push_back( m_datasets[i] );
+            }
+        }
+        return FiberAlgos::tractProfile( ds, volumes, params.isEmpty() ? 100 : params[0].toInt() );
+    }
+    else if ( name == "subdivide" )
+    {
+        return MeshAlgos::loopSubdivision( ds );
+    }
+    else if ( name == "biggestcomponent" )
+    {
+        return MeshAlgos::biggestComponent( ds );
+    }
+    else if ( name == "decimate" )
+    {
+        return MeshAlgos::decimate( ds );
+    }
+    else if ( name == "simplify" )
+    {
+        return MeshAlgos::simplify( ds );
+    }
+    qCritical() << "batch: unknown algorithm" << name << ", one of" << algorithms().join( ", " );
+    return QList<Dataset*>();
+}
+
+bool BatchRunner::save( QStringList& args )
+{
+    Dataset* ds = takeDataset( args );
+    if ( !ds || args.isEmpty() )
+    {
+        qCritical() << "batch: save needs a file name";
+        return false;
+    }
+    QString fileName = args.join( " " );
+    QFileInfo fi( fileName );
+
+    // the writers pick the format from the file dialog filter, which ends with the suffix
+    QString suffix = fileName.endsWith( ".nii.gz" ) ? "nii.gz" : fi.suffix();
+    ds->properties().set( Fn::Property::D_FILENAME, fi.absoluteFilePath() );
+    ds->properties().set( Fn::Property::D_NAME, fi.fileName() );
+
+    Writer writer( ds, fi, "(*." + suffix + ")" );
+    return writer.save();
+}
+
+Dataset* BatchRunner::takeDataset( QStringList& args )
+{
+    int id = m_datasets.size() - 1;
+    for ( int i = 0; i < args.size(); ++i )
+    {
+        if ( args[i].startsWith( "@" ) )
+        {
+            id = args[i].mid( 1 ).toInt();
+            args.removeAt( i );
+            break;
+        }
+    }
+    if ( id < 0 || id >= m_datasets.size() )
+    {
+        qCritical() << "batch: no dataset" << id << ", " << m_datasets.size() << "datasets loaded";
+        return 0;
+    }
+    return m_datasets[id];
+}
+
+void BatchRunner::report()
+{
+    // tab separated, so the output of many subjects can be collected and compared
+    QTextStream out( stdout );
+    out << "stage\tms\tpeak_mb" << endl;
+    for ( unsigned int i = 0; i < m_stages.size(); ++i )
+    {
+        out << m_stages[i].command << "\t" << m_stages[i].ms << "\t"
+            << QString::number( m_stages[i].peakMemory / ( 1024. * 1024. ), 'f', 1 ) << endl;
+    }
+    for ( int i = 0; i < m_datasets.size(); ++i )
+    {
+        qDebug() << "batch: @" + QString::number( i ) << m_datasets[i]->properties().get( Fn::Property::D_NAME ).toString();
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ * batchrunner.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef BATCHRUNNER_H_
+#define BATCHRUNNER_H_
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+class Dataset;
+
+/*
+ * Runs a pipeline file without main window and gl context. One command per line, # starts a comment:
+ *
+ *   set <G_PROPERTY> <value>       sets a global property, e.g. set G_FILTER_SIZE 3
+ *   load <fileName>                appends all datasets of the file
+ *   algo <name> [@id] [params]     runs an algorithm, appends its results
+ *   save <fileName> [@id]          saves a dataset, the writer is chosen by the file suffix
+ *
+ * Datasets are numbered in the order they were appended, @id picks one, without it the last one is used.
+ */
+class BatchRunner
+{
+public:
+    BatchRunner( QString fileName );
+    virtual ~BatchRunner();
+
+    bool run();
+
+    static QStringList algorithms();
+
+private:
+    struct Stage
+    {
+        QString command;
+        qint64 ms;
+        quint64 peakMemory;
+    };
+
+    bool runCommand( QStringList& tokens );
+
+    bool set( QStringList& args );
+    bool load( QStringList& args );
+    bool algo( QStringList& args );
+    bool save( QStringList& args );
+
+    Dataset* takeDataset( QStringList& args );
+    QList<Dataset*> runAlgo( QString name, Dataset* ds, QStringList& params );
+
+    void report();
+
+    QString m_fileName;
+    int m_line;
+    QList<Dataset*> m_datasets;
+    std::vector<Stage> m_stages;
+};
+
+#endif /* BATCHRUNNER_H_ */
@@ -0,0 +1,750 @@
+/*
+ * fibercontainer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "fibercontainer.h"
+#include "fibercontainerthread.h"
+#include "streamwriter.h"
+
+#include "../algos/frameconverter.h"
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const char MAGIC[8] = { 'B', 'G', 'L', 'F', 'I', 'B', 'C', 0 };
+    const int VERSION = 1;
+
+    // chunks handed to the threads at once while saving, bounds the encoded data held in memory
+    const unsigned int CHUNKS_PER_THREAD = 4;
+
+    void putByte( std::vector<uchar>& buf, uchar value )
+    {
+        buf.push_back( value );
+    }
+
+    void putInt32( std::vector<uchar>& buf, qint32 value )
+    {
+        buf.resize( buf.size() + 4 );
+        qToBigEndian<qint32>( value, &buf[buf.size() - 4] );
+    }
+
+    void putFloat( std::vector<uchar>& buf, float value )
+    {
+        quint32 bits;
+        memcpy( &bits, &value, 4 );
+        buf.resize( buf.size() + 4 );
+        qToBigEndian<quint32>( bits, &buf[buf.size() - 4] );
+    }
+
+    void putVarint( std::vector<uchar>& buf, quint32 value )
+    {
+        while ( value >= 0x80 )
+        {
+            buf.push_back( ( value & 0x7f ) | 0x80 );
+            value >>= 7;
+        }
+        buf.push_back( value );
+    }
+
+    // small steps of either sign become small unsigned numbers
+    quint32 zigzag( qint32 value )
+    {
+        return ( static_cast<quint32>( value ) << 1 ) ^ static_cast<quint32>( value >> 31 );
+    }
+
+    qint32 unzigzag( quint32 value )
+    {
+        return static_cast<qint32>( value >> 1 ) ^ -static_cast<qint32>( value & 1 );
+    }
+
+    // bounds checked reading of a decoded chunk or the file header
+    class Reader
+    {
+    public:
+        Reader( const uchar* data, qint64 size ) :
+            m_pos( data ),
+            m_end( data + size ),
+            m_ok( true )
+        {
+        }
+
+        bool ok()
+        {
+            return m_ok;
+        }
+
+        bool has( qint64 size )
+        {
+            if ( m_end - m_pos < size )
+            {
+                m_ok = false;
+            }
+            return m_ok;
+        }
+
+        const uchar* raw( qint64 size )
+        {
+            if ( !has( size ) )
+            {
+                return 0;
+            }
+            const uchar* out = m_pos;
+            m_pos += size;
+            return out;
+        }
+
+        uchar byte()
+        {
+            return has( 1 ) ? *m_pos++ : 0;
+        }
+
+        qint32 int32()
+        {
+            const uchar* p = raw( 4 );
+            return p ? qFromBigEndian<qint32>( p ) : 0;
+        }
+
+        qint64 int64()
+        {
+            const uchar* p = raw( 8 );
+            return p ? qFromBigEndian<qint64>( p ) : 0;
+        }
+
+        float float32()
+        {
+            const uchar* p = raw( 4 );
+            if ( !p )
+            {
+                return 0.0f;
+            }
+            quint32 bits = qFromBigEndian<quint32>( p );
+            float value;
+            memcpy( &value, &bits, 4 );
+            return value;
+        }
+
+        quint32 varint()
+        {
+            quint32 value = 0;
+            for ( int shift = 0; shift < 35; shift += 7 )
+            {
+                uchar b = byte();
+                value |= static_cast<quint32>( b & 0x7f ) << shift;
+                if ( !( b & 0x80 ) || !m_ok )
+                {
+                    return value;
+                }
+            }
+            m_ok = false;
+            return value;
+        }
+
+    private:
+        const uchar* m_pos;
+        const uchar* m_end;
+        bool m_ok;
+    };
+}
+
+FiberContainer::FiberContainer() :
+    m_step( 0.01f ),
+    m_quantisation( FLOAT ),
+    m_chunkSize( 4096 ),
+    m_numFibers( 0 ),
+    m_in( 0 ),
+    m_out( 0 ),
+    m_data( 0 ),
+    m_batchBegin( 0 )
+{
+}
+
+FiberContainer::~FiberContainer()
+{
+    close();
+}
+
+void FiberContainer::setStep( float step )
+{
+    m_step = step > 0 ? step : 0.01f;
+}
+
+void FiberContainer::setQuantisation( Quantisation quantisation )
+{
+    m_quantisation = quantisation;
+}
+
+void FiberContainer::setChunkSize( unsigned int fibers )
+{
+    m_chunkSize = qMax( 1u, fibers );
+}
+
+unsigned int FiberContainer::numFibers()
+{
+    return m_numFibers;
+}
+
+QList<QString> FiberContainer::dataNames()
+{
+    QList<QString> names;
+    for ( unsigned int i = 0; i < m_fields.size(); ++i )
+    {
+        names.push_back( m_fields[i].name );
+    }
+    if ( names.empty() )
+    {
+        names.push_back( "no data" );
+    }
+    return names;
+}
+
+std::vector<float> FiberContainer::dataMins()
+{
+    std::vector<float> mins;
+    for ( unsigned int i = 0; i < m_fields.size(); ++i )
+    {
+        mins.push_back( m_fields[i].min );
+    }
+    return mins;
+}
+
+std::vector<float> FiberContainer::dataMaxes()
+{
+    std::vector<float> maxes;
+    for ( unsigned int i = 0; i < m_fields.size(); ++i )
+    {
+        maxes.push_back( m_fields[i].max );
+    }
+    return maxes;
+}
+
+float FiberContainer::coordinateError()
+{
+    return m_step / 2;
+}
+
+float FiberContainer::dataError( int field )
+{
+    if ( field < 0 || field >= (int)m_fields.size() )
+    {
+        return 0.0f;
+    }
+    return m_fields[field].error;
+}
+
+void FiberContainer::runPass( int pass, unsigned int size )
+{
+    // no more threads than chunks, every thread gets at least one
+    int numThreads = static_cast<int>( qMin( static_cast<unsigned int>( GLFunctions::idealThreadCount ), size ) );
+
+    std::vector<FiberContainerThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new FiberContainerThread( this, pass, size, i, numThreads ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+bool FiberContainer::save( QString fileName, const std::vector<Fib>& fibs, const QList<QString>& dataNames )
+{
+    close();
+    m_numFibers = fibs.size();
+
+    // value range of every data field decides its error bound
+    m_fields.clear();
+    int numFields = ( dataNames.empty() || dataNames[0] == "no data" ) ? 0 : dataNames.size();
+    for ( int f = 0; f < numFields; ++f )
+    {
+        Field field;
+        field.name = dataNames[f];
+        field.min = std::numeric_limits<float>::max();
+        field.max = -std::numeric_limits<float>::max();
+        for ( unsigned int i = 0; i < fibs.size(); ++i )
+        {
+            const std::vector<float>* values = fibs[i].getDataField( f );
+            for ( unsigned int k = 0; values && k < values->size(); ++k )
+            {
+                float value = values->at( k );
+                if ( value == value )
+                {
+                    field.min = qMin( field.min, value );
+                    field.max = qMax( field.max, value );
+                }
+            }
+        }
+        if ( field.min > field.max )
+        {
+            field.min = field.max = 0.0f;
+        }
+
+        // half floats and bytes both store the position between min and max
+        field.quantisation = m_quantisation;
+        switch ( field.quantisation )
+        {
+            case HALF:
+                // half the spacing of half floats just below 1
+                field.error = ( field.max - field.min ) / 4096.0f;
+                break;
+            case BYTE:
+                field.error = ( field.max - field.min ) / 510.0f;
+                break;
+            default:
+                field.error = 0.0f;
+                break;
+        }
+        m_fields.push_back( field );
+    }
+
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) )
+    {
+        qCritical() << "Error writing " << fileName;
+        return false;
+    }
+    StreamWriter out( &file );
+
+    out.writeRaw( MAGIC, 8 );
+    out.writeInt32( VERSION );
+    out.writeInt32( m_numFibers );
+    out.writeFloat( m_step );
+    out.writeInt32( m_fields.size() );
+    for ( unsigned int f = 0; f < m_fields.size(); ++f )
+    {
+        QByteArray name = m_fields[f].name.toUtf8();
+        out.writeInt32( name.size() );
+        out.writeRaw( name.constData(), name.size() );
+        out.writeInt32( m_fields[f].quantisation );
+        out.writeFloat( m_fields[f].min );
+        out.writeFloat( m_fields[f].max );
+        out.writeFloat( m_fields[f].error );
+    }
+
+    // chunks are encoded in batches on all threads and written in order
+    unsigned int numChunks = ( m_numFibers + m_chunkSize - 1 ) / m_chunkSize;
+    unsigned int batchSize = GLFunctions::idealThreadCount * CHUNKS_PER_THREAD;
+    m_in = &fibs;
+    for ( m_batchBegin = 0; m_batchBegin < numChunks; m_batchBegin += batchSize )
+    {
+        unsigned int count = qMin( batchSize, numChunks - m_batchBegin );
+        m_encoded.assign( count, QByteArray() );
+        if ( count == 1 )
+        {
+            encodeRange( 0, 1 );
+        }
+        else
+        {
+            runPass( FiberContainerThread::ENCODE, count );
+        }
+
+        for ( unsigned int i = 0; i < count; ++i )
+        {
+            Chunk chunk;
+            chunk.first = ( m_batchBegin + i ) * m_chunkSize;
+            chunk.count = qMin( m_chunkSize, m_numFibers - chunk.first );
+            chunk.offset = out.pos();
+            chunk.size = m_encoded[i].size();
+            m_chunks.push_back( chunk );
+            out.writeRaw( m_encoded[i].constData(), m_encoded[i].size() );
+        }
+    }
+    m_in = 0;
+    std::vector<QByteArray>().swap( m_encoded );
+
+    // the index goes last, its offset closes the file
+    qint64 indexOffset = out.pos();
+    out.writeInt32( m_chunks.size() );
+    for ( unsigned int i = 0; i < m_chunks.size(); ++i )
+    {
+        out.writeInt32( m_chunks[i].first );
+        out.writeInt32( m_chunks[i].count );
+        out.writeInt64( m_chunks[i].offset );
+        out.writeInt32( m_chunks[i].size );
+    }
+    out.writeInt64( indexOffset );
+
+    bool ok = out.flush();
+    file.close();
+    if ( !ok )
+    {
+        qCritical() << "Error writing " << fileName;
+    }
+    m_chunks.clear();
+    return ok;
+}
+
+void FiberContainer::encodeRange( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        unsigned int first = ( m_batchBegin + i ) * m_chunkSize;
+        m_encoded[i] = encodeChunk( first, qMin( m_chunkSize, m_numFibers - first ) );
+    }
+}
+
+QByteArray FiberContainer::encodeChunk( unsigned int first, unsigned int count )
+{
+    std::vector<uchar> buf;
+    unsigned int numVerts = 0;
+    for ( unsigned int i = first; i < first + count; ++i )
+    {
+        numVerts += m_in->at( i ).length();
+    }
+    buf.reserve( count * 16 + numVerts * ( 4 + 4 * m_fields.size() ) );
+
+    for ( unsigned int i = first; i < first + count; ++i )
+    {
+        const Fib& fib = m_in->at( i );
+        putVarint( buf, fib.length() );
+        QColor color = fib.customColor();
+        putByte( buf, color.red() );
+        putByte( buf, color.green() );
+        putByte( buf, color.blue() );
+    }
+
+    // start vertex on the grid, then the grid steps to the next vertex
+    double scale = 1.0 / m_step;
+    for ( unsigned int i = first; i < first + count; ++i )
+    {
+        const std::vector<QVector3D>* verts = m_in->at( i ).getVerts();
+        qint32 last[3] = { 0, 0, 0 };
+        for ( unsigned int k = 0; k < verts->size(); ++k )
+        {
+            const QVector3D& v = verts->at( k );
+            qint32 q[3] = { static_cast<qint32>( floor( v.x() * scale + 0.5 ) ),
+                            static_cast<qint32>( floor( v.y() * scale + 0.5 ) ),
+                            static_cast<qint32>( floor( v.z() * scale + 0.5 ) ) };
+            for ( int c = 0; c < 3; ++c )
+            {
+                if ( k == 0 )
+                {
+                    putInt32( buf, q[c] );
+                }
+                else
+                {
+                    putVarint( buf, zigzag( q[c] - last[c] ) );
+                }
+                last[c] = q[c];
+            }
+        }
+    }
+
+    for ( unsigned int f = 0; f < m_fields.size(); ++f )
+    {
+        const Field& field = m_fields[f];
+        float range = field.max - field.min;
+        for ( unsigned int i = first; i < first + count; ++i )
+        {
+            const Fib& fib = m_in->at( i );
+            const std::vector<float>* values = fib.getDataField( f );
+            for ( unsigned int k = 0; k < fib.length(); ++k )
+            {
+                float value = ( values && k < values->size() ) ? values->at( k ) : 0.0f;
+                switch ( field.quantisation )
+                {
+                    case HALF:
+                    {
+                        quint16 half = FrameConverter::floatToHalf( range > 0 ? ( value - field.min ) / range : 0.0f );
+                        buf.push_back( half >> 8 );
+                        buf.push_back( half & 0xff );
+                        break;
+                    }
+                    case BYTE:
+                    {
+                        float t = range > 0 ? ( value - field.min ) / range : 0.0f;
+                        putByte( buf, static_cast<uchar>( qBound( 0.0f, t, 1.0f ) * 255.0f + 0.5f ) );
+                        break;
+                    }
+                    default:
+                        putFloat( buf, value );
+                        break;
+                }
+            }
+        }
+    }
+
+    // the deltas are small already, higher levels cost a multiple of the time for a few percent
+    return qCompress( buf.data(), buf.size(), 1 );
+}
+
+bool FiberContainer::open( QString fileName )
+{
+    close();
+    m_file.setFileName( fileName );
+    if ( !m_file.open( QIODevice::ReadOnly ) )
+    {
+        qCritical() << "Error opening " << fileName;
+        return false;
+    }
+    qint64 fileSize = m_file.size();
+
+    QByteArray header = m_file.read( qMin( fileSize, (qint64)65536 ) );
+    Reader in( reinterpret_cast<const uchar*>( header.constData() ), header.size() );
+    const uchar* magic = in.raw( 8 );
+    if ( !magic || memcmp( magic, MAGIC, 8 ) != 0 || in.int32() != VERSION )
+    {
+        qCritical() << fileName << "is no fiber container";
+        close();
+        return false;
+    }
+    m_numFibers = in.int32();
+    m_step = in.float32();
+    int numFields = in.int32();
+    for ( int f = 0; f < numFields && in.ok(); ++f )
+    {
+        Field field;
+        int length = in.int32();
+        const uchar* name = in.raw( length );
+        field.name = name ? QString::fromUtf8( reinterpret_cast<const char*>( name ), length ) : QString();
+        field.quantisation = in.int32();
+        field.min = in.float32();
+        field.max = in.float32();
+        field.error = in.float32();
+        m_fields.push_back( field );
+    }
+
+    QByteArray tail;
+    if ( fileSize >= 8 && m_file.seek( fileSize - 8 ) )
+    {
+        tail = m_file.read( 8 );
+    }
+    Reader tailIn( reinterpret_cast<const uchar*>( tail.constData() ), tail.size() );
+    qint64 indexOffset = tailIn.int64();
+    if ( !in.ok() || !tailIn.ok() || indexOffset < 0 || indexOffset > fileSize - 12 || !m_file.seek( indexOffset ) )
+    {
+        qCritical() << fileName << "is truncated";
+        close();
+        return false;
+    }
+
+    QByteArray index = m_file.read( fileSize - 8 - indexOffset );
+    Reader indexIn( reinterpret_cast<const uchar*>( index.constData() ), index.size() );
+    int numChunks = indexIn.int32();
+    unsigned int next = 0;
+    bool valid = true;
+    for ( int i = 0; i < numChunks && indexIn.ok() && valid; ++i )
+    {
+        Chunk chunk;
+        chunk.first = indexIn.int32();
+        chunk.count = indexIn.int32();
+        chunk.offset = indexIn.int64();
+        chunk.size = indexIn.int32();
+
+        // chunks follow each other without gaps and lie before the index
+        valid = chunk.first == next && chunk.count > 0 && chunk.offset >= 0 && chunk.offset + chunk.size <= indexOffset;
+        next += chunk.count;
+        m_chunks.push_back( chunk );
+    }
+    if ( !indexIn.ok() || !valid || next != m_numFibers )
+    {
+        qCritical() << fileName << "has a broken chunk index";
+        close();
+        return false;
+    }
+    return true;
+}
+
+void FiberContainer::close()
+{
+    if ( m_file.isOpen() )
+    {
+        m_file.close();
+    }
+    m_fields.clear();
+    m_chunks.clear();
+    m_numFibers = 0;
+}
+
+bool FiberContainer::load( std::vector<Fib>& fibs )
+{
+    fibs.clear();
+    if ( !m_file.isOpen() )
+    {
+        return false;
+    }
+
+    // the whole file is mapped, every thread decompresses its chunks straight from the mapping
+    QByteArray all;
+    uchar* mapped = m_file.map( 0, m_file.size() );
+    if ( mapped )
+    {
+        m_data = reinterpret_cast<const char*>( mapped );
+    }
+    else
+    {
+        m_file.seek( 0 );
+        all = m_file.readAll();
+        m_data = all.constData();
+    }
+
+    fibs.resize( m_numFibers );
+    m_out = &fibs;
+    m_decoded.assign( m_chunks.size(), 0 );
+    if ( m_chunks.size() == 1 )
+    {
+        decodeRange( 0, 1 );
+    }
+    else
+    {
+        runPass( FiberContainerThread::DECODE, m_chunks.size() );
+    }
+    m_out = 0;
+    m_data = 0;
+    if ( mapped )
+    {
+        m_file.unmap( mapped );
+    }
+
+    bool ok = std::find( m_decoded.begin(), m_decoded.end(), 0 ) == m_decoded.end();
+    std::vector<char>().swap( m_decoded );
+    if ( !ok )
+    {
+        qCritical() << m_file.fileName() << "has broken chunks";
+        fibs.clear();
+    }
+    return ok;
+}
+
+void FiberContainer::decodeRange( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        const Chunk& chunk = m_chunks[i];
+        QByteArray compressed = QByteArray::fromRawData( m_data + chunk.offset, chunk.size );
+        m_decoded[i] = decodeChunk( compressed, chunk.count, &m_out->at( chunk.first ) );
+    }
+}
+
+Fib FiberContainer::fiber( unsigned int id )
+{
+    if ( !m_file.isOpen() || id >= m_numFibers )
+    {
+        return Fib();
+    }
+
+    unsigned int c = 0;
+    unsigned int lo = 0;
+    unsigned int hi = m_chunks.size();
+    while ( lo < hi )
+    {
+        unsigned int mid = ( lo + hi ) / 2;
+        if ( m_chunks[mid].first <= id )
+        {
+            c = mid;
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    const Chunk& chunk = m_chunks[c];
+    if ( !m_file.seek( chunk.offset ) )
+    {
+        return Fib();
+    }
+    QByteArray compressed = m_file.read( chunk.size );
+    std::vector<Fib> fibs( chunk.count );
+    if ( !decodeChunk( compressed, chunk.count, &fibs[0] ) )
+    {
+        return Fib();
+    }
+    return fibs[id - chunk.first];
+}
+
+bool FiberContainer::decodeChunk( const QByteArray& compressed, unsigned int count, Fib* out )
+{
+    QByteArray raw = qUncompress( compressed );
+    Reader in( reinterpret_cast<const uchar*>( raw.constData() ), raw.size() );
+
+    std::vector<unsigned int> lengths( count );
+    std::vector<QColor> colors( count );
+    for ( unsigned int i = 0; i < count; ++i )
+    {
+        lengths[i] = in.varint();
+        int r = in.byte();
+        int g = in.byte();
+        int b = in.byte();
+        colors[i] = QColor( r, g, b );
+    }
+    if ( !in.ok() )
+    {
+        return false;
+    }
+
+    std::vector< std::vector<QVector3D> > verts( count );
+    for ( unsigned int i = 0; i < count && in.ok(); ++i )
+    {
+        verts[i].resize( lengths[i] );
+        qint32 q[3] = { 0, 0, 0 };
+        for ( unsigned int k = 0; k < lengths[i] && in.ok(); ++k )
+        {
+            for ( int c = 0; c < 3; ++c )
+            {
+                q[c] = ( k == 0 ) ? in.int32() : q[c] + unzigzag( in.varint() );
+            }
+            verts[i][k] = QVector3D( q[0] * static_cast<double>( m_step ), q[1] * static_cast<double>( m_step ), q[2] * static_cast<double>( m_step ) );
+        }
+    }
+
+    for ( unsigned int i = 0; i < count; ++i )
+    {
+        out[i] = Fib( verts[i] );
+        out[i].setCustomColor( colors[i] );
+    }
+
+    for ( unsigned int f = 0; f < m_fields.size() && in.ok(); ++f )
+    {
+        const Field& field = m_fields[f];
+        float range = field.max - field.min;
+        for ( unsigned int i = 0; i < count && in.ok(); ++i )
+        {
+            std::vector<float> v( lengths[i] );
+            for ( unsigned int k = 0; k < lengths[i]; ++k )
+            {
+                switch ( field.quantisation )
+                {
+                    case HALF:
+                    {
+                        const uchar* p = in.raw( 2 );
+                        v[k] = field.min + ( p ? FrameConverter::halfToFloat( ( p[0] << 8 ) | p[1] ) : 0.0f ) * range;
+                        break;
+                    }
+                    case BYTE:
+                        v[k] = field.min + in.byte() / 255.0f * range;
+                        break;
+                    default:
+                        v[k] = in.float32();
+                        break;
+                }
+            }
+            if ( f == 0 )
+            {
+                out[i].setDataField( 0, v );
+            }
+            else
+            {
+                out[i].addDataField( v );
+            }
+        }
+    }
+    return in.ok();
+}
@@ -0,0 +1,117 @@
+/*
+ * fibercontainer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FIBERCONTAINER_H_
+#define FIBERCONTAINER_H_
+
+#include "../algos/fib.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include <vector>
+
+class FiberContainerThread;
+
+/*
+ * Compact file format for fibers. Coordinates are snapped to a grid of step mm, each fiber stores its
+ * start on the grid and the steps between consecutive vertices as variable length integers. Data fields
+ * are stored as floats, or as half floats or bytes of their position between the field's min and max,
+ * the resulting error bound is kept in the header. Fibers are grouped into chunks that are compressed independently and listed in
+ * an index at the end of the file, so chunks are encoded and decoded on all threads and single fibers
+ * can be read without touching the rest of the file. All numbers are big endian.
+ */
+class FiberContainer
+{
+    friend class FiberContainerThread;
+
+public:
+    enum Quantisation
+    {
+        FLOAT,
+        HALF,
+        BYTE
+    };
+
+    FiberContainer();
+    virtual ~FiberContainer();
+
+    // coordinates are off by at most half a step in every direction, plus the float rounding
+    void setStep( float step );
+    void setQuantisation( Quantisation quantisation );
+    void setChunkSize( unsigned int fibers );
+
+    // names without "no data" are stored as data fields
+    bool save( QString fileName, const std::vector<Fib>& fibs, const QList<QString>& dataNames );
+
+    // reads header and index, the chunks are decoded on demand
+    bool open( QString fileName );
+    void close();
+
+    unsigned int numFibers();
+    QList<QString> dataNames();
+    std::vector<float> dataMins();
+    std::vector<float> dataMaxes();
+
+    // maximal absolute error of the coordinates and of a data field
+    float coordinateError();
+    float dataError( int field );
+
+    // all fibers, the chunks are decoded in parallel
+    bool load( std::vector<Fib>& fibs );
+
+    // a single fiber, only its chunk is read
+    Fib fiber( unsigned int id );
+
+private:
+    struct Field
+    {
+        QString name;
+        int quantisation;
+        float min;
+        float max;
+        float error;
+    };
+
+    struct Chunk
+    {
+        unsigned int first;
+        unsigned int count;
+        qint64 offset;
+        unsigned int size;
+    };
+
+    void runPass( int pass, unsigned int size );
+
+    void encodeRange( unsigned int begin, unsigned int end );
+    void decodeRange( unsigned int begin, unsigned int end );
+
+    QByteArray encodeChunk( unsigned int first, unsigned int count );
+    bool decodeChunk( const QByteArray& compressed, unsigned int count, Fib* out );
+
+    float m_step;
+    Quantisation m_quantisation;
+    unsigned int m_chunkSize;
+
+    std::vector<Field> m_fields;
+    std::vector<Chunk> m_chunks;
+    unsigned int m_numFibers;
+
+    QFile m_file;
+
+    // work of the current pass, the threads take chunks from m_batchBegin on
+    const std::vector<Fib>* m_in;
+    std::vector<Fib>* m_out;
+    std::vector<QByteArray> m_encoded;
+    const char* m_data;
+    unsigned int m_batchBegin;
+    std::vector<char> m_decoded;
+};
+
+#endif /* FIBERCONTAINER_H_ */
@@ -0,0 +1,43 @@
+/*
+ * fibercontainerthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "fibercontainerthread.h"
+#include "fibercontainer.h"
+
+#include "../algos/trace.h"
+
+FiberContainerThread::FiberContainerThread( FiberContainer* container, int pass, unsigned int size, int id, int numThreads ) :
+    m_container( container ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id ),
+    m_numThreads( numThreads )
+{
+}
+
+FiberContainerThread::~FiberContainerThread()
+{
+}
+
+void FiberContainerThread::run()
+{
+    TRACE_SCOPE( "FiberContainerThread::run" );
+
+    // the shares differ by one chunk at most
+    unsigned int begin = static_cast<quint64>( m_size ) * m_id / m_numThreads;
+    unsigned int end = static_cast<quint64>( m_size ) * ( m_id + 1 ) / m_numThreads;
+
+    switch ( m_pass )
+    {
+        case ENCODE:
+            m_container->encodeRange( begin, end );
+            break;
+        case DECODE:
+            m_container->decodeRange( begin, end );
+            break;
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * fibercontainerthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FIBERCONTAINERTHREAD_H_
+#define FIBERCONTAINERTHREAD_H_
+
+#include <QThread>
+
+class FiberContainer;
+
+class FiberContainerThread : public QThread
+{
+public:
+    enum Pass
+    {
+        ENCODE,
+        DECODE
+    };
+
+    // thread id of numThreads takes its share of the chunks 0 to size
+    FiberContainerThread( FiberContainer* container, int pass, unsigned int size, int id, int numThreads );
+    virtual ~FiberContainerThread();
+
+private:
+    void run();
+
+    FiberContainer* m_container;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+    int m_numThreads;
+};
+
+#endif /* FIBERCONTAINERTHREAD_H_ */
@@ -0,0 +1,145 @@
+/*
+ * framewriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "framewriter.h"
+#include "framewriterthread.h"
+
+#include "../algos/trace.h"
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+#include <QImage>
+#include <QMutexLocker>
+
+#include <cstring>
+
+FrameWriter::FrameWriter( int maxQueued ) :
+    m_maxQueued( maxQueued > 0 ? maxQueued : 2 * GLFunctions::idealThreadCount ),
+    m_busy( 0 ),
+    m_failed( 0 ),
+    m_stop( false )
+{
+    for ( int i = 0; i < GLFunctions::idealThreadCount; ++i )
+    {
+        m_threads.push_back( new FrameWriterThread( this ) );
+        m_threads.back()->start();
+    }
+}
+
+FrameWriter::~FrameWriter()
+{
+    finish();
+
+    m_mutex.lock();
+    m_stop = true;
+    m_wake.wakeAll();
+    m_mutex.unlock();
+
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->wait();
+        delete m_threads[i];
+    }
+}
+
+void FrameWriter::push( QString fileName, int width, int height, std::vector<unsigned char>& pixels )
+{
+    QMutexLocker locker( &m_mutex );
+    while ( m_queue.size() >= m_maxQueued )
+    {
+        m_done.wait( &m_mutex );
+    }
+
+    m_queue.push_back( Frame() );
+    Frame& frame = m_queue.back();
+    frame.fileName = fileName;
+    frame.width = width;
+    frame.height = height;
+    frame.pixels.swap( pixels );
+
+    if ( !m_spare.empty() )
+    {
+        pixels.swap( m_spare.back() );
+        m_spare.pop_back();
+    }
+    m_wake.wakeOne();
+}
+
+bool FrameWriter::finish()
+{
+    QMutexLocker locker( &m_mutex );
+    while ( !m_queue.empty() || m_busy > 0 )
+    {
+        m_done.wait( &m_mutex );
+    }
+    bool ok = ( m_failed == 0 );
+    m_failed = 0;
+    return ok;
+}
+
+void FrameWriter::work()
+{
+    m_mutex.lock();
+    while ( true )
+    {
+        while ( m_queue.empty() && !m_stop )
+        {
+            m_wake.wait( &m_mutex );
+        }
+        if ( m_queue.empty() )
+        {
+            break;
+        }
+
+        Frame frame;
+        frame.fileName = m_queue.front().fileName;
+        frame.width = m_queue.front().width;
+        frame.height = m_queue.front().height;
+        frame.pixels.swap( m_queue.front().pixels );
+        m_queue.pop_front();
+        ++m_busy;
+        m_done.wakeAll();
+        m_mutex.unlock();
+
+        bool ok = write( frame );
+
+        m_mutex.lock();
+        if ( !ok )
+        {
+            ++m_failed;
+        }
+        m_spare.push_back( std::vector<unsigned char>() );
+        m_spare.back().swap( frame.pixels );
+        --m_busy;
+        m_done.wakeAll();
+    }
+    m_mutex.unlock();
+}
+
+bool FrameWriter::write( Frame& frame )
+{
+    TRACE_SCOPE( "FrameWriter::write" );
+
+    if ( frame.pixels.size() < static_cast<size_t>( frame.width ) * frame.height * 4 )
+    {
+        return false;
+    }
+
+    // BGRA bytes are the memory layout of RGB32 on little endian machines, only the rows need flipping
+    QImage image( frame.width, frame.height, QImage::Format_RGB32 );
+    for ( int y = 0; y < frame.height; ++y )
+    {
+        memcpy( image.scanLine( frame.height - 1 - y ), &frame.pixels[static_cast<size_t>( y ) * frame.width * 4], frame.width * 4 );
+    }
+
+    if ( !image.save( frame.fileName, "PNG" ) )
+    {
+        qCritical() << "error while saving frame to" << frame.fileName;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * framewriter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FRAMEWRITER_H_
+#define FRAMEWRITER_H_
+
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <deque>
+#include <vector>
+
+class FrameWriterThread;
+
+/*
+ * Encodes and saves rendered frames on a pool of worker threads while the next frames are rendered.
+ * Frames come as bottom up BGRA rows like glReadPixels delivers them. Pixel buffers are swapped, not
+ * copied, push hands a spare buffer back to the caller. The queue is bounded, push waits for a free
+ * place so a fast renderer can't pile up gigabytes of 4K frames.
+ */
+class FrameWriter
+{
+    friend class FrameWriterThread;
+
+public:
+    FrameWriter( int maxQueued = 0 );
+    virtual ~FrameWriter();
+
+    void push( QString fileName, int width, int height, std::vector<unsigned char>& pixels );
+
+    // waits until all frames are written, returns false if any of them failed
+    bool finish();
+
+private:
+    struct Frame
+    {
+        QString fileName;
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+    };
+
+    void work();
+    bool write( Frame& frame );
+
+    std::deque<Frame> m_queue;
+    std::vector<std::vector<unsigned char> > m_spare;
+    unsigned int m_maxQueued;
+    int m_busy;
+    int m_failed;
+    bool m_stop;
+
+    QMutex m_mutex;
+    QWaitCondition m_wake; // a frame was queued
+    QWaitCondition m_done; // a frame was taken or written
+
+    std::vector<FrameWriterThread*> m_threads;
+};
+
+#endif /* FRAMEWRITER_H_ */
@@ -0,0 +1,27 @@
+/*
+ * framewriterthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "framewriterthread.h"
+#include "framewriter.h"
+
+#include "../algos/trace.h"
+
+FrameWriterThread::FrameWriterThread( FrameWriter* writer ) :
+    m_writer( writer )
+{
+}
+
+FrameWriterThread::~FrameWriterThread()
+{
+}
+
+void FrameWriterThread::run()
+{
+    TRACE_SCOPE( "FrameWriterThread::run" );
+
+    m_writer->work();
+}
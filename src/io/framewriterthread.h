@@ -0,0 +1,27 @@
+/*
+ * framewriterthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef FRAMEWRITERTHREAD_H_
+#define FRAMEWRITERTHREAD_H_
+
+#include <QThread>
+
+class FrameWriter;
+
+class FrameWriterThread : public QThread
+{
+public:
+    FrameWriterThread( FrameWriter* writer );
+    virtual ~FrameWriterThread();
+
+private:
+    void run();
+
+    FrameWriter* m_writer;
+};
+
+#endif /* FRAMEWRITERTHREAD_H_ */
@@ -5,10 +5,14 @@
  * @author Ralph Schurade
  */
 #include "loader.h"
+#include "fibercontainer.h"
 #include "loaderfreesurfer.h"
 #include "loadernifti.h"
 #include "loadertree.h"
 #include "loadervtk.h"
+#include "mrtrixtracks.h"
+#include "textparser.h"
+#include "timeseriescache.h"
 
 #include "../data/datasets/dataset3d.h"
 #include "../data/datasets/datasetcons.h"
@@ -28,7 +32,6 @@
 #include "../gui/widgets/controls/checkbox.h"
 
 #include <QDebug>
-#include <QDataStream>
 #include <QVector3D>
 #include <QtGui>
 #include <QImage>
@@ -88,6 +91,11 @@ bool Loader::load()
         return loadMRtrix();
     }
 
+    if ( m_fileName.path().endsWith( ".bgf" ) )
+    {
+        return loadFiberContainer();
+    }
+
     if ( m_fileName.path().endsWith( ".vtk" ) )
     {
         return loadVTK();
@@ -306,33 +314,26 @@ bool Loader::loadSet()
 
     qDebug() << "loading surface set: " << fn;
 
-    QFile setfile( fn );
-    if ( !setfile.open( QIODevice::ReadOnly ) )
+    TextParser setfile( fn );
+    if ( !setfile.open() )
     {
         qCritical( "set file unreadable" );
     }
-    QTextStream ts( &setfile );
-    QString nl;
     //TODO: Will windows have a problem with this?
     QString trunk = QFileInfo( fn ).path();
-    while ( !ts.atEnd() )
+    for ( int line = 0; line < setfile.numLines(); ++line )
     {
-        nl = ts.readLine();
+        QString name;
+        float offset[3] = { 0, 0, 0 };
+        if ( !setfile.entry( line, name, offset, 3 ) )
+        {
+            return false;
+        }
         //For commenting out stuff in the setfiles
-        if ( !nl.startsWith( "#" ) )
+        if ( !name.isEmpty() && !name.startsWith( "#" ) )
         {
-            QStringList sl = nl.split( " " );
-            QString fullname = trunk + QDir::separator() + sl.at( 0 );
-            float x = 0;
-            float y = 0;
-            float z = 0;
-            if ( sl.length() > 1 )
-                x = sl.at( 1 ).toFloat();
-            if ( sl.length() > 2 )
-                y = sl.at( 2 ).toFloat();
-            if ( sl.length() > 3 )
-                z = sl.at( 3 ).toFloat();
-            QVector3D s( x, y, z );
+            QString fullname = trunk + QDir::separator() + name;
+            QVector3D s( offset[0], offset[1], offset[2] );
 
             LoaderFreesurfer lf;
 
@@ -359,7 +360,7 @@ bool Loader::loadSet()
             }
             mesh->finalize();
 
-            dataset->addMesh( mesh, sl.at( 0 ) );
+            dataset->addMesh( mesh, name );
         }
     }
     qDebug() << "surfaces read...";
@@ -374,54 +375,58 @@ bool Loader::loadSet()
 bool Loader::loadGlyphset()
 {
     QString glyphsetname = m_fileName.path();
-    QFile glyphsetfile( glyphsetname );
-    if ( !glyphsetfile.open( QIODevice::ReadOnly ) )
+    TextParser glyphsetfile( glyphsetname );
+    if ( !glyphsetfile.open() )
     {
         qCritical( "glyphset file unreadable" );
     }
-    QTextStream gts( &glyphsetfile );
     //TODO: Will windows have a problem with this?
     QString trunk = QFileInfo( glyphsetname ).path();
 
     //glyphsetfile has three lines: 1: nifti (skip), 2: surfaceset(s), 3: connectivity matrix
 
     //1: TODO: skip nifti for now
-    QString gnl = gts.readLine();
-    qDebug() << "skipping: " << gnl;
+    qDebug() << "skipping: " << glyphsetfile.line( 0 );
 
     //2: load surfaceset
-    gnl = gts.readLine();
-    QStringList datasetNames = gnl.split( " " );
+    QStringList datasetNames = glyphsetfile.tokens( 1 );
+    if ( datasetNames.empty() )
+    {
+        qCritical() << glyphsetname << "has no surface set";
+        return false;
+    }
     bool two = ( datasetNames.length() > 1 );
     QString datasetName = datasetNames.at( 0 );
 
-    gnl = gts.readLine();
-    QStringList sl2 = gnl.split( " " );
+    // connectivity, minimum and maximum threshold, up to two roi files
+    QString connection;
+    float thresholds[2] = { 0.8f, 1.0f };
+    if ( !glyphsetfile.entry( 2, connection, thresholds, 2 ) || connection.isEmpty() )
+    {
+        qCritical() << glyphsetname << "has no valid connectivity line";
+        return false;
+    }
+    QStringList sl2 = glyphsetfile.tokens( 2 );
 
     QString connectivityName;
-    if ( sl2.at( 0 ).startsWith( "http" ) )
+    if ( connection.startsWith( "http" ) )
     {
-        connectivityName = sl2.at( 0 );
+        connectivityName = connection;
     }
     else
     {
-        connectivityName = trunk + QDir::separator() + sl2.at( 0 );
+        connectivityName = trunk + QDir::separator() + connection;
     }
-    float mt = 0.8;
+    float mt = thresholds[0];
     if ( sl2.length() > 1 )
     {
-        mt = sl2.at( 1 ).toFloat();
         qDebug() << "minimum threshold: " << mt;
     }
     else
     {
         qDebug() << "no minimum threshold in glyphset file, default of " << mt << " used.";
     }
-    float maxt = 1.0;
-    if ( sl2.length() > 2 )
-    {
-        maxt = sl2.at( 2 ).toFloat();
-    }
+    float maxt = thresholds[1];
 
     DatasetGlyphset* dataset = new DatasetGlyphset( glyphsetname, mt, maxt );
 
@@ -435,51 +440,48 @@ bool Loader::loadGlyphset()
         }
     }
 
-    QFile setfile( trunk + QDir::separator() + datasetName );
-    if ( !setfile.open( QIODevice::ReadOnly ) )
+    TextParser setfile( trunk + QDir::separator() + datasetName );
+    if ( !setfile.open() )
     {
         qCritical( "set file unreadable" );
     }
-    QTextStream ts( &setfile );
-    QString nl;
 
-    QString onl;
-    QTextStream* ots;
-    std::vector<QString> others;
-    if ( two )
+    // the lines of the second set file pair up with those of the first
+    TextParser othersetfile( two ? trunk + QDir::separator() + datasetNames.at( 1 ) : QString() );
+    if ( two && !othersetfile.open() )
     {
-        QFile othersetfile( trunk + QDir::separator() + datasetNames.at( 1 ) );
-        if ( !othersetfile.open( QIODevice::ReadOnly ) )
-        {
-            qCritical( "second set file unreadable" );
-        }
-        ots = new QTextStream( &othersetfile );
-        qDebug() << "ots initialized";
-        while ( !ots->atEnd() )
-        {
-            onl = ots->readLine();
-            others.push_back( onl );
-        }
-
+        qCritical( "second set file unreadable" );
     }
 
-    int k = 0;
-    while ( !ts.atEnd() )
+    for ( int line = 0; line < setfile.numLines(); ++line )
     {
-        nl = ts.readLine();
-        qDebug() << "!" << nl;
+        QString name;
+        float offset[3] = { 0, 0, 0 };
+        if ( !setfile.entry( line, name, offset, 3 ) )
+        {
+            return false;
+        }
+        qDebug() << "!" << name;
+        QString oname;
+        float ooffset[3] = { 0, 0, 0 };
         if ( two )
         {
-            onl = others.at( k );
-            qDebug() << onl;
-            k++;
+            if ( line >= othersetfile.numLines() )
+            {
+                qCritical() << "second set file has less lines than" << datasetName;
+                return false;
+            }
+            if ( !othersetfile.entry( line, oname, ooffset, 3 ) )
+            {
+                return false;
+            }
+            qDebug() << oname;
         }
 
         //For commenting out stuff in the setfiles
-        if ( !nl.startsWith( "#" ) )
+        if ( !name.isEmpty() && !name.startsWith( "#" ) )
         {
-            QStringList sl = nl.split( " " );
-            QString fullname = trunk + QDir::separator() + sl.at( 0 );
+            QString fullname = trunk + QDir::separator() + name;
 
             LoaderFreesurfer lf;
 
@@ -489,16 +491,7 @@ bool Loader::loadGlyphset()
                 return false;
             }
 
-            float x = 0;
-            float y = 0;
-            float z = 0;
-            if ( sl.length() > 1 )
-                x = sl.at( 1 ).toFloat();
-            if ( sl.length() > 2 )
-                y = sl.at( 2 ).toFloat();
-            if ( sl.length() > 3 )
-                z = sl.at( 3 ).toFloat();
-            QVector3D s( x, y, z );
+            QVector3D s( offset[0], offset[1], offset[2] );
             std::vector<float>* points = lf.getPoints();
             std::vector<int> triangles = lf.getTriangles();
             int numPoints = points->size() / 3;
@@ -512,27 +505,14 @@ bool Loader::loadGlyphset()
             LoaderFreesurfer olf;
             if ( two )
             {
-                QStringList osl;
-                osl = onl.split( " " );
-                QString ofullname = trunk + QDir::separator() + osl.at( 0 );
+                QString ofullname = trunk + QDir::separator() + oname;
 
                 if ( !olf.loadASC( ofullname ) )
                 {
                     qCritical() << "unable to load: " << ofullname;
                     return false;
                 }
-                float ox = 0;
-                float oy = 0;
-                float oz = 0;
-
-                if ( osl.length() > 1 )
-                    ox = osl.at( 1 ).toFloat();
-                if ( osl.length() > 2 )
-                    oy = osl.at( 2 ).toFloat();
-                if ( osl.length() > 3 )
-                    oz = osl.at( 3 ).toFloat();
-
-                os = new QVector3D( ox, oy, oz );
+                os = new QVector3D( ooffset[0], ooffset[1], ooffset[2] );
                 opoints = olf.getPoints();
                 otriangles = olf.getTriangles();
                 onumPoints = opoints->size() / 3;
@@ -571,7 +551,7 @@ bool Loader::loadGlyphset()
 
             mesh->finalize();
 
-            dataset->addMesh( mesh, sl.at( 0 ) );
+            dataset->addMesh( mesh, name );
         }
     }
 
@@ -622,24 +602,28 @@ bool Loader::loadMEG()
 
     qDebug() << "loading meg set: " << fn;
 
-    QFile setfile( fn );
-    if ( !setfile.open( QIODevice::ReadOnly ) )
+    TextParser setfile( fn );
+    if ( !setfile.open() )
     {
         qCritical( "set file unreadable" );
     }
-    QTextStream ts( &setfile );
-    QString nl;
     //TODO: Will windows have a problem with this?
     QString trunk = QFileInfo( fn ).path();
-    while ( !ts.atEnd() )
+    std::vector<QString> frameFiles;
+    for ( int line = 0; line < setfile.numLines(); ++line )
     {
-        nl = ts.readLine();
+        QString name;
+        float offset[3] = { 0, 0, 0 };
+        if ( !setfile.entry( line, name, offset, 3 ) )
+        {
+            return false;
+        }
         //For commenting out stuff in the setfiles
-        if ( nl.startsWith( "#meg") )
+        if ( name == "#meg" )
         {
-            QStringList sl = nl.split( " " );
-            bool ok;
-            int count = sl[1].toInt( &ok );
+            QStringList sl = setfile.tokens( line );
+            bool ok = sl.size() > 1;
+            int count = ok ? sl[1].toInt( &ok ) : 0;
             if ( ok )
             {
                 qDebug() << count << "meg data files in set definition";
@@ -651,36 +635,7 @@ bool Loader::loadMEG()
                     {
                         numberString = "0" + numberString;
                     }
-                    QFile dataFile( trunk + QDir::separator() + numberString + ".txt" );
-                    if ( !dataFile.open( QIODevice::ReadOnly ) )
-                    {
-                        qCritical() << "data file unreadable, skipping"  << numberString + ".txt";
-                        continue;
-                    }
-                    std::vector<float>data;
-                    QTextStream ds( &dataFile );
-                    while( !ds.atEnd() )
-                    {
-                        nl = ds.readLine();
-                        float val = nl.toFloat( &ok );
-                        if ( ok )
-                        {
-                            data.push_back( val );
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-                    if ( !ok )
-                    {
-                        qCritical() << "error while reading data file, skipping" << numberString + ".txt";
-                        continue;
-                    }
-                    else
-                    {
-                        dataset->addData( data );
-                    }
+                    frameFiles.push_back( trunk + QDir::separator() + numberString + ".txt" );
                 }
             }
             else
@@ -688,20 +643,10 @@ bool Loader::loadMEG()
                 qCritical() << "can't read count meg data files";
             }
         }
-        else if ( !nl.startsWith( "#" ) )
+        else if ( !name.isEmpty() && !name.startsWith( "#" ) )
         {
-            QStringList sl = nl.split( " " );
-            QString fullname = trunk + QDir::separator() + sl.at( 0 );
-            float x = 0;
-            float y = 0;
-            float z = 0;
-            if ( sl.length() > 1 )
-                x = sl.at( 1 ).toFloat();
-            if ( sl.length() > 2 )
-                y = sl.at( 2 ).toFloat();
-            if ( sl.length() > 3 )
-                z = sl.at( 3 ).toFloat();
-            QVector3D s( x, y, z );
+            QString fullname = trunk + QDir::separator() + name;
+            QVector3D s( offset[0], offset[1], offset[2] );
 
             TriangleMesh2* mesh;
             std::vector<float>* points;
@@ -737,7 +682,7 @@ bool Loader::loadMEG()
                     }
                     mesh->finalize();
 
-                    dataset->addMesh( mesh, sl.at( 0 ) );
+                    dataset->addMesh( mesh, name );
                 }
             }
 
@@ -780,12 +725,27 @@ bool Loader::loadMEG()
 
                         mesh->finalize();
 
-                        dataset->addMesh( mesh, sl.at( 0 ) );
+                        dataset->addMesh( mesh, name );
                     }
                 }
             }
         }
     }
+    // frames are loaded after all meshes so their size can be checked against the first one
+    if ( !frameFiles.empty() && dataset->getMesh() )
+    {
+        TimeSeriesCache* cache = new TimeSeriesCache( fn, frameFiles, dataset->getMesh()->numVerts() );
+        if ( cache->load() )
+        {
+            dataset->setData( cache );
+        }
+        else
+        {
+            qCritical() << "no valid meg data files found";
+            delete cache;
+        }
+    }
+
     dataset->setProperties();
     m_dataset.push_back( dataset );
 
@@ -806,21 +766,27 @@ bool Loader::loadTree()
 
 bool Loader::loadRGB()
 {
-    QFile file( m_fileName.path() );
-    if ( !file.open( QIODevice::ReadOnly ) )
+    TextParser file( m_fileName.path() );
+    if ( !file.open() )
+    {
+        return false;
+    }
+    std::vector<float> values;
+    if ( !file.numbers( 0, file.numLines(), values ) )
     {
         return false;
     }
-    QTextStream in( &file );
 
     if ( dynamic_cast<DatasetMesh*>( m_selectedDataset ) )
     {
         DatasetMesh* sds = dynamic_cast<DatasetMesh*>( m_selectedDataset );
 
-        for ( unsigned int i = 0; i < sds->getMesh()->numVerts(); i++ )
+        unsigned int numVerts = qMin( (unsigned int)values.size() / 3, sds->getMesh()->numVerts() );
+        for ( unsigned int i = 0; i < numVerts; i++ )
         {
-            float r, g, b;
-            in >> r >> g >> b;
+            float r = values[i * 3];
+            float g = values[i * 3 + 1];
+            float b = values[i * 3 + 2];
             for ( int i2 = 0; i2 < sds->getNumberOfMeshes(); i2++ )
             {
                 sds->getMesh( i2 )->setVertexColor( i, r, g, b, 1.0 );
@@ -839,21 +805,25 @@ bool Loader::loadRGB()
 
 bool Loader::load1D()
 {
-    QFile file( m_fileName.path() );
-    if ( !file.open( QIODevice::ReadOnly ) )
+    TextParser file( m_fileName.path() );
+    if ( !file.open() )
+    {
+        return false;
+    }
+    std::vector<float> values;
+    if ( !file.numbers( 0, file.numLines(), values ) )
     {
         return false;
     }
-    QTextStream in( &file );
 
     if ( dynamic_cast<DatasetMesh*>( m_selectedDataset ) )
     {
         DatasetMesh* sds = dynamic_cast<DatasetMesh*>( m_selectedDataset );
 
-        for ( unsigned int i = 0; i < sds->getMesh()->numVerts(); i++ )
+        unsigned int numVerts = qMin( (unsigned int)values.size(), sds->getMesh()->numVerts() );
+        for ( unsigned int i = 0; i < numVerts; i++ )
         {
-            float v;
-            in >> v;
+            float v = values[i];
             for ( int m = 0; m < sds->getNumberOfMeshes(); m++ )
             {
                 sds->getMesh( m )->setVertexData( i, v );
@@ -872,104 +842,101 @@ bool Loader::load1D()
 
 bool Loader::loadMRtrix()
 {
-    QFile file( m_fileName.path() );
-    if ( !file.open( QIODevice::ReadOnly ) )
+    QString fn = m_fileName.path();
+    MRtrixTracks tracks;
+    std::vector<Fib> fibs;
+    if ( !tracks.open( fn ) || !tracks.load( fibs ) )
     {
-        qCritical() << "Error opening the file";
+        return false;
     }
-    QByteArray qba;
-
-    QDataStream dataStream( &qba, QIODevice::WriteOnly );
-    dataStream << file.readAll();
-    file.close();
-
-    int pc = 0;
-    QString offset;
-    for ( int i = 0; i < qba.size(); ++i )
+    QString timestamp = tracks.property( "timestamp" );
+    tracks.close();
+
+    // track scalar files next to the tracks, e.g. tracks_fa.tsf for tracks.tck, become data fields;
+    // MRtrix writes the timestamp of the tracks into their scalar files, files of other or older tracks
+    // with the same basename are left out
+    QList<QString> dataNames;
+    QFileInfo info( fn );
+    QString prefix = info.completeBaseName() + "_";
+    QStringList scalarFiles = info.dir().entryList( QStringList( prefix + "*.tsf" ), QDir::Files, QDir::Name );
+    for ( int f = 0; f < scalarFiles.size(); ++f )
     {
-        char cur = qba.at( i );
-        QString test;
-        if ( cur == 'f' )
+        MRtrixTracks scalars;
+        std::vector< std::vector<float> > values;
+        if ( !scalars.open( info.dir().filePath( scalarFiles[f] ) ) || !scalars.loadScalars( values ) )
         {
-            test.append( 'f' );
-            test.append( qba.at( i + 1 ) );
-            test.append( qba.at( i + 2 ) );
-            test.append( qba.at( i + 3 ) );
-            test.append( qba.at( i + 4 ) );
-            test.append( qba.at( i + 5 ) );
-            test.append( qba.at( i + 6 ) );
-
-            if ( test == "file: ." )
+            continue;
+        }
+        if ( timestamp.isEmpty() || scalars.property( "timestamp" ) != timestamp )
+        {
+            qWarning() << scalarFiles[f] << "has another timestamp than the tracks of" << fn;
+            continue;
+        }
+        bool matches = values.size() == fibs.size();
+        for ( unsigned int i = 0; i < fibs.size() && matches; ++i )
+        {
+            matches = values[i].size() == fibs[i].length();
+        }
+        if ( !matches )
+        {
+            qWarning() << scalarFiles[f] << "doesn't match the tracks of" << fn;
+            continue;
+        }
+        for ( unsigned int i = 0; i < fibs.size(); ++i )
+        {
+            if ( dataNames.empty() )
             {
-                int add = 7;
-                while ( qba.at( i + add ) == ' ' )
-                {
-                    ++add;
-                }
-                while ( qba.at( i + add ) != '\n' && qba.at( i + add ) != ' ' )
-                {
-                    offset.append( qba.at( i + add ) );
-                    ++add;
-                }
-
-                qDebug() << "found file: . at " << i << "offset:" << offset.toInt();
-                pc = offset.toInt() + 4;
-                break;
+                fibs[i].setDataField( 0, values[i] );
+            }
+            else
+            {
+                fibs[i].addDataField( values[i] );
             }
         }
+        dataNames.push_back( scalarFiles[f].mid( prefix.size() ).section( '.', 0, -2 ) );
+    }
+    if ( dataNames.empty() )
+    {
+        dataNames.push_back( "no data" );
     }
 
-    float x,y,z;
-
-    std::vector<Fib> fibs;
-    Fib fib;
-
-    union {
-      float f;
-      uchar b[4];
-    } u;
-
-    while( pc < qba.size() )
+    // empty tracks are kept by the file so scalars line up, they aren't drawable
+    unsigned int kept = 0;
+    for ( unsigned int i = 0; i < fibs.size(); ++i )
     {
-        u.b[0] = qba.at( pc++ );
-        u.b[1] = qba.at( pc++ );
-        u.b[2] = qba.at( pc++ );
-        u.b[3] = qba.at( pc++ );
-        x = u.f;
-
-        u.b[0] = qba.at( pc++ );
-        u.b[1] = qba.at( pc++ );
-        u.b[2] = qba.at( pc++ );
-        u.b[3] = qba.at( pc++ );
-        y = u.f;
-        u.b[0] = qba.at( pc++ );
-        u.b[1] = qba.at( pc++ );
-        u.b[2] = qba.at( pc++ );
-        u.b[3] = qba.at( pc++ );
-        z = u.f;
-
-        if ( std::isinf( x ) )
+        if ( fibs[i].length() > 0 )
         {
-            break;
+            if ( kept != i )
+            {
+                fibs[kept] = fibs[i];
+            }
+            ++kept;
         }
+    }
+    fibs.resize( kept );
 
-        if ( std::isnan( x ) )
-        {
-            fibs.push_back( fib );
-            fib.clear();
-            fib.addDataField();
-            continue;
-        }
+    DatasetFibers* dataset = new DatasetFibers( fn, fibs, dataNames );
+    m_dataset.push_back( dataset );
 
-        fib.addVert( x,y ,z );
-    }
-    qba.clear();
-    qba.squeeze();
+    return true;
+}
 
+bool Loader::loadFiberContainer()
+{
     QString fn = m_fileName.path();
-    QList<QString>dataNames;
-    dataNames.push_back( "no data" );
-    DatasetFibers* dataset = new DatasetFibers( fn, fibs, dataNames );
+    FiberContainer container;
+    std::vector<Fib> fibs;
+    if ( !container.open( fn ) || !container.load( fibs ) )
+    {
+        return false;
+    }
+
+    DatasetFibers* dataset = new DatasetFibers( fn, fibs, container.dataNames() );
+    if ( !container.dataMins().empty() )
+    {
+        dataset->setDataMins( container.dataMins() );
+        dataset->setDataMaxes( container.dataMaxes() );
+    }
     m_dataset.push_back( dataset );
 
     return true;
@@ -42,6 +42,7 @@ private:
     bool loadRGB();
     bool load1D();
     bool loadMRtrix();
+    bool loadFiberContainer();
     bool loadPNG();
     bool loadJSON();
 
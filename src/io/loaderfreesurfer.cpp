@@ -6,10 +6,8 @@
  */
 
 #include "loaderfreesurfer.h"
+#include "textparser.h"
 
-#include <QFile>
-#include <QStringList>
-#include <QTextStream>
 #include <QDebug>
 
 LoaderFreesurfer::LoaderFreesurfer()
@@ -34,38 +32,33 @@ std::vector<int> LoaderFreesurfer::getTriangles()
 
 bool LoaderFreesurfer::loadASC( QString fn )
 {
-    QFile n( fn );
-    if ( !n.open( QIODevice::ReadOnly ) )
+    TextParser parser( fn );
+    if ( !parser.open() )
     {
         qCritical() << "nodes unreadable" << fn;
         return false;
     }
-    QTextStream ns( &n );
 
-    QString nl;
-    ns.readLine();
-    nl = ns.readLine();
-    int numPoints = nl.split( " " ).at( 0 ).toInt();
-    int numTriangles = nl.split( " " ).at( 1 ).toInt();
+    // first line is a comment, second holds the counts
+    std::vector<int> counts;
+    if ( !parser.columns( 1, 1, 2, counts ) )
+    {
+        return false;
+    }
+    int numPoints = counts[0];
+    int numTriangles = counts[1];
 
     //POINTS
-    for ( int i = 0; i < numPoints; i++ )
+    if ( !parser.columns( 2, numPoints, 3, *m_points ) )
     {
-        nl = ns.readLine();
-        QStringList vals = nl.split( " ", QString::SkipEmptyParts );
-        m_points->push_back( vals.at( 0 ).toFloat() );
-        m_points->push_back( vals.at( 1 ).toFloat() );
-        m_points->push_back( vals.at( 2 ).toFloat() );
+        return false;
     }
 
     //TRIANGLES
-    for ( int i = 0; i < numTriangles; i++ )
+    if ( !parser.columns( 2 + numPoints, numTriangles, 3, m_triangles ) )
     {
-        nl = ns.readLine();
-        QStringList vals = nl.split( " ", QString::SkipEmptyParts );
-        m_triangles.push_back( vals.at( 0 ).toInt() );
-        m_triangles.push_back( vals.at( 1 ).toInt() );
-        m_triangles.push_back( vals.at( 2 ).toInt() );
+        return false;
     }
+    qDebug() << "parsed" << fn << "at" << parser.throughput() << "MB/s";
     return true;
 }
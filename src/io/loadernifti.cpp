@@ -6,6 +6,7 @@
  */
 
 #include "loadernifti.h"
+#include "textparser.h"
 
 #include "../data/datasets/datasetscalar.h"
 #include "../data/datasets/dataset3d.h"
@@ -24,6 +25,7 @@
 #include <QVector3D>
 #include <QtGui>
 
+bool LoaderNifti::m_interactive = true;
 
 LoaderNifti::LoaderNifti( QDir fileName ) :
     m_fileName( fileName ),
@@ -55,6 +57,11 @@ Fn::DatasetType LoaderNifti::getDatasetType()
     return m_datasetType;
 }
 
+void LoaderNifti::setInteractive( bool interactive )
+{
+    m_interactive = interactive;
+}
+
 bool LoaderNifti::load()
 {
     QString hdrPath = m_fileName.path();
@@ -148,6 +155,11 @@ bool LoaderNifti::load()
 
 bool LoaderNifti::askTimeSeries( int dim )
 {
+    if ( !m_interactive )
+    {
+        qDebug() << "found" << dim << "images in nifti file, loading as dwi";
+        return false;
+    }
     QMessageBox msgBox;
     msgBox.setText( "Found " + QString::number( dim ) + " images in nifti file." );
     msgBox.setInformativeText( "Interpret as fmri time series?" );
@@ -554,7 +566,6 @@ bool LoaderNifti::loadNiftiDWI( QString fileName )
 
 std::vector<float> LoaderNifti::loadBvals( QString fileName )
 {
-    QStringList slBvals;
     std::vector<float> bvals;
 
     QString fn = m_fileName.path();
@@ -562,7 +573,7 @@ std::vector<float> LoaderNifti::loadBvals( QString fileName )
     fn.replace( ".nii", ".bval" );
     QDir dir( fn );
 
-    while ( !dir.exists( dir.absolutePath() ) )
+    while ( m_interactive && !dir.exists( dir.absolutePath() ) )
     {
         QString path = dir.path();
         fn = QFileDialog::getOpenFileName( 0, "Select bval file", path );
@@ -571,36 +582,30 @@ std::vector<float> LoaderNifti::loadBvals( QString fileName )
 
     if ( dir.exists( dir.absolutePath() ) )
     {
-        QFile file( fn );
-        if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        TextParser file( fn );
+        if ( !file.open() )
         {
             QMessageBox msgBox;
             msgBox.setText( "Error! Couldn't open" + fn );
-            msgBox.exec();
+            if ( m_interactive )
+            {
+                msgBox.exec();
+            }
             qDebug() << "couldn't open " << fn;
             return bvals;
         }
 
-        QTextStream in( &file );
-        if ( !in.atEnd() )
+        if ( file.numLines() > 0 && !file.numbers( 0, 1, bvals ) )
         {
-            slBvals = in.readLine().split( " ", QString::SkipEmptyParts );
-            for ( int i = 0; i < slBvals.size(); ++i )
+            QMessageBox msgBox;
+            msgBox.setText( "Error! While parsing bvals, conversion failure string to float!" );
+            if ( m_interactive )
             {
-                bool ok;
-                bvals.push_back( slBvals[i].toFloat( &ok ) );
-                if ( !ok )
-                {
-                    QMessageBox msgBox;
-                    msgBox.setText( "Error! While parsing bvals (" + QString::number( i ) + "), conversion failure string to float!" );
-                    msgBox.exec();
-                    qCritical() << "error while parsing bvals (" << i << "), conversion failure string to float";
-                    bvals.clear();
-                    return bvals;
-                }
-
+                msgBox.exec();
             }
-
+            qCritical() << "error while parsing bvals, conversion failure string to float";
+            bvals.clear();
+            return bvals;
         }
         return bvals;
     }
@@ -608,7 +613,10 @@ std::vector<float> LoaderNifti::loadBvals( QString fileName )
     {
         QMessageBox msgBox;
         msgBox.setText( "Error! Couldn't open" + fn );
-        msgBox.exec();
+        if ( m_interactive )
+        {
+            msgBox.exec();
+        }
         qCritical() << "couldn't open " << fn;
         return bvals;
     }
@@ -623,7 +631,7 @@ std::vector<QVector3D> LoaderNifti::loadBvecs( QString fileName, std::vector<flo
 
     std::vector<QVector3D> bvecs;
 
-    while ( !dir2.exists( dir2.absolutePath() ) )
+    while ( m_interactive && !dir2.exists( dir2.absolutePath() ) )
     {
         QString path = dir2.path();
         fn = QFileDialog::getOpenFileName( 0, "Select bvec file", path );
@@ -632,60 +640,62 @@ std::vector<QVector3D> LoaderNifti::loadBvecs( QString fileName, std::vector<flo
 
     if ( dir2.exists( dir2.absolutePath() ) )
     {
-        QStringList slBvecs;
-
-        QFile file( fn );
-        if ( !file.open( QIODevice::ReadOnly | QIODevice::Text ) )
+        TextParser file( fn );
+        if ( !file.open() )
         {
             QMessageBox msgBox;
             msgBox.setText( "Error! Couldn't open" + fn );
-            msgBox.exec();
+            if ( m_interactive )
+            {
+                msgBox.exec();
+            }
             qCritical() << "couldn't open " << fn;
             return bvecs;
         }
 
-        QTextStream in( &file );
-        while ( !in.atEnd() )
+        std::vector<double> values;
+        std::vector<unsigned int> offsets;
+        if ( file.numLines() < 3 || !file.rows( 0, 3, values, offsets ) )
         {
-            slBvecs.push_back( in.readLine() );
+            QMessageBox msgBox;
+            msgBox.setText( "Error! While parsing bvecs, conversion failure string to float" );
+            if ( m_interactive )
+            {
+                msgBox.exec();
+            }
+            qCritical() << "error while parsing bvecs, conversion failure string to float";
+            return bvecs;
         }
-        QString sX = slBvecs[0];
-        QString sY = slBvecs[1];
-        QString sZ = slBvecs[2];
-        QStringList slX = sX.split( " ", QString::SkipEmptyParts );
-        QStringList slY = sY.split( " ", QString::SkipEmptyParts );
-        QStringList slZ = sZ.split( " ", QString::SkipEmptyParts );
-
-        if ( (int)bvals.size() != slX.size() || (int)bvals.size() != slY.size() || (int)bvals.size() != slZ.size() )
+
+        unsigned int numX = offsets[1] - offsets[0];
+        unsigned int numY = offsets[2] - offsets[1];
+        unsigned int numZ = offsets[3] - offsets[2];
+
+        if ( bvals.size() != numX || bvals.size() != numY || bvals.size() != numZ )
         {
             QMessageBox msgBox;
             msgBox.setText( "Error! While loading dwi dataset, bvals don't match bvecs!" );
-            msgBox.exec();
+            if ( m_interactive )
+            {
+                msgBox.exec();
+            }
             qCritical() << "*** ERROR *** while loading dwi dataset, bvals don't match bvecs!";
             return bvecs;
         }
-        for ( int i = 0; i < slX.size(); ++i )
+        const double* x = &values[offsets[0]];
+        const double* y = &values[offsets[1]];
+        const double* z = &values[offsets[2]];
+        for ( unsigned int i = 0; i < numX; ++i )
         {
             if ( bvals[i] > 100 )
             {
-                bool okX, okY, okZ;
                 if ( m_isRadiological )
                 {
-                    bvecs.push_back( QVector3D( -slX[i].toDouble( &okX ), slY[i].toDouble( &okY ), slZ[i].toDouble( &okZ ) ) );
+                    bvecs.push_back( QVector3D( -x[i], y[i], z[i] ) );
                 }
                 else
                 {
-                    bvecs.push_back( QVector3D( slX[i].toDouble( &okX ), slY[i].toDouble( &okY ), slZ[i].toDouble( &okZ ) ) );
-                }
-
-                if ( !( okX && okY && okZ ) )
-                {
-                    QMessageBox msgBox;
-                    msgBox.setText( "Error! While parsing bvecs(" + QString::number( i ) + "), conversion failure string to float" );
-                    msgBox.exec();
-                    qCritical() << "error while parsing bvecs(" << i << "), conversion failure string to float";
-                    bvecs.clear();
-                    return bvecs;
+                    bvecs.push_back( QVector3D( x[i], y[i], z[i] ) );
                 }
             }
         }
@@ -695,7 +705,10 @@ std::vector<QVector3D> LoaderNifti::loadBvecs( QString fileName, std::vector<flo
     {
         QMessageBox msgBox;
         msgBox.setText( "Error! Couldn't open" + fn );
-        msgBox.exec();
+        if ( m_interactive )
+        {
+            msgBox.exec();
+        }
         qCritical() << "couldn't open " << fn;
         return bvecs;
     }
@@ -23,6 +23,9 @@ public:
     bool load();
     bool askTimeSeries( int dim );
 
+    // without interaction 4D files load as dwi, missing bval/bvec files and errors are only logged
+    static void setInteractive( bool interactive );
+
     std::vector<Dataset*> getDataset();
     Fn::DatasetType getDatasetType();
 
@@ -54,6 +57,8 @@ private:
     std::vector<Dataset*> m_dataset;
     QList<QVariant>m_propStates;
     bool m_isRadiological;
+
+    static bool m_interactive;
 };
 
 #endif /* LOADERNIFTI_H_ */
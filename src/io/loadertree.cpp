@@ -8,13 +8,15 @@
 #include "loadertree.h"
 
 #include "loaderfreesurfer.h"
+#include "textparser.h"
 
 #include "../data/datasets/datasettree.h"
 
 #include "../data/mesh/trianglemesh2.h"
 
 #include <QDebug>
-#include <QTextStream>
+#include <QFileInfo>
+#include <QDir>
 
 LoaderTree::LoaderTree( QString fileName ) :
     m_fileName( fileName ),
@@ -35,85 +37,101 @@ bool LoaderTree::load()
 
     qDebug() << "loading tree: " << m_fileName;
 
-    QFile treeFile( m_fileName );
-    if ( !treeFile.open( QIODevice::ReadOnly ) )
+    TextParser treeFile( m_fileName );
+    if ( !treeFile.open() )
     {
         qCritical( "tree file unreadable" );
         return false;
     }
-    QTextStream ts( &treeFile );
     QString nl;
 
-    QString dims;
-    QString meshoffset;
-    std::vector<QString>voxels;
-    std::vector<QString>nodes;
+    std::vector<double> dims;
+    std::vector<int> voxels;
+    std::vector<double> nodes;
+    std::vector<unsigned int> nodeOffsets;
+    std::vector<unsigned int> dummy;
     QFileInfo fi( m_fileName );
-    while ( !ts.atEnd() )
+
+    int numLines = treeFile.numLines();
+    int line = 0;
+    while ( line < numLines )
     {
-        nl = ts.readLine();
+        nl = treeFile.line( line++ );
         if ( nl.startsWith( "#imagesize" ) )
         {
-            dims = ts.readLine();
+            treeFile.rows( line++, 1, dims, dummy );
         }
 
         if ( nl.startsWith( "#voxels" ) )
         {
-            nl = ts.readLine();
-            while( nl != "#endvoxels" )
+            int first = line;
+            while( line < numLines && treeFile.line( line ) != "#endvoxels" )
+            {
+                ++line;
+            }
+            if ( !treeFile.columns( first, line - first, 3, voxels ) )
             {
-                voxels.push_back( nl );
-                nl = ts.readLine();
+                return false;
             }
+            nl = treeFile.line( line++ );
         }
 
         if ( nl.startsWith( "#nodes" ) )
         {
-            nl = ts.readLine();
-            while( nl != "#endnodes" )
+            int first = line;
+            while( line < numLines && treeFile.line( line ) != "#endnodes" )
             {
-                nodes.push_back( nl );
-                nl = ts.readLine();
+                ++line;
             }
+            if ( !treeFile.rows( first, line - first, nodes, nodeOffsets ) )
+            {
+                return false;
+            }
+            nl = treeFile.line( line++ );
         }
 
         if ( nl.startsWith( "#meshoffset" ) )
         {
-            meshoffset = ts.readLine();
-            QStringList mol = meshoffset.split( ' ' );
+            std::vector<double> mol;
+            treeFile.rows( line++, 1, mol, dummy );
             if ( mol.size() == 3 )
             {
-                m_meshoffsetX = mol[0].toFloat();
-                m_meshoffsetY = mol[1].toFloat();
-                m_meshoffsetZ = mol[2].toFloat();
+                m_meshoffsetX = mol[0];
+                m_meshoffsetY = mol[1];
+                m_meshoffsetZ = mol[2];
             }
         }
 
 
         if ( nl.startsWith( "#surface" ) )
         {
-            nl = ts.readLine();
-            while( nl != "#endsurface" )
+            while( line < numLines && treeFile.line( line ) != "#endsurface" )
             {
+                nl = treeFile.line( line++ );
                 if ( !loadSurfaceMesh( fi.path() + QDir::separator() + nl ) )
                 {
                     qCritical() << "unable to load: " << fi.path() + QDir::separator() + nl;
                 }
-                nl = ts.readLine();
             }
+            nl = treeFile.line( line++ );
         }
 
         if ( nl.startsWith( "#projection" ) )
         {
-            nl = ts.readLine();
+            nl = treeFile.line( line++ );
             if ( !loadProjection( fi.path() + QDir::separator() + nl ) )
             {
                 qCritical() << "unable to load: " << fi.path() + QDir::separator() + nl;
             }
         }
     }
+    if ( dims.size() < 9 )
+    {
+        qCritical() << "tree file has no valid #imagesize";
+        return false;
+    }
     m_dataset->setProperties();
-    m_dataset->importTree( dims, voxels, nodes );
+    m_dataset->importTree( dims, voxels, nodes, nodeOffsets );
 
     return true;
 }
@@ -151,21 +169,20 @@ bool LoaderTree::loadSurfaceMesh( QString fileName )
 
 bool LoaderTree::loadProjection( QString fileName )
 {
-    QFile file( fileName );
-    if ( !file.open( QIODevice::ReadOnly ) )
+    TextParser file( fileName );
+    if ( !file.open() )
     {
         return false;
     }
-    QTextStream ts( &file );
-
-    QString nl = ts.readLine();
-    QStringList sl = nl.split( ' ' );
-    std::vector<int>projection;
 
-    for ( int i = 0; i < sl.size(); ++i )
+    std::vector<double> values;
+    std::vector<unsigned int> offsets;
+    if ( !file.rows( 0, 1, values, offsets ) )
     {
-        projection.push_back( sl[i].toInt() );
+        return false;
     }
+    std::vector<int>projection( values.begin(), values.end() );
+
     m_dataset->setProjection( projection );
     return true;
 }
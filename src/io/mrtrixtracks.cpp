@@ -0,0 +1,505 @@
+/*
+ * mrtrixtracks.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "mrtrixtracks.h"
+#include "mrtrixtracksthread.h"
+#include "streamwriter.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QStringList>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    enum DataType
+    {
+        FLOAT32LE,
+        FLOAT32BE,
+        FLOAT64LE,
+        FLOAT64BE
+    };
+
+    // digits of the count field, it is written as zeros first and overwritten by finish()
+    const int COUNT_WIDTH = 10;
+
+    inline float decode( const uchar* p, int type )
+    {
+        switch ( type )
+        {
+            case FLOAT32BE:
+            {
+                quint32 bits = qFromBigEndian<quint32>( p );
+                float value;
+                memcpy( &value, &bits, 4 );
+                return value;
+            }
+            case FLOAT64LE:
+            {
+                quint64 bits = qFromLittleEndian<quint64>( p );
+                double value;
+                memcpy( &value, &bits, 8 );
+                return value;
+            }
+            case FLOAT64BE:
+            {
+                quint64 bits = qFromBigEndian<quint64>( p );
+                double value;
+                memcpy( &value, &bits, 8 );
+                return value;
+            }
+            default:
+            {
+                quint32 bits = qFromLittleEndian<quint32>( p );
+                float value;
+                memcpy( &value, &bits, 4 );
+                return value;
+            }
+        }
+    }
+
+    bool parseDataType( QString name, int& type )
+    {
+        name = name.toLower();
+        bool bigEndian = ( Q_BYTE_ORDER == Q_BIG_ENDIAN );
+        if ( name.endsWith( "le" ) )
+        {
+            bigEndian = false;
+            name.chop( 2 );
+        }
+        else if ( name.endsWith( "be" ) )
+        {
+            bigEndian = true;
+            name.chop( 2 );
+        }
+
+        if ( name == "float32" )
+        {
+            type = bigEndian ? FLOAT32BE : FLOAT32LE;
+            return true;
+        }
+        if ( name == "float64" )
+        {
+            type = bigEndian ? FLOAT64BE : FLOAT64LE;
+            return true;
+        }
+        return false;
+    }
+}
+
+MRtrixTracks::MRtrixTracks() :
+    m_scalars( false ),
+    m_dataType( FLOAT32LE ),
+    m_offset( 0 ),
+    m_mapped( 0 ),
+    m_data( 0 ),
+    m_numRecords( 0 ),
+    m_valueSize( 4 ),
+    m_recordSize( 12 ),
+    m_fibOut( 0 ),
+    m_scalarOut( 0 ),
+    m_out( 0 ),
+    m_countPos( 0 ),
+    m_count( 0 )
+{
+}
+
+MRtrixTracks::~MRtrixTracks()
+{
+    if ( m_out )
+    {
+        finish();
+    }
+    close();
+}
+
+void MRtrixTracks::runPass( int pass, unsigned int size )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<MRtrixTracksThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new MRtrixTracksThread( this, pass, size, i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+        delete threads[i];
+    }
+}
+
+bool MRtrixTracks::open( QString fileName )
+{
+    close();
+    m_fileName = fileName;
+    m_file.setFileName( fileName );
+    if ( !m_file.open( QIODevice::ReadOnly ) )
+    {
+        qCritical() << "unable to open" << fileName;
+        return false;
+    }
+
+    QString magic = QString( m_file.readLine() ).trimmed();
+    if ( magic == "mrtrix tracks" )
+    {
+        m_scalars = false;
+    }
+    else if ( magic == "mrtrix track scalars" )
+    {
+        m_scalars = true;
+    }
+    else
+    {
+        qCritical() << fileName << "is not an mrtrix track file";
+        close();
+        return false;
+    }
+
+    // key: value lines up to END, repeated keys are joined by new lines like mrtrix does
+    bool ended = false;
+    while ( !m_file.atEnd() )
+    {
+        QString line = QString( m_file.readLine() ).trimmed();
+        if ( line == "END" )
+        {
+            ended = true;
+            break;
+        }
+        int colon = line.indexOf( ':' );
+        if ( colon < 1 )
+        {
+            continue;
+        }
+        QString key = line.left( colon ).trimmed();
+        QString value = line.mid( colon + 1 ).trimmed();
+        if ( m_properties.contains( key ) )
+        {
+            value = m_properties.value( key ) + "\n" + value;
+        }
+        m_properties.insert( key, value );
+    }
+    if ( !ended )
+    {
+        qCritical() << fileName << "header has no END";
+        close();
+        return false;
+    }
+
+    m_dataType = ( Q_BYTE_ORDER == Q_BIG_ENDIAN ) ? FLOAT32BE : FLOAT32LE;
+    if ( m_properties.contains( "datatype" ) && !parseDataType( m_properties.value( "datatype" ), m_dataType ) )
+    {
+        qCritical() << fileName << "unsupported datatype" << m_properties.value( "datatype" );
+        close();
+        return false;
+    }
+    m_valueSize = ( m_dataType == FLOAT64LE || m_dataType == FLOAT64BE ) ? 8 : 4;
+    m_recordSize = m_scalars ? m_valueSize : 3 * m_valueSize;
+
+    // the payload must be in this file, without an offset it follows the header
+    m_offset = m_file.pos();
+    QStringList file = m_properties.value( "file" ).split( ' ', QString::SkipEmptyParts );
+    if ( file.size() > 0 && file[0] != "." )
+    {
+        qCritical() << fileName << "data in other files is not supported";
+        close();
+        return false;
+    }
+    if ( file.size() > 1 )
+    {
+        bool ok = false;
+        m_offset = file[1].toLongLong( &ok );
+        if ( !ok || m_offset < 0 || m_offset > m_file.size() )
+        {
+            qCritical() << fileName << "invalid data offset" << file[1];
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void MRtrixTracks::close()
+{
+    unmap();
+    if ( m_file.isOpen() )
+    {
+        m_file.close();
+    }
+    m_properties.clear();
+    m_delimiters.clear();
+    m_numRecords = 0;
+}
+
+bool MRtrixTracks::isScalars()
+{
+    return m_scalars;
+}
+
+QString MRtrixTracks::property( QString key )
+{
+    return m_properties.value( key );
+}
+
+bool MRtrixTracks::index()
+{
+    qint64 payload = m_file.size() - m_offset;
+    if ( payload / m_recordSize >= std::numeric_limits<unsigned int>::max() )
+    {
+        qCritical() << m_fileName << "has too many points";
+        return false;
+    }
+    m_numRecords = payload / m_recordSize;
+
+    m_mapped = 0;
+    if ( payload > 0 )
+    {
+        m_mapped = m_file.map( m_offset, payload );
+    }
+    if ( m_mapped )
+    {
+        m_data = m_mapped;
+    }
+    else
+    {
+        // not mappable, e.g. a pipe or special file system
+        m_file.seek( m_offset );
+        m_buffer = m_file.readAll();
+        m_data = reinterpret_cast<const uchar*>( m_buffer.constData() );
+        m_numRecords = m_buffer.size() / m_recordSize;
+    }
+
+    // every thread finds the NaNs of its part up to its first Inf, the earliest Inf ends the file
+    int numThreads = GLFunctions::idealThreadCount;
+    m_stops.assign( numThreads, m_numRecords );
+    m_threadDelimiters.assign( numThreads, std::vector<unsigned int>() );
+    runPass( MRtrixTracksThread::SCAN, m_numRecords );
+
+    unsigned int stop = *std::min_element( m_stops.begin(), m_stops.end() );
+    m_delimiters.clear();
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        std::vector<unsigned int>& delimiters = m_threadDelimiters[i];
+        std::vector<unsigned int>::iterator end = std::lower_bound( delimiters.begin(), delimiters.end(), stop );
+        m_delimiters.insert( m_delimiters.end(), delimiters.begin(), end );
+    }
+    std::vector< std::vector<unsigned int> >().swap( m_threadDelimiters );
+
+    if ( m_properties.contains( "count" ) && m_properties.value( "count" ).toUInt() != m_delimiters.size() )
+    {
+        qWarning() << m_fileName << "header count" << m_properties.value( "count" ) << "but" << m_delimiters.size() << "tracks found";
+    }
+    return true;
+}
+
+void MRtrixTracks::unmap()
+{
+    if ( m_mapped )
+    {
+        m_file.unmap( const_cast<uchar*>( m_mapped ) );
+    }
+    m_mapped = 0;
+    m_data = 0;
+    m_buffer.clear();
+}
+
+void MRtrixTracks::scanRange( int thread, unsigned int begin, unsigned int end )
+{
+    std::vector<unsigned int>& delimiters = m_threadDelimiters[thread];
+    const uchar* p = m_data + static_cast<qint64>( begin ) * m_recordSize;
+    for ( unsigned int i = begin; i < end; ++i, p += m_recordSize )
+    {
+        float value = decode( p, m_dataType );
+        if ( std::isnan( value ) )
+        {
+            delimiters.push_back( i );
+        }
+        else if ( std::isinf( value ) )
+        {
+            m_stops[thread] = i;
+            break;
+        }
+    }
+}
+
+void MRtrixTracks::buildRange( unsigned int begin, unsigned int end )
+{
+    for ( unsigned int i = begin; i < end; ++i )
+    {
+        unsigned int first = ( i == 0 ) ? 0 : m_delimiters[i - 1] + 1;
+        unsigned int size = m_delimiters[i] - first;
+        const uchar* p = m_data + static_cast<qint64>( first ) * m_recordSize;
+
+        if ( m_fibOut )
+        {
+            std::vector<QVector3D> verts( size );
+            for ( unsigned int k = 0; k < size; ++k, p += m_recordSize )
+            {
+                verts[k] = QVector3D( decode( p, m_dataType ), decode( p + m_valueSize, m_dataType ), decode( p + 2 * m_valueSize, m_dataType ) );
+            }
+            ( *m_fibOut )[i] = Fib( verts );
+        }
+        else
+        {
+            std::vector<float>& values = ( *m_scalarOut )[i];
+            values.resize( size );
+            for ( unsigned int k = 0; k < size; ++k, p += m_recordSize )
+            {
+                values[k] = decode( p, m_dataType );
+            }
+        }
+    }
+}
+
+bool MRtrixTracks::load( std::vector<Fib>& fibs )
+{
+    fibs.clear();
+    if ( !m_file.isOpen() || m_scalars || !index() )
+    {
+        return false;
+    }
+
+    fibs.resize( m_delimiters.size() );
+    m_fibOut = &fibs;
+    runPass( MRtrixTracksThread::BUILD, m_delimiters.size() );
+    m_fibOut = 0;
+    unmap();
+    return true;
+}
+
+bool MRtrixTracks::loadScalars( std::vector< std::vector<float> >& values )
+{
+    values.clear();
+    if ( !m_file.isOpen() || !m_scalars || !index() )
+    {
+        return false;
+    }
+
+    values.resize( m_delimiters.size() );
+    m_scalarOut = &values;
+    runPass( MRtrixTracksThread::BUILD, m_delimiters.size() );
+    m_scalarOut = 0;
+    unmap();
+    return true;
+}
+
+bool MRtrixTracks::create( QString fileName, bool scalars, QString timestamp )
+{
+    close();
+    m_fileName = fileName;
+    m_scalars = scalars;
+    m_file.setFileName( fileName );
+    if ( !m_file.open( QIODevice::WriteOnly ) )
+    {
+        qCritical() << "Error writing " << fileName;
+        return false;
+    }
+
+    if ( timestamp.isEmpty() )
+    {
+        timestamp = QString::number( QDateTime::currentMSecsSinceEpoch() / 1000.0, 'f', 3 );
+    }
+    m_properties.insert( "timestamp", timestamp );
+
+    QByteArray header( scalars ? "mrtrix track scalars\n" : "mrtrix tracks\n" );
+    header += "timestamp: " + timestamp.toLatin1() + "\n";
+    header += "datatype: Float32LE\n";
+    header += "count: ";
+    m_countPos = header.size();
+    header += QByteArray( COUNT_WIDTH, '0' ) + "\n";
+
+    // the offset counts its own digits
+    QByteArray end( "END\n" );
+    qint64 base = header.size() + QByteArray( "file: . \n" ).size() + end.size();
+    qint64 offset = base;
+    while ( base + QByteArray::number( offset ).size() != offset )
+    {
+        offset = base + QByteArray::number( offset ).size();
+    }
+    header += "file: . " + QByteArray::number( offset ) + "\n" + end;
+
+    m_out = new StreamWriter( &m_file );
+    m_out->writeText( header );
+    m_count = 0;
+    return true;
+}
+
+void MRtrixTracks::append( const Fib& fib )
+{
+    const std::vector<QVector3D>* verts = fib.getVerts();
+    for ( unsigned int i = 0; i < verts->size(); ++i )
+    {
+        m_out->writeFloatLE( verts->at( i ).x() );
+        m_out->writeFloatLE( verts->at( i ).y() );
+        m_out->writeFloatLE( verts->at( i ).z() );
+    }
+    float nan = std::numeric_limits<float>::quiet_NaN();
+    m_out->writeFloatLE( nan );
+    m_out->writeFloatLE( nan );
+    m_out->writeFloatLE( nan );
+    ++m_count;
+}
+
+void MRtrixTracks::append( const std::vector<float>& values )
+{
+    for ( unsigned int i = 0; i < values.size(); ++i )
+    {
+        m_out->writeFloatLE( values[i] );
+    }
+    m_out->writeFloatLE( std::numeric_limits<float>::quiet_NaN() );
+    ++m_count;
+}
+
+bool MRtrixTracks::finish()
+{
+    if ( !m_out )
+    {
+        return false;
+    }
+    float inf = std::numeric_limits<float>::infinity();
+    for ( int i = 0; i < ( m_scalars ? 1 : 3 ); ++i )
+    {
+        m_out->writeFloatLE( inf );
+    }
+    bool ok = m_out->flush();
+    delete m_out;
+    m_out = 0;
+
+    ok = ok && m_file.seek( m_countPos );
+    ok = ok && m_file.write( QByteArray::number( m_count ).rightJustified( COUNT_WIDTH, '0' ) ) == COUNT_WIDTH;
+    m_file.close();
+    if ( !ok )
+    {
+        qCritical() << "Error writing " << m_fileName;
+    }
+    return ok;
+}
+
+bool MRtrixTracks::save( QString fileName, const std::vector<Fib>& fibs )
+{
+    MRtrixTracks tracks;
+    if ( !tracks.create( fileName ) )
+    {
+        return false;
+    }
+    for ( unsigned int i = 0; i < fibs.size(); ++i )
+    {
+        tracks.append( fibs[i] );
+    }
+    return tracks.finish();
+}
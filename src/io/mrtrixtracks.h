@@ -0,0 +1,97 @@
+/*
+ * mrtrixtracks.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef MRTRIXTRACKS_H_
+#define MRTRIXTRACKS_H_
+
+#include "../algos/fib.h"
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+
+#include <vector>
+
+class MRtrixTracksThread;
+class StreamWriter;
+
+/*
+ * MRtrix track (.tck) and track scalar (.tsf) files. The text header ends with END, its file key points
+ * to the payload of 32 or 64 bit floats in either byte order, three per point for tracks and one per
+ * point for scalars. A NaN ends a track, Inf ends the file. The payload is memory mapped, the
+ * delimiters are found by all threads on their part of the file and the tracks are then decoded
+ * straight from the mapping, again on all threads. Writing streams the tracks as little endian floats
+ * and fills in the count of the header at the end.
+ */
+class MRtrixTracks
+{
+    friend class MRtrixTracksThread;
+
+public:
+    MRtrixTracks();
+    virtual ~MRtrixTracks();
+
+    // reads and checks the header, the payload is mapped by load()
+    bool open( QString fileName );
+    void close();
+
+    // true for track scalar files, one value per point instead of a position
+    bool isScalars();
+    QString property( QString key );
+
+    // all complete tracks in file order, a track without its NaN at the end of the file is dropped
+    bool load( std::vector<Fib>& fibs );
+    bool loadScalars( std::vector< std::vector<float> >& values );
+
+    // streaming output, timestamp should be the one of the tracks when writing scalars for them
+    bool create( QString fileName, bool scalars = false, QString timestamp = QString() );
+    void append( const Fib& fib );
+    void append( const std::vector<float>& values );
+    bool finish();
+
+    static bool save( QString fileName, const std::vector<Fib>& fibs );
+
+private:
+    void runPass( int pass, unsigned int size );
+
+    bool index();
+    void unmap();
+
+    void scanRange( int thread, unsigned int begin, unsigned int end );
+    void buildRange( unsigned int begin, unsigned int end );
+
+    QString m_fileName;
+    QHash<QString, QString> m_properties;
+    bool m_scalars;
+    int m_dataType;
+    qint64 m_offset;
+
+    // mapped payload, records are points or scalar values
+    QFile m_file;
+    QByteArray m_buffer;
+    const uchar* m_mapped;
+    const uchar* m_data;
+    unsigned int m_numRecords;
+    int m_valueSize;
+    int m_recordSize;
+
+    // per thread results of the scan, the record of the first Inf and the NaN records before it
+    std::vector<unsigned int> m_stops;
+    std::vector< std::vector<unsigned int> > m_threadDelimiters;
+    // record of the NaN that ends each track
+    std::vector<unsigned int> m_delimiters;
+
+    std::vector<Fib>* m_fibOut;
+    std::vector< std::vector<float> >* m_scalarOut;
+
+    // output
+    StreamWriter* m_out;
+    qint64 m_countPos;
+    unsigned int m_count;
+};
+
+#endif /* MRTRIXTRACKS_H_ */
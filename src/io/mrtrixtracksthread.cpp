@@ -0,0 +1,51 @@
+/*
+ * mrtrixtracksthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "mrtrixtracksthread.h"
+#include "mrtrixtracks.h"
+
+#include "../algos/trace.h"
+#include "../gui/gl/glfunctions.h"
+
+MRtrixTracksThread::MRtrixTracksThread( MRtrixTracks* tracks, int pass, unsigned int size, int id ) :
+    m_tracks( tracks ),
+    m_pass( pass ),
+    m_size( size ),
+    m_id( id )
+{
+}
+
+MRtrixTracksThread::~MRtrixTracksThread()
+{
+}
+
+void MRtrixTracksThread::run()
+{
+    TRACE_SCOPE( "MRtrixTracksThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    unsigned int chunkSize = m_size / numThreads;
+
+    unsigned int begin = m_id * chunkSize;
+    unsigned int end = m_id * chunkSize + chunkSize;
+
+    if ( m_id == numThreads - 1 )
+    {
+        end = m_size;
+    }
+
+    switch ( m_pass )
+    {
+        case SCAN:
+            m_tracks->scanRange( m_id, begin, end );
+            break;
+        case BUILD:
+            m_tracks->buildRange( begin, end );
+            break;
+    }
+}
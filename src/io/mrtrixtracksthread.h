@@ -0,0 +1,36 @@
+/*
+ * mrtrixtracksthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef MRTRIXTRACKSTHREAD_H_
+#define MRTRIXTRACKSTHREAD_H_
+
+#include <QThread>
+
+class MRtrixTracks;
+
+class MRtrixTracksThread : public QThread
+{
+public:
+    enum Pass
+    {
+        SCAN,
+        BUILD
+    };
+
+    MRtrixTracksThread( MRtrixTracks* tracks, int pass, unsigned int size, int id );
+    virtual ~MRtrixTracksThread();
+
+private:
+    void run();
+
+    MRtrixTracks* m_tracks;
+    int m_pass;
+    unsigned int m_size;
+    int m_id;
+};
+
+#endif /* MRTRIXTRACKSTHREAD_H_ */
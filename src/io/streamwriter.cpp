@@ -0,0 +1,116 @@
+/*
+ * streamwriter.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "streamwriter.h"
+
+#include <QIODevice>
+#include <QtEndian>
+
+#include <cstring>
+
+StreamWriter::StreamWriter( QIODevice* device, unsigned int bufferSize ) :
+    m_device( device ),
+    m_buffer( qMax( 64u, bufferSize ) ),
+    m_used( 0 ),
+    m_written( 0 ),
+    m_ok( true )
+{
+}
+
+StreamWriter::~StreamWriter()
+{
+    flush();
+}
+
+char* StreamWriter::reserve( unsigned int size )
+{
+    if ( m_used + size > m_buffer.size() )
+    {
+        flush();
+    }
+    char* out = &m_buffer[m_used];
+    m_used += size;
+    return out;
+}
+
+bool StreamWriter::flush()
+{
+    if ( m_used > 0 )
+    {
+        if ( m_device->write( &m_buffer[0], m_used ) != static_cast<qint64>( m_used ) )
+        {
+            m_ok = false;
+        }
+        m_written += m_used;
+        m_used = 0;
+    }
+    return m_ok;
+}
+
+bool StreamWriter::ok()
+{
+    return m_ok;
+}
+
+qint64 StreamWriter::pos()
+{
+    return m_written + m_used;
+}
+
+void StreamWriter::writeText( const QByteArray& text )
+{
+    writeRaw( text.constData(), text.size() );
+}
+
+void StreamWriter::writeRaw( const char* data, unsigned int size )
+{
+    if ( size > m_buffer.size() / 2 )
+    {
+        flush();
+        if ( m_device->write( data, size ) != static_cast<qint64>( size ) )
+        {
+            m_ok = false;
+        }
+        m_written += size;
+        return;
+    }
+    memcpy( reserve( size ), data, size );
+}
+
+void StreamWriter::writeInt8( qint8 value )
+{
+    *reserve( 1 ) = value;
+}
+
+void StreamWriter::writeInt16( qint16 value )
+{
+    qToBigEndian<qint16>( value, reinterpret_cast<uchar*>( reserve( 2 ) ) );
+}
+
+void StreamWriter::writeInt32( qint32 value )
+{
+    qToBigEndian<qint32>( value, reinterpret_cast<uchar*>( reserve( 4 ) ) );
+}
+
+void StreamWriter::writeInt64( qint64 value )
+{
+    qToBigEndian<qint64>( value, reinterpret_cast<uchar*>( reserve( 8 ) ) );
+}
+
+void StreamWriter::writeFloat( float value )
+{
+    quint32 bits;
+    memcpy( &bits, &value, 4 );
+    qToBigEndian<quint32>( bits, reinterpret_cast<uchar*>( reserve( 4 ) ) );
+}
+
+void StreamWriter::writeFloatLE( float value )
+{
+    quint32 bits;
+    memcpy( &bits, &value, 4 );
+    qToLittleEndian<quint32>( bits, reinterpret_cast<uchar*>( reserve( 4 ) ) );
+}
@@ -0,0 +1,55 @@
+/*
+ * streamwriter.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef STREAMWRITER_H_
+#define STREAMWRITER_H_
+
+#include <QByteArray>
+#include <QtGlobal>
+
+#include <vector>
+
+class QIODevice;
+
+/*
+ * Buffered big endian output for the binary file formats. Values are converted straight into a large
+ * buffer which goes to the device in one write when full, so saving is bound by the disk and not by
+ * per value calls. A failed write is remembered, ok() tells after the last flush. writeFloatLE() is
+ * for the few formats that are little endian.
+ */
+class StreamWriter
+{
+public:
+    StreamWriter( QIODevice* device, unsigned int bufferSize = 1 << 22 );
+    virtual ~StreamWriter();
+
+    void writeText( const QByteArray& text );
+    void writeRaw( const char* data, unsigned int size );
+    void writeInt8( qint8 value );
+    void writeInt16( qint16 value );
+    void writeInt32( qint32 value );
+    void writeInt64( qint64 value );
+    void writeFloat( float value );
+    void writeFloatLE( float value );
+
+    // bytes written so far, including the buffered ones
+    qint64 pos();
+
+    bool flush();
+    bool ok();
+
+private:
+    char* reserve( unsigned int size );
+
+    QIODevice* m_device;
+    std::vector<char> m_buffer;
+    unsigned int m_used;
+    qint64 m_written;
+    bool m_ok;
+};
+
+#endif /* STREAMWRITER_H_ */
@@ -0,0 +1,26 @@
+/*
+ * check.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <QDebug>
+
+// failed checks of the running test, main() fails when there are any so ctest sees them
+static int failures = 0;
+
+#define CHECK( condition, what ) \
+    do \
+    { \
+        if ( !( condition ) ) \
+        { \
+            qCritical() << __FILE__ << __LINE__ << #condition << what; \
+            ++failures; \
+        } \
+    } while ( 0 )
+
+#endif /* CHECK_H_ */
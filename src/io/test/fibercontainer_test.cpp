@@ -0,0 +1,201 @@
+/*
+ * fibercontainer_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "check.h"
+#include "testdata.h"
+
+#include "../fibercontainer.h"
+
+#include "../../algos/fib.h"
+#include "../../gui/gl/glfunctions.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+    // the bounds are for exact arithmetic, the float rounding of the decoded value comes on top
+    bool within( float value, float expected, float error, float scale )
+    {
+        return fabs( value - expected ) <= error + 4 * FLT_EPSILON * scale;
+    }
+
+    bool equal( const Fib& a, const Fib& b )
+    {
+        if ( *a.getVerts() != *b.getVerts() || a.getCountDataFields() != b.getCountDataFields() || a.customColor() != b.customColor() )
+        {
+            return false;
+        }
+        for ( unsigned int f = 0; f < a.getCountDataFields(); ++f )
+        {
+            if ( *a.getDataField( f ) != *b.getDataField( f ) )
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void roundTrip( const std::vector<Fib>& fibs, const QList<QString>& dataNames, FiberContainer::Quantisation quantisation, QString fileName )
+    {
+        FiberContainer out;
+        out.setQuantisation( quantisation );
+        // several chunks, the last one partly filled
+        out.setChunkSize( 64 );
+        CHECK( out.save( fileName, fibs, dataNames ), fileName );
+
+        FiberContainer in;
+        CHECK( in.open( fileName ), fileName );
+        CHECK( in.numFibers() == fibs.size(), fileName );
+        CHECK( in.dataNames() == dataNames, fileName );
+
+        std::vector<Fib> loaded;
+        CHECK( in.load( loaded ), fileName );
+        CHECK( loaded.size() == fibs.size(), fileName );
+        if ( loaded.size() != fibs.size() )
+        {
+            return;
+        }
+
+        float coordinateError = in.coordinateError();
+        std::vector<float> mins = in.dataMins();
+        std::vector<float> maxes = in.dataMaxes();
+        for ( int f = 0; f < dataNames.size(); ++f )
+        {
+            if ( quantisation == FiberContainer::FLOAT )
+            {
+                CHECK( in.dataError( f ) == 0.0f, fileName << dataNames[f] );
+            }
+            else
+            {
+                CHECK( in.dataError( f ) > 0.0f, fileName << dataNames[f] );
+            }
+        }
+
+        for ( unsigned int i = 0; i < fibs.size(); ++i )
+        {
+            const Fib& fib = fibs[i];
+            const Fib& back = loaded[i];
+            CHECK( back.length() == fib.length(), fileName << "fiber" << i );
+            CHECK( back.getCountDataFields() == fib.getCountDataFields(), fileName << "fiber" << i );
+            CHECK( back.customColor() == fib.customColor(), fileName << "fiber" << i );
+            if ( back.length() != fib.length() || back.getCountDataFields() != fib.getCountDataFields() )
+            {
+                continue;
+            }
+
+            for ( unsigned int k = 0; k < fib.length(); ++k )
+            {
+                QVector3D v = fib.getVert( k );
+                QVector3D w = back.getVert( k );
+                float scale = qMax( fabs( v.x() ), qMax( fabs( v.y() ), fabs( v.z() ) ) );
+                CHECK( within( w.x(), v.x(), coordinateError, scale ) && within( w.y(), v.y(), coordinateError, scale ) && within( w.z(), v.z(), coordinateError, scale ),
+                       fileName << "fiber" << i << "point" << k << v << w );
+            }
+
+            for ( int f = 0; f < dataNames.size(); ++f )
+            {
+                float error = in.dataError( f );
+                float scale = qMax( fabs( mins[f] ), fabs( maxes[f] ) );
+                for ( unsigned int k = 0; k < fib.length(); ++k )
+                {
+                    float value = fib.getDataField( f )->at( k );
+                    float decoded = back.getDataField( f )->at( k );
+                    if ( quantisation == FiberContainer::FLOAT )
+                    {
+                        CHECK( decoded == value, fileName << dataNames[f] << "fiber" << i << "point" << k << value << decoded );
+                    }
+                    else
+                    {
+                        CHECK( within( decoded, value, error, scale ), fileName << dataNames[f] << "fiber" << i << "point" << k << value << decoded << error );
+                    }
+                }
+            }
+        }
+
+        // single fibers decode their chunk alone and must come out as in the full load, in any order
+        for ( int i = fibs.size() - 1; i >= 0; i -= 7 )
+        {
+            CHECK( equal( in.fiber( i ), loaded[i] ), fileName << "fiber" << i );
+        }
+        CHECK( equal( in.fiber( 0 ), loaded[0] ), fileName << "fiber" << 0 );
+        in.close();
+    }
+
+    QByteArray readAll( QString fileName )
+    {
+        QFile file( fileName );
+        return file.open( QIODevice::ReadOnly ) ? file.readAll() : QByteArray();
+    }
+
+    // the file and the loaded fibers don't depend on the number of threads, also with fewer chunks
+    // than threads
+    void checkThreads( const std::vector<Fib>& fibs, const QList<QString>& dataNames, QString dir )
+    {
+        int numThreads = GLFunctions::idealThreadCount;
+        int threads[] = { 1, 3, 8, 16 };
+        // 5 and 43 chunks
+        unsigned int chunkSizes[] = { 64, 7 };
+
+        for ( int c = 0; c < 2; ++c )
+        {
+            QByteArray reference;
+            for ( int t = 0; t < 4; ++t )
+            {
+                GLFunctions::idealThreadCount = threads[t];
+                QString fileName = dir + "/threads" + QString::number( threads[t] ) + ".bgf";
+
+                FiberContainer out;
+                out.setQuantisation( FiberContainer::HALF );
+                out.setChunkSize( chunkSizes[c] );
+                CHECK( out.save( fileName, fibs, dataNames ), fileName );
+                QByteArray bytes = readAll( fileName );
+                if ( t == 0 )
+                {
+                    reference = bytes;
+                }
+                CHECK( !bytes.isEmpty() && bytes == reference, fileName << "chunk size" << chunkSizes[c] );
+
+                FiberContainer in;
+                std::vector<Fib> loaded;
+                CHECK( in.open( fileName ) && in.load( loaded ) && loaded.size() == fibs.size(), fileName );
+                bool same = loaded.size() == fibs.size();
+                for ( unsigned int i = 0; i < loaded.size() && same; ++i )
+                {
+                    same = equal( loaded[i], in.fiber( i ) ) && loaded[i].length() == fibs[i].length();
+                }
+                CHECK( same, fileName << "chunk size" << chunkSizes[c] );
+                in.close();
+            }
+        }
+        GLFunctions::idealThreadCount = numThreads;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    QTemporaryDir dir;
+    CHECK( dir.isValid(), dir.path() );
+
+    std::vector<Fib> fibs = createFibers( 300, 53 );
+    QList<QString> dataNames;
+    dataNames << "fa" << "curvature";
+
+    roundTrip( fibs, dataNames, FiberContainer::FLOAT, dir.path() + "/float.bgf" );
+    roundTrip( fibs, dataNames, FiberContainer::HALF, dir.path() + "/half.bgf" );
+    roundTrip( fibs, dataNames, FiberContainer::BYTE, dir.path() + "/byte.bgf" );
+    checkThreads( fibs, dataNames, dir.path() );
+
+    qDebug() << "fibercontainer_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
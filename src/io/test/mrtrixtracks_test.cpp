@@ -0,0 +1,334 @@
+/*
+ * mrtrixtracks_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "check.h"
+#include "testdata.h"
+
+#include "../loader.h"
+#include "../mrtrixtracks.h"
+#include "../writer.h"
+
+#include "../../algos/fib.h"
+#include "../../data/models.h"
+#include "../../data/datasets/datasetfibers.h"
+#include "../../gui/gl/glfunctions.h"
+
+#include <QApplication>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    typedef std::vector< std::vector<float> > Tracks;
+
+    struct DataType
+    {
+        const char* name;
+        bool float64;
+        bool bigEndian;
+    };
+
+    const DataType DATATYPES[] =
+    {
+        { "Float32LE", false, false },
+        { "Float32BE", false, true },
+        { "Float64LE", true, false },
+        { "Float64BE", true, true },
+        // without a suffix the values are in the byte order of the machine
+        { "Float32", false, Q_BYTE_ORDER == Q_BIG_ENDIAN }
+    };
+
+    // how the payload ends
+    enum Ending
+    {
+        TERMINATED,         // every track has its NaN, then Inf
+        MISSING_NAN,        // the last track has no NaN, the file just ends
+        MISSING_NAN_INF,    // the last track has no NaN, then Inf
+        EARLY_INF           // Inf after half of the tracks, more tracks follow it
+    };
+
+    const char* ENDINGS[] = { "terminated", "missing final NaN", "missing final NaN before Inf", "early Inf" };
+
+    // x, y, z of every point, NaN and Inf records included
+    std::vector<float> records( const Tracks& tracks, int ending )
+    {
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        const float inf = std::numeric_limits<float>::infinity();
+        std::vector<float> out;
+        for ( unsigned int i = 0; i < tracks.size(); ++i )
+        {
+            if ( ending == EARLY_INF && i == tracks.size() / 2 )
+            {
+                out.insert( out.end(), 3, inf );
+            }
+            out.insert( out.end(), tracks[i].begin(), tracks[i].end() );
+            if ( i + 1 < tracks.size() || ( ending != MISSING_NAN && ending != MISSING_NAN_INF ) )
+            {
+                out.insert( out.end(), 3, nan );
+            }
+        }
+        if ( ending == TERMINATED || ending == MISSING_NAN_INF )
+        {
+            out.insert( out.end(), 3, inf );
+        }
+        return out;
+    }
+
+    void put( QByteArray& out, float value, const DataType& type )
+    {
+        uchar bytes[8];
+        if ( type.float64 )
+        {
+            double d = value;
+            quint64 bits;
+            memcpy( &bits, &d, 8 );
+            type.bigEndian ? qToBigEndian<quint64>( bits, bytes ) : qToLittleEndian<quint64>( bits, bytes );
+        }
+        else
+        {
+            quint32 bits;
+            memcpy( &bits, &value, 4 );
+            type.bigEndian ? qToBigEndian<quint32>( bits, bytes ) : qToLittleEndian<quint32>( bits, bytes );
+        }
+        out.append( reinterpret_cast<const char*>( bytes ), type.float64 ? 8 : 4 );
+    }
+
+    // a track file, or a track scalar file holding the x of every point; the payload starts at the
+    // offset of the file key, past some padding after END
+    QByteArray createFile( const std::vector<float>& values, const DataType& type, bool scalars, int count, int& offset )
+    {
+        QByteArray file( scalars ? "mrtrix track scalars\n" : "mrtrix tracks\n" );
+        file += "datatype: " + QByteArray( type.name ) + "\n";
+        file += "count: " + QByteArray::number( count ) + "\n";
+        file += "timestamp: 1.5\n";
+        offset = file.size() + 40;
+        file += "file: . " + QByteArray::number( offset ) + "\nEND\n";
+        file.append( QByteArray( offset - file.size(), '\0' ) );
+
+        for ( unsigned int i = 0; i < values.size(); i += 3 )
+        {
+            put( file, values[i], type );
+            if ( !scalars )
+            {
+                put( file, values[i + 1], type );
+                put( file, values[i + 2], type );
+            }
+        }
+        return file;
+    }
+
+    // the loop the loader decoded tracks with before the memory mapped reader, over the raw file from
+    // the payload on; its copy of the file had the QDataStream length prefix, hence its offset + 4,
+    // and it read floats of the machine, which the files it was used for had as little endian
+    Tracks previousLoop( const QByteArray& qba, int offset )
+    {
+        Tracks fibs;
+        std::vector<float> fib;
+        int pc = offset;
+        float x, y, z;
+        while ( pc + 12 <= qba.size() )
+        {
+            const uchar* p = reinterpret_cast<const uchar*>( qba.constData() ) + pc;
+            quint32 bits[3] = { qFromLittleEndian<quint32>( p ), qFromLittleEndian<quint32>( p + 4 ), qFromLittleEndian<quint32>( p + 8 ) };
+            memcpy( &x, &bits[0], 4 );
+            memcpy( &y, &bits[1], 4 );
+            memcpy( &z, &bits[2], 4 );
+            pc += 12;
+
+            if ( std::isinf( x ) )
+            {
+                break;
+            }
+            if ( std::isnan( x ) )
+            {
+                fibs.push_back( fib );
+                fib.clear();
+                continue;
+            }
+            fib.push_back( x );
+            fib.push_back( y );
+            fib.push_back( z );
+        }
+        return fibs;
+    }
+
+    bool write( QString fileName, const QByteArray& bytes )
+    {
+        QFile file( fileName );
+        return file.open( QIODevice::WriteOnly ) && file.write( bytes ) == bytes.size();
+    }
+
+    void checkTracks( QString fileName, const Tracks& expected, QString what )
+    {
+        MRtrixTracks tracks;
+        CHECK( tracks.open( fileName ), what );
+        CHECK( !tracks.isScalars(), what );
+        CHECK( tracks.property( "timestamp" ) == "1.5", what );
+
+        std::vector<Fib> fibs;
+        CHECK( tracks.load( fibs ), what );
+        CHECK( fibs.size() == expected.size(), what << fibs.size() << expected.size() );
+        for ( unsigned int i = 0; i < fibs.size() && i < expected.size(); ++i )
+        {
+            bool same = fibs[i].length() * 3 == expected[i].size();
+            for ( unsigned int k = 0; k < fibs[i].length() && same; ++k )
+            {
+                QVector3D v = fibs[i].getVert( k );
+                same = v.x() == expected[i][k * 3] && v.y() == expected[i][k * 3 + 1] && v.z() == expected[i][k * 3 + 2];
+            }
+            CHECK( same, what << "track" << i );
+        }
+    }
+
+    void checkScalars( QString fileName, const Tracks& expected, QString what )
+    {
+        MRtrixTracks tracks;
+        CHECK( tracks.open( fileName ), what );
+        CHECK( tracks.isScalars(), what );
+
+        Tracks values;
+        CHECK( tracks.loadScalars( values ), what );
+        CHECK( values.size() == expected.size(), what << values.size() << expected.size() );
+        for ( unsigned int i = 0; i < values.size() && i < expected.size(); ++i )
+        {
+            bool same = values[i].size() * 3 == expected[i].size();
+            for ( unsigned int k = 0; k < values[i].size() && same; ++k )
+            {
+                same = values[i][k] == expected[i][k * 3];
+            }
+            CHECK( same, what << "track" << i );
+        }
+    }
+
+    // every datatype and every ending must decode to what the previous loop made of the Float32LE file,
+    // on one thread and with the chunks of several threads cutting through tracks
+    void checkDecoding( QString dir )
+    {
+        Tracks tracks;
+        for ( int i = 0; i < 500; ++i )
+        {
+            // some tracks are empty, their NaN follows the previous one
+            int length = ( i % 97 == 5 ) ? 0 : 1 + i % 61;
+            std::vector<float> track;
+            for ( int k = 0; k < length * 3; ++k )
+            {
+                track.push_back( next( -100.0f, 100.0f ) );
+            }
+            tracks.push_back( track );
+        }
+
+        int numThreads = GLFunctions::idealThreadCount;
+        int threads[] = { 1, 3, 8 };
+
+        for ( int e = 0; e < 4; ++e )
+        {
+            std::vector<float> values = records( tracks, e );
+            // the tracks with their NaN before the first Inf
+            unsigned int count = ( e == EARLY_INF ) ? tracks.size() / 2 : ( e == TERMINATED ? tracks.size() : tracks.size() - 1 );
+
+            int offset;
+            QByteArray reference = createFile( values, DATATYPES[0], false, count, offset );
+            Tracks expected = previousLoop( reference, offset );
+            CHECK( expected.size() == count, ENDINGS[e] << expected.size() );
+
+            for ( unsigned int d = 0; d < sizeof( DATATYPES ) / sizeof( DATATYPES[0] ); ++d )
+            {
+                QString tck = dir + "/tracks.tck";
+                QString tsf = dir + "/tracks.tsf";
+                CHECK( write( tck, createFile( values, DATATYPES[d], false, count, offset ) ), tck );
+                CHECK( write( tsf, createFile( values, DATATYPES[d], true, count, offset ) ), tsf );
+
+                for ( int t = 0; t < 3; ++t )
+                {
+                    GLFunctions::idealThreadCount = threads[t];
+                    QString what = QString( ENDINGS[e] ) + " " + DATATYPES[d].name + " " + QString::number( threads[t] ) + " threads";
+                    checkTracks( tck, expected, what );
+                    checkScalars( tsf, expected, what );
+                }
+            }
+        }
+        GLFunctions::idealThreadCount = numThreads;
+    }
+
+    // fibers with two data fields written by the writer must load as they were, the loader lists the
+    // scalar files by name, so the fields are in that order already; a scalar file of other tracks next
+    // to them is left out
+    void checkRoundTrip( QString dir )
+    {
+        std::vector<Fib> fibs = createFibers( 200, 45 );
+        QList<QString> dataNames;
+        dataNames << "curvature" << "fa";
+        DatasetFibers* ds = new DatasetFibers( QDir( "synthetic.tck" ), fibs, dataNames );
+
+        QString fileName = dir + "/saved.tck";
+        Writer( ds, QFileInfo( fileName ), "mrtrix tracks (*.tck)" ).save();
+
+        MRtrixTracks tracks;
+        CHECK( tracks.open( fileName ), fileName );
+        CHECK( tracks.property( "count" ).toUInt() == fibs.size(), fileName << tracks.property( "count" ) );
+        QByteArray timestamp = "timestamp: " + tracks.property( "timestamp" ).toLatin1();
+        tracks.close();
+
+        // scalars of the same shape left over from an earlier run differ only in their timestamp, they
+        // must not become a data field
+        QFile curvature( dir + "/saved_curvature.tsf" );
+        CHECK( curvature.open( QIODevice::ReadOnly ), curvature.fileName() );
+        QByteArray stale = curvature.readAll();
+        QByteArray other = timestamp;
+        other[other.size() - 1] = other.at( other.size() - 1 ) == '1' ? '2' : '1';
+        int pos = stale.indexOf( timestamp );
+        CHECK( pos > 0, curvature.fileName() << timestamp );
+        stale.replace( qMax( 0, pos ), timestamp.size(), other );
+        CHECK( write( dir + "/saved_old.tsf", stale ), dir + "/saved_old.tsf" );
+
+        Loader loader;
+        loader.setFilename( QDir( fileName ) );
+        CHECK( loader.load(), fileName );
+        DatasetFibers* back = loader.getNumDatasets() > 0 ? dynamic_cast<DatasetFibers*>( loader.getDataset() ) : 0;
+        CHECK( back, fileName );
+        if ( back )
+        {
+            CHECK( back->getDataNames() == dataNames, fileName << back->getDataNames() );
+            std::vector<Fib>* loaded = back->getFibs();
+            CHECK( loaded->size() == fibs.size(), fileName << loaded->size() );
+            for ( unsigned int i = 0; i < loaded->size() && i < fibs.size(); ++i )
+            {
+                const Fib& fib = loaded->at( i );
+                bool same = *fib.getVerts() == *fibs[i].getVerts() && fib.getCountDataFields() == fibs[i].getCountDataFields();
+                for ( unsigned int f = 0; f < fibs[i].getCountDataFields() && same; ++f )
+                {
+                    same = *fib.getDataField( f ) == *fibs[i].getDataField( f );
+                }
+                CHECK( same, fileName << "fiber" << i );
+            }
+            delete back;
+        }
+        delete ds;
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    // the dataset properties own widgets, the platform plugin is swapped as in batch mode
+    qputenv( "QT_QPA_PLATFORM", "minimal" );
+    QApplication app( argc, argv );
+    Models::init();
+
+    QTemporaryDir dir;
+    CHECK( dir.isValid(), dir.path() );
+
+    checkDecoding( dir.path() );
+    checkRoundTrip( dir.path() );
+
+    qDebug() << "mrtrixtracks_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
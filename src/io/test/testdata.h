@@ -0,0 +1,54 @@
+/*
+ * testdata.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TESTDATA_H_
+#define TESTDATA_H_
+
+#include "../../algos/fib.h"
+
+#include <QColor>
+#include <QVector3D>
+
+#include <vector>
+
+namespace
+{
+    // fixed sequence, so a failure can be reproduced
+    unsigned int seed = 4711;
+
+    float next( float min, float max )
+    {
+        seed = seed * 1664525u + 1013904223u;
+        return min + ( max - min ) * ( seed >> 8 ) / 16777216.0f;
+    }
+
+    // random walks of 2 to maxLength + 1 points in the box of a brain, the value of every point in [0,1],
+    // one curvature data field in [-3,5] and a custom color
+    std::vector<Fib> createFibers( int numFibers, int maxLength )
+    {
+        std::vector<Fib> fibs;
+        for ( int i = 0; i < numFibers; ++i )
+        {
+            Fib fib;
+            std::vector<float> curvature;
+            int length = 2 + i % maxLength;
+            QVector3D pos( next( 0.0f, 160.0f ), next( 0.0f, 200.0f ), next( 0.0f, 160.0f ) );
+            for ( int k = 0; k < length; ++k )
+            {
+                fib.addVert( pos, next( 0.0f, 1.0f ) );
+                curvature.push_back( next( -3.0f, 5.0f ) );
+                pos += QVector3D( next( -1.0f, 1.0f ), next( -1.0f, 1.0f ), next( -1.0f, 1.0f ) );
+            }
+            fib.addDataField( curvature );
+            fib.setCustomColor( QColor( (int)next( 0, 256 ), (int)next( 0, 256 ), (int)next( 0, 256 ) ) );
+            fibs.push_back( fib );
+        }
+        return fibs;
+    }
+}
+
+#endif /* TESTDATA_H_ */
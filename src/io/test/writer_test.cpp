@@ -0,0 +1,179 @@
+/*
+ * writer_test.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "check.h"
+#include "testdata.h"
+
+#include "../loadervtk.h"
+#include "../writer.h"
+
+#include "../../algos/fib.h"
+#include "../../data/models.h"
+#include "../../data/datasets/datasetfibers.h"
+
+#include <QApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <cstring>
+
+namespace
+{
+    // the value an ascii file holds for it
+    float ascii( float value )
+    {
+        return QByteArray::number( value, 'g', 6 ).toFloat();
+    }
+
+    void checkVTK( DatasetFibers* ds, QString fileName, bool binary )
+    {
+        std::vector<Fib>* fibs = ds->getFibs();
+        QList<QString> dataNames = ds->getDataNames();
+
+        LoaderVTK lv( fileName );
+        CHECK( lv.load(), fileName );
+        CHECK( lv.getPrimitiveType() == 2, fileName );
+        CHECK( lv.getNumLines() == (int)fibs->size(), fileName );
+
+        std::vector<float> points;
+        std::vector<int> lines;
+        std::vector<unsigned char> colors;
+        std::vector< std::vector<float> > data( dataNames.size() );
+        for ( unsigned int i = 0; i < fibs->size(); ++i )
+        {
+            const Fib& fib = fibs->at( i );
+            lines.push_back( fib.length() );
+            for ( unsigned int k = 0; k < fib.length(); ++k )
+            {
+                lines.push_back( points.size() / 3 );
+                QVector3D vert = fib.getVert( k );
+                points.push_back( binary ? vert.x() : ascii( vert.x() ) );
+                points.push_back( binary ? vert.y() : ascii( vert.y() ) );
+                points.push_back( binary ? vert.z() : ascii( vert.z() ) );
+                for ( int l = 0; l < dataNames.size(); ++l )
+                {
+                    float value = fib.getDataField( l )->at( k );
+                    data[l].push_back( binary ? value : ascii( value ) );
+                }
+            }
+            colors.push_back( fib.customColor().red() );
+            colors.push_back( fib.customColor().green() );
+            colors.push_back( fib.customColor().blue() );
+        }
+
+        // binary files hold the floats of the fibers bit for bit, ascii files their six digit text
+        std::vector<float>* loaded = lv.getPoints();
+        CHECK( loaded->size() == points.size() && memcmp( loaded->data(), points.data(), points.size() * sizeof( float ) ) == 0, fileName );
+        CHECK( lv.getLines() == lines, fileName );
+        CHECK( lv.getPrimitiveColors() == colors, fileName );
+
+        // the loader appends the cell arrays, CellColors among them, after the point data fields
+        std::vector< std::vector<float> > pointData = lv.getPointData();
+        QList<QString> pointDataNames = lv.getPointDataNames();
+        CHECK( pointData.size() >= data.size(), fileName );
+        for ( unsigned int l = 0; l < data.size() && l < pointData.size(); ++l )
+        {
+            CHECK( pointDataNames[l] == dataNames[l], fileName << pointDataNames[l] );
+            CHECK( pointData[l].size() == data[l].size() && memcmp( pointData[l].data(), data[l].data(), data[l].size() * sizeof( float ) ) == 0, fileName << dataNames[l] );
+        }
+    }
+
+    // there is no TrackVis loader in the tree, so the file is read back here against the header layout
+    // of http://www.trackvis.org/docs/?subsect=fileformat, points and per point scalars are checked
+    // against this reader and not against a loader of the application
+    void checkTrk( DatasetFibers* ds, QString fileName )
+    {
+        std::vector<Fib>* fibs = ds->getFibs();
+        QList<QString> dataNames = ds->getDataNames();
+
+        QFile file( fileName );
+        CHECK( file.open( QIODevice::ReadOnly ), fileName );
+        QByteArray bytes = file.readAll();
+        CHECK( bytes.size() > 1000, fileName );
+        if ( bytes.size() <= 1000 )
+        {
+            return;
+        }
+        CHECK( bytes.startsWith( QByteArray( "TRACK", 6 ) ), fileName );
+
+        QDataStream in( bytes );
+        in.setByteOrder( QDataStream::BigEndian );
+        in.setFloatingPointPrecision( QDataStream::SinglePrecision );
+
+        qint16 numScalars;
+        in.device()->seek( 36 );
+        in >> numScalars;
+        CHECK( numScalars == dataNames.size(), fileName );
+        for ( int i = 0; i < numScalars; ++i )
+        {
+            CHECK( QString( bytes.constData() + 38 + i * 20 ) == dataNames[i], fileName << i );
+        }
+
+        qint32 count, version, headerSize;
+        in.device()->seek( 988 );
+        in >> count >> version >> headerSize;
+        CHECK( count == (qint32)fibs->size(), fileName );
+        CHECK( version == 2, fileName );
+        CHECK( headerSize == 1000, fileName );
+
+        for ( unsigned int i = 0; i < fibs->size() && in.status() == QDataStream::Ok; ++i )
+        {
+            const Fib& fib = fibs->at( i );
+            qint32 length;
+            in >> length;
+            CHECK( length == (qint32)fib.length(), fileName << "fiber" << i );
+            if ( length != (qint32)fib.length() )
+            {
+                return;
+            }
+            for ( int k = 0; k < length; ++k )
+            {
+                float x, y, z;
+                in >> x >> y >> z;
+                CHECK( QVector3D( x, y, z ) == fib.getVert( k ), fileName << "fiber" << i << "point" << k );
+                for ( int l = 0; l < numScalars; ++l )
+                {
+                    float value;
+                    in >> value;
+                    CHECK( value == fib.getDataField( l )->at( k ), fileName << "fiber" << i << "point" << k << "scalar" << l );
+                }
+            }
+        }
+        CHECK( in.status() == QDataStream::Ok && in.atEnd(), fileName );
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    // the dataset properties own widgets, the platform plugin is swapped as in batch mode
+    qputenv( "QT_QPA_PLATFORM", "minimal" );
+    QApplication app( argc, argv );
+    Models::init();
+
+    QTemporaryDir dir;
+    CHECK( dir.isValid(), dir.path() );
+
+    DatasetFibers* ds = new DatasetFibers( QDir( "synthetic.fib" ), createFibers( 50, 37 ), { "fa", "curvature" } );
+
+    QString binaryFile = dir.path() + "/binary.vtk";
+    Writer( ds, QFileInfo( binaryFile ), "fib files binary(*.fib *.vtk)" ).save();
+    checkVTK( ds, binaryFile, true );
+
+    QString asciiFile = dir.path() + "/ascii.vtk";
+    Writer( ds, QFileInfo( asciiFile ), "fib files ascii (*.fib *.vtk)" ).save();
+    checkVTK( ds, asciiFile, false );
+
+    QString trkFile = dir.path() + "/tracks.trk";
+    Writer( ds, QFileInfo( trkFile ), "trackvis (*.trk)" ).save();
+    checkTrk( ds, trkFile );
+
+    delete ds;
+
+    qDebug() << "writer_test:" << failures << "failures";
+    return failures > 0 ? 1 : 0;
+}
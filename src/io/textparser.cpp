@@ -0,0 +1,571 @@
+/*
+ * textparser.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "textparser.h"
+#include "textparserthread.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDebug>
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                             1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    inline bool isDigit( char c )
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    inline bool isSpace( char c )
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    inline bool matchWord( const char* pos, const char* end, const char* word )
+    {
+        while ( *word )
+        {
+            if ( pos == end || ( *pos | 0x20 ) != *word )
+            {
+                return false;
+            }
+            ++pos;
+            ++word;
+        }
+        return true;
+    }
+}
+
+TextParser::TextParser( QString fileName ) :
+    m_fileName( fileName ),
+    m_data( 0 ),
+    m_size( 0 ),
+    m_firstLine( 0 ),
+    m_numColumns( 0 ),
+    m_floatOut( 0 ),
+    m_intOut( 0 ),
+    m_throughput( 0 )
+{
+}
+
+TextParser::~TextParser()
+{
+    close();
+}
+
+bool TextParser::open()
+{
+    m_file.setFileName( m_fileName );
+    if ( !m_file.open( QIODevice::ReadOnly ) )
+    {
+        qCritical() << "unable to open" << m_fileName;
+        return false;
+    }
+    m_size = m_file.size();
+    m_lineStarts.clear();
+
+    if ( m_size == 0 )
+    {
+        return true;
+    }
+
+    m_data = reinterpret_cast<const char*>( m_file.map( 0, m_size ) );
+    if ( !m_data )
+    {
+        // not mappable, e.g. a pipe or special file system
+        m_buffer = m_file.readAll();
+        m_data = m_buffer.constData();
+        m_size = m_buffer.size();
+    }
+
+    m_timer.start();
+
+    // index line starts, threads scan byte ranges and the results are concatenated in order
+    int numThreads = GLFunctions::idealThreadCount;
+    std::vector<qint64> begins;
+    std::vector<qint64> ends;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        begins.push_back( m_size * i / numThreads );
+        ends.push_back( m_size * ( i + 1 ) / numThreads );
+    }
+    runThreads( TextParserThread::LINE_INDEX, begins, ends );
+
+    m_lineStarts.push_back( 0 );
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        std::vector<qint64>& starts = m_threads[i]->m_lineStarts;
+        m_lineStarts.insert( m_lineStarts.end(), starts.begin(), starts.end() );
+    }
+    clearThreads();
+
+    stopTimer( m_size );
+    return true;
+}
+
+void TextParser::close()
+{
+    if ( m_file.isOpen() )
+    {
+        m_file.close();
+    }
+    m_buffer.clear();
+    m_data = 0;
+    m_size = 0;
+    m_lineStarts.clear();
+}
+
+int TextParser::numLines()
+{
+    return m_lineStarts.size();
+}
+
+qint64 TextParser::size()
+{
+    return m_size;
+}
+
+double TextParser::throughput()
+{
+    return m_throughput;
+}
+
+const char* TextParser::lineBegin( int id )
+{
+    if ( id >= (int)m_lineStarts.size() )
+    {
+        return m_data + m_size;
+    }
+    return m_data + m_lineStarts[id];
+}
+
+const char* TextParser::lineEnd( int id )
+{
+    const char* end = ( id + 1 < (int)m_lineStarts.size() ) ? m_data + m_lineStarts[id + 1] : m_data + m_size;
+    const char* begin = lineBegin( id );
+    while ( end > begin && ( end[-1] == '\n' || end[-1] == '\r' ) )
+    {
+        --end;
+    }
+    return end;
+}
+
+QString TextParser::line( int id )
+{
+    if ( id < 0 || id >= numLines() )
+    {
+        return QString();
+    }
+    const char* begin = lineBegin( id );
+    return QString::fromLatin1( begin, lineEnd( id ) - begin );
+}
+
+QStringList TextParser::tokens( int id )
+{
+    QStringList out;
+    if ( id < 0 || id >= numLines() )
+    {
+        return out;
+    }
+    const char* pos = lineBegin( id );
+    const char* end = lineEnd( id );
+    while ( pos < end )
+    {
+        while ( pos < end && isSpace( *pos ) )
+        {
+            ++pos;
+        }
+        const char* begin = pos;
+        while ( pos < end && !isSpace( *pos ) )
+        {
+            ++pos;
+        }
+        if ( pos > begin )
+        {
+            out.push_back( QString::fromLatin1( begin, pos - begin ) );
+        }
+    }
+    return out;
+}
+
+bool TextParser::entry( int id, QString& name, float* numbers, int numNumbers )
+{
+    name.clear();
+    if ( id < 0 || id >= numLines() )
+    {
+        return false;
+    }
+    const char* pos = lineBegin( id );
+    const char* end = lineEnd( id );
+    while ( pos < end && isSpace( *pos ) )
+    {
+        ++pos;
+    }
+    const char* begin = pos;
+    while ( pos < end && !isSpace( *pos ) )
+    {
+        ++pos;
+    }
+    name = QString::fromLatin1( begin, pos - begin );
+    if ( name.startsWith( "#" ) )
+    {
+        return true;
+    }
+
+    for ( int i = 0; i < numNumbers; ++i )
+    {
+        while ( pos < end && isSpace( *pos ) )
+        {
+            ++pos;
+        }
+        if ( pos == end )
+        {
+            break;
+        }
+        double value;
+        if ( !parseNumber( pos, end, value ) )
+        {
+            qCritical() << "parse error in" << m_fileName << "line" << id + 1;
+            return false;
+        }
+        numbers[i] = value;
+    }
+    return true;
+}
+
+void TextParser::lineChunks( int firstLine, int numLines, std::vector<qint64>& begins, std::vector<qint64>& ends )
+{
+    int numThreads = GLFunctions::idealThreadCount;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        begins.push_back( firstLine + (qint64)numLines * i / numThreads );
+        ends.push_back( firstLine + (qint64)numLines * ( i + 1 ) / numThreads );
+    }
+}
+
+void TextParser::runThreads( int pass, std::vector<qint64>& begins, std::vector<qint64>& ends )
+{
+    for ( unsigned int i = 0; i < begins.size(); ++i )
+    {
+        m_threads.push_back( new TextParserThread( this, pass, begins[i], ends[i] ) );
+    }
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->start();
+    }
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        m_threads[i]->wait();
+    }
+}
+
+bool TextParser::collectErrors()
+{
+    bool ok = true;
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        if ( !m_threads[i]->m_ok )
+        {
+            qCritical() << "parse error in" << m_fileName << "line" << m_threads[i]->m_errorLine + 1;
+            ok = false;
+            break;
+        }
+    }
+    return ok;
+}
+
+void TextParser::clearThreads()
+{
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        delete m_threads[i];
+    }
+    m_threads.clear();
+}
+
+void TextParser::stopTimer( qint64 bytes )
+{
+    double seconds = m_timer.nsecsElapsed() / 1e9;
+    m_throughput = ( seconds > 0 ) ? ( bytes / 1e6 ) / seconds : 0;
+}
+
+bool TextParser::columns( int firstLine, int numLines, int numColumns, std::vector<float>& out )
+{
+    if ( firstLine < 0 || numLines < 0 || firstLine + numLines > this->numLines() )
+    {
+        qCritical() << m_fileName << "has less lines than expected";
+        return false;
+    }
+    m_timer.start();
+    out.resize( (size_t)numLines * numColumns );
+    m_firstLine = firstLine;
+    m_numColumns = numColumns;
+    m_floatOut = out.data();
+
+    std::vector<qint64> begins;
+    std::vector<qint64> ends;
+    lineChunks( firstLine, numLines, begins, ends );
+    runThreads( TextParserThread::COLUMNS_FLOAT, begins, ends );
+    bool ok = collectErrors();
+    clearThreads();
+
+    stopTimer( lineBegin( firstLine + numLines ) - lineBegin( firstLine ) );
+    return ok;
+}
+
+bool TextParser::columns( int firstLine, int numLines, int numColumns, std::vector<int>& out )
+{
+    if ( firstLine < 0 || numLines < 0 || firstLine + numLines > this->numLines() )
+    {
+        qCritical() << m_fileName << "has less lines than expected";
+        return false;
+    }
+    m_timer.start();
+    out.resize( (size_t)numLines * numColumns );
+    m_firstLine = firstLine;
+    m_numColumns = numColumns;
+    m_intOut = out.data();
+
+    std::vector<qint64> begins;
+    std::vector<qint64> ends;
+    lineChunks( firstLine, numLines, begins, ends );
+    runThreads( TextParserThread::COLUMNS_INT, begins, ends );
+    bool ok = collectErrors();
+    clearThreads();
+
+    stopTimer( lineBegin( firstLine + numLines ) - lineBegin( firstLine ) );
+    return ok;
+}
+
+bool TextParser::numbers( int firstLine, int lastLine, std::vector<float>& out )
+{
+    out.clear();
+    if ( m_size == 0 )
+    {
+        return true;
+    }
+    m_timer.start();
+
+    qint64 begin = lineBegin( firstLine ) - m_data;
+    qint64 end = lineBegin( lastLine ) - m_data;
+
+    // byte ranges, moved forward to the next whitespace so no token is split
+    int numThreads = GLFunctions::idealThreadCount;
+    std::vector<qint64> begins;
+    std::vector<qint64> ends;
+    qint64 last = begin;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        qint64 split = ( i == numThreads - 1 ) ? end : begin + ( end - begin ) * ( i + 1 ) / numThreads;
+        split = qMax( split, last );
+        while ( split < end && !isSpace( m_data[split] ) )
+        {
+            ++split;
+        }
+        begins.push_back( last );
+        ends.push_back( split );
+        last = split;
+    }
+    runThreads( TextParserThread::NUMBERS, begins, ends );
+    bool ok = collectErrors();
+
+    size_t count = 0;
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        count += m_threads[i]->m_floats.size();
+    }
+    out.reserve( count );
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        out.insert( out.end(), m_threads[i]->m_floats.begin(), m_threads[i]->m_floats.end() );
+    }
+    clearThreads();
+
+    stopTimer( end - begin );
+    return ok;
+}
+
+bool TextParser::rows( int firstLine, int numLines, std::vector<double>& values, std::vector<unsigned int>& offsets )
+{
+    values.clear();
+    offsets.clear();
+    if ( firstLine < 0 || numLines < 0 || firstLine + numLines > this->numLines() )
+    {
+        qCritical() << m_fileName << "has less lines than expected";
+        return false;
+    }
+    m_timer.start();
+
+    std::vector<qint64> begins;
+    std::vector<qint64> ends;
+    lineChunks( firstLine, numLines, begins, ends );
+    runThreads( TextParserThread::ROWS, begins, ends );
+    bool ok = collectErrors();
+
+    offsets.reserve( numLines + 1 );
+    offsets.push_back( 0 );
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        std::vector<unsigned int>& counts = m_threads[i]->m_counts;
+        for ( unsigned int k = 0; k < counts.size(); ++k )
+        {
+            offsets.push_back( offsets.back() + counts[k] );
+        }
+    }
+    values.reserve( offsets.back() );
+    for ( unsigned int i = 0; i < m_threads.size(); ++i )
+    {
+        values.insert( values.end(), m_threads[i]->m_values.begin(), m_threads[i]->m_values.end() );
+    }
+    clearThreads();
+
+    stopTimer( lineBegin( firstLine + numLines ) - lineBegin( firstLine ) );
+    return ok;
+}
+
+bool TextParser::parseNumber( const char*& pos, const char* end, double& out )
+{
+    const char* p = pos;
+    bool negative = false;
+    if ( p < end && ( *p == '-' || *p == '+' ) )
+    {
+        negative = ( *p == '-' );
+        ++p;
+    }
+
+    if ( p < end && !isDigit( *p ) && *p != '.' )
+    {
+        if ( matchWord( p, end, "nan" ) )
+        {
+            out = std::numeric_limits<double>::quiet_NaN();
+            pos = p + 3;
+            return pos == end || isSpace( *pos );
+        }
+        if ( matchWord( p, end, "inf" ) )
+        {
+            out = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+            p += 3;
+            if ( matchWord( p, end, "inity" ) )
+            {
+                p += 5;
+            }
+            pos = p;
+            return pos == end || isSpace( *pos );
+        }
+        return false;
+    }
+
+    // up to 19 significant digits fit into the mantissa, further digits only shift the exponent
+    quint64 mantissa = 0;
+    int exponent = 0;
+    int digits = 0;
+    bool any = false;
+    while ( p < end && isDigit( *p ) )
+    {
+        if ( digits < 19 )
+        {
+            mantissa = mantissa * 10 + ( *p - '0' );
+            if ( mantissa )
+            {
+                ++digits;
+            }
+        }
+        else
+        {
+            ++exponent;
+        }
+        ++p;
+        any = true;
+    }
+    if ( p < end && *p == '.' )
+    {
+        ++p;
+        while ( p < end && isDigit( *p ) )
+        {
+            if ( digits < 19 )
+            {
+                mantissa = mantissa * 10 + ( *p - '0' );
+                --exponent;
+                if ( mantissa )
+                {
+                    ++digits;
+                }
+            }
+            ++p;
+            any = true;
+        }
+    }
+    if ( !any )
+    {
+        return false;
+    }
+    if ( p < end && ( *p == 'e' || *p == 'E' ) )
+    {
+        const char* e = p + 1;
+        bool negativeExp = false;
+        if ( e < end && ( *e == '-' || *e == '+' ) )
+        {
+            negativeExp = ( *e == '-' );
+            ++e;
+        }
+        if ( e < end && isDigit( *e ) )
+        {
+            int exp = 0;
+            while ( e < end && isDigit( *e ) )
+            {
+                if ( exp < 10000 )
+                {
+                    exp = exp * 10 + ( *e - '0' );
+                }
+                ++e;
+            }
+            exponent += negativeExp ? -exp : exp;
+            p = e;
+        }
+    }
+    if ( p < end && !isSpace( *p ) )
+    {
+        return false;
+    }
+
+    double value = (double)mantissa;
+    if ( exponent < 0 )
+    {
+        value = ( exponent >= -22 ) ? value / POW10[-exponent] : value * std::pow( 10.0, exponent );
+    }
+    else if ( exponent > 0 )
+    {
+        value = ( exponent <= 22 ) ? value * POW10[exponent] : value * std::pow( 10.0, exponent );
+    }
+    out = negative ? -value : value;
+    pos = p;
+    return true;
+}
+
+double TextParser::benchmark( QString fileName )
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    TextParser parser( fileName );
+    if ( !parser.open() )
+    {
+        return 0;
+    }
+    std::vector<float> values;
+    parser.numbers( 0, parser.numLines(), values );
+
+    double seconds = timer.nsecsElapsed() / 1e9;
+    double mbs = ( seconds > 0 ) ? ( parser.size() / 1e6 ) / seconds : 0;
+    qDebug() << "parsed" << values.size() << "numbers," << parser.size() / 1e6 << "MB in" << seconds << "s:" << mbs << "MB/s";
+    return mbs;
+}
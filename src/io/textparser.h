@@ -0,0 +1,93 @@
+/*
+ * textparser.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TEXTPARSER_H_
+#define TEXTPARSER_H_
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+class TextParserThread;
+
+/*
+ * Locale free parser for whitespace separated ascii number files. The file is memory mapped,
+ * line starts are indexed in parallel and number blocks are parsed in chunks split at line or
+ * whitespace boundaries, one chunk per thread.
+ */
+class TextParser
+{
+    friend class TextParserThread;
+
+public:
+    TextParser( QString fileName );
+    virtual ~TextParser();
+
+    bool open();
+    void close();
+
+    int numLines();
+    QString line( int id );
+    qint64 size();
+
+    // whitespace separated tokens of a line, for the file lists and headers of set files
+    QStringList tokens( int id );
+    // a name followed by up to numNumbers numbers, e.g. a surface and its offset in a set file; numbers
+    // missing at the end of the line keep their value, tokens after them are ignored, of comment lines
+    // starting with # only the name is read
+    bool entry( int id, QString& name, float* numbers, int numNumbers );
+
+    // fixed number of columns per line, extra tokens are ignored, row major output
+    bool columns( int firstLine, int numLines, int numColumns, std::vector<float>& out );
+    bool columns( int firstLine, int numLines, int numColumns, std::vector<int>& out );
+
+    // all numbers between firstLine and lastLine (exclusive), ignoring line structure
+    bool numbers( int firstLine, int lastLine, std::vector<float>& out );
+
+    // variable number of values per line, line i owns values[offsets[i]] to values[offsets[i+1]]
+    bool rows( int firstLine, int numLines, std::vector<double>& values, std::vector<unsigned int>& offsets );
+
+    // MB/s of the last parsing call
+    double throughput();
+
+    static bool parseNumber( const char*& pos, const char* end, double& out );
+    static double benchmark( QString fileName );
+
+private:
+    void runThreads( int pass, std::vector<qint64>& begins, std::vector<qint64>& ends );
+    bool collectErrors();
+    void clearThreads();
+    void lineChunks( int firstLine, int numLines, std::vector<qint64>& begins, std::vector<qint64>& ends );
+    void stopTimer( qint64 bytes );
+
+    const char* lineBegin( int id );
+    const char* lineEnd( int id );
+
+    QString m_fileName;
+    QFile m_file;
+    QByteArray m_buffer;
+    const char* m_data;
+    qint64 m_size;
+
+    std::vector<qint64> m_lineStarts;
+
+    // output targets of the current pass
+    std::vector<TextParserThread*> m_threads;
+    int m_firstLine;
+    int m_numColumns;
+    float* m_floatOut;
+    int* m_intOut;
+
+    QElapsedTimer m_timer;
+    double m_throughput;
+};
+
+#endif /* TEXTPARSER_H_ */
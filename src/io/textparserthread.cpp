@@ -0,0 +1,177 @@
+/*
+ * textparserthread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "textparserthread.h"
+#include "textparser.h"
+
+#include "../algos/trace.h"
+
+#include <algorithm>
+
+namespace
+{
+    inline bool isSpace( char c )
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+}
+
+TextParserThread::TextParserThread( TextParser* parser, int pass, qint64 begin, qint64 end ) :
+    m_parser( parser ),
+    m_pass( pass ),
+    m_begin( begin ),
+    m_end( end ),
+    m_ok( true ),
+    m_errorLine( -1 )
+{
+}
+
+TextParserThread::~TextParserThread()
+{
+}
+
+void TextParserThread::run()
+{
+    TRACE_SCOPE( "TextParserThread::run" );
+    switch ( m_pass )
+    {
+        case LINE_INDEX:
+            lineIndex();
+            break;
+        case COLUMNS_FLOAT:
+        case COLUMNS_INT:
+            columns();
+            break;
+        case NUMBERS:
+            numbers();
+            break;
+        case ROWS:
+            rows();
+            break;
+    }
+}
+
+void TextParserThread::fail( int line )
+{
+    if ( m_ok )
+    {
+        m_ok = false;
+        m_errorLine = line;
+    }
+}
+
+void TextParserThread::lineIndex()
+{
+    const char* data = m_parser->m_data;
+    qint64 size = m_parser->m_size;
+    for ( qint64 i = m_begin; i < m_end; ++i )
+    {
+        if ( data[i] == '\n' && i + 1 < size )
+        {
+            m_lineStarts.push_back( i + 1 );
+        }
+    }
+}
+
+void TextParserThread::columns()
+{
+    int numColumns = m_parser->m_numColumns;
+    int firstLine = m_parser->m_firstLine;
+    double value;
+
+    for ( qint64 l = m_begin; l < m_end && m_ok; ++l )
+    {
+        const char* pos = m_parser->lineBegin( l );
+        const char* end = m_parser->lineEnd( l );
+        size_t out = (size_t)( l - firstLine ) * numColumns;
+
+        for ( int c = 0; c < numColumns; ++c )
+        {
+            while ( pos < end && isSpace( *pos ) )
+            {
+                ++pos;
+            }
+            if ( pos == end || !TextParser::parseNumber( pos, end, value ) )
+            {
+                fail( l );
+                break;
+            }
+            if ( m_pass == COLUMNS_FLOAT )
+            {
+                m_parser->m_floatOut[out + c] = value;
+            }
+            else
+            {
+                m_parser->m_intOut[out + c] = (int)value;
+            }
+        }
+    }
+}
+
+void TextParserThread::numbers()
+{
+    const char* pos = m_parser->m_data + m_begin;
+    const char* end = m_parser->m_data + m_end;
+    double value;
+
+    while ( pos < end )
+    {
+        while ( pos < end && isSpace( *pos ) )
+        {
+            ++pos;
+        }
+        if ( pos == end )
+        {
+            break;
+        }
+        if ( !TextParser::parseNumber( pos, end, value ) )
+        {
+            // report the line of the offending token
+            qint64 offset = pos - m_parser->m_data;
+            std::vector<qint64>& starts = m_parser->m_lineStarts;
+            fail( std::upper_bound( starts.begin(), starts.end(), offset ) - starts.begin() - 1 );
+            break;
+        }
+        m_floats.push_back( value );
+    }
+}
+
+void TextParserThread::rows()
+{
+    double value;
+    for ( qint64 l = m_begin; l < m_end && m_ok; ++l )
+    {
+        const char* pos = m_parser->lineBegin( l );
+        const char* end = m_parser->lineEnd( l );
+        unsigned int count = 0;
+        size_t lineStart = m_values.size();
+        while ( pos < end )
+        {
+            while ( pos < end && isSpace( *pos ) )
+            {
+                ++pos;
+            }
+            if ( pos == end )
+            {
+                break;
+            }
+            if ( !TextParser::parseNumber( pos, end, value ) )
+            {
+                // keep values and counts consistent, the broken line is dropped
+                m_values.resize( lineStart );
+                fail( l );
+                break;
+            }
+            m_values.push_back( value );
+            ++count;
+        }
+        if ( m_ok )
+        {
+            m_counts.push_back( count );
+        }
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * textparserthread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TEXTPARSERTHREAD_H_
+#define TEXTPARSERTHREAD_H_
+
+#include <QThread>
+
+#include <vector>
+
+class TextParser;
+
+class TextParserThread : public QThread
+{
+    friend class TextParser;
+
+public:
+    enum Pass
+    {
+        LINE_INDEX,     // byte range
+        COLUMNS_FLOAT,  // line range
+        COLUMNS_INT,    // line range
+        NUMBERS,        // byte range
+        ROWS            // line range
+    };
+
+    TextParserThread( TextParser* parser, int pass, qint64 begin, qint64 end );
+    virtual ~TextParserThread();
+
+private:
+    void run();
+
+    void lineIndex();
+    void columns();
+    void numbers();
+    void rows();
+
+    void fail( int line );
+
+    TextParser* m_parser;
+    int m_pass;
+    qint64 m_begin;
+    qint64 m_end;
+
+    bool m_ok;
+    int m_errorLine;
+
+    std::vector<qint64> m_lineStarts;
+    std::vector<float> m_floats;
+    std::vector<double> m_values;
+    std::vector<unsigned int> m_counts;
+};
+
+#endif /* TEXTPARSERTHREAD_H_ */
@@ -0,0 +1,341 @@
+/*
+ * timeseriescache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "timeseriescache.h"
+#include "timeseriescachethread.h"
+#include "textparser.h"
+
+#include "../gui/gl/glfunctions.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+    const char CACHE_MAGIC[8] = { 'B', 'G', 'L', 'T', 'S', 'E', 'R', 0 };
+    const quint32 CACHE_VERSION = 1;
+
+    inline bool isSpace( char c )
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+}
+
+TimeSeriesCache::TimeSeriesCache( QString setFileName, std::vector<QString> frameFiles, unsigned int numVerts ) :
+    m_setFileName( setFileName ),
+    m_cacheFileName( setFileName + ".cache" ),
+    m_frameFiles( frameFiles ),
+    m_numVerts( numVerts ),
+    m_numFrames( 0 ),
+    m_min( 0 ),
+    m_max( 0 ),
+    m_frames( 0 ),
+    m_series( 0 )
+{
+}
+
+TimeSeriesCache::~TimeSeriesCache()
+{
+    if ( m_cacheFile.isOpen() )
+    {
+        m_cacheFile.close();
+    }
+}
+
+bool TimeSeriesCache::load()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if ( mapCache() )
+    {
+        qDebug() << "mapped time series cache" << m_cacheFileName << m_numFrames << "frames in" << timer.elapsed() << "ms";
+        return true;
+    }
+
+    if ( !parseFrames() )
+    {
+        return false;
+    }
+    qDebug() << "parsed" << m_numFrames << "time series frames in" << timer.elapsed() << "ms";
+
+    if ( writeCache() && mapCache() )
+    {
+        std::vector<float>().swap( m_frameData );
+        std::vector<float>().swap( m_seriesData );
+        return true;
+    }
+
+    qDebug() << "unable to write time series cache" << m_cacheFileName << ", keeping data in memory";
+    m_frames = m_frameData.empty() ? 0 : &m_frameData[0];
+    m_series = m_seriesData.empty() ? 0 : &m_seriesData[0];
+    return true;
+}
+
+unsigned int TimeSeriesCache::numVerts()
+{
+    return m_numVerts;
+}
+
+unsigned int TimeSeriesCache::numFrames()
+{
+    return m_numFrames;
+}
+
+float TimeSeriesCache::min()
+{
+    return m_min;
+}
+
+float TimeSeriesCache::max()
+{
+    return m_max;
+}
+
+const float* TimeSeriesCache::frames()
+{
+    return m_frames;
+}
+
+const float* TimeSeriesCache::series()
+{
+    return m_series;
+}
+
+void TimeSeriesCache::fileKeys( std::vector<FileKey>& keys )
+{
+    keys.resize( m_frameFiles.size() + 1 );
+    for ( unsigned int i = 0; i < keys.size(); ++i )
+    {
+        QFileInfo fi( i == 0 ? m_setFileName : m_frameFiles[i - 1] );
+        if ( fi.exists() )
+        {
+            keys[i].modified = fi.lastModified().toMSecsSinceEpoch();
+            keys[i].size = fi.size();
+        }
+        else
+        {
+            keys[i].modified = -1;
+            keys[i].size = -1;
+        }
+    }
+}
+
+bool TimeSeriesCache::mapCache()
+{
+    m_cacheFile.setFileName( m_cacheFileName );
+    if ( !m_cacheFile.open( QIODevice::ReadOnly ) )
+    {
+        return false;
+    }
+
+    std::vector<FileKey> keys;
+    fileKeys( keys );
+
+    qint64 size = m_cacheFile.size();
+    qint64 keysSize = keys.size() * sizeof( FileKey );
+    const uchar* data = 0;
+    if ( size >= (qint64)sizeof( Header ) + keysSize )
+    {
+        data = m_cacheFile.map( 0, size );
+    }
+    if ( data == 0 )
+    {
+        m_cacheFile.close();
+        return false;
+    }
+
+    Header header;
+    memcpy( &header, data, sizeof( Header ) );
+
+    qint64 valuesSize = (qint64)header.numFrames * header.numVerts * sizeof( float );
+    bool valid = memcmp( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) ) == 0 &&
+                 header.version == CACHE_VERSION &&
+                 header.numVerts == m_numVerts &&
+                 header.numFiles == keys.size() &&
+                 size == (qint64)sizeof( Header ) + keysSize + 2 * valuesSize &&
+                 memcmp( data + sizeof( Header ), &keys[0], keysSize ) == 0;
+
+    if ( !valid )
+    {
+        m_cacheFile.unmap( const_cast<uchar*>( data ) );
+        m_cacheFile.close();
+        return false;
+    }
+
+    m_numFrames = header.numFrames;
+    m_min = header.min;
+    m_max = header.max;
+    m_frames = reinterpret_cast<const float*>( data + sizeof( Header ) + keysSize );
+    m_series = m_frames + (qint64)m_numFrames * m_numVerts;
+    return true;
+}
+
+bool TimeSeriesCache::parseFrames()
+{
+    m_parsed.clear();
+    m_parsed.resize( m_frameFiles.size() );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    std::vector<TimeSeriesCacheThread*> threads;
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads.push_back( new TimeSeriesCacheThread( this, m_frameFiles.size(), i ) );
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->start();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        threads[i]->wait();
+    }
+    for ( int i = 0; i < numThreads; ++i )
+    {
+        delete threads[i];
+    }
+
+    m_numFrames = 0;
+    for ( unsigned int i = 0; i < m_parsed.size(); ++i )
+    {
+        if ( !m_parsed[i].empty() )
+        {
+            ++m_numFrames;
+        }
+    }
+
+    m_frameData.resize( (size_t)m_numFrames * m_numVerts );
+    m_min = std::numeric_limits<float>::max();
+    m_max = -std::numeric_limits<float>::max();
+
+    unsigned int frame = 0;
+    for ( unsigned int i = 0; i < m_parsed.size(); ++i )
+    {
+        if ( m_parsed[i].empty() )
+        {
+            continue;
+        }
+        float* dest = &m_frameData[(size_t)frame * m_numVerts];
+        for ( unsigned int k = 0; k < m_numVerts; ++k )
+        {
+            dest[k] = m_parsed[i][k];
+            m_min = qMin( m_min, dest[k] );
+            m_max = qMax( m_max, dest[k] );
+        }
+        std::vector<float>().swap( m_parsed[i] );
+        ++frame;
+    }
+    m_parsed.clear();
+
+    m_seriesData.resize( m_frameData.size() );
+    for ( unsigned int k = 0; k < m_numVerts; ++k )
+    {
+        float* dest = &m_seriesData[(size_t)k * m_numFrames];
+        for ( unsigned int f = 0; f < m_numFrames; ++f )
+        {
+            dest[f] = m_frameData[(size_t)f * m_numVerts + k];
+        }
+    }
+
+    return m_numFrames > 0;
+}
+
+void TimeSeriesCache::parseFrame( unsigned int id )
+{
+    QFile file( m_frameFiles[id] );
+    if ( !file.open( QIODevice::ReadOnly ) )
+    {
+        qCritical() << "data file unreadable, skipping" << m_frameFiles[id];
+        return;
+    }
+
+    qint64 size = file.size();
+    QByteArray buffer;
+    const char* pos = reinterpret_cast<const char*>( file.map( 0, size ) );
+    if ( pos == 0 )
+    {
+        buffer = file.readAll();
+        pos = buffer.constData();
+    }
+    const char* end = pos + size;
+
+    std::vector<float>& out = m_parsed[id];
+    out.reserve( m_numVerts );
+
+    double value;
+    while ( true )
+    {
+        while ( pos < end && isSpace( *pos ) )
+        {
+            ++pos;
+        }
+        if ( pos == end )
+        {
+            break;
+        }
+        if ( !TextParser::parseNumber( pos, end, value ) )
+        {
+            qCritical() << "error while reading data file, skipping" << m_frameFiles[id];
+            out.clear();
+            return;
+        }
+        out.push_back( value );
+    }
+
+    if ( out.size() != m_numVerts )
+    {
+        qCritical() << "data file" << m_frameFiles[id] << "has" << out.size() << "values, expected" << m_numVerts << ", skipping";
+        out.clear();
+    }
+}
+
+bool TimeSeriesCache::writeCache()
+{
+    std::vector<FileKey> keys;
+    fileKeys( keys );
+
+    Header header;
+    memcpy( header.magic, CACHE_MAGIC, sizeof( CACHE_MAGIC ) );
+    header.version = CACHE_VERSION;
+    header.numVerts = m_numVerts;
+    header.numFrames = m_numFrames;
+    header.numFiles = keys.size();
+    header.min = m_min;
+    header.max = m_max;
+
+    // write to a temporary file first so an interrupted write never leaves a valid looking cache
+    QString tmpName = m_cacheFileName + ".tmp";
+    QFile file( tmpName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        return false;
+    }
+
+    qint64 valuesSize = (qint64)m_frameData.size() * sizeof( float );
+    bool ok = file.write( reinterpret_cast<const char*>( &header ), sizeof( Header ) ) == sizeof( Header );
+    ok = ok && file.write( reinterpret_cast<const char*>( &keys[0] ), keys.size() * sizeof( FileKey ) ) == (qint64)( keys.size() * sizeof( FileKey ) );
+    if ( valuesSize > 0 )
+    {
+        ok = ok && file.write( reinterpret_cast<const char*>( &m_frameData[0] ), valuesSize ) == valuesSize;
+        ok = ok && file.write( reinterpret_cast<const char*>( &m_seriesData[0] ), valuesSize ) == valuesSize;
+    }
+    file.close();
+
+    if ( !ok )
+    {
+        QFile::remove( tmpName );
+        return false;
+    }
+    QFile::remove( m_cacheFileName );
+    return QFile::rename( tmpName, m_cacheFileName );
+}
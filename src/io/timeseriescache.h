@@ -0,0 +1,86 @@
+/*
+ * timeseriescache.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TIMESERIESCACHE_H_
+#define TIMESERIESCACHE_H_
+
+#include <QFile>
+#include <QString>
+
+#include <vector>
+
+class TimeSeriesCacheThread;
+
+/*
+ * Assembles the numbered frame files of a time series set into one block of floats. The result is
+ * written to a binary sidecar next to the set file, keyed by modification time and size of the set
+ * and all frame files, and memory mapped directly on subsequent opens.
+ */
+class TimeSeriesCache
+{
+    friend class TimeSeriesCacheThread;
+
+public:
+    TimeSeriesCache( QString setFileName, std::vector<QString> frameFiles, unsigned int numVerts );
+    virtual ~TimeSeriesCache();
+
+    bool load();
+
+    unsigned int numVerts();
+    unsigned int numFrames();
+    float min();
+    float max();
+
+    // frame major, numVerts values per frame
+    const float* frames();
+    // vertex major, numFrames values per vertex
+    const float* series();
+
+private:
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 numVerts;
+        quint32 numFrames;
+        quint32 numFiles;
+        float min;
+        float max;
+    };
+
+    struct FileKey
+    {
+        qint64 modified;
+        qint64 size;
+    };
+
+    void fileKeys( std::vector<FileKey>& keys );
+    bool mapCache();
+    bool parseFrames();
+    void parseFrame( unsigned int id );
+    bool writeCache();
+
+    QString m_setFileName;
+    QString m_cacheFileName;
+    std::vector<QString> m_frameFiles;
+
+    unsigned int m_numVerts;
+    unsigned int m_numFrames;
+    float m_min;
+    float m_max;
+
+    QFile m_cacheFile;
+    const float* m_frames;
+    const float* m_series;
+
+    // parse results, only kept when the cache can't be written
+    std::vector<std::vector<float> > m_parsed;
+    std::vector<float> m_frameData;
+    std::vector<float> m_seriesData;
+};
+
+#endif /* TIMESERIESCACHE_H_ */
@@ -0,0 +1,37 @@
+/*
+ * timeseriescachethread.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#include "timeseriescachethread.h"
+#include "timeseriescache.h"
+
+#include "../algos/trace.h"
+
+#include "../gui/gl/glfunctions.h"
+
+TimeSeriesCacheThread::TimeSeriesCacheThread( TimeSeriesCache* cache, unsigned int numFrames, int id ) :
+    m_cache( cache ),
+    m_numFrames( numFrames ),
+    m_id( id )
+{
+}
+
+TimeSeriesCacheThread::~TimeSeriesCacheThread()
+{
+}
+
+void TimeSeriesCacheThread::run()
+{
+    TRACE_SCOPE( "TimeSeriesCacheThread::run" );
+
+    int numThreads = GLFunctions::idealThreadCount;
+
+    // frames are small and equally sized, interleaving keeps all threads busy when a few fail early
+    for ( unsigned int i = m_id; i < m_numFrames; i += numThreads )
+    {
+        m_cache->parseFrame( i );
+    }
+}
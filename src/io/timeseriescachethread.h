@@ -0,0 +1,29 @@
+/*
+ * timeseriescachethread.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: schurade
+ */
+
+#ifndef TIMESERIESCACHETHREAD_H_
+#define TIMESERIESCACHETHREAD_H_
+
+#include <QThread>
+
+class TimeSeriesCache;
+
+class TimeSeriesCacheThread : public QThread
+{
+public:
+    TimeSeriesCacheThread( TimeSeriesCache* cache, unsigned int numFrames, int id );
+    virtual ~TimeSeriesCacheThread();
+
+private:
+    void run();
+
+    TimeSeriesCache* m_cache;
+    unsigned int m_numFrames;
+    int m_id;
+};
+
+#endif /* TIMESERIESCACHETHREAD_H_ */
@@ -5,6 +5,9 @@
  * @author Ralph Schurade
  */
 #include "writer.h"
+#include "fibercontainer.h"
+#include "mrtrixtracks.h"
+#include "streamwriter.h"
 #include "writervtk.h"
 
 #include "../data/datasets/dataset.h"
@@ -27,7 +30,11 @@
 
 #include <QBuffer>
 #include <QDebug>
+#include <QDir>
 #include <QImage>
+#include <QRegExp>
+
+#include <cstring>
 
 Writer::Writer( Dataset* dataset, QFileInfo fileName, QString filter ) :
     m_dataset( dataset ),
@@ -300,6 +307,14 @@ bool Writer::save()
             {
                 saveFibTrk();
             }
+            else if ( m_filter.endsWith( "(*.bgf)" ) )
+            {
+                saveFibContainer();
+            }
+            else if ( m_filter.endsWith( "(*.tck)" ) )
+            {
+                saveFibMRtrix();
+            }
             else
             {
                 WriterVTK* vtkWriter = new WriterVTK( m_dataset, m_fileName.absoluteFilePath(), m_filter );
@@ -1024,64 +1039,140 @@ void Writer::saveFibTrk()
     if ( dynamic_cast<DatasetFibers*>( m_dataset ) )
     {
         DatasetFibers* dsf = dynamic_cast<DatasetFibers*>( m_dataset );
+        std::vector<Fib>* fibs = dsf->getFibs();
+
+        // data fields go along as per point scalars, the format takes up to 10
+        QList<QString> dataNames = dsf->getDataNames();
+        int numScalars = ( dataNames[0] == "no data" ) ? 0 : qMin( 10, dataNames.size() );
 
         QFile file( m_fileName.absoluteFilePath() );
-        file.open( QIODevice::WriteOnly );
-        QDataStream out( &file );
-        out.setFloatingPointPrecision( QDataStream::SinglePrecision );
-        const char* s = const_cast<char *>("TRACK");
-
-        out.writeRawData( s, 6 ); // ID string for track file. The first 5 characters must be "TRACK".
-        out << (short) 128; // Dimension of the image volume.
-        out << (short) 128;
-        out << (short) 128;
-        out << (float) 1.0f; // Voxel size of the image volume.
-        out << (float) 1.0f;
-        out << (float) 1.0f;
-        out << (float) 0.0f; // Origin of the image volume. This field is not yet being used by TrackVis. That means the origin is always (0, 0, 0).
-        out << (float) 0.0f;
-        out << (float) 0.0f;
-        out << (short) 0; // Number of scalars saved at each track point (besides x, y and z coordinates).
-        for ( int i = 0; i < 200; ++i )
+        if ( !file.open( QIODevice::WriteOnly ) )
         {
-            out << (qint8)0; // Name of each scalar. Can not be longer than 20 characters each. Can only store up to 10 names.
+            qCritical() << "Error writing " << m_fileName.absoluteFilePath();
+            return;
         }
-        out << (short) 0; // Number of properties saved at each track.
-        for ( int i = 0; i < 200; ++i )
+        StreamWriter out( &file );
+
+        char id[6] = { 'T', 'R', 'A', 'C', 'K', 0 };
+        out.writeRaw( id, 6 ); // ID string for track file. The first 5 characters must be "TRACK".
+        out.writeInt16( 128 ); // Dimension of the image volume.
+        out.writeInt16( 128 );
+        out.writeInt16( 128 );
+        out.writeFloat( 1.0f ); // Voxel size of the image volume.
+        out.writeFloat( 1.0f );
+        out.writeFloat( 1.0f );
+        out.writeFloat( 0.0f ); // Origin of the image volume. This field is not yet being used by TrackVis. That means the origin is always (0, 0, 0).
+        out.writeFloat( 0.0f );
+        out.writeFloat( 0.0f );
+        out.writeInt16( numScalars ); // Number of scalars saved at each track point (besides x, y and z coordinates).
+        char names[200] = { 0 };
+        for ( int i = 0; i < numScalars; ++i )
         {
-            out << (qint8)0; // Name of each property. Can not be longer than 20 characters each. Can only store up to 10 names.
+            QByteArray name = dataNames[i].toLatin1().left( 19 );
+            memcpy( names + i * 20, name.constData(), name.size() );
         }
+        out.writeRaw( names, 200 ); // Name of each scalar. Can not be longer than 20 characters each. Can only store up to 10 names.
+        out.writeInt16( 0 ); // Number of properties saved at each track.
+        char zeros[444] = { 0 };
+        out.writeRaw( zeros, 200 ); // Name of each property. Can not be longer than 20 characters each. Can only store up to 10 names.
         for ( int i = 0; i < 16; ++i )
         {
-            out << (float)0; // 4x4 matrix for voxel to RAS (crs to xyz) transformation. If vox_to_ras[3][3] is 0, it means the matrix is not recorded. This field is added from version 2.
+            out.writeFloat( 0.0f ); // 4x4 matrix for voxel to RAS (crs to xyz) transformation. If vox_to_ras[3][3] is 0, it means the matrix is not recorded. This field is added from version 2.
         }
-        for ( int i = 0; i < 444; ++i )
+        out.writeRaw( zeros, 444 ); // Reserved space for future version.
+        out.writeRaw( zeros, 40 ); // see documentation in link above
+        out.writeInt32( fibs->size() ); // Number of tracks stored in this track file. 0 means the number was NOT stored.
+        out.writeInt32( 2 ); // Version number. Current version is 2.
+        out.writeInt32( 1000 ); // Size of the header. Used to determine byte swap. Should be 1000.
+
+        for ( unsigned int i = 0; i < fibs->size(); ++i )
         {
-            out << (qint8)0; // Reserved space for future version.
+            const Fib& fib = fibs->at( i );
+            const std::vector<QVector3D>* verts = fib.getVerts();
+            out.writeInt32( verts->size() );
+            for ( unsigned int k = 0; k < verts->size(); ++k )
+            {
+                out.writeFloat( verts->at( k ).x() );
+                out.writeFloat( verts->at( k ).y() );
+                out.writeFloat( verts->at( k ).z() );
+                for ( int l = 0; l < numScalars; ++l )
+                {
+                    const std::vector<float>* field = fib.getDataField( l );
+                    out.writeFloat( ( field && k < field->size() ) ? field->at( k ) : 0.0f );
+                }
+            }
         }
-        for ( int i = 0; i < 40; ++i )
+
+        if ( !out.flush() )
         {
-            out << (qint8)0; // see documentation in link above
+            qCritical() << "Error writing " << m_fileName.absoluteFilePath();
         }
-        out << (qint32)dsf->numLines(); // Number of tracks stored in this track file. 0 means the number was NOT stored.
-        out << (qint32)2; // Version number. Current version is 2.
-        out << (qint32)1000; // Size of the header. Used to determine byte swap. Should be 1000.
+        file.close();
+    }
+}
 
-        std::vector<Fib>* fibs = dsf->getFibs();
+void Writer::saveFibContainer()
+{
+    DatasetFibers* dsf = dynamic_cast<DatasetFibers*>( m_dataset );
+    if ( !dsf )
+    {
+        return;
+    }
+    FiberContainer container;
+    if ( m_filter.contains( "half" ) )
+    {
+        container.setQuantisation( FiberContainer::HALF );
+    }
+    else if ( m_filter.contains( "8 bit" ) )
+    {
+        container.setQuantisation( FiberContainer::BYTE );
+    }
+    container.save( m_fileName.absoluteFilePath(), *dsf->getFibs(), dsf->getDataNames() );
+}
+
+void Writer::saveFibMRtrix()
+{
+    DatasetFibers* dsf = dynamic_cast<DatasetFibers*>( m_dataset );
+    if ( !dsf )
+    {
+        return;
+    }
+    std::vector<Fib>* fibs = dsf->getFibs();
+    MRtrixTracks tracks;
+    if ( !tracks.create( m_fileName.absoluteFilePath() ) )
+    {
+        return;
+    }
+    for ( unsigned int i = 0; i < fibs->size(); ++i )
+    {
+        tracks.append( fibs->at( i ) );
+    }
+    if ( !tracks.finish() )
+    {
+        return;
+    }
 
+    // every data field goes into a track scalar file next to it, named like the loader expects
+    QList<QString> dataNames = dsf->getDataNames();
+    if ( dataNames[0] == "no data" )
+    {
+        return;
+    }
+    QString timestamp = tracks.property( "timestamp" );
+    for ( int f = 0; f < dataNames.size(); ++f )
+    {
+        QString name = dataNames[f];
+        name.replace( QRegExp( "[^A-Za-z0-9_-]" ), "_" );
+        QString scalarName = m_fileName.absoluteDir().filePath( m_fileName.completeBaseName() + "_" + name + ".tsf" );
+        MRtrixTracks scalars;
+        if ( !scalars.create( scalarName, true, timestamp ) )
+        {
+            return;
+        }
         for ( unsigned int i = 0; i < fibs->size(); ++i )
         {
-            Fib fib = fibs->at(i);
-            out << (qint32)fib.length();
-            for ( unsigned int k = 0; k < fib.length(); ++k )
-            {
-                QVector3D vert = fib.getVert( k );
-                out << (float)vert.x();
-                out << (float)vert.y();
-                out << (float)vert.z();
-            }
+            scalars.append( *fibs->at( i ).getDataField( f ) );
         }
-
-        file.close();
+        scalars.finish();
     }
 }
@@ -45,6 +45,8 @@ private:
     void saveBinaryConnectivity();
     void saveFibJson();
     void saveFibTrk();
+    void saveFibContainer();
+    void saveFibMRtrix();
 };
 
 #endif /* WRITER_H_ */
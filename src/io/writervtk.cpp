@@ -15,18 +15,110 @@
 
 #include "../data/mesh/trianglemesh2.h"
 
+#include "streamwriter.h"
+
 #include <QDebug>
 #include <QFile>
 
-#include <vtkPolyDataWriter.h>
-#include <vtkSmartPointer.h>
-#include <vtkPolyData.h>
-#include <vtkPointData.h>
-#include <vtkCellArray.h>
-#include <vtkCellData.h>
-#include <vtkDoubleArray.h>
-#include <vtkFloatArray.h>
-#include <vtkPolyLine.h>
+namespace
+{
+    // one data block of a legacy vtk file, big endian in binary files, nine values per line in ascii files
+    class Block
+    {
+    public:
+        Block( StreamWriter& out, bool binary ) :
+            m_out( out ),
+            m_binary( binary ),
+            m_count( 0 )
+        {
+        }
+
+        void add( float value )
+        {
+            if ( m_binary )
+            {
+                m_out.writeFloat( value );
+            }
+            else
+            {
+                m_out.writeText( QByteArray::number( value, 'g', 6 ) );
+                separate();
+            }
+        }
+
+        void add( int value )
+        {
+            if ( m_binary )
+            {
+                m_out.writeInt32( value );
+            }
+            else
+            {
+                m_out.writeText( QByteArray::number( value ) );
+                separate();
+            }
+        }
+
+        void addByte( unsigned char value )
+        {
+            if ( m_binary )
+            {
+                m_out.writeInt8( value );
+            }
+            else
+            {
+                m_out.writeText( QByteArray::number( value ) );
+                separate();
+            }
+        }
+
+        void end()
+        {
+            if ( m_binary || m_count % 9 != 0 )
+            {
+                m_out.writeText( "\n" );
+            }
+        }
+
+    private:
+        void separate()
+        {
+            ++m_count;
+            m_out.writeText( m_count % 9 == 0 ? "\n" : " " );
+        }
+
+        StreamWriter& m_out;
+        bool m_binary;
+        int m_count;
+    };
+
+    // array names can't contain white space, vtk escapes it the same way
+    QByteArray encodeName( QString name )
+    {
+        QByteArray in = name.toUtf8();
+        QByteArray out;
+        for ( int i = 0; i < in.size(); ++i )
+        {
+            unsigned char c = in[i];
+            if ( c <= ' ' || c >= 127 || c == '%' || c == '"' )
+            {
+                out += "%" + QByteArray::number( c, 16 ).rightJustified( 2, '0' ).toUpper();
+            }
+            else
+            {
+                out += static_cast<char>( c );
+            }
+        }
+        return out;
+    }
+
+    void writeHeader( StreamWriter& out, bool binary )
+    {
+        out.writeText( "# vtk DataFile Version 3.0\nvtk output\n" );
+        out.writeText( binary ? "BINARY\n" : "ASCII\n" );
+        out.writeText( "DATASET POLYDATA\n" );
+    }
+}
 
 
 WriterVTK::WriterVTK( Dataset* dataset, QString fileName, QString filter ) :
@@ -87,89 +179,96 @@ bool WriterVTK::save()
 void WriterVTK::saveFibs( QString filename, bool binary )
 {
     DatasetFibers* ds = dynamic_cast<DatasetFibers*>( m_dataset );
+    if ( !ds )
+    {
+        return;
+    }
     std::vector< Fib >* fibs = ds->getFibs();
     QList< QString >dataNames = ds->getDataNames();
 
-    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkCellArray> newLines = vtkSmartPointer<vtkCellArray>::New();
-    vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkIdType pointId = 0;
-
-    vtkSmartPointer<vtkUnsignedCharArray> colorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    colorArray->SetNumberOfComponents(3);
-    colorArray->SetName ("CellColors");
-
-    unsigned char rgb[3];
-
-    for ( unsigned int i = 0; i < fibs->size(); ++i )
+    int numLines = fibs->size();
+    int numPoints = 0;
+    for ( int i = 0; i < numLines; ++i )
     {
-        Fib fib = fibs->at( i );
-        vtkSmartPointer<vtkPolyLine> newLine = vtkSmartPointer<vtkPolyLine>::New();
-        QColor color = fib.customColor();
+        numPoints += fibs->at( i ).length();
+    }
 
-        rgb[0] = color.redF() * 255;
-        rgb[1] = color.greenF() * 255;
-        rgb[2] = color.blueF() * 255;
+    qDebug() << "Writing " << filename;
+    QFile file( filename );
+    if ( !file.open( QIODevice::WriteOnly ) )
+    {
+        qCritical() << "Error writing " << filename;
+        return;
+    }
+    StreamWriter out( &file );
+    writeHeader( out, binary );
 
-        colorArray->InsertNextTupleValue( rgb );
+    // points, lines and data are streamed fiber by fiber straight from the fibs
+    out.writeText( "POINTS " + QByteArray::number( numPoints ) + " float\n" );
+    Block points( out, binary );
+    for ( int i = 0; i < numLines; ++i )
+    {
+        const std::vector<QVector3D>* verts = fibs->at( i ).getVerts();
+        for ( unsigned int k = 0; k < verts->size(); ++k )
+        {
+            points.add( verts->at( k ).x() );
+            points.add( verts->at( k ).y() );
+            points.add( verts->at( k ).z() );
+        }
+    }
+    points.end();
 
-        for ( unsigned int k = 0; k < fib.length(); ++k )
+    out.writeText( "LINES " + QByteArray::number( numLines ) + " " + QByteArray::number( numLines + numPoints ) + "\n" );
+    Block lines( out, binary );
+    int pointId = 0;
+    for ( int i = 0; i < numLines; ++i )
+    {
+        int length = fibs->at( i ).length();
+        lines.add( length );
+        for ( int k = 0; k < length; ++k )
         {
-            newPoints->InsertNextPoint( fib[k].x(), fib[k].y(), fib[k].z() );
-            newLine->GetPointIds()->InsertNextId( pointId );
-            ++pointId;
+            lines.add( pointId++ );
         }
-        newLines->InsertNextCell( newLine );
     }
+    lines.end();
 
-    // add points and lines to new polydata
-    newPolyData->SetPoints( newPoints );
-    newPolyData->SetLines( newLines );
-    newPolyData->GetCellData()->AddArray( colorArray );
+    out.writeText( "CELL_DATA " + QByteArray::number( numLines ) + "\nFIELD FieldData 1\n" );
+    out.writeText( "CellColors 3 " + QByteArray::number( numLines ) + " unsigned_char\n" );
+    Block colors( out, binary );
+    for ( int i = 0; i < numLines; ++i )
+    {
+        QColor color = fibs->at( i ).customColor();
+        colors.addByte( color.redF() * 255 );
+        colors.addByte( color.greenF() * 255 );
+        colors.addByte( color.blueF() * 255 );
+    }
+    colors.end();
 
     if ( dataNames[0] != "no data" )
     {
+        out.writeText( "POINT_DATA " + QByteArray::number( numPoints ) + "\nFIELD FieldData " + QByteArray::number( dataNames.size() ) + "\n" );
         for ( int i = 0; i < dataNames.size(); ++i )
         {
-            vtkSmartPointer<vtkFloatArray> dataArray = vtkSmartPointer<vtkFloatArray>::New();
-            dataArray->SetNumberOfComponents( 1 );
-            dataArray->SetName( dataNames[i].toStdString().c_str() );
-
-            for ( unsigned int k = 0; k < fibs->size(); ++k )
+            out.writeText( encodeName( dataNames[i] ) + " 1 " + QByteArray::number( numPoints ) + " float\n" );
+            Block data( out, binary );
+            for ( int k = 0; k < numLines; ++k )
             {
-                Fib fib = fibs->at( k );
+                const Fib& fib = fibs->at( k );
+                const std::vector<float>* field = fib.getDataField( i );
                 for ( unsigned int l = 0; l < fib.length(); ++l )
                 {
-                    dataArray->InsertNextValue( fib.getData( i, l ) );
+                    data.add( ( field && l < field->size() ) ? field->at( l ) : 0.0f );
                 }
             }
-            newPolyData->GetPointData()->AddArray( dataArray );
+            data.end();
         }
     }
 
-    qDebug() << "Writing " << filename;
-    vtkSmartPointer<vtkPolyDataWriter> writer = vtkPolyDataWriter::New();
-    writer->SetFileName( filename.toStdString().c_str() );
-
-    if ( binary )
-    {
-        writer->SetFileTypeToBinary();
-    }
-    else
+    if ( !out.flush() )
     {
-        writer->SetFileTypeToASCII();
+        qCritical() << "Error writing " << filename;
     }
-
-#if VTK_MAJOR_VERSION < 6
-    writer->SetInput( newPolyData );
-#else
-    writer->SetInputData( newPolyData );
-#endif
-
-     if ( ! writer->Write() )
-     {
-         qCritical() << "Error writing " << filename;
-     }
+    file.close();
 }
 
 void WriterVTK::saveMesh( QString filename, TriangleMesh2* mesh, bool binary )
@@ -179,90 +278,72 @@ void WriterVTK::saveMesh( QString filename, TriangleMesh2* mesh, bool binary )
     unsigned int* indexes = mesh->getIndexes();
     float* colors = mesh->getVertexColors();
 
-    unsigned int numPoints = mesh->numVerts();
-    unsigned int numTris = mesh->numTris();
-
-    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-    vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+    int numPoints = mesh->numVerts();
+    int numTris = mesh->numTris();
 
-    for ( unsigned int i = 0; i < numPoints; ++i )
+    qDebug() << "Writing " << filename;
+    QFile file( filename );
+    if ( !file.open( QIODevice::WriteOnly ) )
     {
-        newPoints->InsertNextPoint( points[i*bufferSize], points[i*bufferSize+1], points[i*bufferSize+2] );
+        qCritical() << "Error writing " << filename;
+        return;
     }
+    StreamWriter out( &file );
+    writeHeader( out, binary );
 
-    if ( m_dataset->properties().get( Fn::Property::D_INVERT_VERTEX_ORDER ).toBool() )
+    out.writeText( "POINTS " + QByteArray::number( numPoints ) + " float\n" );
+    Block vertices( out, binary );
+    for ( int i = 0; i < numPoints; ++i )
     {
-        for( unsigned int i = 0; i < numTris; ++i )
-        {
-            polys->InsertNextCell(3);
-            polys->InsertCellPoint( indexes[i*3] );
-            polys->InsertCellPoint( indexes[i*3+2] );
-            polys->InsertCellPoint( indexes[i*3+1] );
-        }
-
+        vertices.add( points[i * bufferSize] );
+        vertices.add( points[i * bufferSize + 1] );
+        vertices.add( points[i * bufferSize + 2] );
     }
-    else
-    {
-        for( unsigned int i = 0; i < numTris; ++i )
-        {
-            polys->InsertNextCell(3);
-            polys->InsertCellPoint( indexes[i*3] );
-            polys->InsertCellPoint( indexes[i*3+1] );
-            polys->InsertCellPoint( indexes[i*3+2] );
-        }
+    vertices.end();
 
-    }
-
-    vtkSmartPointer<vtkUnsignedCharArray> colorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    colorArray->SetNumberOfComponents(3);
-    colorArray->SetName ("Colors");
-
-    unsigned char rgb[3];
-
-    for ( unsigned int i = 0; i < numPoints; ++i )
+    bool invert = m_dataset->properties().get( Fn::Property::D_INVERT_VERTEX_ORDER ).toBool();
+    out.writeText( "POLYGONS " + QByteArray::number( numTris ) + " " + QByteArray::number( numTris * 4 ) + "\n" );
+    Block polys( out, binary );
+    for ( int i = 0; i < numTris; ++i )
     {
-        rgb[0] = colors[4*i]   * 255;
-        rgb[1] = colors[4*i+1] * 255;
-        rgb[2] = colors[4*i+2] * 255;
-
-        colorArray->InsertNextTupleValue( rgb );
+        polys.add( 3 );
+        polys.add( (int)indexes[i * 3] );
+        polys.add( (int)indexes[i * 3 + ( invert ? 2 : 1 )] );
+        polys.add( (int)indexes[i * 3 + ( invert ? 1 : 2 )] );
     }
+    polys.end();
 
-    // add points and lines to new polydata
-    polyData->SetPoints( newPoints );
-    polyData->SetPolys( polys );
-    polyData->GetPointData()->SetScalars( colorArray );
-
-    vtkSmartPointer<vtkFloatArray> dataArray = vtkSmartPointer<vtkFloatArray>::New();
-    dataArray->SetNumberOfComponents( 1 );
-    dataArray->SetName( "data" );
-
-    for ( unsigned int i = 0; i < numPoints; ++i )
+    // unsigned char scalars are color scalars, bytes in binary files and 0..1 floats in ascii files
+    out.writeText( "POINT_DATA " + QByteArray::number( numPoints ) + "\nCOLOR_SCALARS Colors 3\n" );
+    Block rgb( out, binary );
+    for ( int i = 0; i < numPoints * 4; i += 4 )
     {
-        dataArray->InsertNextValue( points[i*bufferSize+6] );
+        for ( int c = 0; c < 3; ++c )
+        {
+            unsigned char value = colors[i + c] * 255;
+            if ( binary )
+            {
+                rgb.addByte( value );
+            }
+            else
+            {
+                rgb.add( value / 255.0f );
+            }
+        }
     }
-    polyData->GetPointData()->AddArray( dataArray );
-
-    qDebug() << "Writing " << filename;
-    vtkSmartPointer<vtkPolyDataWriter> writer = vtkPolyDataWriter::New();
-    writer->SetFileName( filename.toStdString().c_str() );
+    rgb.end();
 
-    if ( binary )
+    out.writeText( "FIELD FieldData 1\ndata 1 " + QByteArray::number( numPoints ) + " float\n" );
+    Block data( out, binary );
+    for ( int i = 0; i < numPoints; ++i )
     {
-        writer->SetFileTypeToBinary();
+        data.add( points[i * bufferSize + 6] );
     }
-    else
-    {
-        writer->SetFileTypeToASCII();
-    }
-#if VTK_MAJOR_VERSION < 6
-    writer->SetInput( polyData );
-#else
-    writer->SetInputData( polyData );
-#endif
-    if ( !writer->Write() )
+    data.end();
+
+    if ( !out.flush() )
     {
         qCritical() << "Error writing " << filename;
     }
+    file.close();
 }
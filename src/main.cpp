@@ -10,7 +10,12 @@
 #include "data/vptr.h"
 #include "gui/mainwindow.h"
 
+#include "algos/trace.h"
+#include "algos/tractdensity.h"
+
+#include "io/batchrunner.h"
 #include "io/loader.h"
+#include "io/textparser.h"
 
 QTextStream *out = 0;
 bool logToFile = false;
@@ -60,6 +65,11 @@ void noOutput( QtMsgType type, const QMessageLogContext& context, const QString
 {
 }
 
+void writeTrace()
+{
+    Trace::writeChromeTrace( Trace::outputFile );
+}
+
 int main( int argc, char *argv[] )
 {
 #ifdef __DEBUG__
@@ -76,6 +86,23 @@ int main( int argc, char *argv[] )
     qDebug() << "(c) 2012, 2014 Ralph Schurade, Joachim Boettger";
     qDebug() << "Submit suggestions, feature requests, bug reports to https://code.google.com/p/braingl/";
 
+    // batch mode runs without display, the dataset properties still own widgets, so
+    // the application object is kept and only the platform plugin is swapped
+    for ( int i = 1; i < argc; ++i )
+    {
+        QString arg( argv[i] );
+        if ( arg == "--batch" && qgetenv( "QT_QPA_PLATFORM" ).isEmpty() )
+        {
+            qputenv( "QT_QPA_PLATFORM", "minimal" );
+        }
+        // registered before the batch modes run, so their exit() still writes the trace
+        if ( arg == "--trace" && i + 1 < argc && Trace::isEnabled() )
+        {
+            Trace::outputFile = QString( argv[i + 1] );
+            atexit( writeTrace );
+        }
+    }
+
     QApplication app( argc, argv );
 
     QCoreApplication::setOrganizationDomain( "braingl.de" );
@@ -118,8 +145,14 @@ int main( int argc, char *argv[] )
                     qDebug() << "-t : runs the loaded script";
                     qDebug() << "-v : toggles verbose mode, warning: this will spam your console with messages";
                     qDebug() << "---";
+                    qDebug() << "--batch <pipelineFile> : runs load, algo, save and set commands without gui and reports timings";
+                    qDebug() << "    algorithms:" << BatchRunner::algorithms().join( ", " );
                     qDebug() << "--isosurface <isoValue> <fileName> : creates an isosurface dataset";
                     qDebug() << "--isoline <isoValue> <fileName> : creates an isoline dataset";
+                    qDebug() << "--parse-benchmark <fileName> : parses an ascii number file and reports MB/s";
+                    qDebug() << "--tdi-benchmark <numFibers> : maps synthetic fibers into a 1mm tract density grid";
+                    qDebug() << "--trace <fileName> : writes a chrome trace json file at exit, needs a build with BRAINGL_TRACE";
+                    qDebug() << "    ctrl+r in a gl view toggles the frame time overlay, ctrl+t writes the trace file";
                     qDebug() << "---";
                     exit( 0 );
                     break;
@@ -199,6 +232,44 @@ int main( int argc, char *argv[] )
                 }
 
             }
+            else if ( arg == "--batch" )
+            {
+                if ( args.length() > i + 1 )
+                {
+                    out = new QTextStream( stdout );
+                    qInstallMessageHandler( logOutput );
+                    Models::init();
+                    BatchRunner runner( args.at( ++i ) );
+                    exit( runner.run() ? 0 : 1 );
+                }
+            }
+            else if ( arg == "--parse-benchmark" )
+            {
+                if ( args.length() > i + 1 )
+                {
+                    debug = true;
+                    out = new QTextStream( stdout );
+                    qInstallMessageHandler( logOutput );
+                    TextParser::benchmark( args.at( ++i ) );
+                    exit( 0 );
+                }
+            }
+            else if ( arg == "--tdi-benchmark" )
+            {
+                if ( args.length() > i + 1 )
+                {
+                    debug = true;
+                    out = new QTextStream( stdout );
+                    qInstallMessageHandler( logOutput );
+                    TractDensity::benchmark( args.at( ++i ).toInt() );
+                    exit( 0 );
+                }
+            }
+            else if ( arg == "--trace" )
+            {
+                // handled before the application object is created
+                ++i;
+            }
             else if ( arg == "--isoline")
             {
                 if ( args.length() > i + 1 )